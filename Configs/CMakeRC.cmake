@@ -1,6 +1,54 @@
 # This block is executed when generating an intermediate resource file, not when
 # running in CMake configure mode
 if(_CMRC_GENERATE_MODE)
+    if(EMBED STREQUAL "INCBIN")
+        # The assembler copies the file into the object as it is, so nothing is
+        # converted here, regardless of the file size. The payload hash is part of
+        # the symbol names, so that the source changes whenever the payload does
+        # (compiler caches only see the source, not the included file).
+        file(MD5 "${INPUT_FILE}" hash)
+        string(SUBSTRING "${hash}" 0 8 hash)
+        set(label "cmrc_${NAMESPACE}_${SYMBOL}_${hash}")
+        string(REPLACE "\\" "/" path "${INPUT_FILE}")
+        string(REPLACE "\"" "\\\"" path "${path}")
+        string(CONFIGURE [[
+            #if defined(__APPLE__)
+            #define CMRC_INCBIN_SECTION "__TEXT,__const"
+            #define CMRC_INCBIN_LABEL(name) "_" name
+            #define CMRC_INCBIN_HIDDEN(name) ".private_extern " CMRC_INCBIN_LABEL(name) "\n"
+            #elif defined(_WIN32)
+            #define CMRC_INCBIN_SECTION ".rdata,\"dr\""
+            #define CMRC_INCBIN_LABEL(name) name
+            #define CMRC_INCBIN_HIDDEN(name) ""
+            #else
+            #define CMRC_INCBIN_SECTION ".rodata"
+            #define CMRC_INCBIN_LABEL(name) name
+            #define CMRC_INCBIN_HIDDEN(name) ".hidden " CMRC_INCBIN_LABEL(name) "\n"
+            #endif
+            __asm__(
+                ".pushsection " CMRC_INCBIN_SECTION "\n"
+                ".balign 16\n"
+                ".globl " CMRC_INCBIN_LABEL("@label@_begin") "\n"
+                ".globl " CMRC_INCBIN_LABEL("@label@_end") "\n"
+                CMRC_INCBIN_HIDDEN("@label@_begin")
+                CMRC_INCBIN_HIDDEN("@label@_end")
+                CMRC_INCBIN_LABEL("@label@_begin") ":\n"
+                ".incbin \"@path@\"\n"
+                CMRC_INCBIN_LABEL("@label@_end") ":\n"
+                ".byte 0\n"
+                ".popsection\n");
+            extern "C" const char @label@_begin[];
+            extern "C" const char @label@_end[];
+            namespace cmrc { namespace @NAMESPACE@ { namespace res_chars {
+            extern const char* const @SYMBOL@_begin = @label@_begin;
+            extern const char* const @SYMBOL@_end = @label@_end;
+            }}}
+        ]] code @ONLY)
+        string(REPLACE "\n            " "\n" code "${code}")
+        string(STRIP "${code}" code)
+        file(WRITE "${OUTPUT_FILE}" "${code}\n")
+        return()
+    endif()
     # Read in the digits
     file(READ "${INPUT_FILE}" bytes HEX)
     # Format each pair into a character literal. Heuristics seem to favor doing
@@ -49,6 +97,13 @@ set(_CMRC_VERSION "${_version}" CACHE INTERNAL "CMakeRC version. Used for checki
 
 set(_CMRC_SCRIPT "${CMAKE_CURRENT_LIST_FILE}" CACHE INTERNAL "Path to CMakeRC script")
 
+# HEX converts every file into a C array at build time, which is portable but slow
+# and memory hungry for files larger than a few hundred KB. INCBIN lets the
+# assembler include the file directly (GCC and Clang only). AUTO picks INCBIN
+# whenever the compiler supports it.
+set(CMRC_EMBED_MODE "AUTO" CACHE STRING "How CMakeRC embeds resource files (AUTO, HEX or INCBIN)")
+set_property(CACHE CMRC_EMBED_MODE PROPERTY STRINGS "AUTO" "HEX" "INCBIN")
+
 function(_cmrc_normalize_path var)
     set(path "${${var}}")
     file(TO_CMAKE_PATH "${path}" path)
@@ -413,7 +468,7 @@ set_property(TARGET cmrc-base PROPERTY INTERFACE_CXX_EXTENSIONS OFF)
 add_library(cmrc::base ALIAS cmrc-base)
 
 function(cmrc_add_resource_library name)
-    set(args ALIAS NAMESPACE TYPE)
+    set(args ALIAS NAMESPACE TYPE EMBED)
     cmake_parse_arguments(ARG "" "${args}" "" "${ARGN}")
     # Generate the identifier for the resource library's namespace
     set(ns_re "[a-zA-Z_][a-zA-Z0-9_]*")
@@ -437,6 +492,22 @@ function(cmrc_add_resource_library name)
         message(SEND_ERROR "${ARG_TYPE} is not a valid TYPE (STATIC and OBJECT are acceptable)")
         set(ARG_TYPE STATIC)
     endif()
+    # Resolve how files are embedded, the library may override the global mode
+    if(NOT DEFINED ARG_EMBED)
+        set(ARG_EMBED "${CMRC_EMBED_MODE}")
+    endif()
+    if(NOT ARG_EMBED MATCHES "^(AUTO|HEX|INCBIN)$")
+        message(SEND_ERROR "${ARG_EMBED} is not a valid EMBED mode (AUTO, HEX and INCBIN are acceptable)")
+        set(ARG_EMBED AUTO)
+    endif()
+    if(ARG_EMBED STREQUAL "AUTO")
+        _cmrc_incbin_supported(incbin)
+        if(incbin)
+            set(ARG_EMBED INCBIN)
+        else()
+            set(ARG_EMBED HEX)
+        endif()
+    endif()
     # Generate a library with the compiled in character arrays.
     string(CONFIGURE [=[
         #include <cmrc/cmrc.hpp>
@@ -498,6 +569,7 @@ function(cmrc_add_resource_library name)
     add_library(${name} ${ARG_TYPE} ${libcpp})
     set_property(TARGET ${name} PROPERTY CMRC_LIBDIR "${libdir}")
     set_property(TARGET ${name} PROPERTY CMRC_NAMESPACE "${ARG_NAMESPACE}")
+    set_property(TARGET ${name} PROPERTY CMRC_EMBED "${ARG_EMBED}")
     target_link_libraries(${name} PUBLIC cmrc::base)
     set_property(TARGET ${name} PROPERTY CMRC_IS_RESOURCE_LIBRARY TRUE)
     if(ARG_ALIAS)
@@ -506,6 +578,14 @@ function(cmrc_add_resource_library name)
     cmrc_add_resources(${name} ${ARG_UNPARSED_ARGUMENTS})
 endfunction()
 
+function(_cmrc_incbin_supported var)
+    set(supported FALSE)
+    if(CMAKE_CXX_COMPILER_ID MATCHES "^(GNU|Clang|AppleClang)$" AND NOT CMAKE_CXX_COMPILER_FRONTEND_VARIANT STREQUAL "MSVC")
+        set(supported TRUE)
+    endif()
+    set(${var} ${supported} PARENT_SCOPE)
+endfunction()
+
 function(_cmrc_register_dirs name dirpath)
     if(dirpath STREQUAL "")
         return()
@@ -557,6 +637,7 @@ function(cmrc_add_resources name)
 
     # Generate the identifier for the resource library's namespace
     get_target_property(lib_ns "${name}" CMRC_NAMESPACE)
+    get_target_property(lib_embed "${name}" CMRC_EMBED)
 
     get_target_property(libdir ${name} CMRC_LIBDIR)
     get_target_property(target_dir ${name} SOURCE_DIR)
@@ -595,7 +676,7 @@ function(cmrc_add_resources name)
             _cm_encode_fpath(parent_sym "${dirpath}")
         endif()
         # Generate the rule for the intermediate source file
-        _cmrc_generate_intermediate_cpp(${lib_ns} ${sym} "${abs_out}" "${abs_in}")
+        _cmrc_generate_intermediate_cpp(${lib_ns} ${sym} "${abs_out}" "${abs_in}" ${lib_embed})
         target_sources(${name} PRIVATE "${abs_out}")
         set_property(TARGET ${name} APPEND PROPERTY CMRC_EXTERN_DECLS
             "// Pointers to ${input}"
@@ -618,7 +699,7 @@ function(cmrc_add_resources name)
     endforeach()
 endfunction()
 
-function(_cmrc_generate_intermediate_cpp lib_ns symbol outfile infile)
+function(_cmrc_generate_intermediate_cpp lib_ns symbol outfile infile embed)
     add_custom_command(
         # This is the file we will generate
         OUTPUT "${outfile}"
@@ -629,6 +710,7 @@ function(_cmrc_generate_intermediate_cpp lib_ns symbol outfile infile)
                 -D_CMRC_GENERATE_MODE=TRUE
                 -DNAMESPACE=${lib_ns}
                 -DSYMBOL=${symbol}
+                -DEMBED=${embed}
                 "-DINPUT_FILE=${infile}"
                 "-DOUTPUT_FILE=${outfile}"
                 -P "${_CMRC_SCRIPT}"
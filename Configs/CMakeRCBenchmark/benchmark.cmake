@@ -0,0 +1,101 @@
+# Measures configure and build time of CMakeRC against payload size, for each embed mode.
+#
+#   cmake [-DSIZES=1;64;1024;8192] [-DMODES=HEX;INCBIN] [-DWORKDIR=<dir>] -P benchmark.cmake
+#
+# WORKDIR defaults to Scratch/CMakeRCBenchmark, the git ignored build directory of the repository.
+#
+# SIZES are in KB. Every build starts from an empty build directory,
+# and the embedded payload is checked against the original file after the build.
+
+cmake_minimum_required(VERSION 3.23)
+
+if(NOT DEFINED SIZES)
+    set(SIZES 1 64 1024 8192)
+endif()
+if(NOT DEFINED MODES)
+    set(MODES HEX INCBIN)
+endif()
+if(NOT DEFINED WORKDIR)
+    set(WORKDIR "${CMAKE_CURRENT_LIST_DIR}/../../Scratch/CMakeRCBenchmark")
+endif()
+get_filename_component(WORKDIR "${WORKDIR}" ABSOLUTE)
+
+function(now_ms var)
+    string(TIMESTAMP seconds "%s")
+    string(TIMESTAMP micros "%f")
+    math(EXPR ms "${seconds} * 1000 + ${micros} / 1000")
+    set(${var} ${ms} PARENT_SCOPE)
+endfunction()
+
+# payloads are random text, the cost of embedding does not depend on the content
+function(generate_payload path kb)
+    string(RANDOM LENGTH 1024 chunk)
+    set(block "")
+    foreach(i RANGE 63)
+        string(APPEND block "${chunk}")
+    endforeach()
+
+    file(WRITE "${path}" "")
+    math(EXPR blocks "${kb} / 64")
+    math(EXPR rest "${kb} % 64")
+    if(blocks GREATER 0)
+        foreach(i RANGE 1 ${blocks})
+            file(APPEND "${path}" "${block}")
+        endforeach()
+    endif()
+    if(rest GREATER 0)
+        foreach(i RANGE 1 ${rest})
+            file(APPEND "${path}" "${chunk}")
+        endforeach()
+    endif()
+endfunction()
+
+function(run_step label var)
+    now_ms(begin)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE output)
+    now_ms(end)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${label} failed:\n${output}")
+    endif()
+    math(EXPR elapsed "${end} - ${begin}")
+    set(${var} ${elapsed} PARENT_SCOPE)
+endfunction()
+
+function(pad var text width)
+    string(LENGTH "${text}" length)
+    while(length LESS width)
+        string(PREPEND text " ")
+        math(EXPR length "${length} + 1")
+    endwhile()
+    set(${var} "${text}" PARENT_SCOPE)
+endfunction()
+
+message(STATUS "  mode     size KB  configure ms   build ms")
+foreach(kb IN LISTS SIZES)
+    set(payload_dir "${WORKDIR}/payload-${kb}")
+    file(MAKE_DIRECTORY "${payload_dir}")
+    generate_payload("${payload_dir}/payload.bin" ${kb})
+
+    foreach(mode IN LISTS MODES)
+        set(build "${WORKDIR}/build-${mode}-${kb}")
+        file(REMOVE_RECURSE "${build}")
+
+        run_step("configure ${mode} ${kb} KB" configure_ms
+            "${CMAKE_COMMAND}" -S "${CMAKE_CURRENT_LIST_DIR}" -B "${build}"
+            -DCMAKE_BUILD_TYPE=Release -DCMRC_EMBED_MODE=${mode} "-DPAYLOAD=${payload_dir}/payload.bin")
+        run_step("build ${mode} ${kb} KB" build_ms
+            "${CMAKE_COMMAND}" --build "${build}" --config Release)
+
+        find_program(check payload-check PATHS "${build}" "${build}/Release" NO_DEFAULT_PATH NO_CACHE)
+        execute_process(COMMAND "${check}" RESULT_VARIABLE result OUTPUT_QUIET ERROR_VARIABLE output)
+        if(NOT result EQUAL 0)
+            message(FATAL_ERROR "${mode} ${kb} KB: ${output}")
+        endif()
+
+        pad(mode_text "${mode}" 6)
+        pad(kb_text "${kb}" 11)
+        pad(configure_text "${configure_ms}" 14)
+        pad(build_text "${build_ms}" 11)
+        message(STATUS "${mode_text}${kb_text}${configure_text}${build_text}")
+    endforeach()
+endforeach()
@@ -0,0 +1,31 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <cmrc/cmrc.hpp>
+
+CMRC_DECLARE(payload);
+
+int main()
+{
+    auto fs       = cmrc::payload::get_filesystem();
+    auto embedded = fs.open("payload.bin");
+
+    auto input    = std::ifstream(PAYLOAD_PATH, std::ios::binary);
+    auto original = std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+
+    if (embedded.size() != original.size() || std::memcmp(embedded.begin(), original.data(), original.size()) != 0) {
+        std::cerr << "embedded payload does not match " << PAYLOAD_PATH << std::endl;
+        return 1;
+    }
+
+    // NOTE: samples read embedded shaders as C strings
+    if (*embedded.end() != '\0') {
+        std::cerr << "embedded payload is not null terminated" << std::endl;
+        return 1;
+    }
+
+    std::cout << embedded.size() << " bytes" << std::endl;
+    return 0;
+}
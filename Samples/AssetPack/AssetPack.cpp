@@ -0,0 +1,197 @@
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include "AssetPack.h"
+#include "FileMapping.h"
+#include "LZ4.h"
+
+namespace
+{
+    auto normalize_path(std::string path) -> std::string
+    {
+        while (!path.empty() && path.front() == '/')
+            path.erase(path.begin());
+        return path;
+    }
+} // namespace
+
+auto pack_hash(const std::string& path) -> uint64_t
+{
+    auto hash = uint64_t(14695981039346656037ull);
+    for (char c : path) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+auto AssetPack::load(const std::string& path) -> std::unique_ptr<AssetPack>
+{
+    auto pack     = std::unique_ptr<AssetPack>(new AssetPack());
+    pack->mapping = map_file(path, pack->mapping_size, pack->handle);
+    if (!pack->mapping)
+        return nullptr;
+
+    // validate everything the index points at once, so that lookups do not need to
+    auto  size   = pack->mapping_size;
+    auto* header = reinterpret_cast<const PackHeader*>(pack->mapping);
+    if (size < sizeof(PackHeader) || std::memcmp(header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header->version != PACK_VERSION)
+        return nullptr;
+
+    auto buckets_size = uint64_t(header->bucket_count) * sizeof(uint32_t);
+    auto entries_size = uint64_t(header->entry_count) * sizeof(PackEntry);
+    if (header->bucket_count == 0 || (header->bucket_count & (header->bucket_count - 1)) != 0 ||
+        (header->index_offset + buckets_size) % alignof(PackEntry) != 0 || header->index_offset > size ||
+        header->index_size > size - header->index_offset || buckets_size + entries_size > header->index_size)
+        return nullptr;
+
+    auto* index   = pack->mapping + header->index_offset;
+    auto  names   = header->index_size - buckets_size - entries_size;
+    pack->header  = header;
+    pack->buckets = reinterpret_cast<const uint32_t*>(index);
+    pack->entries = reinterpret_cast<const PackEntry*>(index + buckets_size);
+    pack->names   = reinterpret_cast<const char*>(index + buckets_size + entries_size);
+
+    for (uint i = 0; i < header->bucket_count; i++)
+        if (pack->buckets[i] != PACK_INVALID && pack->buckets[i] >= header->entry_count)
+            return nullptr;
+
+    for (uint i = 0; i < header->entry_count; i++) {
+        auto& entry = pack->entries[i];
+        auto  extra = entry.codec == PackCodec::NONE ? 1 : 0; // trailing null byte
+        if (entry.offset > size || entry.stored_size + extra > size - entry.offset ||
+            uint64_t(entry.name_offset) + entry.name_length > names ||
+            (entry.next != PACK_INVALID && entry.next >= header->entry_count) ||
+            (entry.codec != PackCodec::NONE && entry.codec != PackCodec::LZ4) ||
+            (entry.codec == PackCodec::NONE && entry.stored_size != entry.size) ||
+            (entry.codec == PackCodec::LZ4 && entry.size > entry.stored_size * LZ4_MAX_EXPANSION))
+            return nullptr;
+    }
+
+    // every entry belongs to exactly one chain, so a chain that reaches an entry twice is a cycle and find() would never return
+    auto reached = std::vector<bool>(header->entry_count, false);
+    for (uint i = 0; i < header->bucket_count; i++) {
+        for (auto index = pack->buckets[i]; index != PACK_INVALID; index = pack->entries[index].next) {
+            if (reached[index])
+                return nullptr;
+            reached[index] = true;
+        }
+    }
+
+    pack->slots.resize(header->entry_count);
+    return pack;
+}
+
+AssetPack::~AssetPack()
+{
+    // NOTE: background decompression writes into slots, wait for it before anything goes away
+    for (auto& slot : slots)
+        if (slot.pending.valid())
+            slot.pending.wait();
+
+    if (mapping)
+        unmap_file(mapping, mapping_size, handle);
+}
+
+auto AssetPack::find(const std::string& path) const -> uint
+{
+    auto name = normalize_path(path);
+    auto hash = pack_hash(name);
+
+    for (auto index = buckets[hash & (header->bucket_count - 1)]; index != PACK_INVALID; index = entries[index].next) {
+        auto& entry = entries[index];
+        if (entry.hash == hash && entry.name_length == name.size() && std::memcmp(names + entry.name_offset, name.data(), name.size()) == 0)
+            return index;
+    }
+    return PACK_INVALID;
+}
+
+auto AssetPack::exists(const std::string& path) const -> bool
+{
+    return find(path) != PACK_INVALID;
+}
+
+auto AssetPack::open(const std::string& path) -> AssetFile
+{
+    auto index = find(path);
+    if (index == PACK_INVALID)
+        throw std::system_error(make_error_code(std::errc::no_such_file_or_directory), path);
+
+    auto& entry = entries[index];
+    if (entry.codec == PackCodec::NONE) {
+        auto* data = reinterpret_cast<const char*>(mapping + entry.offset);
+        return AssetFile(data, data + entry.size);
+    }
+
+    // rethrows if decompression failed
+    request(index, false).get();
+
+    auto* data = slots[index].data.get();
+    return AssetFile(data, data + entry.size);
+}
+
+void AssetPack::prefetch(const std::string& path)
+{
+    auto index = find(path);
+    if (index != PACK_INVALID && entries[index].codec != PackCodec::NONE)
+        request(index, true);
+}
+
+auto AssetPack::request(uint index, bool async) -> std::shared_future<void>
+{
+    auto  lock = std::unique_lock<std::mutex>(mutex);
+    auto& slot = slots[index];
+    if (slot.pending.valid())
+        return slot.pending;
+
+    if (async) {
+        slot.pending = std::async(std::launch::async, [this, index]() { decompress(index); }).share();
+        return slot.pending;
+    }
+
+    // decompress on the calling thread, other threads asking for the same entry wait for it
+    auto promise  = std::promise<void>();
+    slot.pending  = promise.get_future().share();
+    auto pending  = slot.pending;
+    lock.unlock();
+
+    try {
+        decompress(index);
+        promise.set_value();
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+    return pending;
+}
+
+void AssetPack::decompress(uint index)
+{
+    auto& entry = entries[index];
+    auto  data  = std::unique_ptr<char[]>(new char[entry.size + 1]);
+
+    auto* dst = reinterpret_cast<uint8_t*>(data.get());
+    if (!lz4_decompress(mapping + entry.offset, entry.stored_size, dst, entry.size))
+        throw std::runtime_error("corrupted asset pack entry: " + std::string(names + entry.name_offset, entry.name_length));
+    data[entry.size] = '\0';
+
+    // NOTE: readers only look at the data after waiting on the slot's future
+    slots[index].data = std::move(data);
+    decompressed_count++;
+    decompressed_bytes += entry.size + 1;
+}
+
+auto AssetPack::stats() const -> AssetPackStats
+{
+    auto stats               = AssetPackStats{};
+    stats.entry_count        = header->entry_count;
+    stats.file_bytes         = mapping_size;
+    stats.decompressed_count = decompressed_count;
+    stats.decompressed_bytes = decompressed_bytes;
+
+    for (uint i = 0; i < header->entry_count; i++) {
+        stats.stored_bytes += entries[i].stored_size;
+        stats.original_bytes += entries[i].size;
+    }
+    return stats;
+}
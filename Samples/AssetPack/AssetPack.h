@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Lyra/Common.hpp>
+
+// On-disk layout of an asset pack, little endian:
+//
+//   PackHeader
+//   blobs, each aligned to PACK_ALIGNMENT (stored blobs are followed by a null byte)
+//   index: bucket_count x uint32_t, entry_count x PackEntry, names
+//
+// Entries are looked up by the FNV-1a hash of their path, chained per bucket.
+
+constexpr char     PACK_MAGIC[8]  = {'L', 'Y', 'R', 'A', 'P', 'A', 'C', 'K'};
+constexpr uint32_t PACK_VERSION   = 1;
+constexpr uint64_t PACK_ALIGNMENT = 16;
+constexpr uint32_t PACK_INVALID   = ~0u;
+
+enum class PackCodec : uint32_t
+{
+    NONE, // stored as is, opened without a copy
+    LZ4,  // LZ4 block, decompressed on first access
+};
+
+struct PackHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t bucket_count; // power of two
+    uint32_t reserved;
+    uint64_t index_offset;
+    uint64_t index_size;
+};
+
+struct PackEntry
+{
+    uint64_t  hash;
+    uint64_t  offset;
+    uint64_t  stored_size;
+    uint64_t  size;
+    uint32_t  name_offset;
+    uint32_t  name_length;
+    PackCodec codec;
+    uint32_t  next; // next entry in the same bucket
+};
+
+auto pack_hash(const std::string& path) -> uint64_t;
+
+// Same interface as cmrc::file, the data is always followed by a null byte.
+class AssetFile
+{
+public:
+    using iterator       = const char*;
+    using const_iterator = iterator;
+
+    AssetFile() = default;
+    AssetFile(iterator begin, iterator end) noexcept : _begin(begin), _end(end) {}
+
+    iterator begin() const noexcept { return _begin; }
+    iterator end() const noexcept { return _end; }
+    auto     size() const -> size_t { return static_cast<size_t>(_end - _begin); }
+
+private:
+    const char* _begin = nullptr;
+    const char* _end   = nullptr;
+};
+
+struct AssetPackStats
+{
+    uint     entry_count        = 0;
+    uint64_t file_bytes         = 0; // size of the pack file, mapped but only paged in when touched
+    uint64_t stored_bytes       = 0; // sum of all blobs as stored
+    uint64_t original_bytes     = 0; // sum of all blobs after decompression
+    uint     decompressed_count = 0;
+    uint64_t decompressed_bytes = 0; // heap memory used by decompressed entries
+};
+
+// Read-only memory mapped asset pack.
+// Compressed entries are decompressed once, on the first open() or in the background with prefetch(),
+// and stay resident for the lifetime of the pack. Everything else is left to the page cache.
+class AssetPack
+{
+public:
+    // Returns nullptr when the file cannot be mapped or is not a valid pack.
+    static auto load(const std::string& path) -> std::unique_ptr<AssetPack>;
+
+    ~AssetPack();
+
+    AssetPack(const AssetPack&)            = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // Throws std::system_error when the entry does not exist, like cmrc::embedded_filesystem::open().
+    auto open(const std::string& path) -> AssetFile;
+
+    // Decompress an entry on a worker thread, so that a later open() does not have to wait for it.
+    void prefetch(const std::string& path);
+
+    auto exists(const std::string& path) const -> bool;
+    auto stats() const -> AssetPackStats;
+
+private:
+    struct Slot
+    {
+        std::shared_future<void> pending; // valid once decompression has been requested
+        std::unique_ptr<char[]>  data;
+    };
+
+    AssetPack() = default;
+
+    auto find(const std::string& path) const -> uint;
+    auto request(uint index, bool async) -> std::shared_future<void>;
+    void decompress(uint index);
+
+private:
+    const uint8_t*        mapping            = nullptr;
+    uint64_t              mapping_size       = 0;
+    void*                 handle             = nullptr; // platform file mapping
+    const PackHeader*     header             = nullptr;
+    const uint32_t*       buckets            = nullptr;
+    const PackEntry*      entries            = nullptr;
+    const char*           names              = nullptr;
+    std::mutex            mutex;
+    std::vector<Slot>     slots;
+    std::atomic<uint>     decompressed_count = 0;
+    std::atomic<uint64_t> decompressed_bytes = 0;
+};
@@ -0,0 +1,73 @@
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "FileMapping.h"
+
+auto map_file(const std::string& path, uint64_t& size, void*& handle) -> const uint8_t*
+{
+#if defined(_WIN32)
+    auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    auto length = LARGE_INTEGER{};
+    if (!GetFileSizeEx(file, &length) || length.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        return nullptr;
+
+    auto data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping);
+        return nullptr;
+    }
+
+    size   = static_cast<uint64_t>(length.QuadPart);
+    handle = mapping;
+    return static_cast<const uint8_t*>(data);
+#else
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    auto data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    size   = static_cast<uint64_t>(info.st_size);
+    handle = nullptr;
+    return static_cast<const uint8_t*>(data);
+#endif
+}
+
+void unmap_file(const uint8_t* data, uint64_t size, void* handle)
+{
+#if defined(_WIN32)
+    (void)size;
+    UnmapViewOfFile(data);
+    CloseHandle(handle);
+#else
+    (void)handle;
+    munmap(const_cast<uint8_t*>(data), static_cast<size_t>(size));
+#endif
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap / MapViewOfFile), shared by AssetPack and MipStreaming.
+// NOTE: the size of the mapping is the size of the file at the time it is mapped.
+
+// Returns nullptr when the file cannot be opened, is empty, or cannot be mapped.
+// On success, size and handle are to be passed back to unmap_file().
+auto map_file(const std::string& path, uint64_t& size, void*& handle) -> const uint8_t*;
+
+void unmap_file(const uint8_t* data, uint64_t size, void* handle);
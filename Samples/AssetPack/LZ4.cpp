@@ -0,0 +1,175 @@
+#include <cstring>
+#include <vector>
+
+#include "LZ4.h"
+
+namespace
+{
+    constexpr size_t MIN_MATCH     = 4;
+    constexpr size_t LAST_LITERALS = 5;  // the last 5 bytes are always literals
+    constexpr size_t MATCH_LIMIT   = 12; // the last match must start at least 12 bytes before the end
+    constexpr size_t MAX_OFFSET    = 65535;
+    constexpr size_t HASH_LOG      = 16;
+
+    auto read32(const uint8_t* p) -> uint32_t
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    auto hash(uint32_t sequence) -> uint32_t
+    {
+        return (sequence * 2654435761u) >> (32 - HASH_LOG);
+    }
+
+    // lengths of 15 and above continue in extra bytes of 255, ended by a byte below 255
+    auto write_length(uint8_t*& op, const uint8_t* end, size_t length) -> bool
+    {
+        for (; length >= 255; length -= 255) {
+            if (op >= end) return false;
+            *op++ = 255;
+        }
+        if (op >= end) return false;
+        *op++ = static_cast<uint8_t>(length);
+        return true;
+    }
+
+    auto read_length(const uint8_t*& ip, const uint8_t* end, size_t& length) -> bool
+    {
+        uint8_t byte;
+        do {
+            if (ip >= end) return false;
+            byte = *ip++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    auto write_sequence(uint8_t*& op, const uint8_t* end, const uint8_t* literals, size_t literal_length, size_t offset, size_t match_length) -> bool
+    {
+        auto  has_match = match_length >= MIN_MATCH;
+        auto  extra     = has_match ? match_length - MIN_MATCH : 0;
+        auto* token     = op++;
+        if (token >= end) return false;
+
+        *token = static_cast<uint8_t>((literal_length < 15 ? literal_length : 15) << 4);
+        if (literal_length >= 15 && !write_length(op, end, literal_length - 15))
+            return false;
+
+        if (size_t(end - op) < literal_length) return false;
+        if (literal_length > 0)
+            std::memcpy(op, literals, literal_length);
+        op += literal_length;
+
+        if (!has_match)
+            return true;
+
+        if (end - op < 2) return false;
+        *op++ = static_cast<uint8_t>(offset & 0xff);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+
+        *token |= static_cast<uint8_t>(extra < 15 ? extra : 15);
+        if (extra >= 15 && !write_length(op, end, extra - 15))
+            return false;
+        return true;
+    }
+} // namespace
+
+auto lz4_compress_bound(size_t size) -> size_t
+{
+    return size + size / 255 + 16;
+}
+
+auto lz4_compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) -> size_t
+{
+    auto* op     = dst;
+    auto* end    = dst + capacity;
+    auto  anchor = size_t(0);
+
+    if (size > MATCH_LIMIT) {
+        // NOTE: positions are stored + 1, so that 0 means empty
+        auto table = std::vector<uint32_t>(size_t(1) << HASH_LOG, 0);
+        auto limit = size - MATCH_LIMIT;
+        auto ip    = size_t(0);
+
+        while (ip < limit) {
+            auto sequence  = read32(src + ip);
+            auto& slot     = table[hash(sequence)];
+            auto candidate = size_t(slot);
+            slot           = static_cast<uint32_t>(ip + 1);
+
+            if (candidate == 0 || ip - (candidate - 1) > MAX_OFFSET || read32(src + candidate - 1) != sequence) {
+                ip++;
+                continue;
+            }
+
+            auto match  = candidate - 1;
+            auto length = MIN_MATCH;
+            while (ip + length < size - LAST_LITERALS && src[match + length] == src[ip + length])
+                length++;
+
+            if (!write_sequence(op, end, src + anchor, ip - anchor, ip - match, length))
+                return 0;
+
+            ip += length;
+            anchor = ip;
+        }
+    }
+
+    // the block always ends with a literal-only sequence
+    if (!write_sequence(op, end, src + anchor, size - anchor, 0, 0))
+        return 0;
+    return static_cast<size_t>(op - dst);
+}
+
+auto lz4_decompress(const uint8_t* src, size_t stored_size, uint8_t* dst, size_t size) -> bool
+{
+    auto* ip     = src;
+    auto* in_end = src + stored_size;
+    auto* op     = dst;
+    auto* end    = dst + size;
+
+    while (ip < in_end) {
+        auto token          = *ip++;
+        auto literal_length = size_t(token >> 4);
+        if (literal_length == 15 && !read_length(ip, in_end, literal_length))
+            return false;
+
+        if (size_t(in_end - ip) < literal_length || size_t(end - op) < literal_length)
+            return false;
+        if (literal_length > 0)
+            std::memcpy(op, ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+
+        // the last sequence has no match
+        if (ip == in_end)
+            break;
+
+        if (in_end - ip < 2)
+            return false;
+        auto offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > size_t(op - dst))
+            return false;
+
+        auto match_length = size_t(token & 15);
+        if (match_length == 15 && !read_length(ip, in_end, match_length))
+            return false;
+        match_length += MIN_MATCH;
+        if (size_t(end - op) < match_length)
+            return false;
+
+        // NOTE: matches may overlap their own output (offset < length), so copy byte by byte in that case
+        auto* match = op - offset;
+        if (offset >= match_length) {
+            std::memcpy(op, match, match_length);
+            op += match_length;
+        } else {
+            for (size_t i = 0; i < match_length; i++)
+                *op++ = *match++;
+        }
+    }
+    return op == end;
+}
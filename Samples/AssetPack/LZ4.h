@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// LZ4 block format (no frame header), compatible with LZ4_compress_default / LZ4_decompress_safe.
+// The compressor is a plain greedy matcher with a single hash table: fast, with a ratio
+// close to the reference implementation at its default level.
+
+// Every byte of a block expands to at most this many bytes, i.e. a valid block of n bytes decompresses to at most n * 255 bytes.
+constexpr uint64_t LZ4_MAX_EXPANSION = 255;
+
+// Largest possible compressed size of an input of the given size.
+auto lz4_compress_bound(size_t size) -> size_t;
+
+// Returns the compressed size, or 0 when dst is too small.
+auto lz4_compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) -> size_t;
+
+// Decompresses exactly size bytes, returns false on malformed or truncated input.
+auto lz4_decompress(const uint8_t* src, size_t stored_size, uint8_t* dst, size_t size) -> bool;
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "AssetPack.h"
+#include "LZ4.h"
+
+// Builds an asset pack from a list of files.
+//
+//   asset-packer <output> <whence> <file>...
+//
+// Entries are named by their path relative to <whence>. Each file is compressed with LZ4,
+// unless that saves less than an eighth of its size, in which case it is stored as is.
+
+struct Input
+{
+    std::string          name;
+    std::vector<uint8_t> data;
+};
+
+auto read_file(const std::string& path, std::vector<uint8_t>& data) -> bool
+{
+    auto file = std::ifstream(path, std::ios::binary);
+    if (!file)
+        return false;
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+auto relative_name(std::string whence, std::string path) -> std::string
+{
+    std::replace(whence.begin(), whence.end(), '\\', '/');
+    std::replace(path.begin(), path.end(), '\\', '/');
+    if (!whence.empty() && whence.back() != '/')
+        whence += '/';
+    if (path.compare(0, whence.size(), whence) == 0)
+        path = path.substr(whence.size());
+    while (!path.empty() && path.front() == '/')
+        path.erase(path.begin());
+    return path;
+}
+
+void pad_to(std::ofstream& out, uint64_t& offset, uint64_t alignment)
+{
+    static const char zeros[PACK_ALIGNMENT] = {};
+    auto padding = (alignment - offset % alignment) % alignment;
+    out.write(zeros, static_cast<std::streamsize>(padding));
+    offset += padding;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4) {
+        std::cerr << "usage: asset-packer <output> <whence> <file>..." << std::endl;
+        return 1;
+    }
+
+    auto output = std::string(argv[1]);
+    auto whence = std::string(argv[2]);
+    auto inputs = std::vector<Input>{};
+
+    for (int i = 3; i < argc; i++) {
+        auto path  = std::string(argv[i]);
+        auto input = Input{};
+        input.name = relative_name(whence, path);
+
+        // relative inputs are taken from <whence>
+        if (!read_file(path, input.data) && !read_file(whence + "/" + path, input.data)) {
+            std::cerr << "failed to read " << path << std::endl;
+            return 1;
+        }
+        inputs.push_back(std::move(input));
+    }
+
+    // NOTE: at least 2 buckets, so that the entries after them stay 8 byte aligned
+    auto bucket_count = uint32_t(2);
+    while (bucket_count < inputs.size())
+        bucket_count <<= 1;
+
+    auto out = std::ofstream(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "failed to open " << output << std::endl;
+        return 1;
+    }
+
+    // the header is written last, once the index offset is known
+    auto header   = PackHeader{};
+    auto offset   = uint64_t(sizeof(PackHeader));
+    auto entries  = std::vector<PackEntry>{};
+    auto names    = std::string{};
+    auto buckets  = std::vector<uint32_t>(bucket_count, PACK_INVALID);
+    auto original = uint64_t(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (auto& input : inputs) {
+        auto compressed = std::vector<uint8_t>(lz4_compress_bound(input.data.size()));
+        compressed.resize(lz4_compress(input.data.data(), input.data.size(), compressed.data(), compressed.size()));
+
+        auto entry        = PackEntry{};
+        entry.hash        = pack_hash(input.name);
+        entry.size        = input.data.size();
+        entry.name_offset = static_cast<uint32_t>(names.size());
+        entry.name_length = static_cast<uint32_t>(input.name.size());
+        entry.codec       = compressed.size() > 0 && compressed.size() < input.data.size() - input.data.size() / 8 ? PackCodec::LZ4 : PackCodec::NONE;
+
+        auto& blob        = entry.codec == PackCodec::LZ4 ? compressed : input.data;
+        entry.stored_size = blob.size();
+
+        pad_to(out, offset, PACK_ALIGNMENT);
+        entry.offset = offset;
+        out.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+        offset += blob.size();
+
+        // NOTE: stored entries are handed out without a copy, the null byte makes them usable as C strings
+        if (entry.codec == PackCodec::NONE) {
+            out.put('\0');
+            offset++;
+        }
+
+        auto& bucket = buckets[entry.hash & (bucket_count - 1)];
+        entry.next   = bucket;
+        bucket       = static_cast<uint32_t>(entries.size());
+
+        names += input.name;
+        original += entry.size;
+        entries.push_back(entry);
+    }
+
+    pad_to(out, offset, PACK_ALIGNMENT);
+    header.version      = PACK_VERSION;
+    header.entry_count  = static_cast<uint32_t>(entries.size());
+    header.bucket_count = bucket_count;
+    header.index_offset = offset;
+    header.index_size   = buckets.size() * sizeof(uint32_t) + entries.size() * sizeof(PackEntry) + names.size();
+    std::copy(std::begin(PACK_MAGIC), std::end(PACK_MAGIC), header.magic);
+
+    out.write(reinterpret_cast<const char*>(buckets.data()), static_cast<std::streamsize>(buckets.size() * sizeof(uint32_t)));
+    out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(PackEntry)));
+    out.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out) {
+        std::cerr << "failed to write " << output << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << entries.size() << " files, " << original << " bytes into " << offset + header.index_size << " bytes" << std::endl;
+    return 0;
+}
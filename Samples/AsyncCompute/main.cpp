@@ -0,0 +1,790 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string_view>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+// NOTE: must match the layout in scene.slang
+struct Frame
+{
+    glm::mat4 view_proj;
+    float     time;
+    uint      grid;
+    glm::vec2 padding;
+};
+
+// Intermediate targets of one frame, used in turns by consecutive frames.
+// While the compute queue post-processes one of them, the graphics queue renders the next frame into the other.
+struct PostTarget
+{
+    GPUTexture     hdr;
+    GPUTextureView hdr_view;
+    GPUTexture     ldr;
+    GPUTextureView ldr_view;
+    GPUBindGroup   post_bind_group;
+    GPUBindGroup   composite_bind_group;
+    GPUSemaphore   geometry_done;
+    GPUSemaphore   post_done;
+    bool           async = false; // whether the last post-process of this target ran on the compute queue
+};
+
+struct Interval
+{
+    uint64_t begin = 0;
+    uint64_t end   = 0;
+};
+
+struct FrameStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last;
+    double            accumulated = 0.0;
+    double            geometry    = 0.0;
+    double            post        = 0.0;
+    double            overlap     = 0.0;
+    uint              samples     = 0;
+    uint              frames      = 0;
+};
+
+enum Timestamp : uint
+{
+    GEOMETRY_BEGIN,
+    GEOMETRY_END,
+    POST_BEGIN,
+    POST_END,
+    TIMESTAMP_COUNT,
+};
+
+constexpr uint OBJECT_GRID       = 96;
+constexpr uint OBJECT_COUNT      = OBJECT_GRID * OBJECT_GRID;
+constexpr uint POST_TARGETS      = 2;
+constexpr uint FRAMES_INFLIGHT   = 3;
+constexpr uint TIMESTAMP_SLOTS   = FRAMES_INFLIGHT + 1; // NOTE: timestamps of a frame are resolved by the next frame
+constexpr uint FRAMES_PER_TOGGLE = 240;
+
+GPUShaderModule    scene_vshader;
+GPUShaderModule    scene_fshader;
+GPUShaderModule    post_shader;
+GPUShaderModule    composite_vshader;
+GPUShaderModule    composite_fshader;
+GPUBindGroupLayout scene_blayout;
+GPUBindGroupLayout post_blayout;
+GPUBindGroupLayout composite_blayout;
+GPUPipelineLayout  scene_playout;
+GPUPipelineLayout  post_playout;
+GPUPipelineLayout  composite_playout;
+GPURenderPipeline  scene_pipeline;
+GPUComputePipeline post_pipeline;
+GPURenderPipeline  composite_pipeline;
+GPUBuffer          vbuffer;
+GPUBuffer          ibuffer;
+GPUBuffer          ubuffer;
+GPUBindGroup       scene_bind_group;
+GPUTexture         dbuffer;
+GPUTextureView     dview;
+PostTarget         targets[POST_TARGETS];
+GPUQuerySet        timestamps[TIMESTAMP_SLOTS];
+GPUBuffer          timestamp_resolve[TIMESTAMP_SLOTS];
+GPUBuffer          timestamp_readback[TIMESTAMP_SLOTS];
+bool               timestamp_async[TIMESTAMP_SLOTS];
+Interval           previous_post;
+double             timestamp_period = 1.0; // nanoseconds per tick
+uint64_t           frame_index      = 0;
+bool               async            = true;
+FrameStats         stats;
+
+auto read_shader_source(const std::string& name) -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open(name);
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+auto compile_shader(const std::string& name, const char* entry, const char* label) -> GPUShaderModule
+{
+    auto& device = RHI::get_current_device();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = name;
+        desc.path   = name;
+        desc.source = read_shader_source(name);
+        return compiler->compile(desc);
+    });
+
+    return execute([&]() {
+        auto code  = module->get_shader_blob(entry);
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = label;
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+}
+
+auto texture_layout_entry(uint binding, uint32_t visibility) -> GPUBindGroupLayoutEntry
+{
+    auto entry                   = GPUBindGroupLayoutEntry{};
+    entry.type                   = GPUBindingResourceType::TEXTURE;
+    entry.binding                = binding;
+    entry.count                  = 1;
+    entry.visibility             = visibility;
+    entry.texture.sample_type    = GPUTextureSampleType::UNFILTERABLE_FLOAT;
+    entry.texture.view_dimension = GPUTextureViewDimension::x2D;
+    entry.texture.multisampled   = false;
+    return entry;
+}
+
+auto texture_entry(uint binding, GPUBindingResourceType type, const GPUTextureView& view) -> GPUBindGroupEntry
+{
+    auto entry    = GPUBindGroupEntry{};
+    entry.type    = type;
+    entry.binding = binding;
+    entry.index   = 0;
+    entry.texture = view;
+    return entry;
+}
+
+// Ownership transfer between queues. The same barrier is recorded twice,
+// once on the source queue (release) and once on the destination queue (acquire).
+auto queue_transition(const GPUTexture& texture, GPUState before, GPUState after, GPUQueueType src, GPUQueueType dst) -> GPUBarrier
+{
+    auto barrier      = state_transition(texture, before, after);
+    barrier.src_queue = src;
+    barrier.dst_queue = dst;
+    return barrier;
+}
+
+void setup_pipelines()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    scene_vshader     = compile_shader("scene.slang", "vsmain", "scene_vertex_shader");
+    scene_fshader     = compile_shader("scene.slang", "fsmain", "scene_fragment_shader");
+    post_shader       = compile_shader("post.slang", "csmain", "post_shader");
+    composite_vshader = compile_shader("composite.slang", "vsmain", "composite_vertex_shader");
+    composite_fshader = compile_shader("composite.slang", "fsmain", "composite_fragment_shader");
+
+    scene_blayout = execute([&]() {
+        auto entry                      = GPUBindGroupLayoutEntry{};
+        entry.type                      = GPUBindingResourceType::BUFFER;
+        entry.binding                   = 0;
+        entry.count                     = 1;
+        entry.visibility                = GPUShaderStage::VERTEX;
+        entry.buffer.type               = GPUBufferBindingType::UNIFORM;
+        entry.buffer.has_dynamic_offset = false;
+
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(entry);
+        return device.create_bind_group_layout(desc);
+    });
+
+    post_blayout = execute([&]() {
+        auto entry                           = GPUBindGroupLayoutEntry{};
+        entry.type                           = GPUBindingResourceType::STORAGE_TEXTURE;
+        entry.binding                        = 1;
+        entry.count                          = 1;
+        entry.visibility                     = GPUShaderStage::COMPUTE;
+        entry.storage_texture.access         = GPUStorageTextureAccess::WRITE_ONLY;
+        entry.storage_texture.format         = GPUTextureFormat::RGBA8UNORM;
+        entry.storage_texture.view_dimension = GPUTextureViewDimension::x2D;
+
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(texture_layout_entry(0, GPUShaderStage::COMPUTE));
+        desc.entries.push_back(entry);
+        return device.create_bind_group_layout(desc);
+    });
+
+    composite_blayout = execute([&]() {
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(texture_layout_entry(0, GPUShaderStage::FRAGMENT));
+        return device.create_bind_group_layout(desc);
+    });
+
+    scene_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {scene_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    post_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {post_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    composite_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {composite_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    scene_pipeline = execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x3;
+        position.offset          = 0;
+        position.shader_location = 0;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position};
+        layout.array_stride = sizeof(glm::vec3);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto target         = GPUColorTargetState{};
+        target.format       = GPUTextureFormat::RGBA16FLOAT;
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = scene_playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.format                  = GPUTextureFormat::DEPTH32FLOAT;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::LESS;
+        desc.depth_stencil.depth_write_enabled     = true;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = scene_vshader;
+        desc.fragment.module                       = scene_fshader;
+        desc.vertex.buffers.push_back(layout);
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+
+    post_pipeline = execute([&]() {
+        auto desc           = GPUComputePipelineDescriptor{};
+        desc.layout         = post_playout;
+        desc.compute.module = post_shader;
+        return device.create_compute_pipeline(desc);
+    });
+
+    composite_pipeline = execute([&]() {
+        auto target         = GPUColorTargetState{};
+        target.format       = surface.get_current_format();
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = composite_playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::ALWAYS;
+        desc.depth_stencil.depth_write_enabled     = false;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = composite_vshader;
+        desc.fragment.module                       = composite_fshader;
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+}
+
+void setup_buffers()
+{
+    auto& device = RHI::get_current_device();
+
+    vbuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "vertex_buffer";
+        desc.size               = sizeof(glm::vec3) * 8;
+        desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    ibuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "index_buffer";
+        desc.size               = sizeof(uint32_t) * 36;
+        desc.usage              = GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    ubuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "uniform_buffer";
+        desc.size               = sizeof(Frame);
+        desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    // unit cube centered at origin
+    auto vertices = vbuffer.get_mapped_range<glm::vec3>();
+    for (uint i = 0; i < 8; i++)
+        vertices.at(i) = glm::vec3((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f);
+
+    const uint faces[36] = {
+        0, 2, 1, 1, 2, 3, // -z
+        4, 5, 6, 5, 7, 6, // +z
+        0, 1, 4, 1, 5, 4, // -y
+        2, 6, 3, 3, 6, 7, // +y
+        0, 4, 2, 2, 4, 6, // -x
+        1, 3, 5, 3, 7, 5, // +x
+    };
+
+    auto indices = ibuffer.get_mapped_range<uint>();
+    for (uint i = 0; i < 36; i++)
+        indices.at(i) = faces[i];
+
+    scene_bind_group = execute([&]() {
+        auto entry          = GPUBindGroupEntry{};
+        entry.type          = GPUBindingResourceType::BUFFER;
+        entry.binding       = 0;
+        entry.index         = 0;
+        entry.buffer.buffer = ubuffer;
+        entry.buffer.offset = 0;
+        entry.buffer.size   = 0;
+
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = scene_blayout;
+        desc.entries.push_back(entry);
+        return device.create_bind_group(desc);
+    });
+}
+
+void setup_targets()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // NOTE: depth is only used by the geometry pass, which never runs concurrently with itself
+    dbuffer = execute([&]() {
+        auto desc            = GPUTextureDescriptor{};
+        desc.format          = GPUTextureFormat::DEPTH32FLOAT;
+        desc.size.width      = extent.width;
+        desc.size.height     = extent.height;
+        desc.size.depth      = 1;
+        desc.array_layers    = 1;
+        desc.mip_level_count = 1;
+        desc.usage           = GPUTextureUsage::RENDER_ATTACHMENT;
+        desc.label           = "depth_buffer";
+        return device.create_texture(desc);
+    });
+
+    dview = dbuffer.create_view();
+
+    for (auto& target : targets) {
+        target.hdr = execute([&]() {
+            auto desc            = GPUTextureDescriptor{};
+            desc.format          = GPUTextureFormat::RGBA16FLOAT;
+            desc.size.width      = extent.width;
+            desc.size.height     = extent.height;
+            desc.size.depth      = 1;
+            desc.array_layers    = 1;
+            desc.mip_level_count = 1;
+            desc.usage           = GPUTextureUsage::RENDER_ATTACHMENT | GPUTextureUsage::TEXTURE_BINDING;
+            desc.label           = "hdr_color";
+            return device.create_texture(desc);
+        });
+
+        target.ldr = execute([&]() {
+            auto desc            = GPUTextureDescriptor{};
+            desc.format          = GPUTextureFormat::RGBA8UNORM;
+            desc.size.width      = extent.width;
+            desc.size.height     = extent.height;
+            desc.size.depth      = 1;
+            desc.array_layers    = 1;
+            desc.mip_level_count = 1;
+            desc.usage           = GPUTextureUsage::STORAGE_BINDING | GPUTextureUsage::TEXTURE_BINDING;
+            desc.label           = "ldr_color";
+            return device.create_texture(desc);
+        });
+
+        target.hdr_view = target.hdr.create_view();
+        target.ldr_view = target.ldr.create_view();
+
+        target.post_bind_group = execute([&]() {
+            auto desc   = GPUBindGroupDescriptor{};
+            desc.layout = post_blayout;
+            desc.entries.push_back(texture_entry(0, GPUBindingResourceType::TEXTURE, target.hdr_view));
+            desc.entries.push_back(texture_entry(1, GPUBindingResourceType::STORAGE_TEXTURE, target.ldr_view));
+            return device.create_bind_group(desc);
+        });
+
+        target.composite_bind_group = execute([&]() {
+            auto desc   = GPUBindGroupDescriptor{};
+            desc.layout = composite_blayout;
+            desc.entries.push_back(texture_entry(0, GPUBindingResourceType::TEXTURE, target.ldr_view));
+            return device.create_bind_group(desc);
+        });
+
+        target.geometry_done = device.create_semaphore();
+        target.post_done     = device.create_semaphore();
+    }
+}
+
+void setup_timestamps()
+{
+    auto& device = RHI::get_current_device();
+
+    timestamp_period = device.get_timestamp_period();
+
+    for (uint i = 0; i < TIMESTAMP_SLOTS; i++) {
+        timestamps[i] = execute([&]() {
+            auto desc  = GPUQuerySetDescriptor{};
+            desc.label = "timestamp_queries";
+            desc.type  = GPUQueryType::TIMESTAMP;
+            desc.count = TIMESTAMP_COUNT;
+            return device.create_query_set(desc);
+        });
+
+        timestamp_resolve[i] = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "timestamp_resolve_buffer";
+            desc.size  = sizeof(uint64_t) * TIMESTAMP_COUNT;
+            desc.usage = GPUBufferUsage::QUERY_RESOLVE | GPUBufferUsage::COPY_SRC;
+            return device.create_buffer(desc);
+        });
+
+        timestamp_readback[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "timestamp_readback_buffer";
+            desc.size               = sizeof(uint64_t) * TIMESTAMP_COUNT;
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    }
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    for (uint i = 0; i < TIMESTAMP_SLOTS; i++) {
+        timestamps[i].destroy();
+        timestamp_resolve[i].destroy();
+        timestamp_readback[i].destroy();
+    }
+    for (auto& target : targets) {
+        target.hdr.destroy();
+        target.ldr.destroy();
+    }
+    dbuffer.destroy();
+    vbuffer.destroy();
+    ibuffer.destroy();
+    ubuffer.destroy();
+    scene_vshader.destroy();
+    scene_fshader.destroy();
+    post_shader.destroy();
+    composite_vshader.destroy();
+    composite_fshader.destroy();
+    scene_blayout.destroy();
+    post_blayout.destroy();
+    composite_blayout.destroy();
+    scene_playout.destroy();
+    post_playout.destroy();
+    composite_playout.destroy();
+    scene_pipeline.destroy();
+    post_pipeline.destroy();
+    composite_pipeline.destroy();
+}
+
+void update(const WindowInput& input)
+{
+    static float time = 0.0f;
+    time += input.delta_time;
+
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto eye  = glm::vec3(std::sin(time * 0.2f) * 20.0f, 12.0f, 12.0f);
+    auto proj = glm::perspective(1.05f, float(extent.width) / float(extent.height), 0.1f, 300.0f);
+    auto view = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, -float(OBJECT_GRID) * 0.5f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    auto frame            = ubuffer.get_mapped_range<Frame>();
+    frame.at(0).view_proj = proj * view;
+    frame.at(0).time      = time;
+    frame.at(0).grid      = OBJECT_GRID;
+}
+
+auto create_command_buffer(GPUQueueType queue) -> GPUCommandBuffer
+{
+    auto& device = RHI::get_current_device();
+
+    return execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = queue;
+        return device.create_command_buffer(desc);
+    });
+}
+
+void draw_scene(GPUCommandBuffer& command, PostTarget& target)
+{
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.02f, 0.02f, 0.03f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = target.hdr_view;
+
+    auto depth_attachment              = GPURenderPassDepthStencilAttachment{};
+    depth_attachment.view              = dview;
+    depth_attachment.depth_clear_value = 1.0f;
+    depth_attachment.depth_load_op     = GPULoadOp::CLEAR;
+    depth_attachment.depth_store_op    = GPUStoreOp::DISCARD;
+    depth_attachment.depth_read_only   = false;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = {color_attachment};
+    render_pass.depth_stencil_attachment = depth_attachment;
+
+    command.resource_barrier(state_transition(target.hdr, undefined_state(), color_attachment_state()));
+    command.resource_barrier(state_transition(dbuffer, undefined_state(), depth_stencil_attachment_state()));
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(scene_pipeline);
+    command.set_vertex_buffer(0, vbuffer);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+    command.set_bind_group(0, scene_bind_group);
+    command.draw_indexed(36, OBJECT_COUNT, 0, 0, 0);
+    command.end_render_pass();
+}
+
+void post_process(GPUCommandBuffer& command, PostTarget& target, uint slot)
+{
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    command.write_timestamp(timestamps[slot], POST_BEGIN);
+    command.resource_barrier(state_transition(target.ldr, undefined_state(), storage_state(GPUShaderStage::COMPUTE)));
+    command.set_pipeline(post_pipeline);
+    command.set_bind_group(0, target.post_bind_group);
+    command.dispatch_workgroups((extent.width + 7) / 8, (extent.height + 7) / 8);
+    command.write_timestamp(timestamps[slot], POST_END);
+}
+
+void composite(GPUCommandBuffer& command, const GPUSurfaceTexture& backbuffer, PostTarget* target)
+{
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = backbuffer.view;
+
+    auto render_pass              = GPURenderPassDescriptor{};
+    render_pass.color_attachments = {color_attachment};
+
+    command.begin_render_pass(render_pass);
+    if (target) {
+        command.set_viewport(0, 0, extent.width, extent.height);
+        command.set_scissor_rect(0, 0, extent.width, extent.height);
+        command.set_pipeline(composite_pipeline);
+        command.set_bind_group(0, target->composite_bind_group);
+        command.draw(3, 1, 0, 0);
+    }
+    command.end_render_pass();
+}
+
+void read_timestamps(uint slot)
+{
+    // the readback buffer in this slot was filled TIMESTAMP_SLOTS frames ago, and resolved by the frame after it
+    if (frame_index < TIMESTAMP_SLOTS)
+        return;
+
+    auto values   = timestamp_readback[slot].get_mapped_range<uint64_t>();
+    auto geometry = Interval{values.at(GEOMETRY_BEGIN), values.at(GEOMETRY_END)};
+    auto post     = Interval{values.at(POST_BEGIN), values.at(POST_END)};
+    auto ms       = [](uint64_t ticks) { return double(ticks) * timestamp_period * 1e-6; };
+
+    // the post-process of the previous frame may run while the geometry of this frame is rendered
+    auto begin    = std::max(previous_post.begin, geometry.begin);
+    auto end      = std::min(previous_post.end, geometry.end);
+    previous_post = post;
+
+    // samples recorded before the last toggle belong to the other mode
+    if (timestamp_async[slot] != async)
+        return;
+
+    stats.geometry += ms(geometry.end - geometry.begin);
+    stats.post += ms(post.end - post.begin);
+    stats.overlap += end > begin ? ms(end - begin) : 0.0;
+    stats.samples++;
+}
+
+void report()
+{
+    auto now = FrameStats::Clock::now();
+    if (stats.frames > 0)
+        stats.accumulated += std::chrono::duration<double, std::milli>(now - stats.last).count();
+    stats.last = now;
+
+    // alternate between the compute queue and the graphics queue for post-processing, to compare both
+    if (++stats.frames == FRAMES_PER_TOGGLE) {
+        auto samples = double(std::max(stats.samples, 1u));
+        std::cout << "Post: " << (async ? "ASYNC" : "SYNC ")
+                  << ", Frame Time: " << stats.accumulated / (FRAMES_PER_TOGGLE - 1) << " ms"
+                  << ", Geometry: " << stats.geometry / samples << " ms"
+                  << ", Post: " << stats.post / samples << " ms"
+                  << ", Overlap: " << stats.overlap / samples << " ms"
+                  << " (" << (stats.post > 0.0 ? 100.0 * stats.overlap / stats.post : 0.0) << "% of post hidden)" << std::endl;
+
+        async = !async;
+        stats = FrameStats{};
+    }
+}
+
+void render()
+{
+    auto& surface = RHI::get_current_surface();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    auto  slot     = static_cast<uint>(frame_index % TIMESTAMP_SLOTS);
+    auto  previous = static_cast<uint>((frame_index + TIMESTAMP_SLOTS - 1) % TIMESTAMP_SLOTS);
+    auto& current  = targets[frame_index % POST_TARGETS];
+    auto& last     = targets[(frame_index + POST_TARGETS - 1) % POST_TARGETS];
+
+    read_timestamps(slot);
+    timestamp_async[slot] = async;
+
+    // geometry of this frame, on the graphics queue
+    auto geometry = create_command_buffer(GPUQueueType::DEFAULT);
+    geometry.write_timestamp(timestamps[slot], GEOMETRY_BEGIN);
+    draw_scene(geometry, current);
+    geometry.write_timestamp(timestamps[slot], GEOMETRY_END);
+
+    if (async) {
+        // hand the color target over to the compute queue
+        geometry.resource_barrier(queue_transition(current.hdr, color_attachment_state(), shader_resource_state(GPUShaderStage::COMPUTE), GPUQueueType::DEFAULT, GPUQueueType::COMPUTE));
+        geometry.signal(current.geometry_done, GPUBarrierSync::RENDER_TARGET);
+        geometry.submit();
+
+        // post-process of this frame, overlapping with the geometry of the next frame
+        auto compute = create_command_buffer(GPUQueueType::COMPUTE);
+        compute.wait(current.geometry_done, GPUBarrierSync::COMPUTE_SHADING);
+        compute.resource_barrier(queue_transition(current.hdr, color_attachment_state(), shader_resource_state(GPUShaderStage::COMPUTE), GPUQueueType::DEFAULT, GPUQueueType::COMPUTE));
+        post_process(compute, current, slot);
+        compute.resource_barrier(queue_transition(current.ldr, storage_state(GPUShaderStage::COMPUTE), shader_resource_state(GPUShaderStage::FRAGMENT), GPUQueueType::COMPUTE, GPUQueueType::DEFAULT));
+        compute.signal(current.post_done, GPUBarrierSync::COMPUTE_SHADING);
+        compute.submit();
+    } else {
+        // post-process right after the geometry, serialized on the graphics queue
+        geometry.resource_barrier(state_transition(current.hdr, color_attachment_state(), shader_resource_state(GPUShaderStage::COMPUTE)));
+        post_process(geometry, current, slot);
+        geometry.resource_barrier(state_transition(current.ldr, storage_state(GPUShaderStage::COMPUTE), shader_resource_state(GPUShaderStage::FRAGMENT)));
+        geometry.submit();
+    }
+    current.async = async;
+
+    // present the previous frame, so that this submission does not wait for the post-process just submitted.
+    // NOTE: geometry and present are separate submissions, a wait in the present submission would otherwise
+    // hold back the geometry of this frame as well.
+    auto present = create_command_buffer(GPUQueueType::DEFAULT);
+    present.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    if (frame_index > 0 && last.async) {
+        present.wait(last.post_done, GPUBarrierSync::PIXEL_SHADING);
+        present.resource_barrier(queue_transition(last.ldr, storage_state(GPUShaderStage::COMPUTE), shader_resource_state(GPUShaderStage::FRAGMENT), GPUQueueType::COMPUTE, GPUQueueType::DEFAULT));
+    }
+    present.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    composite(present, texture, frame_index > 0 ? &last : nullptr);
+    present.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+
+    // timestamps of the previous frame are complete at this point, including its post-process
+    if (frame_index > 0) {
+        present.resource_barrier(state_transition(timestamp_resolve[previous], undefined_state(), copy_dst_state()));
+        present.resolve_query_set(timestamps[previous], 0, TIMESTAMP_COUNT, timestamp_resolve[previous], 0);
+        present.resource_barrier(state_transition(timestamp_resolve[previous], copy_dst_state(), copy_src_state()));
+        present.copy_buffer_to_buffer(timestamp_resolve[previous], 0, timestamp_readback[previous], 0, sizeof(uint64_t) * TIMESTAMP_COUNT);
+    }
+
+    present.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    present.submit();
+
+    // present this frame to swapchain
+    texture.present();
+
+    report();
+    frame_index++;
+}
+
+int main()
+{
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Immediate; // NOTE: do not hide frame time behind vsync
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipelines);
+    win->bind<WindowEvent::START>(setup_buffers);
+    win->bind<WindowEvent::START>(setup_targets);
+    win->bind<WindowEvent::START>(setup_timestamps);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
@@ -0,0 +1,524 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+struct Vertex
+{
+    glm::vec2 position;
+    glm::vec2 uv;
+};
+
+// NOTE: must match the layout in shader.slang
+struct Material
+{
+    glm::vec4 color;
+    uint      texture;
+    float     scale;
+    glm::vec2 scroll;
+};
+
+// NOTE: must match the layout in shader.slang, pushed with every draw
+struct DrawConstants
+{
+    uint  object;
+    uint  grid;
+    uint  textures;
+    float time;
+};
+
+struct FrameStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last;
+    double            frame  = 0.0;
+    double            cpu    = 0.0;
+    uint              frames = 0;
+};
+
+constexpr uint OBJECT_GRID        = 64;
+constexpr uint OBJECT_COUNT       = OBJECT_GRID * OBJECT_GRID; // one material per object
+constexpr uint MATERIALS_PER_PAGE = 1024;                      // NOTE: must match shader.slang
+constexpr uint MATERIAL_PAGES     = OBJECT_COUNT / MATERIALS_PER_PAGE;
+constexpr uint MAX_MATERIAL_PAGES = 16;   // NOTE: capacity of the buffer array, must match shader.slang
+constexpr uint MAX_TEXTURES       = 1024; // capacity of the texture array, filled while frames are running
+constexpr uint TEXTURE_COUNT      = 512;
+constexpr uint TEXTURE_SIZE       = 64;   // NOTE: rows of 256 bytes, the copy pitch alignment of D3D12
+constexpr uint TEXTURES_PER_FRAME = 4;
+constexpr uint FRAMES_INFLIGHT    = 3;
+constexpr uint FRAMES_PER_REPORT  = 240;
+
+GPUShaderModule             vshader;
+GPUShaderModule             fshader;
+GPUBindGroupLayout          blayout;
+GPUPipelineLayout           playout;
+GPURenderPipeline           pipeline;
+GPUBuffer                   vbuffer;
+GPUBuffer                   ibuffer;
+GPUBuffer                   staging;
+GPUBuffer                   material_pages[MATERIAL_PAGES];
+std::vector<GPUTexture>     textures;
+std::vector<GPUTextureView> views;
+GPUBindGroup                bind_group;
+uint                        textures_loaded = 0;
+float                       elapsed         = 0.0f;
+FrameStats                  stats;
+
+auto read_shader_source() -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open("shader.slang");
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+void setup_pipeline()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = "bindless";
+        desc.path   = "shader.slang";
+        desc.source = read_shader_source();
+        return compiler->compile(desc);
+    });
+
+    vshader = execute([&]() {
+        auto code  = module->get_shader_blob("vsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "vertex_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+
+    fshader = execute([&]() {
+        auto code  = module->get_shader_blob("fsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "fragment_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+
+    // NOTE: each binding is an array, which does not have to be fully written (PARTIALLY_BOUND),
+    // and may be written while the bind group is in use by frames in flight (UPDATE_AFTER_BIND),
+    // as long as those frames never access the elements being written.
+    blayout = execute([&]() {
+        auto materials                      = GPUBindGroupLayoutEntry{};
+        materials.type                      = GPUBindingResourceType::BUFFER;
+        materials.binding                   = 0;
+        materials.count                     = MAX_MATERIAL_PAGES;
+        materials.flags                     = GPUBindingFlag::PARTIALLY_BOUND;
+        materials.visibility                = GPUShaderStage::FRAGMENT;
+        materials.buffer.type               = GPUBufferBindingType::READ_ONLY_STORAGE;
+        materials.buffer.has_dynamic_offset = false;
+
+        auto images                   = GPUBindGroupLayoutEntry{};
+        images.type                   = GPUBindingResourceType::TEXTURE;
+        images.binding                = 1;
+        images.count                  = MAX_TEXTURES;
+        images.flags                  = GPUBindingFlag::PARTIALLY_BOUND | GPUBindingFlag::UPDATE_AFTER_BIND;
+        images.visibility             = GPUShaderStage::FRAGMENT;
+        images.texture.sample_type    = GPUTextureSampleType::FLOAT;
+        images.texture.view_dimension = GPUTextureViewDimension::x2D;
+        images.texture.multisampled   = false;
+
+        auto desc    = GPUBindGroupLayoutDescriptor{};
+        desc.entries = {materials, images};
+        return device.create_bind_group_layout(desc);
+    });
+
+    // NOTE: push constant ranges come from the shader reflection, DrawConstants has to match the reflected block
+    playout = execute([&]() {
+        auto desc                 = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts   = {blayout};
+        desc.push_constant_ranges = module->get_push_constant_ranges();
+        return device.create_pipeline_layout(desc);
+    });
+
+    pipeline = execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x2;
+        position.offset          = offsetof(Vertex, position);
+        position.shader_location = 0;
+
+        auto uv            = GPUVertexAttribute{};
+        uv.format          = GPUVertexFormat::FLOAT32x2;
+        uv.offset          = offsetof(Vertex, uv);
+        uv.shader_location = 1;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position, uv};
+        layout.array_stride = sizeof(Vertex);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto target         = GPUColorTargetState{};
+        target.format       = surface.get_current_format();
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::ALWAYS;
+        desc.depth_stencil.depth_write_enabled     = false;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vshader;
+        desc.fragment.module                       = fshader;
+        desc.vertex.buffers.push_back(layout);
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+}
+
+void setup_buffers()
+{
+    auto& device = RHI::get_current_device();
+
+    auto create_buffer = [&](const char* label, uint64_t size, uint usage) {
+        return execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = label;
+            desc.size               = size;
+            desc.usage              = usage | GPUBufferUsage::MAP_WRITE;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    };
+
+    vbuffer = create_buffer("vertex_buffer", sizeof(Vertex) * 4, GPUBufferUsage::VERTEX);
+    ibuffer = create_buffer("index_buffer", sizeof(uint32_t) * 6, GPUBufferUsage::INDEX);
+
+    auto vertices  = vbuffer.get_mapped_range<Vertex>();
+    vertices.at(0) = Vertex{{-1.0f, -1.0f}, {0.0f, 1.0f}};
+    vertices.at(1) = Vertex{{+1.0f, -1.0f}, {1.0f, 1.0f}};
+    vertices.at(2) = Vertex{{+1.0f, +1.0f}, {1.0f, 0.0f}};
+    vertices.at(3) = Vertex{{-1.0f, +1.0f}, {0.0f, 0.0f}};
+
+    auto indices  = ibuffer.get_mapped_range<uint>();
+    indices.at(0) = 0;
+    indices.at(1) = 1;
+    indices.at(2) = 2;
+    indices.at(3) = 0;
+    indices.at(4) = 2;
+    indices.at(5) = 3;
+
+    // every object has a material of its own, several materials share each texture
+    auto rng  = std::mt19937(7);
+    auto unit = std::uniform_real_distribution<float>(0.0f, 1.0f);
+    for (uint page = 0; page < MATERIAL_PAGES; page++) {
+        material_pages[page] = create_buffer("material_buffer", sizeof(Material) * MATERIALS_PER_PAGE, GPUBufferUsage::STORAGE);
+
+        auto materials = material_pages[page].get_mapped_range<Material>();
+        for (uint i = 0; i < MATERIALS_PER_PAGE; i++) {
+            auto& material   = materials.at(i);
+            material.color   = glm::vec4(0.4f + 0.6f * unit(rng), 0.4f + 0.6f * unit(rng), 0.4f + 0.6f * unit(rng), 1.0f);
+            material.texture = static_cast<uint>(rng() % TEXTURE_COUNT);
+            material.scale   = 1.0f + float(rng() % 3);
+            material.scroll  = glm::vec2(unit(rng) - 0.5f, unit(rng) - 0.5f) * 0.5f;
+        }
+    }
+}
+
+void setup_textures()
+{
+    auto& device = RHI::get_current_device();
+
+    // NOTE: all texels are generated up front, and copied into a few textures per frame
+    auto texels = TEXTURE_SIZE * TEXTURE_SIZE;
+
+    staging = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "staging_buffer";
+        desc.size               = sizeof(uint32_t) * texels * TEXTURE_COUNT;
+        desc.usage              = GPUBufferUsage::COPY_SRC | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    // a different pattern per texture, checkers and stripes of two random colors
+    auto rng    = std::mt19937(11);
+    auto pixels = staging.get_mapped_range<uint32_t>();
+    for (uint t = 0; t < TEXTURE_COUNT; t++) {
+        auto a      = rng() | 0xFF000000u;
+        auto b      = rng() | 0xFF000000u;
+        auto period = 4u << (t % 4);
+        auto stripe = (t / 4) % 3;
+        for (uint y = 0; y < TEXTURE_SIZE; y++) {
+            for (uint x = 0; x < TEXTURE_SIZE; x++) {
+                auto cx   = x / period;
+                auto cy   = y / period;
+                auto odd  = stripe == 0 ? (cx + cy) & 1 : stripe == 1 ? cx & 1 : (cx + y / 2) / 2 & 1;
+                auto& out = pixels.at(t * texels + y * TEXTURE_SIZE + x);
+                out       = odd ? a : b;
+            }
+        }
+    }
+
+    textures.reserve(TEXTURE_COUNT);
+    views.reserve(TEXTURE_COUNT);
+    for (uint t = 0; t < TEXTURE_COUNT; t++) {
+        textures.push_back(execute([&]() {
+            auto desc            = GPUTextureDescriptor{};
+            desc.format          = GPUTextureFormat::RGBA8UNORM;
+            desc.size.width      = TEXTURE_SIZE;
+            desc.size.height     = TEXTURE_SIZE;
+            desc.size.depth      = 1;
+            desc.array_layers    = 1;
+            desc.mip_level_count = 1;
+            desc.usage           = GPUTextureUsage::COPY_DST | GPUTextureUsage::TEXTURE_BINDING;
+            desc.label           = "material_texture";
+            return device.create_texture(desc);
+        }));
+        views.push_back(textures.back().create_view());
+    }
+
+    // the only bind group of the sample, no texture is bound yet, they are written in as they are uploaded
+    bind_group = execute([&]() {
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = blayout;
+        for (uint page = 0; page < MATERIAL_PAGES; page++) {
+            auto entry          = GPUBindGroupEntry{};
+            entry.type          = GPUBindingResourceType::BUFFER;
+            entry.binding       = 0;
+            entry.index         = page;
+            entry.buffer.buffer = material_pages[page];
+            entry.buffer.offset = 0;
+            entry.buffer.size   = 0;
+            desc.entries.push_back(entry);
+        }
+        return device.create_bind_group(desc);
+    });
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    for (auto& texture : textures)
+        texture.destroy();
+    for (auto& page : material_pages)
+        page.destroy();
+    staging.destroy();
+    vbuffer.destroy();
+    ibuffer.destroy();
+    vshader.destroy();
+    fshader.destroy();
+    blayout.destroy();
+    playout.destroy();
+    pipeline.destroy();
+}
+
+void update(const WindowInput& input)
+{
+    elapsed += input.delta_time;
+}
+
+void upload_textures(GPUCommandBuffer& command)
+{
+    auto& device = RHI::get_current_device();
+
+    auto count = std::min(TEXTURES_PER_FRAME, TEXTURE_COUNT - textures_loaded);
+    if (count == 0)
+        return;
+
+    auto entries = std::vector<GPUBindGroupEntry>{};
+    for (uint t = textures_loaded; t < textures_loaded + count; t++) {
+        auto src           = GPUImageCopyBuffer{};
+        src.buffer         = staging;
+        src.offset         = uint64_t(t) * TEXTURE_SIZE * TEXTURE_SIZE * sizeof(uint32_t);
+        src.bytes_per_row  = TEXTURE_SIZE * sizeof(uint32_t);
+        src.rows_per_image = TEXTURE_SIZE;
+
+        auto dst      = GPUImageCopyTexture{};
+        dst.texture   = textures.at(t);
+        dst.mip_level = 0;
+
+        auto size   = GPUExtent3D{};
+        size.width  = TEXTURE_SIZE;
+        size.height = TEXTURE_SIZE;
+        size.depth  = 1;
+
+        command.resource_barrier(state_transition(textures.at(t), undefined_state(), copy_dst_state()));
+        command.copy_buffer_to_texture(src, dst, size);
+        command.resource_barrier(state_transition(textures.at(t), copy_dst_state(), shader_resource_state(GPUShaderStage::FRAGMENT)));
+
+        auto entry    = GPUBindGroupEntry{};
+        entry.type    = GPUBindingResourceType::TEXTURE;
+        entry.binding = 1;
+        entry.index   = t;
+        entry.texture = views.at(t);
+        entries.push_back(entry);
+    }
+
+    // NOTE: frames in flight use the same bind group, but only the first textures_loaded elements, which are not written here
+    device.update_bind_group(bind_group, entries);
+    textures_loaded += count;
+}
+
+void report(double cpu)
+{
+    auto now = FrameStats::Clock::now();
+    if (stats.frames > 0)
+        stats.frame += std::chrono::duration<double, std::milli>(now - stats.last).count();
+    stats.last = now;
+    stats.cpu += cpu;
+
+    if (++stats.frames == FRAMES_PER_REPORT) {
+        std::cout << "Objects: " << OBJECT_COUNT << " (" << OBJECT_COUNT << " materials)"
+                  << ", Textures: " << textures_loaded << "/" << TEXTURE_COUNT
+                  << ", Bind Groups: 1/frame"
+                  << ", CPU: " << stats.cpu / FRAMES_PER_REPORT << " ms"
+                  << ", Frame Time: " << stats.frame / (FRAMES_PER_REPORT - 1) << " ms" << std::endl;
+        stats = FrameStats{};
+    }
+}
+
+void render()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    auto start = FrameStats::Clock::now();
+
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    upload_textures(command);
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = texture.view;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = {color_attachment};
+    render_pass.depth_stencil_attachment = {};
+
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(pipeline);
+    command.set_vertex_buffer(0, vbuffer);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+
+    // one bind group for every object, only the object index changes between draws
+    command.set_bind_group(0, bind_group);
+
+    auto constants     = DrawConstants{};
+    constants.grid     = OBJECT_GRID;
+    constants.textures = textures_loaded;
+    constants.time     = elapsed;
+    for (uint i = 0; i < OBJECT_COUNT; i++) {
+        constants.object = i;
+        command.set_push_constants(GPUShaderStage::VERTEX | GPUShaderStage::FRAGMENT, 0, sizeof(constants), &constants);
+        command.draw_indexed(6, 1, 0, 0, 0);
+    }
+
+    command.end_render_pass();
+    command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    auto cpu = std::chrono::duration<double, std::milli>(FrameStats::Clock::now() - start).count();
+
+    // present this frame to swapchain
+    texture.present();
+
+    report(cpu);
+}
+
+int main()
+{
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    // NOTE: descriptor arrays need descriptor indexing (Vulkan 1.2) or resource binding tier 3 (D3D12)
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Fifo;
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipeline);
+    win->bind<WindowEvent::START>(setup_buffers);
+    win->bind<WindowEvent::START>(setup_textures);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
@@ -0,0 +1,872 @@
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <vector>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+constexpr uint  CASCADE_COUNT     = 4;
+constexpr uint  SHADOW_SIZE       = 2048;
+constexpr uint  OBJECT_GRID       = 32;
+constexpr uint  FRAMES_INFLIGHT   = 3;
+constexpr uint  FRAMES_PER_REPORT = 240;
+constexpr float FOVY              = 1.05f;
+constexpr float NEAR_PLANE        = 0.1f;
+constexpr float FAR_PLANE         = 200.0f;
+constexpr float SHADOW_DISTANCE   = 120.0f; // shadows fade out past the last cascade
+constexpr float SPLIT_LAMBDA      = 0.8f;   // 0 = uniform splits, 1 = logarithmic splits
+constexpr float CASTER_DISTANCE   = 50.0f;  // how far casters outside of a cascade can be, towards the light
+
+// timestamps are written at the beginning of the frame, after every cascade, and after the scene
+constexpr uint FRAME_BEGIN     = 0;
+constexpr uint SCENE_END       = CASCADE_COUNT + 1;
+constexpr uint TIMESTAMP_COUNT = CASCADE_COUNT + 2;
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec3 color;
+};
+
+// NOTE: must match the layout in shader.slang
+struct Frame
+{
+    glm::mat4 view;
+    glm::mat4 view_proj;
+    glm::mat4 cascades[CASCADE_COUNT];
+    glm::vec4 splits;
+    glm::vec4 texels;
+    glm::vec4 light_direction;
+    glm::vec4 shadow;
+};
+
+struct Object
+{
+    uint      first_index;
+    uint      index_count;
+    glm::vec4 sphere; // xyz = world center, w = world radius
+};
+
+struct Cascade
+{
+    glm::mat4         view;              // light view
+    glm::mat4         view_proj;         // light view projection, snapped to texels
+    float             near_depth = 0.0f; // camera view depth covered by this cascade
+    float             far_depth  = 0.0f;
+    float             radius     = 0.0f; // half extent of the orthographic projection
+    float             depth      = 0.0f; // depth range of the orthographic projection
+    std::vector<uint> draws;             // objects overlapping this cascade
+};
+
+struct ShadowConfig
+{
+    bool show_cascades = false;
+};
+
+struct ShadowStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last;
+    double            cascade_gpu[CASCADE_COUNT]   = {};
+    uint64_t          cascade_draws[CASCADE_COUNT] = {};
+    double            scene   = 0.0;
+    double            frame   = 0.0;
+    uint              samples = 0; // GPU samples
+    uint              frames  = 0;
+};
+
+GPUShaderModule     vshader;
+GPUShaderModule     fshader;
+GPUShaderModule     shadow_vshader;
+GPUBindGroupLayout  blayout;
+GPUPipelineLayout   playout;
+GPUPipelineLayout   shadow_playout;
+GPURenderPipeline   pipeline;
+GPURenderPipeline   shadow_pipeline;
+GPUBindGroup        bind_group;
+GPUBuffer           vbuffer;
+GPUBuffer           ibuffer;
+GPUBuffer           ubuffer;
+GPUTexture          dbuffer;
+GPUTextureView      dview;
+GPUTexture          shadow_map;
+GPUTextureView      shadow_view; // all cascades, sampled by the scene
+GPUTextureView      cascade_views[CASCADE_COUNT]; // one layer each, rendered by the cascade passes
+GPUSampler          shadow_sampler;
+GPUQuerySet         timestamps[FRAMES_INFLIGHT];
+GPUBuffer           timestamp_resolve[FRAMES_INFLIGHT];
+GPUBuffer           timestamp_readback[FRAMES_INFLIGHT];
+std::vector<Object> objects;
+Cascade             cascades[CASCADE_COUNT];
+glm::vec3           light_direction  = glm::normalize(glm::vec3(-0.4f, -1.0f, -0.3f));
+double              timestamp_period = 1.0; // nanoseconds per tick
+uint                index_count      = 0;
+uint64_t            frame_index      = 0;
+ShadowConfig        config;
+ShadowStats         stats;
+
+auto read_shader_source(const std::string& name) -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open(name);
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+// NOTE: when push_constants is given, it receives the push constant ranges reported by the shader reflection
+auto compile_shader(const std::string& name, const char* entry, const char* label,
+                    std::vector<GPUPushConstantRange>* push_constants = nullptr) -> GPUShaderModule
+{
+    auto& device = RHI::get_current_device();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = name;
+        desc.path   = name;
+        desc.source = read_shader_source(name);
+        return compiler->compile(desc);
+    });
+
+    if (push_constants) *push_constants = module->get_push_constant_ranges();
+
+    return execute([&]() {
+        auto code  = module->get_shader_blob(entry);
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = label;
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+}
+
+void setup_config(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+        if (std::strcmp(argv[i], "--show-cascades") == 0) config.show_cascades = true;
+}
+
+void setup_pipelines()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    auto shadow_push_constants = std::vector<GPUPushConstantRange>{};
+
+    vshader        = compile_shader("shader.slang", "vsmain", "vertex_shader");
+    fshader        = compile_shader("shader.slang", "fsmain", "fragment_shader");
+    shadow_vshader = compile_shader("shadow.slang", "vsmain", "shadow_vertex_shader", &shadow_push_constants);
+
+    blayout = execute([&]() {
+        auto frame                      = GPUBindGroupLayoutEntry{};
+        frame.type                      = GPUBindingResourceType::BUFFER;
+        frame.binding                   = 0;
+        frame.count                     = 1;
+        frame.visibility                = GPUShaderStage::VERTEX | GPUShaderStage::FRAGMENT;
+        frame.buffer.type               = GPUBufferBindingType::UNIFORM;
+        frame.buffer.has_dynamic_offset = false;
+
+        auto shadows                   = GPUBindGroupLayoutEntry{};
+        shadows.type                   = GPUBindingResourceType::TEXTURE;
+        shadows.binding                = 1;
+        shadows.count                  = 1;
+        shadows.visibility             = GPUShaderStage::FRAGMENT;
+        shadows.texture.sample_type    = GPUTextureSampleType::DEPTH;
+        shadows.texture.view_dimension = GPUTextureViewDimension::x2D_ARRAY;
+        shadows.texture.multisampled   = false;
+
+        auto sampler         = GPUBindGroupLayoutEntry{};
+        sampler.type         = GPUBindingResourceType::SAMPLER;
+        sampler.binding      = 2;
+        sampler.count        = 1;
+        sampler.visibility   = GPUShaderStage::FRAGMENT;
+        sampler.sampler.type = GPUSamplerBindingType::COMPARISON;
+
+        auto desc    = GPUBindGroupLayoutDescriptor{};
+        desc.entries = {frame, shadows, sampler};
+        return device.create_bind_group_layout(desc);
+    });
+
+    playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    // NOTE: cascade passes only push the light view projection, no bind group is needed
+    shadow_playout = execute([&]() {
+        auto desc                 = GPUPipelineLayoutDescriptor{};
+        desc.push_constant_ranges = shadow_push_constants;
+        return device.create_pipeline_layout(desc);
+    });
+
+    pipeline = execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x3;
+        position.offset          = offsetof(Vertex, position);
+        position.shader_location = 0;
+
+        auto normal            = GPUVertexAttribute{};
+        normal.format          = GPUVertexFormat::FLOAT32x3;
+        normal.offset          = offsetof(Vertex, normal);
+        normal.shader_location = 1;
+
+        auto color            = GPUVertexAttribute{};
+        color.format          = GPUVertexFormat::FLOAT32x3;
+        color.offset          = offsetof(Vertex, color);
+        color.shader_location = 2;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position, normal, color};
+        layout.array_stride = sizeof(Vertex);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto target         = GPUColorTargetState{};
+        target.format       = surface.get_current_format();
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.format                  = GPUTextureFormat::DEPTH32FLOAT;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::LESS;
+        desc.depth_stencil.depth_write_enabled     = true;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vshader;
+        desc.fragment.module                       = fshader;
+        desc.vertex.buffers.push_back(layout);
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+
+    // Depth-only pipeline. Unlike the mask pass of StencilTest, which keeps a color target and disables writes
+    // with GPUColorWrite::NONE, there is no color target and no fragment shader at all.
+    shadow_pipeline = execute([&]() {
+        // NOTE: same vertex buffer as the scene, only the position is fetched
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x3;
+        position.offset          = offsetof(Vertex, position);
+        position.shader_location = 0;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position};
+        layout.array_stride = sizeof(Vertex);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = shadow_playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.format                  = GPUTextureFormat::DEPTH32FLOAT;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::LESS;
+        desc.depth_stencil.depth_write_enabled     = true;
+        desc.depth_stencil.depth_bias              = 2;
+        desc.depth_stencil.depth_bias_slope_scale  = 2.0f;
+        desc.depth_stencil.depth_bias_clamp        = 0.0f;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = shadow_vshader;
+        desc.vertex.buffers.push_back(layout);
+
+        return device.create_render_pipeline(desc);
+    });
+}
+
+void add_box(std::vector<Vertex>& vertices, std::vector<uint>& indices, glm::vec3 center, glm::vec3 extent, glm::vec3 color)
+{
+    auto first = static_cast<uint>(indices.size());
+
+    // 4 vertices per face, so that every face has a normal of its own
+    for (uint axis = 0; axis < 3; axis++) {
+        for (float sign : {-1.0f, 1.0f}) {
+            auto normal             = glm::vec3(0.0f);
+            auto tangent            = glm::vec3(0.0f);
+            normal[axis]            = sign;
+            tangent[(axis + 1) % 3] = 1.0f;
+
+            auto bitangent = glm::cross(normal, tangent);
+
+            auto base = static_cast<uint>(vertices.size());
+            for (uint i = 0; i < 4; i++) {
+                float u      = (i & 1) ? 0.5f : -0.5f;
+                float v      = (i & 2) ? 0.5f : -0.5f;
+                auto  corner = normal * 0.5f + tangent * u + bitangent * v;
+                vertices.push_back({center + corner * extent, normal, color});
+            }
+
+            for (uint i : {0u, 1u, 3u, 0u, 3u, 2u})
+                indices.push_back(base + i);
+        }
+    }
+
+    auto object        = Object{};
+    object.first_index = first;
+    object.index_count = static_cast<uint>(indices.size()) - first;
+    object.sphere      = glm::vec4(center, glm::length(extent) * 0.5f);
+    objects.push_back(object);
+}
+
+void setup_geometry()
+{
+    auto& device = RHI::get_current_device();
+
+    auto vertices = std::vector<Vertex>{};
+    auto indices  = std::vector<uint>{};
+
+    // ground
+    add_box(vertices, indices, glm::vec3(0.0f, -0.5f, 0.0f), glm::vec3(400.0f, 1.0f, 400.0f), glm::vec3(0.7f));
+
+    // towers of varying heights, spread far enough that every cascade has casters
+    for (uint z = 0; z < OBJECT_GRID; z++) {
+        for (uint x = 0; x < OBJECT_GRID; x++) {
+            float height = 1.0f + float((x * 7 + z * 13) % 9) * 1.5f;
+            auto  center = glm::vec3((float(x) - OBJECT_GRID * 0.5f + 0.5f) * 6.0f, height * 0.5f, (float(z) - OBJECT_GRID * 0.5f + 0.5f) * 6.0f);
+            auto  color  = glm::vec3(0.5f + 0.5f * float(x) / OBJECT_GRID, 0.6f, 0.5f + 0.5f * float(z) / OBJECT_GRID);
+            add_box(vertices, indices, center, glm::vec3(1.5f, height, 1.5f), color);
+        }
+    }
+
+    index_count = static_cast<uint>(indices.size());
+
+    vbuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "vertex_buffer";
+        desc.size               = sizeof(Vertex) * vertices.size();
+        desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    ibuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "index_buffer";
+        desc.size               = sizeof(uint32_t) * indices.size();
+        desc.usage              = GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    auto vdata = vbuffer.get_mapped_range<Vertex>();
+    for (uint i = 0; i < vertices.size(); i++)
+        vdata.at(i) = vertices.at(i);
+
+    auto idata = ibuffer.get_mapped_range<uint>();
+    for (uint i = 0; i < index_count; i++)
+        idata.at(i) = indices.at(i);
+}
+
+void setup_shadow_map()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // one layer per cascade
+    shadow_map = execute([&]() {
+        auto desc            = GPUTextureDescriptor{};
+        desc.format          = GPUTextureFormat::DEPTH32FLOAT;
+        desc.size.width      = SHADOW_SIZE;
+        desc.size.height     = SHADOW_SIZE;
+        desc.size.depth      = 1;
+        desc.array_layers    = CASCADE_COUNT;
+        desc.mip_level_count = 1;
+        desc.usage           = GPUTextureUsage::RENDER_ATTACHMENT | GPUTextureUsage::TEXTURE_BINDING;
+        desc.label           = "shadow_map";
+        return device.create_texture(desc);
+    });
+
+    shadow_view = execute([&]() {
+        auto desc              = GPUTextureViewDescriptor{};
+        desc.format            = GPUTextureFormat::DEPTH32FLOAT;
+        desc.dimension         = GPUTextureViewDimension::x2D_ARRAY;
+        desc.aspect            = GPUTextureAspect::DEPTH_ONLY;
+        desc.base_mip_level    = 0;
+        desc.mip_level_count   = 1;
+        desc.base_array_layer  = 0;
+        desc.array_layer_count = CASCADE_COUNT;
+        return shadow_map.create_view(desc);
+    });
+
+    for (uint i = 0; i < CASCADE_COUNT; i++) {
+        auto desc              = GPUTextureViewDescriptor{};
+        desc.format            = GPUTextureFormat::DEPTH32FLOAT;
+        desc.dimension         = GPUTextureViewDimension::x2D;
+        desc.aspect            = GPUTextureAspect::DEPTH_ONLY;
+        desc.base_mip_level    = 0;
+        desc.mip_level_count   = 1;
+        desc.base_array_layer  = i;
+        desc.array_layer_count = 1;
+        cascade_views[i]       = shadow_map.create_view(desc);
+    }
+
+    // NOTE: linear filtering with a comparison gives 2x2 PCF for free, the shader adds a 3x3 kernel on top
+    shadow_sampler = execute([&]() {
+        auto desc           = GPUSamplerDescriptor{};
+        desc.label          = "shadow_sampler";
+        desc.address_mode_u = GPUAddressMode::CLAMP_TO_EDGE;
+        desc.address_mode_v = GPUAddressMode::CLAMP_TO_EDGE;
+        desc.address_mode_w = GPUAddressMode::CLAMP_TO_EDGE;
+        desc.mag_filter     = GPUFilterMode::LINEAR;
+        desc.min_filter     = GPUFilterMode::LINEAR;
+        desc.mipmap_filter  = GPUMipmapFilterMode::NEAREST;
+        desc.compare        = GPUCompareFunction::LESS_EQUAL;
+        desc.compare_enable = true;
+        return device.create_sampler(desc);
+    });
+
+    dbuffer = execute([&]() {
+        auto desc            = GPUTextureDescriptor{};
+        desc.format          = GPUTextureFormat::DEPTH32FLOAT;
+        desc.size.width      = extent.width;
+        desc.size.height     = extent.height;
+        desc.size.depth      = 1;
+        desc.array_layers    = 1;
+        desc.mip_level_count = 1;
+        desc.usage           = GPUTextureUsage::RENDER_ATTACHMENT;
+        desc.label           = "depth_buffer";
+        return device.create_texture(desc);
+    });
+
+    dview = dbuffer.create_view();
+
+    ubuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "uniform_buffer";
+        desc.size               = sizeof(Frame);
+        desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    bind_group = execute([&]() {
+        auto frame          = GPUBindGroupEntry{};
+        frame.type          = GPUBindingResourceType::BUFFER;
+        frame.binding       = 0;
+        frame.index         = 0;
+        frame.buffer.buffer = ubuffer;
+        frame.buffer.offset = 0;
+        frame.buffer.size   = 0;
+
+        auto shadows    = GPUBindGroupEntry{};
+        shadows.type    = GPUBindingResourceType::TEXTURE;
+        shadows.binding = 1;
+        shadows.index   = 0;
+        shadows.texture = shadow_view;
+
+        auto sampler    = GPUBindGroupEntry{};
+        sampler.type    = GPUBindingResourceType::SAMPLER;
+        sampler.binding = 2;
+        sampler.index   = 0;
+        sampler.sampler = shadow_sampler;
+
+        auto desc    = GPUBindGroupDescriptor{};
+        desc.layout  = blayout;
+        desc.entries = {frame, shadows, sampler};
+        return device.create_bind_group(desc);
+    });
+}
+
+void setup_timestamps()
+{
+    auto& device = RHI::get_current_device();
+
+    timestamp_period = device.get_timestamp_period();
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        timestamps[i] = execute([&]() {
+            auto desc  = GPUQuerySetDescriptor{};
+            desc.label = "timestamp_queries";
+            desc.type  = GPUQueryType::TIMESTAMP;
+            desc.count = TIMESTAMP_COUNT;
+            return device.create_query_set(desc);
+        });
+
+        timestamp_resolve[i] = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "timestamp_resolve_buffer";
+            desc.size  = sizeof(uint64_t) * TIMESTAMP_COUNT;
+            desc.usage = GPUBufferUsage::QUERY_RESOLVE | GPUBufferUsage::COPY_SRC;
+            return device.create_buffer(desc);
+        });
+
+        timestamp_readback[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "timestamp_readback_buffer";
+            desc.size               = sizeof(uint64_t) * TIMESTAMP_COUNT;
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    }
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        timestamps[i].destroy();
+        timestamp_resolve[i].destroy();
+        timestamp_readback[i].destroy();
+    }
+    shadow_sampler.destroy();
+    shadow_map.destroy();
+    dbuffer.destroy();
+    ubuffer.destroy();
+    ibuffer.destroy();
+    vbuffer.destroy();
+    vshader.destroy();
+    fshader.destroy();
+    shadow_vshader.destroy();
+    blayout.destroy();
+    playout.destroy();
+    shadow_playout.destroy();
+    pipeline.destroy();
+    shadow_pipeline.destroy();
+}
+
+// Practical split scheme, a blend between logarithmic splits (even texel density in depth)
+// and uniform splits (which do not waste the first cascade on the first few meters).
+auto split_depth(uint cascade) -> float
+{
+    float p       = float(cascade + 1) / float(CASCADE_COUNT);
+    float log     = NEAR_PLANE * std::pow(SHADOW_DISTANCE / NEAR_PLANE, p);
+    float uniform = NEAR_PLANE + (SHADOW_DISTANCE - NEAR_PLANE) * p;
+    return SPLIT_LAMBDA * log + (1.0f - SPLIT_LAMBDA) * uniform;
+}
+
+// Stable fit: the cascade is fitted to the bounding sphere of its slice of the view frustum rather than to the slice
+// itself. The sphere does not change size when the camera rotates, so neither does the projection, and snapping
+// the projection to whole texels removes the shimmering that would otherwise come from camera translation.
+void fit_cascade(Cascade& cascade, const glm::mat4& view, float aspect)
+{
+    auto inverse = glm::inverse(view);
+    auto tan_y   = std::tan(FOVY * 0.5f);
+    auto tan_x   = tan_y * aspect;
+
+    // corners of the slice in world space
+    glm::vec3 corners[8];
+    auto      center = glm::vec3(0.0f);
+    for (uint i = 0; i < 8; i++) {
+        float depth = (i & 4) ? cascade.far_depth : cascade.near_depth;
+        float x     = (i & 1) ? tan_x : -tan_x;
+        float y     = (i & 2) ? tan_y : -tan_y;
+        corners[i]  = glm::vec3(inverse * glm::vec4(x * depth, y * depth, -depth, 1.0f));
+        center      = center + corners[i] * 0.125f;
+    }
+
+    float radius = 0.0f;
+    for (uint i = 0; i < 8; i++)
+        radius = std::max(radius, glm::length(corners[i] - center));
+
+    // NOTE: round up, so that floating point noise does not change the size of a texel from frame to frame
+    radius = std::ceil(radius * 16.0f) / 16.0f;
+
+    cascade.radius = radius;
+    cascade.depth  = radius * 2.0f + CASTER_DISTANCE;
+    cascade.view   = glm::lookAt(center - light_direction * (radius + CASTER_DISTANCE), center, glm::vec3(0.0f, 1.0f, 0.0f));
+
+    // snap the projection, so that the world origin (and with it, every texel) lands on a whole texel
+    auto proj    = glm::ortho(-radius, radius, -radius, radius, 0.0f, cascade.depth);
+    auto world   = proj * cascade.view * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    auto texels  = glm::vec2(world.x, world.y) * (SHADOW_SIZE * 0.5f);
+    auto snapped = glm::vec2(std::round(texels.x), std::round(texels.y));
+    auto offset  = (snapped - texels) * (2.0f / SHADOW_SIZE);
+    proj[3][0] += offset.x;
+    proj[3][1] += offset.y;
+
+    cascade.view_proj = proj * cascade.view;
+}
+
+// Per cascade culling of bounding spheres against the orthographic box of the light.
+// Objects between the light and the box are kept, they may still cast into it.
+void cull_cascade(Cascade& cascade)
+{
+    cascade.draws.clear();
+
+    for (uint i = 0; i < objects.size(); i++) {
+        auto& sphere = objects.at(i).sphere;
+        auto  center = cascade.view * glm::vec4(sphere.x, sphere.y, sphere.z, 1.0f);
+        float reach  = cascade.radius + sphere.w;
+        float depth  = -center.z;
+
+        if (std::abs(center.x) > reach || std::abs(center.y) > reach) continue;
+        if (depth + sphere.w < 0.0f || depth - sphere.w > cascade.depth) continue;
+
+        cascade.draws.push_back(i);
+    }
+}
+
+void update(const WindowInput& input)
+{
+    static float time = 0.0f;
+    time += input.delta_time;
+
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+    auto  aspect  = float(extent.width) / float(extent.height);
+
+    // circle around the towers, looking along the path, so every cascade keeps changing what it covers
+    float angle = time * 0.05f;
+    auto  eye   = glm::vec3(std::sin(angle) * 40.0f, 6.0f, std::cos(angle) * 40.0f);
+    auto  ahead = glm::vec3(std::cos(angle), -0.15f, -std::sin(angle));
+    auto  view  = glm::lookAt(eye, eye + ahead, glm::vec3(0.0f, 1.0f, 0.0f));
+    auto  proj  = glm::perspective(FOVY, aspect, NEAR_PLANE, FAR_PLANE);
+
+    auto frame                  = ubuffer.get_mapped_range<Frame>();
+    frame.at(0).view            = view;
+    frame.at(0).view_proj       = proj * view;
+    frame.at(0).light_direction = glm::vec4(light_direction, 0.0f);
+    frame.at(0).shadow          = glm::vec4(1.0f / SHADOW_SIZE, 1.5f, config.show_cascades ? 1.0f : 0.0f, 0.0f);
+
+    for (uint i = 0; i < CASCADE_COUNT; i++) {
+        auto& cascade      = cascades[i];
+        cascade.near_depth = i == 0 ? NEAR_PLANE : split_depth(i - 1);
+        cascade.far_depth  = split_depth(i);
+        fit_cascade(cascade, view, aspect);
+        cull_cascade(cascade);
+
+        frame.at(0).cascades[i] = cascade.view_proj;
+        frame.at(0).splits[i]   = cascade.far_depth;
+        frame.at(0).texels[i]   = cascade.radius * 2.0f / SHADOW_SIZE;
+    }
+}
+
+void render_cascades(GPUCommandBuffer& command, uint slot)
+{
+    command.resource_barrier(state_transition(shadow_map, undefined_state(), depth_stencil_attachment_state()));
+
+    // every cascade renders into its own layer, with the same pipeline, vertex and index buffer
+    for (uint i = 0; i < CASCADE_COUNT; i++) {
+        auto& cascade = cascades[i];
+
+        auto depth_attachment              = GPURenderPassDepthStencilAttachment{};
+        depth_attachment.view              = cascade_views[i];
+        depth_attachment.depth_clear_value = 1.0f;
+        depth_attachment.depth_load_op     = GPULoadOp::CLEAR;
+        depth_attachment.depth_store_op    = GPUStoreOp::STORE;
+        depth_attachment.depth_read_only   = false;
+
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = {};
+        render_pass.depth_stencil_attachment = depth_attachment;
+
+        command.begin_render_pass(render_pass);
+        command.set_viewport(0, 0, SHADOW_SIZE, SHADOW_SIZE);
+        command.set_scissor_rect(0, 0, SHADOW_SIZE, SHADOW_SIZE);
+        command.set_pipeline(shadow_pipeline);
+        command.set_vertex_buffer(0, vbuffer);
+        command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+        command.set_push_constants(GPUShaderStage::VERTEX, 0, sizeof(glm::mat4), &cascade.view_proj);
+        for (uint index : cascade.draws) {
+            auto& object = objects.at(index);
+            command.draw_indexed(object.index_count, 1, object.first_index, 0, 0);
+        }
+        command.end_render_pass();
+        command.write_timestamp(timestamps[slot], FRAME_BEGIN + 1 + i);
+    }
+
+    command.resource_barrier(state_transition(shadow_map, depth_stencil_attachment_state(), shader_resource_state(GPUShaderStage::FRAGMENT)));
+}
+
+void render_scene(GPUCommandBuffer& command, const GPUSurfaceTexture& backbuffer)
+{
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.5f, 0.6f, 0.8f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = backbuffer.view;
+
+    auto depth_attachment              = GPURenderPassDepthStencilAttachment{};
+    depth_attachment.view              = dview;
+    depth_attachment.depth_clear_value = 1.0f;
+    depth_attachment.depth_load_op     = GPULoadOp::CLEAR;
+    depth_attachment.depth_store_op    = GPUStoreOp::DISCARD;
+    depth_attachment.depth_read_only   = false;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = {color_attachment};
+    render_pass.depth_stencil_attachment = depth_attachment;
+
+    command.resource_barrier(state_transition(dbuffer, undefined_state(), depth_stencil_attachment_state()));
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(pipeline);
+    command.set_vertex_buffer(0, vbuffer);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+    command.set_bind_group(0, bind_group);
+    command.draw_indexed(index_count, 1, 0, 0, 0);
+    command.end_render_pass();
+}
+
+void read_timestamps(uint slot)
+{
+    // the readback buffer in this slot was filled FRAMES_INFLIGHT frames ago, which is complete once its texture is acquired
+    if (frame_index < FRAMES_INFLIGHT)
+        return;
+
+    auto values = timestamp_readback[slot].get_mapped_range<uint64_t>();
+    for (uint i = 0; i < CASCADE_COUNT; i++)
+        stats.cascade_gpu[i] += double(values.at(FRAME_BEGIN + 1 + i) - values.at(FRAME_BEGIN + i)) * timestamp_period * 1e-6;
+    stats.scene += double(values.at(SCENE_END) - values.at(SCENE_END - 1)) * timestamp_period * 1e-6;
+    stats.samples++;
+}
+
+void report()
+{
+    auto now = ShadowStats::Clock::now();
+    if (stats.frames > 0)
+        stats.frame += std::chrono::duration<double, std::milli>(now - stats.last).count();
+    stats.last = now;
+
+    for (uint i = 0; i < CASCADE_COUNT; i++)
+        stats.cascade_draws[i] += cascades[i].draws.size();
+
+    if (++stats.frames == FRAMES_PER_REPORT) {
+        auto samples = double(std::max(stats.samples, 1u));
+        auto shadows = 0.0;
+        for (uint i = 0; i < CASCADE_COUNT; i++) {
+            auto gpu = stats.cascade_gpu[i] / samples;
+            shadows += gpu;
+            std::cout << "Cascade " << i << ": " << cascades[i].near_depth << " - " << cascades[i].far_depth << " m"
+                      << ", Draws: " << double(stats.cascade_draws[i]) / FRAMES_PER_REPORT << "/" << objects.size()
+                      << ", GPU: " << gpu << " ms" << std::endl;
+        }
+        std::cout << "Shadows: " << shadows << " ms"
+                  << ", Scene: " << stats.scene / samples << " ms"
+                  << ", Frame Time: " << stats.frame / (FRAMES_PER_REPORT - 1) << " ms" << std::endl;
+
+        stats = ShadowStats{};
+    }
+}
+
+void render()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    auto slot = static_cast<uint>(frame_index % FRAMES_INFLIGHT);
+    read_timestamps(slot);
+
+    // create command buffer
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    // commands
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    command.write_timestamp(timestamps[slot], FRAME_BEGIN);
+    render_cascades(command, slot);
+    render_scene(command, texture);
+    command.write_timestamp(timestamps[slot], SCENE_END);
+    command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+
+    // timestamps are read back by the frame that reuses this slot
+    command.resource_barrier(state_transition(timestamp_resolve[slot], undefined_state(), copy_dst_state()));
+    command.resolve_query_set(timestamps[slot], 0, TIMESTAMP_COUNT, timestamp_resolve[slot], 0);
+    command.resource_barrier(state_transition(timestamp_resolve[slot], copy_dst_state(), copy_src_state()));
+    command.copy_buffer_to_buffer(timestamp_resolve[slot], 0, timestamp_readback[slot], 0, sizeof(uint64_t) * TIMESTAMP_COUNT);
+
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    // present this frame to swapchain
+    texture.present();
+
+    report();
+    frame_index++;
+}
+
+int main(int argc, char** argv)
+{
+    setup_config(argc, argv);
+
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Immediate; // NOTE: do not hide frame time behind vsync
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipelines);
+    win->bind<WindowEvent::START>(setup_geometry);
+    win->bind<WindowEvent::START>(setup_shadow_map);
+    win->bind<WindowEvent::START>(setup_timestamps);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
@@ -0,0 +1,842 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec3 color;
+};
+
+// NOTE: must match the layout in shader.slang, animate.slang and cluster.slang
+struct Frame
+{
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::vec4 slices; // near, far, slice scale, slice bias
+    float     time;
+    uint      light_count;
+    glm::vec2 padding;
+};
+
+struct Light
+{
+    glm::vec4 center; // xyz = center of the orbit, w = orbit radius
+    glm::vec4 color;  // rgb = color, w = range
+    glm::vec4 motion; // x = angular speed, y = phase
+};
+
+struct ViewLight
+{
+    glm::vec4 position; // xyz = view space position, w = range
+    glm::vec4 color;
+};
+
+struct ClusterBounds
+{
+    glm::vec4 min; // view space
+    glm::vec4 max;
+};
+
+enum Timestamp : uint
+{
+    FRAME_BEGIN,
+    BINNING_END,
+    SHADING_END,
+    TIMESTAMP_COUNT,
+};
+
+struct CaseStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last;
+    double            binning = 0.0;
+    double            shading = 0.0;
+    double            frame   = 0.0;
+    uint              samples = 0; // GPU samples
+    uint              frames  = 0;
+};
+
+constexpr uint  CLUSTER_X              = 16;
+constexpr uint  CLUSTER_Y              = 9;
+constexpr uint  CLUSTER_Z              = 24;
+constexpr uint  CLUSTER_COUNT          = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+constexpr uint  MAX_LIGHTS_PER_CLUSTER = 256;
+constexpr uint  LIGHT_COUNTS[]         = {256, 1024, 4096, 16384};
+constexpr uint  MAX_LIGHTS             = 16384;
+constexpr uint  CASE_COUNT             = std::size(LIGHT_COUNTS);
+constexpr uint  FRAMES_PER_CASE        = 240;
+constexpr uint  FRAMES_INFLIGHT        = 3;
+constexpr uint  CUBE_GRID              = 16;
+constexpr float NEAR_PLANE             = 0.1f;
+constexpr float FAR_PLANE              = 100.0f;
+
+GPUShaderModule    vshader;
+GPUShaderModule    fshader;
+GPUShaderModule    animate_shader;
+GPUShaderModule    cluster_shader;
+GPUBindGroupLayout draw_blayout;
+GPUBindGroupLayout animate_blayout;
+GPUBindGroupLayout cluster_blayout;
+GPUPipelineLayout  draw_playout;
+GPUPipelineLayout  animate_playout;
+GPUPipelineLayout  cluster_playout;
+GPURenderPipeline  draw_pipeline;
+GPUComputePipeline animate_pipeline;
+GPUComputePipeline cluster_pipeline;
+GPUBindGroup       draw_bind_group;
+GPUBindGroup       animate_bind_group;
+GPUBindGroup       cluster_bind_group;
+GPUBuffer          vbuffer;
+GPUBuffer          ibuffer;
+GPUBuffer          frame_ubuffer;
+GPUBuffer          light_buffer;
+GPUBuffer          view_light_buffer;
+GPUBuffer          cluster_buffer;
+GPUBuffer          light_grid_buffer;
+GPUBuffer          light_index_buffer;
+GPUTexture         dbuffer;
+GPUTextureView     dview;
+GPUQuerySet        timestamps[FRAMES_INFLIGHT];
+GPUBuffer          timestamp_resolve[FRAMES_INFLIGHT];
+GPUBuffer          timestamp_readback[FRAMES_INFLIGHT];
+uint               timestamp_case[FRAMES_INFLIGHT];
+double             timestamp_period = 1.0; // nanoseconds per tick
+uint               index_count      = 0;
+uint64_t           frame_index      = 0;
+uint               current_case     = 0;
+CaseStats          stats;
+
+auto read_shader_source(const std::string& name) -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open(name);
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+auto compile_shader(const std::string& name, const char* entry, const char* label) -> GPUShaderModule
+{
+    auto& device = RHI::get_current_device();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = name;
+        desc.path   = name;
+        desc.source = read_shader_source(name);
+        return compiler->compile(desc);
+    });
+
+    return execute([&]() {
+        auto code  = module->get_shader_blob(entry);
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = label;
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+}
+
+auto buffer_layout_entry(uint binding, uint32_t visibility, GPUBufferBindingType type) -> GPUBindGroupLayoutEntry
+{
+    auto entry                      = GPUBindGroupLayoutEntry{};
+    entry.type                      = GPUBindingResourceType::BUFFER;
+    entry.binding                   = binding;
+    entry.count                     = 1;
+    entry.visibility                = visibility;
+    entry.buffer.type               = type;
+    entry.buffer.has_dynamic_offset = false;
+    return entry;
+}
+
+auto buffer_entry(uint binding, const GPUBuffer& buffer) -> GPUBindGroupEntry
+{
+    auto entry          = GPUBindGroupEntry{};
+    entry.type          = GPUBindingResourceType::BUFFER;
+    entry.binding       = binding;
+    entry.index         = 0;
+    entry.buffer.buffer = buffer;
+    entry.buffer.offset = 0;
+    entry.buffer.size   = 0;
+    return entry;
+}
+
+auto create_compute_pipeline(const GPUPipelineLayout& layout, const GPUShaderModule& module) -> GPUComputePipeline
+{
+    auto& device = RHI::get_current_device();
+
+    return execute([&]() {
+        auto desc           = GPUComputePipelineDescriptor{};
+        desc.layout         = layout;
+        desc.compute.module = module;
+        return device.create_compute_pipeline(desc);
+    });
+}
+
+// NOTE: same camera as the DepthTest sample (standard depth), the froxel grid is built from this projection
+auto create_projection(float aspect) -> glm::mat4
+{
+    return glm::perspective(1.05f, aspect, NEAR_PLANE, FAR_PLANE);
+}
+
+auto create_modelview() -> glm::mat4
+{
+    return glm::lookAt(
+        glm::vec3(0.0f, 0.0f, 3.0f),
+        glm::vec3(0.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+// view space depth where the given slice begins, slices are spaced exponentially between the near and far plane
+auto slice_depth(uint slice) -> float
+{
+    return NEAR_PLANE * std::pow(FAR_PLANE / NEAR_PLANE, float(slice) / float(CLUSTER_Z));
+}
+
+void setup_pipelines()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    vshader        = compile_shader("shader.slang", "vsmain", "vertex_shader");
+    fshader        = compile_shader("shader.slang", "fsmain", "fragment_shader");
+    animate_shader = compile_shader("animate.slang", "csmain", "animate_shader");
+    cluster_shader = compile_shader("cluster.slang", "csmain", "cluster_shader");
+
+    draw_blayout = execute([&]() {
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(buffer_layout_entry(0, GPUShaderStage::VERTEX | GPUShaderStage::FRAGMENT, GPUBufferBindingType::UNIFORM));
+        desc.entries.push_back(buffer_layout_entry(1, GPUShaderStage::FRAGMENT, GPUBufferBindingType::READ_ONLY_STORAGE));
+        desc.entries.push_back(buffer_layout_entry(2, GPUShaderStage::FRAGMENT, GPUBufferBindingType::READ_ONLY_STORAGE));
+        desc.entries.push_back(buffer_layout_entry(3, GPUShaderStage::FRAGMENT, GPUBufferBindingType::READ_ONLY_STORAGE));
+        return device.create_bind_group_layout(desc);
+    });
+
+    animate_blayout = execute([&]() {
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(buffer_layout_entry(0, GPUShaderStage::COMPUTE, GPUBufferBindingType::UNIFORM));
+        desc.entries.push_back(buffer_layout_entry(1, GPUShaderStage::COMPUTE, GPUBufferBindingType::READ_ONLY_STORAGE));
+        desc.entries.push_back(buffer_layout_entry(2, GPUShaderStage::COMPUTE, GPUBufferBindingType::STORAGE));
+        return device.create_bind_group_layout(desc);
+    });
+
+    cluster_blayout = execute([&]() {
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(buffer_layout_entry(0, GPUShaderStage::COMPUTE, GPUBufferBindingType::UNIFORM));
+        desc.entries.push_back(buffer_layout_entry(1, GPUShaderStage::COMPUTE, GPUBufferBindingType::READ_ONLY_STORAGE));
+        desc.entries.push_back(buffer_layout_entry(2, GPUShaderStage::COMPUTE, GPUBufferBindingType::READ_ONLY_STORAGE));
+        desc.entries.push_back(buffer_layout_entry(3, GPUShaderStage::COMPUTE, GPUBufferBindingType::STORAGE));
+        desc.entries.push_back(buffer_layout_entry(4, GPUShaderStage::COMPUTE, GPUBufferBindingType::STORAGE));
+        return device.create_bind_group_layout(desc);
+    });
+
+    draw_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {draw_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    animate_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {animate_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    cluster_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {cluster_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    draw_pipeline = execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x3;
+        position.offset          = 0;
+        position.shader_location = 0;
+
+        auto normal            = GPUVertexAttribute{};
+        normal.format          = GPUVertexFormat::FLOAT32x3;
+        normal.offset          = sizeof(float) * 3;
+        normal.shader_location = 1;
+
+        auto color            = GPUVertexAttribute{};
+        color.format          = GPUVertexFormat::FLOAT32x3;
+        color.offset          = sizeof(float) * 6;
+        color.shader_location = 2;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position, normal, color};
+        layout.array_stride = sizeof(Vertex);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto target         = GPUColorTargetState{};
+        target.format       = surface.get_current_format();
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = draw_playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.format                  = GPUTextureFormat::DEPTH32FLOAT;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::LESS;
+        desc.depth_stencil.depth_write_enabled     = true;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vshader;
+        desc.fragment.module                       = fshader;
+        desc.vertex.buffers.push_back(layout);
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+
+    animate_pipeline = create_compute_pipeline(animate_playout, animate_shader);
+    cluster_pipeline = create_compute_pipeline(cluster_playout, cluster_shader);
+}
+
+void add_box(std::vector<Vertex>& vertices, std::vector<uint>& indices, glm::vec3 center, glm::vec3 extent, glm::vec3 color)
+{
+    // 4 vertices per face, so that every face has a normal of its own
+    for (uint axis = 0; axis < 3; axis++) {
+        for (float sign : {-1.0f, 1.0f}) {
+            auto normal             = glm::vec3(0.0f);
+            auto tangent            = glm::vec3(0.0f);
+            normal[axis]            = sign;
+            tangent[(axis + 1) % 3] = 1.0f;
+
+            auto bitangent = glm::cross(normal, tangent);
+
+            auto base = static_cast<uint>(vertices.size());
+            for (uint i = 0; i < 4; i++) {
+                float u      = (i & 1) ? 0.5f : -0.5f;
+                float v      = (i & 2) ? 0.5f : -0.5f;
+                auto  corner = normal * 0.5f + tangent * u + bitangent * v;
+                vertices.push_back({center + corner * extent, normal, color});
+            }
+
+            for (uint i : {0u, 1u, 3u, 0u, 3u, 2u})
+                indices.push_back(base + i);
+        }
+    }
+}
+
+void setup_geometry()
+{
+    auto& device = RHI::get_current_device();
+
+    auto vertices = std::vector<Vertex>{};
+    auto indices  = std::vector<uint>{};
+
+    // floor, below the camera and stretching away from it
+    add_box(vertices, indices, glm::vec3(0.0f, -1.05f, -20.0f), glm::vec3(50.0f, 0.1f, 50.0f), glm::vec3(0.8f));
+
+    // grid of boxes with varying heights, so that lights hit surfaces at every depth
+    for (uint z = 0; z < CUBE_GRID; z++) {
+        for (uint x = 0; x < CUBE_GRID; x++) {
+            float height = 0.5f + float((x * 7 + z * 3) % 5) * 0.4f;
+            auto  center = glm::vec3((float(x) - CUBE_GRID * 0.5f + 0.5f) * 2.5f, -1.0f + height * 0.5f, -2.5f - float(z) * 2.5f);
+            auto  color  = glm::vec3(0.6f + 0.4f * float(x) / CUBE_GRID, 0.7f, 0.6f + 0.4f * float(z) / CUBE_GRID);
+            add_box(vertices, indices, center, glm::vec3(0.8f, height, 0.8f), color);
+        }
+    }
+
+    index_count = static_cast<uint>(indices.size());
+
+    vbuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "vertex_buffer";
+        desc.size               = sizeof(Vertex) * vertices.size();
+        desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    ibuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "index_buffer";
+        desc.size               = sizeof(uint32_t) * indices.size();
+        desc.usage              = GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    auto vdata = vbuffer.get_mapped_range<Vertex>();
+    for (uint i = 0; i < vertices.size(); i++)
+        vdata.at(i) = vertices.at(i);
+
+    auto idata = ibuffer.get_mapped_range<uint>();
+    for (uint i = 0; i < index_count; i++)
+        idata.at(i) = indices.at(i);
+}
+
+void setup_lights()
+{
+    auto& device = RHI::get_current_device();
+
+    light_buffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "light_buffer";
+        desc.size               = sizeof(Light) * MAX_LIGHTS;
+        desc.usage              = GPUBufferUsage::STORAGE | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    view_light_buffer = execute([&]() {
+        auto desc  = GPUBufferDescriptor{};
+        desc.label = "view_light_buffer";
+        desc.size  = sizeof(ViewLight) * MAX_LIGHTS;
+        desc.usage = GPUBufferUsage::STORAGE;
+        return device.create_buffer(desc);
+    });
+
+    // NOTE: fixed seed, so that every run (and every light count) sees the same lights
+    auto rng    = std::mt19937(1234);
+    auto random = [&](float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); };
+
+    // smaller light counts use a prefix of the same list, which is still uniformly spread over the scene
+    auto lights = light_buffer.get_mapped_range<Light>();
+    for (uint i = 0; i < MAX_LIGHTS; i++) {
+        auto color = glm::vec3(random(0.0f, 1.0f), random(0.0f, 1.0f), random(0.0f, 1.0f));
+        auto peak  = std::max(std::max(color.x, color.y), std::max(color.z, 1e-3f));
+        color      = color * (1.0f / peak); // saturated colors, brightness comes from the range
+
+        auto& light  = lights.at(i);
+        light.center = glm::vec4(random(-20.0f, 20.0f), random(-0.8f, 0.8f), random(-40.0f, 2.0f), random(0.5f, 3.0f));
+        light.color  = glm::vec4(color, random(0.75f, 2.0f));
+        light.motion = glm::vec4(random(-1.0f, 1.0f), random(0.0f, 6.2831853f), 0.0f, 0.0f);
+    }
+}
+
+void setup_clusters()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+    auto  proj    = create_projection(float(extent.width) / float(extent.height));
+
+    cluster_buffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "cluster_buffer";
+        desc.size               = sizeof(ClusterBounds) * CLUSTER_COUNT;
+        desc.usage              = GPUBufferUsage::STORAGE | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    light_grid_buffer = execute([&]() {
+        auto desc  = GPUBufferDescriptor{};
+        desc.label = "light_grid_buffer";
+        desc.size  = sizeof(uint) * CLUSTER_COUNT;
+        desc.usage = GPUBufferUsage::STORAGE;
+        return device.create_buffer(desc);
+    });
+
+    // NOTE: fixed capacity per cluster, lights past MAX_LIGHTS_PER_CLUSTER are dropped
+    light_index_buffer = execute([&]() {
+        auto desc  = GPUBufferDescriptor{};
+        desc.label = "light_index_buffer";
+        desc.size  = sizeof(uint) * CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER;
+        desc.usage = GPUBufferUsage::STORAGE;
+        return device.create_buffer(desc);
+    });
+
+    // The bounds only depend on the projection, so they are built once. Each cluster is the view space box
+    // around the part of its screen tile between the near and far depth of its slice.
+    auto clusters = cluster_buffer.get_mapped_range<ClusterBounds>();
+    for (uint z = 0; z < CLUSTER_Z; z++) {
+        float depths[2] = {slice_depth(z), slice_depth(z + 1)};
+
+        for (uint y = 0; y < CLUSTER_Y; y++) {
+            for (uint x = 0; x < CLUSTER_X; x++) {
+                auto lo = glm::vec3(+1e30f);
+                auto hi = glm::vec3(-1e30f);
+
+                for (uint i = 0; i < 8; i++) {
+                    // uv has y pointing down, like in find_cluster() in shader.slang
+                    float u     = float(x + (i & 1)) / float(CLUSTER_X);
+                    float v     = float(y + ((i >> 1) & 1)) / float(CLUSTER_Y);
+                    float depth = depths[i >> 2];
+                    auto  point = glm::vec3(
+                        (u * 2.0f - 1.0f) * depth / proj[0][0],
+                        (1.0f - v * 2.0f) * depth / proj[1][1],
+                        -depth);
+
+                    lo = glm::min(lo, point);
+                    hi = glm::max(hi, point);
+                }
+
+                auto& cluster = clusters.at((z * CLUSTER_Y + y) * CLUSTER_X + x);
+                cluster.min   = glm::vec4(lo, 0.0f);
+                cluster.max   = glm::vec4(hi, 0.0f);
+            }
+        }
+    }
+}
+
+void setup_frame()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    frame_ubuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "frame_uniform_buffer";
+        desc.size               = sizeof(Frame);
+        desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    dbuffer = execute([&]() {
+        auto desc            = GPUTextureDescriptor{};
+        desc.format          = GPUTextureFormat::DEPTH32FLOAT;
+        desc.size.width      = extent.width;
+        desc.size.height     = extent.height;
+        desc.size.depth      = 1;
+        desc.array_layers    = 1;
+        desc.mip_level_count = 1;
+        desc.usage           = GPUTextureUsage::RENDER_ATTACHMENT;
+        desc.label           = "depth_buffer";
+        return device.create_texture(desc);
+    });
+
+    dview = dbuffer.create_view();
+
+    // bind groups are fixed, because none of the buffers ever change
+    draw_bind_group = execute([&]() {
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = draw_blayout;
+        desc.entries.push_back(buffer_entry(0, frame_ubuffer));
+        desc.entries.push_back(buffer_entry(1, view_light_buffer));
+        desc.entries.push_back(buffer_entry(2, light_grid_buffer));
+        desc.entries.push_back(buffer_entry(3, light_index_buffer));
+        return device.create_bind_group(desc);
+    });
+
+    animate_bind_group = execute([&]() {
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = animate_blayout;
+        desc.entries.push_back(buffer_entry(0, frame_ubuffer));
+        desc.entries.push_back(buffer_entry(1, light_buffer));
+        desc.entries.push_back(buffer_entry(2, view_light_buffer));
+        return device.create_bind_group(desc);
+    });
+
+    cluster_bind_group = execute([&]() {
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = cluster_blayout;
+        desc.entries.push_back(buffer_entry(0, frame_ubuffer));
+        desc.entries.push_back(buffer_entry(1, cluster_buffer));
+        desc.entries.push_back(buffer_entry(2, view_light_buffer));
+        desc.entries.push_back(buffer_entry(3, light_grid_buffer));
+        desc.entries.push_back(buffer_entry(4, light_index_buffer));
+        return device.create_bind_group(desc);
+    });
+}
+
+void setup_timestamps()
+{
+    auto& device = RHI::get_current_device();
+
+    timestamp_period = device.get_timestamp_period();
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        timestamps[i] = execute([&]() {
+            auto desc  = GPUQuerySetDescriptor{};
+            desc.label = "timestamp_queries";
+            desc.type  = GPUQueryType::TIMESTAMP;
+            desc.count = TIMESTAMP_COUNT;
+            return device.create_query_set(desc);
+        });
+
+        timestamp_resolve[i] = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "timestamp_resolve_buffer";
+            desc.size  = sizeof(uint64_t) * TIMESTAMP_COUNT;
+            desc.usage = GPUBufferUsage::QUERY_RESOLVE | GPUBufferUsage::COPY_SRC;
+            return device.create_buffer(desc);
+        });
+
+        timestamp_readback[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "timestamp_readback_buffer";
+            desc.size               = sizeof(uint64_t) * TIMESTAMP_COUNT;
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    }
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        timestamps[i].destroy();
+        timestamp_resolve[i].destroy();
+        timestamp_readback[i].destroy();
+    }
+    vbuffer.destroy();
+    ibuffer.destroy();
+    frame_ubuffer.destroy();
+    light_buffer.destroy();
+    view_light_buffer.destroy();
+    cluster_buffer.destroy();
+    light_grid_buffer.destroy();
+    light_index_buffer.destroy();
+    dbuffer.destroy();
+    vshader.destroy();
+    fshader.destroy();
+    animate_shader.destroy();
+    cluster_shader.destroy();
+    draw_blayout.destroy();
+    animate_blayout.destroy();
+    cluster_blayout.destroy();
+    draw_playout.destroy();
+    animate_playout.destroy();
+    cluster_playout.destroy();
+    draw_pipeline.destroy();
+    animate_pipeline.destroy();
+    cluster_pipeline.destroy();
+}
+
+void update(const WindowInput& input)
+{
+    static float time = 0.0f;
+    time += input.delta_time;
+
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // NOTE: slice = log(depth) * scale - bias, which maps the near plane to slice 0 and the far plane to CLUSTER_Z
+    float scale = float(CLUSTER_Z) / std::log(FAR_PLANE / NEAR_PLANE);
+    float bias  = std::log(NEAR_PLANE) * scale;
+
+    auto frame              = frame_ubuffer.get_mapped_range<Frame>();
+    frame.at(0).view        = create_modelview();
+    frame.at(0).proj        = create_projection(float(extent.width) / float(extent.height));
+    frame.at(0).slices      = glm::vec4(NEAR_PLANE, FAR_PLANE, scale, bias);
+    frame.at(0).time        = time;
+    frame.at(0).light_count = LIGHT_COUNTS[current_case];
+}
+
+void bin_lights(GPUCommandBuffer& command)
+{
+    auto lights = LIGHT_COUNTS[current_case];
+
+    command.resource_barrier(state_transition(view_light_buffer, undefined_state(), storage_state(GPUShaderStage::COMPUTE)));
+    command.set_pipeline(animate_pipeline);
+    command.set_bind_group(0, animate_bind_group);
+    command.dispatch_workgroups((lights + 63) / 64);
+    command.resource_barrier(state_transition(view_light_buffer, storage_state(GPUShaderStage::COMPUTE), shader_resource_state(GPUShaderStage::COMPUTE)));
+
+    // one thread per cluster, every workgroup walks all lights
+    command.resource_barrier(state_transition(light_grid_buffer, undefined_state(), storage_state(GPUShaderStage::COMPUTE)));
+    command.resource_barrier(state_transition(light_index_buffer, undefined_state(), storage_state(GPUShaderStage::COMPUTE)));
+    command.set_pipeline(cluster_pipeline);
+    command.set_bind_group(0, cluster_bind_group);
+    command.dispatch_workgroups((CLUSTER_COUNT + 63) / 64);
+    command.resource_barrier(state_transition(light_grid_buffer, storage_state(GPUShaderStage::COMPUTE), shader_resource_state(GPUShaderStage::FRAGMENT)));
+    command.resource_barrier(state_transition(light_index_buffer, storage_state(GPUShaderStage::COMPUTE), shader_resource_state(GPUShaderStage::FRAGMENT)));
+    command.resource_barrier(state_transition(view_light_buffer, shader_resource_state(GPUShaderStage::COMPUTE), shader_resource_state(GPUShaderStage::FRAGMENT)));
+}
+
+void draw_scene(GPUCommandBuffer& command, const GPUSurfaceTexture& backbuffer)
+{
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = backbuffer.view;
+
+    auto depth_attachment              = GPURenderPassDepthStencilAttachment{};
+    depth_attachment.view              = dview;
+    depth_attachment.depth_clear_value = 1.0f;
+    depth_attachment.depth_load_op     = GPULoadOp::CLEAR;
+    depth_attachment.depth_store_op    = GPUStoreOp::DISCARD;
+    depth_attachment.depth_read_only   = false;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = {color_attachment};
+    render_pass.depth_stencil_attachment = depth_attachment;
+
+    command.resource_barrier(state_transition(dbuffer, undefined_state(), depth_stencil_attachment_state()));
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(draw_pipeline);
+    command.set_vertex_buffer(0, vbuffer);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+    command.set_bind_group(0, draw_bind_group);
+    command.draw_indexed(index_count, 1, 0, 0, 0);
+    command.end_render_pass();
+}
+
+void read_timestamps(uint slot)
+{
+    // the readback buffer in this slot was filled FRAMES_INFLIGHT frames ago, which is complete once its texture is acquired
+    if (frame_index < FRAMES_INFLIGHT || timestamp_case[slot] != current_case)
+        return;
+
+    auto values = timestamp_readback[slot].get_mapped_range<uint64_t>();
+    stats.binning += double(values.at(BINNING_END) - values.at(FRAME_BEGIN)) * timestamp_period * 1e-6;
+    stats.shading += double(values.at(SHADING_END) - values.at(BINNING_END)) * timestamp_period * 1e-6;
+    stats.samples++;
+}
+
+void report()
+{
+    auto now = CaseStats::Clock::now();
+    if (stats.frames > 0)
+        stats.frame += std::chrono::duration<double, std::milli>(now - stats.last).count();
+    stats.last = now;
+
+    // every light count runs for a fixed number of frames, then the next one takes over
+    if (++stats.frames == FRAMES_PER_CASE) {
+        auto samples = double(std::max(stats.samples, 1u));
+        auto binning = stats.binning / samples;
+        auto shading = stats.shading / samples;
+        std::cout << "Lights: " << LIGHT_COUNTS[current_case]
+                  << ", Binning: " << binning << " ms"
+                  << ", Shading: " << shading << " ms"
+                  << ", GPU: " << binning + shading << " ms"
+                  << ", Frame Time: " << stats.frame / (FRAMES_PER_CASE - 1) << " ms" << std::endl;
+
+        current_case = (current_case + 1) % CASE_COUNT;
+        stats        = CaseStats{};
+    }
+}
+
+void render()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    auto slot = static_cast<uint>(frame_index % FRAMES_INFLIGHT);
+    read_timestamps(slot);
+    timestamp_case[slot] = current_case;
+
+    // create command buffer
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    // commands
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    command.write_timestamp(timestamps[slot], FRAME_BEGIN);
+    bin_lights(command);
+    command.write_timestamp(timestamps[slot], BINNING_END);
+    draw_scene(command, texture);
+    command.write_timestamp(timestamps[slot], SHADING_END);
+    command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+
+    // timestamps are read back by the frame that reuses this slot
+    command.resource_barrier(state_transition(timestamp_resolve[slot], undefined_state(), copy_dst_state()));
+    command.resolve_query_set(timestamps[slot], 0, TIMESTAMP_COUNT, timestamp_resolve[slot], 0);
+    command.resource_barrier(state_transition(timestamp_resolve[slot], copy_dst_state(), copy_src_state()));
+    command.copy_buffer_to_buffer(timestamp_resolve[slot], 0, timestamp_readback[slot], 0, sizeof(uint64_t) * TIMESTAMP_COUNT);
+
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    // present this frame to swapchain
+    texture.present();
+
+    report();
+    frame_index++;
+}
+
+int main()
+{
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Immediate; // NOTE: do not hide frame time behind vsync
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipelines);
+    win->bind<WindowEvent::START>(setup_geometry);
+    win->bind<WindowEvent::START>(setup_lights);
+    win->bind<WindowEvent::START>(setup_clusters);
+    win->bind<WindowEvent::START>(setup_frame);
+    win->bind<WindowEvent::START>(setup_timestamps);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <stdexcept>
+
+#include "Trace.h"
+
+using namespace lyra;
+using namespace lyra::rhi;
+
+namespace
+{
+    // traces are written in chunks of this size
+    constexpr size_t WRITE_BUFFER_SIZE = 4ull << 20;
+} // namespace
+
+auto to_gpu_state(const TraceResourceState& state) -> GPUState
+{
+    switch (state.state) {
+        case TraceState::UNDEFINED:
+            return undefined_state();
+        case TraceState::COLOR_ATTACHMENT:
+            return color_attachment_state();
+        case TraceState::DEPTH_STENCIL_ATTACHMENT:
+            return depth_stencil_attachment_state();
+        case TraceState::DEPTH_STENCIL_READ:
+            return depth_stencil_read_state();
+        case TraceState::PRESENT_SRC:
+            return present_src_state();
+        case TraceState::SHADER_RESOURCE:
+            return shader_resource_state(state.stages);
+        case TraceState::STORAGE:
+            return storage_state(state.stages);
+        case TraceState::COPY_SRC:
+            return copy_src_state();
+        case TraceState::COPY_DST:
+            return copy_dst_state();
+        case TraceState::INDIRECT:
+            return indirect_state();
+    }
+    throw std::runtime_error("invalid resource state in trace");
+}
+
+TraceWriter::TraceWriter(const std::string& path, const TraceHeader& header)
+    : file(path, std::ios::binary | std::ios::trunc)
+{
+    if (!file)
+        throw std::runtime_error("failed to create trace " + path);
+
+    buffer.reserve(WRITE_BUFFER_SIZE);
+    write(header);
+}
+
+void TraceWriter::write_bytes(const void* data, size_t size)
+{
+    if (buffer.size() + size > WRITE_BUFFER_SIZE)
+        flush();
+
+    // large blobs (shaders, buffer contents) bypass the buffer
+    if (size > WRITE_BUFFER_SIZE) {
+        file.write(reinterpret_cast<const char*>(data), size);
+    } else {
+        auto bytes = reinterpret_cast<const uint8_t*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+    total += size;
+}
+
+void TraceWriter::write_string(std::string_view value)
+{
+    write_blob(value.data(), value.size());
+}
+
+void TraceWriter::write_blob(const void* data, size_t size)
+{
+    write<uint64_t>(size);
+    write_bytes(data, size);
+}
+
+void TraceWriter::close(const TraceHeader& header)
+{
+    write(TraceOp::END);
+    flush();
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(TraceHeader));
+    file.close();
+}
+
+void TraceWriter::flush()
+{
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    buffer.clear();
+}
+
+TraceReader::TraceReader(const std::string& path)
+{
+    auto file = std::ifstream(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        throw std::runtime_error("failed to open trace " + path);
+
+    data.resize(size_t(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+
+    trace_header = read<TraceHeader>();
+
+    auto expected = TraceHeader{};
+    if (std::memcmp(trace_header.magic, expected.magic, sizeof(expected.magic)) != 0)
+        throw std::runtime_error(path + " is not a command trace");
+    if (trace_header.version != expected.version)
+        throw std::runtime_error(path + " has unsupported version " + std::to_string(trace_header.version));
+}
+
+auto TraceReader::read_bytes(size_t size) -> const uint8_t*
+{
+    if (size > data.size() - cursor)
+        throw std::runtime_error("command trace is truncated");
+
+    auto bytes = data.data() + cursor;
+    cursor += size;
+    return bytes;
+}
+
+auto TraceReader::read_string() -> std::string
+{
+    auto [bytes, size] = read_blob();
+    return std::string(reinterpret_cast<const char*>(bytes), size);
+}
+
+auto TraceReader::read_blob() -> std::pair<const uint8_t*, size_t>
+{
+    auto size = read<uint64_t>();
+    return {read_bytes(size), size};
+}
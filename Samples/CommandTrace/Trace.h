@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+
+// Objects are referred to by id in a trace, ids are never reused within a trace.
+using TraceId = uint32_t;
+
+constexpr TraceId INVALID_TRACE_ID     = 0;
+constexpr TraceId SWAPCHAIN_TEXTURE_ID = 1; // the swapchain objects get new handles every frame, but keep their ids
+constexpr TraceId SWAPCHAIN_VIEW_ID    = 2;
+constexpr TraceId SWAPCHAIN_AVAILABLE  = 3;
+constexpr TraceId SWAPCHAIN_COMPLETE   = 4;
+constexpr TraceId FIRST_TRACE_ID       = 5;
+
+enum class TraceOp : uint8_t
+{
+    // device
+    CREATE_BUFFER,
+    CREATE_TEXTURE,
+    CREATE_TEXTURE_VIEW,
+    CREATE_SHADER_MODULE,
+    CREATE_BIND_GROUP_LAYOUT,
+    CREATE_PIPELINE_LAYOUT,
+    CREATE_RENDER_PIPELINE,
+    CREATE_BIND_GROUP,
+    CREATE_SEMAPHORE,
+    DESTROY,
+    WRITE_BUFFER,
+
+    // surface
+    ACQUIRE,
+    PRESENT,
+
+    // command buffer
+    CREATE_COMMAND_BUFFER,
+    WAIT,
+    SIGNAL,
+    TRANSITION,
+    BEGIN_RENDER_PASS,
+    END_RENDER_PASS,
+    SET_VIEWPORT,
+    SET_SCISSOR_RECT,
+    SET_PIPELINE,
+    SET_VERTEX_BUFFER,
+    SET_INDEX_BUFFER,
+    SET_BIND_GROUP,
+    SET_STENCIL_REFERENCE,
+    SET_PUSH_CONSTANTS,
+    DRAW,
+    DRAW_INDEXED,
+    SUBMIT,
+
+    END,
+};
+
+// GPUState is opaque, so transitions are traced with this instead, and converted back with to_gpu_state().
+enum class TraceState : uint8_t
+{
+    UNDEFINED,
+    COLOR_ATTACHMENT,
+    DEPTH_STENCIL_ATTACHMENT,
+    DEPTH_STENCIL_READ,
+    PRESENT_SRC,
+    SHADER_RESOURCE,
+    STORAGE,
+    COPY_SRC,
+    COPY_DST,
+    INDIRECT,
+};
+
+struct TraceResourceState
+{
+    TraceState state  = TraceState::UNDEFINED;
+    uint32_t   stages = 0; // GPUShaderStage flags, only used by SHADER_RESOURCE and STORAGE
+};
+
+auto to_gpu_state(const TraceResourceState& state) -> lyra::rhi::GPUState;
+
+struct TraceHeader
+{
+    char     magic[8]    = {'L', 'Y', 'R', 'A', 'T', 'R', 'C', 'E'};
+    uint32_t version     = 2;
+    uint32_t backend     = 0; // RHIBackend, shader blobs only run on the backend they were compiled for
+    uint32_t width       = 0; // surface at the time of recording
+    uint32_t height      = 0;
+    uint32_t format      = 0; // GPUTextureFormat of the surface
+    uint32_t frame_count = 0; // patched when the trace is closed
+};
+
+// Appends trace data to a file, through a large buffer.
+// NOTE: values are written in host byte order, traces are meant to be replayed on the platform that recorded them.
+class TraceWriter
+{
+public:
+    // Throws std::runtime_error when the file cannot be created.
+    explicit TraceWriter(const std::string& path, const TraceHeader& header);
+
+    template <typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be traced");
+        write_bytes(&value, sizeof(T));
+    }
+
+    void write_bytes(const void* data, size_t size);
+    void write_string(std::string_view value);
+    void write_blob(const void* data, size_t size); // size prefixed
+
+    // Writes the END marker, and the final header.
+    void close(const TraceHeader& header);
+
+    auto bytes_written() const -> uint64_t { return total; }
+
+private:
+    void flush();
+
+private:
+    std::ofstream        file;
+    std::vector<uint8_t> buffer;
+    uint64_t             total = 0;
+};
+
+// Reads a trace loaded into memory. Throws std::runtime_error when reading past the end.
+class TraceReader
+{
+public:
+    explicit TraceReader(const std::string& path);
+
+    template <typename T>
+    auto read() -> T
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be traced");
+        T value;
+        std::memcpy(&value, read_bytes(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    auto read_bytes(size_t size) -> const uint8_t*;
+    auto read_string() -> std::string;
+    auto read_blob() -> std::pair<const uint8_t*, size_t>;
+
+    auto header() const -> const TraceHeader& { return trace_header; }
+    auto tell() const -> size_t { return cursor; }
+    void seek(size_t offset) { cursor = offset; }
+
+private:
+    std::vector<uint8_t> data;
+    size_t               cursor = 0;
+    TraceHeader          trace_header;
+};
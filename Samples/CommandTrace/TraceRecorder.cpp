@@ -0,0 +1,675 @@
+#include <filesystem>
+
+#include "TraceRecorder.h"
+
+using namespace lyra;
+using namespace lyra::rhi;
+
+namespace
+{
+    template <typename E>
+    void write_enum(TraceWriter& writer, E value)
+    {
+        writer.write<uint32_t>(static_cast<uint32_t>(value));
+    }
+
+    // NOTE: RHI objects are small copyable handles, copies of a handle refer to the same object and have the same bits
+    template <typename T>
+    auto object_key(uint8_t type, const T& object) -> std::string
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "objects are identified by their handle bits");
+
+        auto key = std::string(1 + sizeof(T), '\0');
+        key[0]   = char(type);
+        std::memcpy(key.data() + 1, &object, sizeof(T));
+        return key;
+    }
+} // namespace
+
+TraceRecorder::TraceRecorder(const std::string& path) : path(path)
+{
+    if (path.empty())
+        return;
+
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    header.backend = uint32_t(LYRA_RHI_BACKEND);
+    header.width   = extent.width;
+    header.height  = extent.height;
+    header.format  = uint32_t(surface.get_current_format());
+
+    writer = std::make_unique<TraceWriter>(path, header);
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    close();
+}
+
+template <typename T>
+auto TraceRecorder::assign(ObjectType type, const T& object, TraceId id) -> TraceId
+{
+    if (id == INVALID_TRACE_ID)
+        id = next_id++;
+
+    ids[object_key(uint8_t(type), object)] = id;
+    return id;
+}
+
+template <typename T>
+auto TraceRecorder::lookup(ObjectType type, const T& object) const -> TraceId
+{
+    auto it = ids.find(object_key(uint8_t(type), object));
+    return it == ids.end() ? INVALID_TRACE_ID : it->second;
+}
+
+template <typename T>
+auto TraceRecorder::require(ObjectType type, const T& object, const char* what) -> TraceId
+{
+    auto id = lookup(type, object);
+    if (id == INVALID_TRACE_ID)
+        fail(std::string(what) + " not created through the recorder");
+    return id;
+}
+
+void TraceRecorder::fail(const std::string& reason)
+{
+    // NOTE: the writer is only dropped by close(), the call which failed may still be writing its arguments
+    if (recording())
+        failure_reason = reason;
+}
+
+auto TraceRecorder::create_buffer(const GPUBufferDescriptor& desc) -> GPUBuffer
+{
+    auto buffer = RHI::get_current_device().create_buffer(desc);
+    if (!recording())
+        return buffer;
+
+    writer->write(TraceOp::CREATE_BUFFER);
+    writer->write(assign(ObjectType::BUFFER, buffer));
+    writer->write_string(desc.label);
+    writer->write<uint64_t>(desc.size);
+    writer->write<uint32_t>(desc.usage);
+    writer->write<uint8_t>(desc.mapped_at_creation);
+    return buffer;
+}
+
+auto TraceRecorder::create_texture(const GPUTextureDescriptor& desc) -> GPUTexture
+{
+    auto texture = RHI::get_current_device().create_texture(desc);
+    if (!recording())
+        return texture;
+
+    writer->write(TraceOp::CREATE_TEXTURE);
+    writer->write(assign(ObjectType::TEXTURE, texture));
+    writer->write_string(desc.label);
+    write_enum(*writer, desc.format);
+    writer->write<uint32_t>(desc.size.width);
+    writer->write<uint32_t>(desc.size.height);
+    writer->write<uint32_t>(desc.size.depth);
+    writer->write<uint32_t>(desc.array_layers);
+    writer->write<uint32_t>(desc.mip_level_count);
+    writer->write<uint32_t>(desc.sample_count);
+    writer->write<uint32_t>(desc.usage);
+    write_enum(*writer, desc.dimension);
+    return texture;
+}
+
+auto TraceRecorder::create_view(GPUTexture& texture) -> GPUTextureView
+{
+    auto view = texture.create_view();
+    if (!recording())
+        return view;
+
+    writer->write(TraceOp::CREATE_TEXTURE_VIEW);
+    writer->write(assign(ObjectType::TEXTURE_VIEW, view));
+    writer->write(require(ObjectType::TEXTURE, texture, "texture of a view"));
+    return view;
+}
+
+auto TraceRecorder::create_shader_module(const GPUShaderModuleDescriptor& desc) -> GPUShaderModule
+{
+    auto module = RHI::get_current_device().create_shader_module(desc);
+    if (!recording())
+        return module;
+
+    // NOTE: the compiled blob is stored, so replays skip the shader compiler entirely
+    writer->write(TraceOp::CREATE_SHADER_MODULE);
+    writer->write(assign(ObjectType::SHADER_MODULE, module));
+    writer->write_string(desc.label);
+    writer->write_blob(desc.data, desc.size);
+    return module;
+}
+
+auto TraceRecorder::create_bind_group_layout(const GPUBindGroupLayoutDescriptor& desc) -> GPUBindGroupLayout
+{
+    auto layout = RHI::get_current_device().create_bind_group_layout(desc);
+    if (!recording())
+        return layout;
+
+    writer->write(TraceOp::CREATE_BIND_GROUP_LAYOUT);
+    writer->write(assign(ObjectType::BIND_GROUP_LAYOUT, layout));
+    writer->write_string(desc.label);
+    writer->write<uint32_t>(uint32_t(desc.entries.size()));
+    for (auto& entry : desc.entries) {
+        write_enum(*writer, entry.type);
+        writer->write<uint32_t>(entry.binding);
+        writer->write<uint32_t>(entry.count);
+        writer->write<uint32_t>(entry.visibility);
+        write_enum(*writer, entry.buffer.type);
+        writer->write<uint8_t>(entry.buffer.has_dynamic_offset);
+        writer->write<uint64_t>(entry.buffer.min_binding_size);
+        write_enum(*writer, entry.sampler.type);
+        write_enum(*writer, entry.texture.sample_type);
+        write_enum(*writer, entry.texture.view_dimension);
+        writer->write<uint8_t>(entry.texture.multisampled);
+        write_enum(*writer, entry.storage_texture.access);
+        write_enum(*writer, entry.storage_texture.format);
+        write_enum(*writer, entry.storage_texture.view_dimension);
+    }
+    return layout;
+}
+
+auto TraceRecorder::create_pipeline_layout(const GPUPipelineLayoutDescriptor& desc) -> GPUPipelineLayout
+{
+    auto layout = RHI::get_current_device().create_pipeline_layout(desc);
+    if (!recording())
+        return layout;
+
+    writer->write(TraceOp::CREATE_PIPELINE_LAYOUT);
+    writer->write(assign(ObjectType::PIPELINE_LAYOUT, layout));
+    writer->write_string(desc.label);
+    writer->write<uint32_t>(uint32_t(desc.bind_group_layouts.size()));
+    for (auto& bind_group_layout : desc.bind_group_layouts)
+        writer->write(require(ObjectType::BIND_GROUP_LAYOUT, bind_group_layout, "bind group layout of a pipeline layout"));
+    writer->write<uint32_t>(uint32_t(desc.push_constant_ranges.size()));
+    for (auto& range : desc.push_constant_ranges) {
+        writer->write<uint32_t>(range.visibility);
+        writer->write<uint32_t>(range.offset);
+        writer->write<uint32_t>(range.size);
+    }
+    return layout;
+}
+
+auto TraceRecorder::create_render_pipeline(const GPURenderPipelineDescriptor& desc) -> GPURenderPipeline
+{
+    auto pipeline = RHI::get_current_device().create_render_pipeline(desc);
+    if (!recording())
+        return pipeline;
+
+    auto write_stencil_face = [&](const GPUStencilFaceState& face) {
+        write_enum(*writer, face.compare);
+        write_enum(*writer, face.fail_op);
+        write_enum(*writer, face.depth_fail_op);
+        write_enum(*writer, face.pass_op);
+    };
+
+    auto write_blend_component = [&](const GPUBlendComponent& component) {
+        write_enum(*writer, component.operation);
+        write_enum(*writer, component.src_factor);
+        write_enum(*writer, component.dst_factor);
+    };
+
+    writer->write(TraceOp::CREATE_RENDER_PIPELINE);
+    writer->write(assign(ObjectType::RENDER_PIPELINE, pipeline));
+    writer->write_string(desc.label);
+    writer->write(require(ObjectType::PIPELINE_LAYOUT, desc.layout, "pipeline layout of a render pipeline"));
+
+    write_enum(*writer, desc.primitive.cull_mode);
+    write_enum(*writer, desc.primitive.topology);
+    write_enum(*writer, desc.primitive.front_face);
+    write_enum(*writer, desc.primitive.strip_index_format);
+
+    write_enum(*writer, desc.depth_stencil.format);
+    writer->write<uint8_t>(desc.depth_stencil.depth_write_enabled);
+    write_enum(*writer, desc.depth_stencil.depth_compare);
+    write_stencil_face(desc.depth_stencil.stencil_front);
+    write_stencil_face(desc.depth_stencil.stencil_back);
+    writer->write<uint32_t>(desc.depth_stencil.stencil_read_mask);
+    writer->write<uint32_t>(desc.depth_stencil.stencil_write_mask);
+    writer->write<int32_t>(desc.depth_stencil.depth_bias);
+    writer->write<float>(desc.depth_stencil.depth_bias_slope_scale);
+    writer->write<float>(desc.depth_stencil.depth_bias_clamp);
+
+    writer->write<uint8_t>(desc.multisample.alpha_to_coverage_enabled);
+    writer->write<uint32_t>(desc.multisample.count);
+
+    writer->write(require(ObjectType::SHADER_MODULE, desc.vertex.module, "vertex shader module"));
+    writer->write<uint32_t>(uint32_t(desc.vertex.buffers.size()));
+    for (auto& buffer : desc.vertex.buffers) {
+        writer->write<uint64_t>(buffer.array_stride);
+        write_enum(*writer, buffer.step_mode);
+        writer->write<uint32_t>(uint32_t(buffer.attributes.size()));
+        for (auto& attribute : buffer.attributes) {
+            write_enum(*writer, attribute.format);
+            writer->write<uint64_t>(attribute.offset);
+            writer->write<uint32_t>(attribute.shader_location);
+        }
+    }
+
+    writer->write(require(ObjectType::SHADER_MODULE, desc.fragment.module, "fragment shader module"));
+    writer->write<uint32_t>(uint32_t(desc.fragment.targets.size()));
+    for (auto& target : desc.fragment.targets) {
+        write_enum(*writer, target.format);
+        writer->write<uint8_t>(target.blend_enable);
+        write_blend_component(target.blend.color);
+        write_blend_component(target.blend.alpha);
+        writer->write<uint32_t>(target.write_mask);
+    }
+    return pipeline;
+}
+
+auto TraceRecorder::create_bind_group(const GPUBindGroupDescriptor& desc) -> GPUBindGroup
+{
+    auto bind_group = RHI::get_current_device().create_bind_group(desc);
+    if (!recording())
+        return bind_group;
+
+    writer->write(TraceOp::CREATE_BIND_GROUP);
+    writer->write(assign(ObjectType::BIND_GROUP, bind_group));
+    writer->write_string(desc.label);
+    writer->write(require(ObjectType::BIND_GROUP_LAYOUT, desc.layout, "bind group layout of a bind group"));
+    writer->write<uint32_t>(uint32_t(desc.entries.size()));
+    for (auto& entry : desc.entries) {
+        if (entry.type == GPUBindingResourceType::SAMPLER)
+            fail("sampler binding cannot be traced");
+
+        auto is_buffer = entry.type == GPUBindingResourceType::BUFFER;
+        write_enum(*writer, entry.type);
+        writer->write<uint32_t>(entry.binding);
+        writer->write<uint32_t>(entry.index);
+        writer->write(is_buffer ? require(ObjectType::BUFFER, entry.buffer.buffer, "buffer of a bind group") : INVALID_TRACE_ID);
+        writer->write<uint64_t>(entry.buffer.offset);
+        writer->write<uint64_t>(entry.buffer.size);
+        writer->write(is_buffer ? INVALID_TRACE_ID : require(ObjectType::TEXTURE_VIEW, entry.texture, "texture view of a bind group"));
+    }
+    return bind_group;
+}
+
+auto TraceRecorder::create_semaphore() -> GPUSemaphore
+{
+    auto semaphore = RHI::get_current_device().create_semaphore();
+    if (!recording())
+        return semaphore;
+
+    writer->write(TraceOp::CREATE_SEMAPHORE);
+    writer->write(assign(ObjectType::SEMAPHORE, semaphore));
+    return semaphore;
+}
+
+auto TraceRecorder::create_command_buffer(const GPUCommandBufferDescriptor& desc) -> TracedCommandBuffer
+{
+    auto command = RHI::get_current_device().create_command_buffer(desc);
+    if (!recording())
+        return TracedCommandBuffer(this, command, INVALID_TRACE_ID);
+
+    // NOTE: command buffers are never referenced by other objects, so they are not looked up by handle
+    auto id = next_id++;
+    writer->write(TraceOp::CREATE_COMMAND_BUFFER);
+    writer->write(id);
+    writer->write_string(desc.label);
+    write_enum(*writer, desc.queue);
+    return TracedCommandBuffer(this, command, id);
+}
+
+auto TraceRecorder::create_sampler(const GPUSamplerDescriptor& desc) -> GPUSampler
+{
+    fail("sampler cannot be traced");
+    return RHI::get_current_device().create_sampler(desc);
+}
+
+auto TraceRecorder::create_compute_pipeline(const GPUComputePipelineDescriptor& desc) -> GPUComputePipeline
+{
+    fail("compute pipeline cannot be traced");
+    return RHI::get_current_device().create_compute_pipeline(desc);
+}
+
+auto TraceRecorder::create_query_set(const GPUQuerySetDescriptor& desc) -> GPUQuerySet
+{
+    fail("query set cannot be traced");
+    return RHI::get_current_device().create_query_set(desc);
+}
+
+void TraceRecorder::update_bind_group(const GPUBindGroup& bind_group, const std::vector<GPUBindGroupEntry>& entries)
+{
+    fail("bind group update cannot be traced");
+    RHI::get_current_device().update_bind_group(bind_group, entries);
+}
+
+void TraceRecorder::write_buffer(GPUBuffer& buffer, uint64_t offset, const void* data, uint64_t size)
+{
+    std::memcpy(buffer.get_mapped_range<uint8_t>().data() + offset, data, size);
+    if (!recording())
+        return;
+
+    writer->write(TraceOp::WRITE_BUFFER);
+    writer->write(require(ObjectType::BUFFER, buffer, "written buffer"));
+    writer->write<uint64_t>(offset);
+    writer->write_blob(data, size);
+}
+
+void TraceRecorder::destroy(GPUBuffer& buffer)
+{
+    if (recording()) {
+        writer->write(TraceOp::DESTROY);
+        writer->write(require(ObjectType::BUFFER, buffer, "destroyed buffer"));
+        ids.erase(object_key(uint8_t(ObjectType::BUFFER), buffer));
+    }
+    buffer.destroy();
+}
+
+void TraceRecorder::destroy(GPUTexture& texture)
+{
+    if (recording()) {
+        writer->write(TraceOp::DESTROY);
+        writer->write(require(ObjectType::TEXTURE, texture, "destroyed texture"));
+        ids.erase(object_key(uint8_t(ObjectType::TEXTURE), texture));
+    }
+    texture.destroy();
+}
+
+auto TraceRecorder::acquire(GPUSurface& surface) -> GPUSurfaceTexture
+{
+    auto texture = surface.get_current_texture();
+    if (!recording() || texture.suboptimal)
+        return texture;
+
+    // the swapchain rotates between several textures, they all share the same ids in the trace
+    assign(ObjectType::TEXTURE, texture.texture, SWAPCHAIN_TEXTURE_ID);
+    assign(ObjectType::TEXTURE_VIEW, texture.view, SWAPCHAIN_VIEW_ID);
+    assign(ObjectType::SEMAPHORE, texture.available, SWAPCHAIN_AVAILABLE);
+    assign(ObjectType::SEMAPHORE, texture.complete, SWAPCHAIN_COMPLETE);
+
+    writer->write(TraceOp::ACQUIRE);
+    return texture;
+}
+
+void TraceRecorder::present(GPUSurfaceTexture& texture)
+{
+    if (recording()) {
+        writer->write(TraceOp::PRESENT);
+        header.frame_count++;
+    }
+    texture.present();
+}
+
+void TraceRecorder::close()
+{
+    if (!writer)
+        return;
+
+    if (failure_reason.empty()) {
+        writer->close(header);
+        bytes = writer->bytes_written();
+        writer.reset();
+    } else {
+        // NOTE: a trace missing an operation would replay differently from the recording, so none is kept
+        auto error = std::error_code{};
+        writer.reset();
+        std::filesystem::remove(path, error);
+    }
+    ids.clear();
+}
+
+auto TracedCommandBuffer::begin(TraceOp op) -> TraceWriter*
+{
+    if (!recorder->recording() || id == INVALID_TRACE_ID)
+        return nullptr;
+
+    auto* writer = recorder->writer.get();
+    writer->write(op);
+    writer->write(id);
+    return writer;
+}
+
+void TracedCommandBuffer::wait(const GPUSemaphore& semaphore, GPUBarrierSync sync)
+{
+    command.wait(semaphore, sync);
+    if (auto* writer = begin(TraceOp::WAIT)) {
+        writer->write(recorder->require(TraceRecorder::ObjectType::SEMAPHORE, semaphore, "waited semaphore"));
+        write_enum(*writer, sync);
+    }
+}
+
+void TracedCommandBuffer::signal(const GPUSemaphore& semaphore, GPUBarrierSync sync)
+{
+    command.signal(semaphore, sync);
+    if (auto* writer = begin(TraceOp::SIGNAL)) {
+        writer->write(recorder->require(TraceRecorder::ObjectType::SEMAPHORE, semaphore, "signaled semaphore"));
+        write_enum(*writer, sync);
+    }
+}
+
+void TracedCommandBuffer::transition(const GPUTexture& texture, TraceResourceState from, TraceResourceState to)
+{
+    command.resource_barrier(state_transition(texture, to_gpu_state(from), to_gpu_state(to)));
+    if (auto* writer = begin(TraceOp::TRANSITION)) {
+        writer->write<uint8_t>(0); // texture
+        writer->write(recorder->require(TraceRecorder::ObjectType::TEXTURE, texture, "transitioned texture"));
+        writer->write(from);
+        writer->write(to);
+    }
+}
+
+void TracedCommandBuffer::transition(const GPUBuffer& buffer, TraceResourceState from, TraceResourceState to)
+{
+    command.resource_barrier(state_transition(buffer, to_gpu_state(from), to_gpu_state(to)));
+    if (auto* writer = begin(TraceOp::TRANSITION)) {
+        writer->write<uint8_t>(1); // buffer
+        writer->write(recorder->require(TraceRecorder::ObjectType::BUFFER, buffer, "transitioned buffer"));
+        writer->write(from);
+        writer->write(to);
+    }
+}
+
+void TracedCommandBuffer::begin_render_pass(const GPURenderPassDescriptor& desc)
+{
+    command.begin_render_pass(desc);
+
+    auto* writer = begin(TraceOp::BEGIN_RENDER_PASS);
+    if (writer == nullptr)
+        return;
+
+    writer->write<uint32_t>(uint32_t(desc.color_attachments.size()));
+    for (auto& attachment : desc.color_attachments) {
+        writer->write(recorder->require(TraceRecorder::ObjectType::TEXTURE_VIEW, attachment.view, "color attachment"));
+        writer->write(attachment.clear_value);
+        write_enum(*writer, attachment.load_op);
+        write_enum(*writer, attachment.store_op);
+    }
+
+    // NOTE: a default constructed view means no depth stencil attachment, and is not found
+    auto& depth = desc.depth_stencil_attachment;
+    writer->write(recorder->lookup(TraceRecorder::ObjectType::TEXTURE_VIEW, depth.view));
+    writer->write<float>(depth.depth_clear_value);
+    write_enum(*writer, depth.depth_load_op);
+    write_enum(*writer, depth.depth_store_op);
+    writer->write<uint8_t>(depth.depth_read_only);
+    writer->write<uint32_t>(depth.stencil_clear_value);
+    write_enum(*writer, depth.stencil_load_op);
+    write_enum(*writer, depth.stencil_store_op);
+    writer->write<uint8_t>(depth.stencil_read_only);
+}
+
+void TracedCommandBuffer::end_render_pass()
+{
+    command.end_render_pass();
+    begin(TraceOp::END_RENDER_PASS);
+}
+
+void TracedCommandBuffer::set_viewport(float x, float y, float width, float height, float min_depth, float max_depth)
+{
+    command.set_viewport(x, y, width, height, min_depth, max_depth);
+    if (auto* writer = begin(TraceOp::SET_VIEWPORT)) {
+        writer->write(x);
+        writer->write(y);
+        writer->write(width);
+        writer->write(height);
+        writer->write(min_depth);
+        writer->write(max_depth);
+    }
+}
+
+void TracedCommandBuffer::set_scissor_rect(uint x, uint y, uint width, uint height)
+{
+    command.set_scissor_rect(x, y, width, height);
+    if (auto* writer = begin(TraceOp::SET_SCISSOR_RECT)) {
+        writer->write<uint32_t>(x);
+        writer->write<uint32_t>(y);
+        writer->write<uint32_t>(width);
+        writer->write<uint32_t>(height);
+    }
+}
+
+void TracedCommandBuffer::set_pipeline(const GPURenderPipeline& pipeline)
+{
+    command.set_pipeline(pipeline);
+    if (auto* writer = begin(TraceOp::SET_PIPELINE))
+        writer->write(recorder->require(TraceRecorder::ObjectType::RENDER_PIPELINE, pipeline, "render pipeline"));
+}
+
+void TracedCommandBuffer::set_vertex_buffer(uint slot, const GPUBuffer& buffer, uint64_t offset, uint64_t size)
+{
+    command.set_vertex_buffer(slot, buffer, offset, size);
+    if (auto* writer = begin(TraceOp::SET_VERTEX_BUFFER)) {
+        writer->write<uint32_t>(slot);
+        writer->write(recorder->require(TraceRecorder::ObjectType::BUFFER, buffer, "vertex buffer"));
+        writer->write<uint64_t>(offset);
+        writer->write<uint64_t>(size);
+    }
+}
+
+void TracedCommandBuffer::set_index_buffer(const GPUBuffer& buffer, GPUIndexFormat format, uint64_t offset, uint64_t size)
+{
+    command.set_index_buffer(buffer, format, offset, size);
+    if (auto* writer = begin(TraceOp::SET_INDEX_BUFFER)) {
+        writer->write(recorder->require(TraceRecorder::ObjectType::BUFFER, buffer, "index buffer"));
+        write_enum(*writer, format);
+        writer->write<uint64_t>(offset);
+        writer->write<uint64_t>(size);
+    }
+}
+
+void TracedCommandBuffer::set_bind_group(uint index, const GPUBindGroup& bind_group, const std::vector<uint32_t>& dynamic_offsets)
+{
+    command.set_bind_group(index, bind_group, dynamic_offsets);
+    if (auto* writer = begin(TraceOp::SET_BIND_GROUP)) {
+        writer->write<uint32_t>(index);
+        writer->write(recorder->require(TraceRecorder::ObjectType::BIND_GROUP, bind_group, "bind group"));
+        writer->write<uint32_t>(uint32_t(dynamic_offsets.size()));
+        writer->write_bytes(dynamic_offsets.data(), dynamic_offsets.size() * sizeof(uint32_t));
+    }
+}
+
+void TracedCommandBuffer::set_stencil_reference(uint reference)
+{
+    command.set_stencil_reference(reference);
+    if (auto* writer = begin(TraceOp::SET_STENCIL_REFERENCE))
+        writer->write<uint32_t>(reference);
+}
+
+void TracedCommandBuffer::set_push_constants(uint stages, uint offset, uint size, const void* data)
+{
+    command.set_push_constants(stages, offset, size, data);
+    if (auto* writer = begin(TraceOp::SET_PUSH_CONSTANTS)) {
+        writer->write<uint32_t>(stages);
+        writer->write<uint32_t>(offset);
+        writer->write_blob(data, size);
+    }
+}
+
+void TracedCommandBuffer::draw(uint vertex_count, uint instance_count, uint first_vertex, uint first_instance)
+{
+    command.draw(vertex_count, instance_count, first_vertex, first_instance);
+    if (auto* writer = begin(TraceOp::DRAW)) {
+        writer->write<uint32_t>(vertex_count);
+        writer->write<uint32_t>(instance_count);
+        writer->write<uint32_t>(first_vertex);
+        writer->write<uint32_t>(first_instance);
+    }
+}
+
+void TracedCommandBuffer::draw_indexed(uint index_count, uint instance_count, uint first_index, int base_vertex, uint first_instance)
+{
+    command.draw_indexed(index_count, instance_count, first_index, base_vertex, first_instance);
+    if (auto* writer = begin(TraceOp::DRAW_INDEXED)) {
+        writer->write<uint32_t>(index_count);
+        writer->write<uint32_t>(instance_count);
+        writer->write<uint32_t>(first_index);
+        writer->write<int32_t>(base_vertex);
+        writer->write<uint32_t>(first_instance);
+    }
+}
+
+void TracedCommandBuffer::submit()
+{
+    command.submit();
+    begin(TraceOp::SUBMIT);
+}
+
+void TracedCommandBuffer::set_pipeline(const GPUComputePipeline& pipeline)
+{
+    recorder->fail("compute pipeline cannot be traced");
+    command.set_pipeline(pipeline);
+}
+
+void TracedCommandBuffer::dispatch_workgroups(uint x, uint y, uint z)
+{
+    recorder->fail("dispatch cannot be traced");
+    command.dispatch_workgroups(x, y, z);
+}
+
+void TracedCommandBuffer::draw_indirect(const GPUBuffer& buffer, uint64_t offset)
+{
+    recorder->fail("indirect draw cannot be traced");
+    command.draw_indirect(buffer, offset);
+}
+
+void TracedCommandBuffer::draw_indexed_indirect(const GPUBuffer& buffer, uint64_t offset)
+{
+    recorder->fail("indirect draw cannot be traced");
+    command.draw_indexed_indirect(buffer, offset);
+}
+
+void TracedCommandBuffer::copy_buffer_to_buffer(const GPUBuffer& src, uint64_t src_offset, const GPUBuffer& dst, uint64_t dst_offset, uint64_t size)
+{
+    recorder->fail("buffer copy cannot be traced");
+    command.copy_buffer_to_buffer(src, src_offset, dst, dst_offset, size);
+}
+
+void TracedCommandBuffer::copy_buffer_to_texture(const GPUImageCopyBuffer& src, const GPUImageCopyTexture& dst, const GPUExtent3D& size)
+{
+    recorder->fail("buffer to texture copy cannot be traced");
+    command.copy_buffer_to_texture(src, dst, size);
+}
+
+void TracedCommandBuffer::copy_texture_to_buffer(const GPUImageCopyTexture& src, const GPUImageCopyBuffer& dst, const GPUExtent3D& size)
+{
+    recorder->fail("texture to buffer copy cannot be traced");
+    command.copy_texture_to_buffer(src, dst, size);
+}
+
+void TracedCommandBuffer::write_timestamp(const GPUQuerySet& query_set, uint index)
+{
+    recorder->fail("timestamp query cannot be traced");
+    command.write_timestamp(query_set, index);
+}
+
+void TracedCommandBuffer::begin_query(const GPUQuerySet& query_set, uint index)
+{
+    recorder->fail("query cannot be traced");
+    command.begin_query(query_set, index);
+}
+
+void TracedCommandBuffer::end_query(const GPUQuerySet& query_set, uint index)
+{
+    recorder->fail("query cannot be traced");
+    command.end_query(query_set, index);
+}
+
+void TracedCommandBuffer::resolve_query_set(const GPUQuerySet& query_set, uint first, uint count, const GPUBuffer& dst, uint64_t offset)
+{
+    recorder->fail("query resolve cannot be traced");
+    command.resolve_query_set(query_set, first, count, dst, offset);
+}
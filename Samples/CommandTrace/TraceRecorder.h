@@ -0,0 +1,163 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+
+#include "Trace.h"
+
+class TracedCommandBuffer;
+
+// Capture layer between a sample and the RHI device.
+//
+// Every call is forwarded to the current device, and serialized into a binary trace while recording.
+// Objects referenced by descriptors (layouts, shader modules, buffers, views) are mapped back to their trace ids
+// by their handle bits, so the regular RHI descriptors can be passed in unchanged.
+// After close(), calls are only forwarded.
+//
+// Supported: buffers, textures with their default view, shader modules, bind group layouts and bind groups
+// (without samplers), pipeline layouts, render pipelines, semaphores, render passes and push constants.
+//
+// Operations which cannot be traced (samplers, compute, copies, queries, indirect draws) are still forwarded,
+// but fail the capture: a trace missing them would replay differently, so it is discarded by close(),
+// and failure() tells which operation caused it. So are objects which were not created through the recorder.
+class TraceRecorder
+{
+public:
+    // Throws std::runtime_error when the trace cannot be created.
+    // With an empty path nothing is recorded, calls are only forwarded.
+    explicit TraceRecorder(const std::string& path);
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&)            = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    auto create_buffer(const lyra::rhi::GPUBufferDescriptor& desc) -> lyra::rhi::GPUBuffer;
+    auto create_texture(const lyra::rhi::GPUTextureDescriptor& desc) -> lyra::rhi::GPUTexture;
+    auto create_view(lyra::rhi::GPUTexture& texture) -> lyra::rhi::GPUTextureView;
+    auto create_shader_module(const lyra::rhi::GPUShaderModuleDescriptor& desc) -> lyra::rhi::GPUShaderModule;
+    auto create_bind_group_layout(const lyra::rhi::GPUBindGroupLayoutDescriptor& desc) -> lyra::rhi::GPUBindGroupLayout;
+    auto create_pipeline_layout(const lyra::rhi::GPUPipelineLayoutDescriptor& desc) -> lyra::rhi::GPUPipelineLayout;
+    auto create_render_pipeline(const lyra::rhi::GPURenderPipelineDescriptor& desc) -> lyra::rhi::GPURenderPipeline;
+    auto create_bind_group(const lyra::rhi::GPUBindGroupDescriptor& desc) -> lyra::rhi::GPUBindGroup;
+    auto create_semaphore() -> lyra::rhi::GPUSemaphore;
+    auto create_command_buffer(const lyra::rhi::GPUCommandBufferDescriptor& desc) -> TracedCommandBuffer;
+
+    // forwarded, but fail the capture
+    auto create_sampler(const lyra::rhi::GPUSamplerDescriptor& desc) -> lyra::rhi::GPUSampler;
+    auto create_compute_pipeline(const lyra::rhi::GPUComputePipelineDescriptor& desc) -> lyra::rhi::GPUComputePipeline;
+    auto create_query_set(const lyra::rhi::GPUQuerySetDescriptor& desc) -> lyra::rhi::GPUQuerySet;
+    void update_bind_group(const lyra::rhi::GPUBindGroup& bind_group, const std::vector<lyra::rhi::GPUBindGroupEntry>& entries);
+
+    // Writes into a mapped buffer. Writes through get_mapped_range() are invisible to the trace.
+    void write_buffer(lyra::rhi::GPUBuffer& buffer, uint64_t offset, const void* data, uint64_t size);
+
+    void destroy(lyra::rhi::GPUBuffer& buffer);
+    void destroy(lyra::rhi::GPUTexture& texture);
+
+    auto acquire(lyra::rhi::GPUSurface& surface) -> lyra::rhi::GPUSurfaceTexture;
+    void present(lyra::rhi::GPUSurfaceTexture& texture);
+
+    // Finish the trace, further calls are forwarded without being recorded.
+    // A failed capture is discarded instead, nothing is left at the path of the trace.
+    void close();
+
+    auto recording() const -> bool { return writer != nullptr && failure_reason.empty(); }
+    auto failure() const -> const std::string& { return failure_reason; }
+    auto frame_count() const -> uint32_t { return header.frame_count; }
+    auto bytes_written() const -> uint64_t { return writer ? writer->bytes_written() : bytes; }
+
+private:
+    friend class TracedCommandBuffer;
+
+    enum class ObjectType : uint8_t
+    {
+        BUFFER,
+        TEXTURE,
+        TEXTURE_VIEW,
+        SHADER_MODULE,
+        BIND_GROUP_LAYOUT,
+        PIPELINE_LAYOUT,
+        RENDER_PIPELINE,
+        BIND_GROUP,
+        SEMAPHORE,
+    };
+
+    template <typename T>
+    auto assign(ObjectType type, const T& object, TraceId id = INVALID_TRACE_ID) -> TraceId;
+
+    template <typename T>
+    auto lookup(ObjectType type, const T& object) const -> TraceId;
+
+    // same as lookup(), but fails the capture when the object is not part of the trace
+    template <typename T>
+    auto require(ObjectType type, const T& object, const char* what) -> TraceId;
+
+    // stops recording, the first reason is kept
+    void fail(const std::string& reason);
+
+private:
+    std::string                              path;
+    std::string                              failure_reason;
+    std::unique_ptr<TraceWriter>             writer;
+    TraceHeader                              header;
+    std::unordered_map<std::string, TraceId> ids; // handle bits (prefixed by the object type) -> trace id
+    TraceId                                  next_id = FIRST_TRACE_ID;
+    uint64_t                                 bytes   = 0;
+};
+
+// Command buffer that records its commands into the trace of its recorder.
+class TracedCommandBuffer
+{
+public:
+    void wait(const lyra::rhi::GPUSemaphore& semaphore, lyra::rhi::GPUBarrierSync sync);
+    void signal(const lyra::rhi::GPUSemaphore& semaphore, lyra::rhi::GPUBarrierSync sync);
+    void transition(const lyra::rhi::GPUTexture& texture, TraceResourceState from, TraceResourceState to);
+    void transition(const lyra::rhi::GPUBuffer& buffer, TraceResourceState from, TraceResourceState to);
+    void begin_render_pass(const lyra::rhi::GPURenderPassDescriptor& desc);
+    void end_render_pass();
+    void set_viewport(float x, float y, float width, float height, float min_depth = 0.0f, float max_depth = 1.0f);
+    void set_scissor_rect(uint x, uint y, uint width, uint height);
+    void set_pipeline(const lyra::rhi::GPURenderPipeline& pipeline);
+    void set_vertex_buffer(uint slot, const lyra::rhi::GPUBuffer& buffer, uint64_t offset = 0, uint64_t size = 0);
+    void set_index_buffer(const lyra::rhi::GPUBuffer& buffer, lyra::rhi::GPUIndexFormat format, uint64_t offset = 0, uint64_t size = 0);
+    void set_bind_group(uint index, const lyra::rhi::GPUBindGroup& bind_group, const std::vector<uint32_t>& dynamic_offsets = {});
+    void set_stencil_reference(uint reference);
+    void set_push_constants(uint stages, uint offset, uint size, const void* data);
+    void draw(uint vertex_count, uint instance_count, uint first_vertex, uint first_instance);
+    void draw_indexed(uint index_count, uint instance_count, uint first_index, int base_vertex, uint first_instance);
+    void submit();
+
+    // forwarded, but fail the capture
+    void set_pipeline(const lyra::rhi::GPUComputePipeline& pipeline);
+    void dispatch_workgroups(uint x, uint y = 1, uint z = 1);
+    void draw_indirect(const lyra::rhi::GPUBuffer& buffer, uint64_t offset);
+    void draw_indexed_indirect(const lyra::rhi::GPUBuffer& buffer, uint64_t offset);
+    void copy_buffer_to_buffer(const lyra::rhi::GPUBuffer& src, uint64_t src_offset, const lyra::rhi::GPUBuffer& dst, uint64_t dst_offset, uint64_t size);
+    void copy_buffer_to_texture(const lyra::rhi::GPUImageCopyBuffer& src, const lyra::rhi::GPUImageCopyTexture& dst, const lyra::rhi::GPUExtent3D& size);
+    void copy_texture_to_buffer(const lyra::rhi::GPUImageCopyTexture& src, const lyra::rhi::GPUImageCopyBuffer& dst, const lyra::rhi::GPUExtent3D& size);
+    void write_timestamp(const lyra::rhi::GPUQuerySet& query_set, uint index);
+    void begin_query(const lyra::rhi::GPUQuerySet& query_set, uint index);
+    void end_query(const lyra::rhi::GPUQuerySet& query_set, uint index);
+    void resolve_query_set(const lyra::rhi::GPUQuerySet& query_set, uint first, uint count, const lyra::rhi::GPUBuffer& dst, uint64_t offset);
+
+private:
+    friend class TraceRecorder;
+
+    TracedCommandBuffer(TraceRecorder* recorder, lyra::rhi::GPUCommandBuffer command, TraceId id)
+        : recorder(recorder), command(command), id(id)
+    {
+    }
+
+    // starts a command in the trace, returns null when not recording
+    auto begin(TraceOp op) -> TraceWriter*;
+
+private:
+    TraceRecorder*              recorder = nullptr;
+    lyra::rhi::GPUCommandBuffer command;
+    TraceId                     id = INVALID_TRACE_ID;
+};
@@ -0,0 +1,467 @@
+#include <chrono>
+#include <stdexcept>
+
+#include "TraceReplayer.h"
+
+using namespace lyra;
+using namespace lyra::rhi;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    template <typename E>
+    auto read_enum(TraceReader& reader) -> E
+    {
+        return static_cast<E>(reader.read<uint32_t>());
+    }
+
+    inline auto elapsed_ms(Clock::time_point start) -> double
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+} // namespace
+
+TraceReplayer::TraceReplayer(const std::string& path) : reader(path)
+{
+    // NOTE: the null backend never runs shaders, so it replays traces recorded with any backend
+    auto backend = uint32_t(LYRA_RHI_BACKEND);
+    if (backend != uint32_t(RHIBackend::NONE) && header().backend != backend)
+        throw std::runtime_error(path + " was recorded with another backend, its shaders cannot be replayed");
+    if (header().frame_count == 0)
+        throw std::runtime_error(path + " does not contain a frame");
+}
+
+template <typename T>
+auto TraceReplayer::find(std::unordered_map<TraceId, T>& objects, TraceId id) -> T&
+{
+    auto it = objects.find(id);
+    if (it == objects.end())
+        throw std::runtime_error("command trace refers to unknown object " + std::to_string(id));
+    return it->second;
+}
+
+void TraceReplayer::setup()
+{
+    // everything before the first frame is setup: resources, shaders, pipelines
+    while (true) {
+        auto offset = reader.tell();
+        auto op     = reader.read<TraceOp>();
+        if (op == TraceOp::ACQUIRE || op == TraceOp::END) {
+            first_frame = offset;
+            reader.seek(offset);
+            return;
+        }
+        execute(op);
+    }
+}
+
+auto TraceReplayer::replay_frame() -> bool
+{
+    auto& surface = RHI::get_current_surface();
+
+    auto frame = reader.tell();
+    if (reader.read<TraceOp>() != TraceOp::ACQUIRE)
+        throw std::runtime_error("command trace is out of sync, expected a frame");
+
+    // NOTE: acquire and present wait for the swapchain, they count towards the frame time but not the CPU time
+    surface_texture = surface.get_current_texture();
+    if (surface_texture.suboptimal) {
+        reader.seek(frame); // try the same frame again next time
+        return false;
+    }
+
+    auto now = Clock::now();
+    if (statistics.frames > 0)
+        statistics.frame_ms += std::chrono::duration<double, std::milli>(now - last_acquire).count();
+    last_acquire = now;
+
+    textures[SWAPCHAIN_TEXTURE_ID]  = surface_texture.texture;
+    views[SWAPCHAIN_VIEW_ID]        = surface_texture.view;
+    semaphores[SWAPCHAIN_AVAILABLE] = surface_texture.available;
+    semaphores[SWAPCHAIN_COMPLETE]  = surface_texture.complete;
+
+    auto op    = TraceOp::END;
+    auto start = Clock::now();
+    while ((op = reader.read<TraceOp>()) != TraceOp::PRESENT) {
+        execute(op);
+        statistics.commands++;
+    }
+    statistics.cpu_ms += elapsed_ms(start);
+
+    surface_texture.present();
+    statistics.frames++;
+
+    // start over at the first frame, objects created during frames are simply created again
+    auto last = reader.read<TraceOp>() == TraceOp::END;
+    reader.seek(last ? first_frame : reader.tell() - sizeof(TraceOp));
+    return last;
+}
+
+void TraceReplayer::execute(TraceOp op)
+{
+    auto& device = RHI::get_current_device();
+
+    switch (op) {
+        case TraceOp::CREATE_BUFFER: {
+            auto id                 = reader.read<TraceId>();
+            auto label              = reader.read_string();
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = label;
+            desc.size               = reader.read<uint64_t>();
+            desc.usage              = reader.read<uint32_t>();
+            desc.mapped_at_creation = reader.read<uint8_t>() != 0;
+            buffers[id]             = device.create_buffer(desc);
+            break;
+        }
+        case TraceOp::CREATE_TEXTURE: {
+            auto id              = reader.read<TraceId>();
+            auto label           = reader.read_string();
+            auto desc            = GPUTextureDescriptor{};
+            desc.label           = label;
+            desc.format          = read_enum<GPUTextureFormat>(reader);
+            desc.size.width      = reader.read<uint32_t>();
+            desc.size.height     = reader.read<uint32_t>();
+            desc.size.depth      = reader.read<uint32_t>();
+            desc.array_layers    = reader.read<uint32_t>();
+            desc.mip_level_count = reader.read<uint32_t>();
+            desc.sample_count    = reader.read<uint32_t>();
+            desc.usage           = reader.read<uint32_t>();
+            desc.dimension       = read_enum<GPUTextureViewDimension>(reader);
+            textures[id]         = device.create_texture(desc);
+            break;
+        }
+        case TraceOp::CREATE_TEXTURE_VIEW: {
+            auto id      = reader.read<TraceId>();
+            auto texture = reader.read<TraceId>();
+            views[id]    = find(textures, texture).create_view();
+            break;
+        }
+        case TraceOp::CREATE_SHADER_MODULE: {
+            auto id            = reader.read<TraceId>();
+            auto label         = reader.read_string();
+            auto [code, size]  = reader.read_blob();
+            auto desc          = GPUShaderModuleDescriptor{};
+            desc.label         = label;
+            desc.data          = code;
+            desc.size          = size;
+            shader_modules[id] = device.create_shader_module(desc);
+            break;
+        }
+        case TraceOp::CREATE_BIND_GROUP_LAYOUT: {
+            auto id    = reader.read<TraceId>();
+            auto label = reader.read_string();
+            auto desc  = GPUBindGroupLayoutDescriptor{};
+            desc.label = label;
+            desc.entries.resize(reader.read<uint32_t>());
+            for (auto& entry : desc.entries) {
+                entry.type                           = read_enum<GPUBindingResourceType>(reader);
+                entry.binding                        = reader.read<uint32_t>();
+                entry.count                          = reader.read<uint32_t>();
+                entry.visibility                     = reader.read<uint32_t>();
+                entry.buffer.type                    = read_enum<GPUBufferBindingType>(reader);
+                entry.buffer.has_dynamic_offset      = reader.read<uint8_t>() != 0;
+                entry.buffer.min_binding_size        = reader.read<uint64_t>();
+                entry.sampler.type                   = read_enum<GPUSamplerBindingType>(reader);
+                entry.texture.sample_type            = read_enum<GPUTextureSampleType>(reader);
+                entry.texture.view_dimension         = read_enum<GPUTextureViewDimension>(reader);
+                entry.texture.multisampled           = reader.read<uint8_t>() != 0;
+                entry.storage_texture.access         = read_enum<GPUStorageTextureAccess>(reader);
+                entry.storage_texture.format         = read_enum<GPUTextureFormat>(reader);
+                entry.storage_texture.view_dimension = read_enum<GPUTextureViewDimension>(reader);
+            }
+            bind_group_layouts[id] = device.create_bind_group_layout(desc);
+            break;
+        }
+        case TraceOp::CREATE_PIPELINE_LAYOUT: {
+            auto id    = reader.read<TraceId>();
+            auto label = reader.read_string();
+            auto desc  = GPUPipelineLayoutDescriptor{};
+            desc.label = label;
+            desc.bind_group_layouts.resize(reader.read<uint32_t>());
+            for (auto& layout : desc.bind_group_layouts)
+                layout = find(bind_group_layouts, reader.read<TraceId>());
+            desc.push_constant_ranges.resize(reader.read<uint32_t>());
+            for (auto& range : desc.push_constant_ranges) {
+                range.visibility = reader.read<uint32_t>();
+                range.offset     = reader.read<uint32_t>();
+                range.size       = reader.read<uint32_t>();
+            }
+            pipeline_layouts[id] = device.create_pipeline_layout(desc);
+            break;
+        }
+        case TraceOp::CREATE_RENDER_PIPELINE: {
+            auto read_stencil_face = [&](GPUStencilFaceState& face) {
+                face.compare       = read_enum<GPUCompareFunction>(reader);
+                face.fail_op       = read_enum<GPUStencilOperation>(reader);
+                face.depth_fail_op = read_enum<GPUStencilOperation>(reader);
+                face.pass_op       = read_enum<GPUStencilOperation>(reader);
+            };
+
+            auto read_blend_component = [&](GPUBlendComponent& component) {
+                component.operation  = read_enum<GPUBlendOperation>(reader);
+                component.src_factor = read_enum<GPUBlendFactor>(reader);
+                component.dst_factor = read_enum<GPUBlendFactor>(reader);
+            };
+
+            auto id     = reader.read<TraceId>();
+            auto label  = reader.read_string();
+            auto desc   = GPURenderPipelineDescriptor{};
+            desc.label  = label;
+            desc.layout = find(pipeline_layouts, reader.read<TraceId>());
+
+            desc.primitive.cull_mode          = read_enum<GPUCullMode>(reader);
+            desc.primitive.topology           = read_enum<GPUPrimitiveTopology>(reader);
+            desc.primitive.front_face         = read_enum<GPUFrontFace>(reader);
+            desc.primitive.strip_index_format = read_enum<GPUIndexFormat>(reader);
+
+            desc.depth_stencil.format              = read_enum<GPUTextureFormat>(reader);
+            desc.depth_stencil.depth_write_enabled = reader.read<uint8_t>() != 0;
+            desc.depth_stencil.depth_compare       = read_enum<GPUCompareFunction>(reader);
+            read_stencil_face(desc.depth_stencil.stencil_front);
+            read_stencil_face(desc.depth_stencil.stencil_back);
+            desc.depth_stencil.stencil_read_mask      = reader.read<uint32_t>();
+            desc.depth_stencil.stencil_write_mask     = reader.read<uint32_t>();
+            desc.depth_stencil.depth_bias             = reader.read<int32_t>();
+            desc.depth_stencil.depth_bias_slope_scale = reader.read<float>();
+            desc.depth_stencil.depth_bias_clamp       = reader.read<float>();
+
+            desc.multisample.alpha_to_coverage_enabled = reader.read<uint8_t>() != 0;
+            desc.multisample.count                     = reader.read<uint32_t>();
+
+            desc.vertex.module = find(shader_modules, reader.read<TraceId>());
+            desc.vertex.buffers.resize(reader.read<uint32_t>());
+            for (auto& buffer : desc.vertex.buffers) {
+                buffer.array_stride = reader.read<uint64_t>();
+                buffer.step_mode    = read_enum<GPUVertexStepMode>(reader);
+                buffer.attributes.resize(reader.read<uint32_t>());
+                for (auto& attribute : buffer.attributes) {
+                    attribute.format          = read_enum<GPUVertexFormat>(reader);
+                    attribute.offset          = reader.read<uint64_t>();
+                    attribute.shader_location = reader.read<uint32_t>();
+                }
+            }
+
+            desc.fragment.module = find(shader_modules, reader.read<TraceId>());
+            desc.fragment.targets.resize(reader.read<uint32_t>());
+            for (auto& target : desc.fragment.targets) {
+                target.format       = read_enum<GPUTextureFormat>(reader);
+                target.blend_enable = reader.read<uint8_t>() != 0;
+                read_blend_component(target.blend.color);
+                read_blend_component(target.blend.alpha);
+                target.write_mask = reader.read<uint32_t>();
+            }
+
+            render_pipelines[id] = device.create_render_pipeline(desc);
+            break;
+        }
+        case TraceOp::CREATE_BIND_GROUP: {
+            auto id     = reader.read<TraceId>();
+            auto label  = reader.read_string();
+            auto desc   = GPUBindGroupDescriptor{};
+            desc.label  = label;
+            desc.layout = find(bind_group_layouts, reader.read<TraceId>());
+            desc.entries.resize(reader.read<uint32_t>());
+            for (auto& entry : desc.entries) {
+                entry.type    = read_enum<GPUBindingResourceType>(reader);
+                entry.binding = reader.read<uint32_t>();
+                entry.index   = reader.read<uint32_t>();
+
+                auto buffer         = reader.read<TraceId>();
+                entry.buffer.offset = reader.read<uint64_t>();
+                entry.buffer.size   = reader.read<uint64_t>();
+                auto view           = reader.read<TraceId>();
+
+                if (buffer != INVALID_TRACE_ID)
+                    entry.buffer.buffer = find(buffers, buffer);
+                if (view != INVALID_TRACE_ID)
+                    entry.texture = find(views, view);
+            }
+            bind_groups[id] = device.create_bind_group(desc);
+            break;
+        }
+        case TraceOp::CREATE_SEMAPHORE: {
+            auto id        = reader.read<TraceId>();
+            semaphores[id] = device.create_semaphore();
+            break;
+        }
+        case TraceOp::DESTROY: {
+            auto id = reader.read<TraceId>();
+            if (auto it = buffers.find(id); it != buffers.end()) {
+                it->second.destroy();
+                buffers.erase(it);
+            } else if (auto it = textures.find(id); it != textures.end()) {
+                it->second.destroy();
+                textures.erase(it);
+            }
+            break;
+        }
+        case TraceOp::WRITE_BUFFER: {
+            auto& buffer       = find(buffers, reader.read<TraceId>());
+            auto  offset       = reader.read<uint64_t>();
+            auto [data, size]  = reader.read_blob();
+            std::memcpy(buffer.get_mapped_range<uint8_t>().data() + offset, data, size);
+            break;
+        }
+        case TraceOp::CREATE_COMMAND_BUFFER: {
+            auto id             = reader.read<TraceId>();
+            auto label          = reader.read_string();
+            auto desc           = GPUCommandBufferDescriptor{};
+            desc.label          = label;
+            desc.queue          = read_enum<GPUQueueType>(reader);
+            command_buffers[id] = device.create_command_buffer(desc);
+            break;
+        }
+        case TraceOp::ACQUIRE:
+        case TraceOp::PRESENT:
+        case TraceOp::END:
+            throw std::runtime_error("command trace is out of sync, unexpected frame boundary");
+        default: {
+            auto id = reader.read<TraceId>();
+            execute_command(op, find(command_buffers, id));
+
+            // command buffers are only valid for one submission
+            if (op == TraceOp::SUBMIT)
+                command_buffers.erase(id);
+            break;
+        }
+    }
+}
+
+void TraceReplayer::execute_command(TraceOp op, GPUCommandBuffer& command)
+{
+    switch (op) {
+        case TraceOp::WAIT: {
+            auto& semaphore = find(semaphores, reader.read<TraceId>());
+            command.wait(semaphore, read_enum<GPUBarrierSync>(reader));
+            break;
+        }
+        case TraceOp::SIGNAL: {
+            auto& semaphore = find(semaphores, reader.read<TraceId>());
+            command.signal(semaphore, read_enum<GPUBarrierSync>(reader));
+            break;
+        }
+        case TraceOp::TRANSITION: {
+            auto is_buffer = reader.read<uint8_t>() != 0;
+            auto id        = reader.read<TraceId>();
+            auto from      = to_gpu_state(reader.read<TraceResourceState>());
+            auto to        = to_gpu_state(reader.read<TraceResourceState>());
+            if (is_buffer)
+                command.resource_barrier(state_transition(find(buffers, id), from, to));
+            else
+                command.resource_barrier(state_transition(find(textures, id), from, to));
+            break;
+        }
+        case TraceOp::BEGIN_RENDER_PASS: {
+            auto desc = GPURenderPassDescriptor{};
+            desc.color_attachments.resize(reader.read<uint32_t>());
+            for (auto& attachment : desc.color_attachments) {
+                attachment.view        = find(views, reader.read<TraceId>());
+                attachment.clear_value = reader.read<GPUColor>();
+                attachment.load_op     = read_enum<GPULoadOp>(reader);
+                attachment.store_op    = read_enum<GPUStoreOp>(reader);
+            }
+
+            auto& depth               = desc.depth_stencil_attachment;
+            auto  view                = reader.read<TraceId>();
+            depth.depth_clear_value   = reader.read<float>();
+            depth.depth_load_op       = read_enum<GPULoadOp>(reader);
+            depth.depth_store_op      = read_enum<GPUStoreOp>(reader);
+            depth.depth_read_only     = reader.read<uint8_t>() != 0;
+            depth.stencil_clear_value = reader.read<uint32_t>();
+            depth.stencil_load_op     = read_enum<GPULoadOp>(reader);
+            depth.stencil_store_op    = read_enum<GPUStoreOp>(reader);
+            depth.stencil_read_only   = reader.read<uint8_t>() != 0;
+            if (view != INVALID_TRACE_ID)
+                depth.view = find(views, view);
+
+            command.begin_render_pass(desc);
+            break;
+        }
+        case TraceOp::END_RENDER_PASS:
+            command.end_render_pass();
+            break;
+        case TraceOp::SET_VIEWPORT: {
+            auto x         = reader.read<float>();
+            auto y         = reader.read<float>();
+            auto width     = reader.read<float>();
+            auto height    = reader.read<float>();
+            auto min_depth = reader.read<float>();
+            auto max_depth = reader.read<float>();
+            command.set_viewport(x, y, width, height, min_depth, max_depth);
+            break;
+        }
+        case TraceOp::SET_SCISSOR_RECT: {
+            auto x      = reader.read<uint32_t>();
+            auto y      = reader.read<uint32_t>();
+            auto width  = reader.read<uint32_t>();
+            auto height = reader.read<uint32_t>();
+            command.set_scissor_rect(x, y, width, height);
+            break;
+        }
+        case TraceOp::SET_PIPELINE:
+            command.set_pipeline(find(render_pipelines, reader.read<TraceId>()));
+            break;
+        case TraceOp::SET_VERTEX_BUFFER: {
+            auto  slot   = reader.read<uint32_t>();
+            auto& buffer = find(buffers, reader.read<TraceId>());
+            auto  offset = reader.read<uint64_t>();
+            auto  size   = reader.read<uint64_t>();
+            command.set_vertex_buffer(slot, buffer, offset, size);
+            break;
+        }
+        case TraceOp::SET_INDEX_BUFFER: {
+            auto& buffer = find(buffers, reader.read<TraceId>());
+            auto  format = read_enum<GPUIndexFormat>(reader);
+            auto  offset = reader.read<uint64_t>();
+            auto  size   = reader.read<uint64_t>();
+            command.set_index_buffer(buffer, format, offset, size);
+            break;
+        }
+        case TraceOp::SET_BIND_GROUP: {
+            // NOTE: the offsets vector is reused, so that replaying does not allocate per command
+            static std::vector<uint32_t> offsets;
+
+            auto  index      = reader.read<uint32_t>();
+            auto& bind_group = find(bind_groups, reader.read<TraceId>());
+            offsets.resize(reader.read<uint32_t>());
+            std::memcpy(offsets.data(), reader.read_bytes(offsets.size() * sizeof(uint32_t)), offsets.size() * sizeof(uint32_t));
+            command.set_bind_group(index, bind_group, offsets);
+            break;
+        }
+        case TraceOp::SET_STENCIL_REFERENCE:
+            command.set_stencil_reference(reader.read<uint32_t>());
+            break;
+        case TraceOp::SET_PUSH_CONSTANTS: {
+            auto stages       = reader.read<uint32_t>();
+            auto offset       = reader.read<uint32_t>();
+            auto [data, size] = reader.read_blob();
+            command.set_push_constants(stages, offset, uint32_t(size), data);
+            break;
+        }
+        case TraceOp::DRAW: {
+            auto vertex_count   = reader.read<uint32_t>();
+            auto instance_count = reader.read<uint32_t>();
+            auto first_vertex   = reader.read<uint32_t>();
+            auto first_instance = reader.read<uint32_t>();
+            command.draw(vertex_count, instance_count, first_vertex, first_instance);
+            statistics.draws++;
+            break;
+        }
+        case TraceOp::DRAW_INDEXED: {
+            auto index_count    = reader.read<uint32_t>();
+            auto instance_count = reader.read<uint32_t>();
+            auto first_index    = reader.read<uint32_t>();
+            auto base_vertex    = reader.read<int32_t>();
+            auto first_instance = reader.read<uint32_t>();
+            command.draw_indexed(index_count, instance_count, first_index, base_vertex, first_instance);
+            statistics.draws++;
+            break;
+        }
+        case TraceOp::SUBMIT:
+            command.submit();
+            break;
+        default:
+            throw std::runtime_error("unknown operation in command trace: " + std::to_string(int(op)));
+    }
+}
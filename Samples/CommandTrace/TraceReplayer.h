@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+
+#include "Trace.h"
+
+struct ReplayStats
+{
+    uint64_t frames   = 0;
+    uint64_t commands = 0; // trace operations executed, excluding acquire and present
+    uint64_t draws    = 0;
+    double   cpu_ms   = 0.0; // time spent executing commands, i.e. in the RHI, excluding acquire and present
+    double   frame_ms = 0.0; // wall time from acquire to acquire
+};
+
+// Re-executes a command trace against the current device and surface, as fast as the device allows.
+//
+// setup() creates every object recorded before the first frame. Each call to replay_frame() then executes
+// one frame, from acquire to present, starting over at the first frame once the trace ends.
+class TraceReplayer
+{
+public:
+    // Throws std::runtime_error when the trace cannot be read, or was recorded for another backend.
+    explicit TraceReplayer(const std::string& path);
+
+    void setup();
+
+    // Returns true when this frame was the last one of the trace.
+    // When the surface is suboptimal, nothing is executed, and the same frame is replayed by the next call.
+    auto replay_frame() -> bool;
+
+    auto header() const -> const TraceHeader& { return reader.header(); }
+
+    auto stats() const -> const ReplayStats& { return statistics; }
+    void reset_stats() { statistics = ReplayStats{}; }
+
+private:
+    void execute(TraceOp op);
+    void execute_command(TraceOp op, lyra::rhi::GPUCommandBuffer& command);
+
+    template <typename T>
+    auto find(std::unordered_map<TraceId, T>& objects, TraceId id) -> T&;
+
+private:
+    TraceReader                           reader;
+    size_t                                first_frame = 0; // offset of the first ACQUIRE
+    ReplayStats                           statistics;
+    std::chrono::steady_clock::time_point last_acquire;
+
+    lyra::rhi::GPUSurfaceTexture                               surface_texture;
+    std::unordered_map<TraceId, lyra::rhi::GPUBuffer>          buffers;
+    std::unordered_map<TraceId, lyra::rhi::GPUTexture>         textures;
+    std::unordered_map<TraceId, lyra::rhi::GPUTextureView>     views;
+    std::unordered_map<TraceId, lyra::rhi::GPUShaderModule>    shader_modules;
+    std::unordered_map<TraceId, lyra::rhi::GPUBindGroupLayout> bind_group_layouts;
+    std::unordered_map<TraceId, lyra::rhi::GPUPipelineLayout>  pipeline_layouts;
+    std::unordered_map<TraceId, lyra::rhi::GPURenderPipeline>  render_pipelines;
+    std::unordered_map<TraceId, lyra::rhi::GPUBindGroup>       bind_groups;
+    std::unordered_map<TraceId, lyra::rhi::GPUSemaphore>       semaphores;
+    std::unordered_map<TraceId, lyra::rhi::GPUCommandBuffer>   command_buffers;
+};
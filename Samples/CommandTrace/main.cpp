@@ -0,0 +1,463 @@
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <vector>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+#include "TraceRecorder.h"
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+struct FrameUniform
+{
+    float time;
+};
+
+struct ObjectUniform
+{
+    glm::vec2 offset;
+    float     scale;
+    float     speed;
+    glm::vec4 color;
+};
+
+constexpr uint     OBJECT_GRID       = 32;
+constexpr uint     OBJECT_COUNT      = OBJECT_GRID * OBJECT_GRID;
+constexpr uint     FRAMES_INFLIGHT   = 3;
+constexpr uint     TRACE_FRAMES      = 300; // frames recorded after setup, the sample keeps running untraced afterwards
+constexpr uint     FRAMES_PER_REPORT = 240;
+constexpr uint64_t UNIFORM_ALIGNMENT = 256; // NOTE: minimum dynamic uniform buffer offset alignment
+constexpr auto     TRACE_PATH        = "command_trace.bin";
+
+GPUShaderModule                vshader;
+GPUShaderModule                fshader;
+GPUBindGroupLayout             blayout;
+GPUPipelineLayout              playout;
+GPURenderPipeline              pipeline;
+GPUBuffer                      vbuffer;
+GPUBuffer                      ibuffer;
+GPUBuffer                      object_buffer;
+GPUBuffer                      frame_buffers[FRAMES_INFLIGHT];
+GPUBindGroup                   bind_groups[FRAMES_INFLIGHT];
+GPUQuerySet                    timestamp_queries[FRAMES_INFLIGHT];
+GPUBuffer                      timestamp_resolve[FRAMES_INFLIGHT];
+GPUBuffer                      timestamp_readback[FRAMES_INFLIGHT];
+std::unique_ptr<TraceRecorder> tracer;
+bool                           tracing          = true;
+bool                           timestamps       = false; // NOTE: queries cannot be traced, so --timestamps fails the capture
+double                         timestamp_period = 1.0;   // nanoseconds per tick
+double                         gpu_time         = 0.0;   // accumulated over a report, in milliseconds
+uint64_t                       frame_index      = 0;
+float                          elapsed          = 0.0f;
+
+auto read_shader_source() -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open("shader.slang");
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+void setup_tracer()
+{
+    // NOTE: the tracer must exist before anything is created, every object a trace refers to is part of it
+    tracer = std::make_unique<TraceRecorder>(TRACE_PATH);
+    std::cout << "Recording " << TRACE_FRAMES << " frames to " << TRACE_PATH << std::endl;
+}
+
+void setup_pipeline()
+{
+    auto& surface = RHI::get_current_surface();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = "test";
+        desc.path   = "test.slang";
+        desc.source = read_shader_source();
+        return compiler->compile(desc);
+    });
+
+    vshader = execute([&]() {
+        auto code  = module->get_shader_blob("vsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "vertex_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return tracer->create_shader_module(desc);
+    });
+
+    fshader = execute([&]() {
+        auto code  = module->get_shader_blob("fsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "fragment_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return tracer->create_shader_module(desc);
+    });
+
+    blayout = execute([&]() {
+        auto frame                      = GPUBindGroupLayoutEntry{};
+        frame.type                      = GPUBindingResourceType::BUFFER;
+        frame.binding                   = 0;
+        frame.count                     = 1;
+        frame.visibility                = GPUShaderStage::VERTEX;
+        frame.buffer.type               = GPUBufferBindingType::UNIFORM;
+        frame.buffer.has_dynamic_offset = false;
+
+        auto object                      = GPUBindGroupLayoutEntry{};
+        object.type                      = GPUBindingResourceType::BUFFER;
+        object.binding                   = 1;
+        object.count                     = 1;
+        object.visibility                = GPUShaderStage::VERTEX;
+        object.buffer.type               = GPUBufferBindingType::UNIFORM;
+        object.buffer.has_dynamic_offset = true;
+
+        auto desc    = GPUBindGroupLayoutDescriptor{};
+        desc.entries = {frame, object};
+        return tracer->create_bind_group_layout(desc);
+    });
+
+    playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {blayout};
+        return tracer->create_pipeline_layout(desc);
+    });
+
+    pipeline = execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x2;
+        position.offset          = 0;
+        position.shader_location = 0;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position};
+        layout.array_stride = sizeof(glm::vec2);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        // NOTE: objects are translucent, the blend state is part of the trace like the rest of the pipeline
+        auto target                   = GPUColorTargetState{};
+        target.format                 = surface.get_current_format();
+        target.blend_enable           = true;
+        target.blend.color.operation  = GPUBlendOperation::ADD;
+        target.blend.color.src_factor = GPUBlendFactor::SRC_ALPHA;
+        target.blend.color.dst_factor = GPUBlendFactor::ONE_MINUS_SRC_ALPHA;
+        target.blend.alpha.operation  = GPUBlendOperation::ADD;
+        target.blend.alpha.src_factor = GPUBlendFactor::ONE;
+        target.blend.alpha.dst_factor = GPUBlendFactor::ZERO;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::ALWAYS;
+        desc.depth_stencil.depth_write_enabled     = false;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vshader;
+        desc.fragment.module                       = fshader;
+        desc.vertex.buffers.push_back(layout);
+        desc.fragment.targets.push_back(target);
+
+        return tracer->create_render_pipeline(desc);
+    });
+}
+
+void setup_buffers()
+{
+    auto create_buffer = [&](const char* label, uint64_t size, uint usage) {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = label;
+        desc.size               = size;
+        desc.usage              = usage | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return tracer->create_buffer(desc);
+    };
+
+    vbuffer       = create_buffer("vertex_buffer", sizeof(glm::vec2) * 3, GPUBufferUsage::VERTEX);
+    ibuffer       = create_buffer("index_buffer", sizeof(uint32_t) * 3, GPUBufferUsage::INDEX);
+    object_buffer = create_buffer("object_buffer", UNIFORM_ALIGNMENT * OBJECT_COUNT, GPUBufferUsage::UNIFORM);
+
+    // NOTE: contents go through the tracer as well, writes into mapped ranges would not be part of the trace
+    glm::vec2 vertices[] = {{-0.5f, -0.5f}, {0.5f, -0.5f}, {0.0f, 0.5f}};
+    uint32_t  indices[]  = {0, 1, 2};
+    tracer->write_buffer(vbuffer, 0, vertices, sizeof(vertices));
+    tracer->write_buffer(ibuffer, 0, indices, sizeof(indices));
+
+    // objects never change, they only rotate with the time of the frame
+    auto rng     = std::mt19937(42);
+    auto unit    = std::uniform_real_distribution<float>(0.0f, 1.0f);
+    auto objects = std::vector<uint8_t>(UNIFORM_ALIGNMENT * OBJECT_COUNT);
+    for (uint i = 0; i < OBJECT_COUNT; i++) {
+        auto  cell    = glm::vec2(float(i % OBJECT_GRID), float(i / OBJECT_GRID));
+        auto& object  = *reinterpret_cast<ObjectUniform*>(objects.data() + i * UNIFORM_ALIGNMENT);
+        object.offset = (cell + 0.5f) / float(OBJECT_GRID) * 2.0f - 1.0f;
+        object.scale  = 1.2f / float(OBJECT_GRID);
+        object.speed  = unit(rng) * 4.0f - 2.0f;
+        object.color  = glm::vec4(unit(rng), unit(rng), unit(rng), 0.5f + unit(rng) * 0.5f);
+    }
+    tracer->write_buffer(object_buffer, 0, objects.data(), objects.size());
+
+    // one small frame uniform per frame in flight, so that the CPU never writes what the GPU is reading
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        frame_buffers[i] = create_buffer("frame_buffer", UNIFORM_ALIGNMENT, GPUBufferUsage::UNIFORM);
+
+        bind_groups[i] = execute([&]() {
+            auto frame          = GPUBindGroupEntry{};
+            frame.type          = GPUBindingResourceType::BUFFER;
+            frame.binding       = 0;
+            frame.index         = 0;
+            frame.buffer.buffer = frame_buffers[i];
+            frame.buffer.offset = 0;
+            frame.buffer.size   = sizeof(FrameUniform);
+
+            auto object          = GPUBindGroupEntry{};
+            object.type          = GPUBindingResourceType::BUFFER;
+            object.binding       = 1;
+            object.index         = 0;
+            object.buffer.buffer = object_buffer;
+            object.buffer.offset = 0;
+            object.buffer.size   = sizeof(ObjectUniform);
+
+            auto desc    = GPUBindGroupDescriptor{};
+            desc.layout  = blayout;
+            desc.entries = {frame, object};
+            return tracer->create_bind_group(desc);
+        });
+    }
+}
+
+void setup_timestamps()
+{
+    if (!timestamps)
+        return;
+
+    timestamp_period = RHI::get_current_device().get_timestamp_period();
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        timestamp_queries[i] = execute([&]() {
+            auto desc  = GPUQuerySetDescriptor{};
+            desc.label = "timestamp_queries";
+            desc.type  = GPUQueryType::TIMESTAMP;
+            desc.count = 2;
+            return tracer->create_query_set(desc);
+        });
+
+        timestamp_resolve[i] = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "timestamp_resolve_buffer";
+            desc.size  = sizeof(uint64_t) * 2;
+            desc.usage = GPUBufferUsage::QUERY_RESOLVE | GPUBufferUsage::COPY_SRC;
+            return tracer->create_buffer(desc);
+        });
+
+        timestamp_readback[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "timestamp_readback_buffer";
+            desc.size               = sizeof(uint64_t) * 2;
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            return tracer->create_buffer(desc);
+        });
+    }
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    tracer->close();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    if (timestamps) {
+        for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+            timestamp_queries[i].destroy();
+            timestamp_resolve[i].destroy();
+            timestamp_readback[i].destroy();
+        }
+    }
+    vbuffer.destroy();
+    ibuffer.destroy();
+    object_buffer.destroy();
+    for (auto& buffer : frame_buffers)
+        buffer.destroy();
+    vshader.destroy();
+    fshader.destroy();
+    blayout.destroy();
+    playout.destroy();
+    pipeline.destroy();
+}
+
+void update(const WindowInput& input)
+{
+    elapsed += input.delta_time;
+}
+
+void report_timestamps(uint slot)
+{
+    // the readback buffer in this slot was filled FRAMES_INFLIGHT frames ago, which is complete once its texture is acquired
+    if (frame_index < FRAMES_INFLIGHT)
+        return;
+
+    auto values = timestamp_readback[slot].get_mapped_range<uint64_t>();
+    gpu_time += double(values.at(1) - values.at(0)) * timestamp_period * 1e-6;
+
+    if ((frame_index - FRAMES_INFLIGHT + 1) % FRAMES_PER_REPORT != 0)
+        return;
+
+    std::cout << "GPU: " << gpu_time / FRAMES_PER_REPORT << " ms/frame for " << OBJECT_COUNT << " draws" << std::endl;
+    gpu_time = 0.0;
+}
+
+void render()
+{
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // acquire next frame from swapchain
+    auto texture = tracer->acquire(surface);
+    if (texture.suboptimal) return;
+
+    auto frame = FrameUniform{elapsed};
+    auto slot  = static_cast<uint>(frame_index % FRAMES_INFLIGHT);
+    if (timestamps)
+        report_timestamps(slot);
+    tracer->write_buffer(frame_buffers[slot], 0, &frame, sizeof(frame));
+
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return tracer->create_command_buffer(desc);
+    });
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = texture.view;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = {color_attachment};
+    render_pass.depth_stencil_attachment = {};
+
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    command.transition(texture.texture, {TraceState::UNDEFINED}, {TraceState::COLOR_ATTACHMENT});
+    if (timestamps)
+        command.write_timestamp(timestamp_queries[slot], 0);
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(pipeline);
+    command.set_vertex_buffer(0, vbuffer);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+
+    // one draw per object, the kind of stream where the CPU cost of the backend shows
+    for (uint i = 0; i < OBJECT_COUNT; i++) {
+        command.set_bind_group(0, bind_groups[slot], {static_cast<uint32_t>(i * UNIFORM_ALIGNMENT)});
+        command.draw_indexed(3, 1, 0, 0, 0);
+    }
+
+    command.end_render_pass();
+
+    // timestamps are resolved on the GPU, and read back by the frame that reuses this slot
+    if (timestamps) {
+        command.write_timestamp(timestamp_queries[slot], 1);
+        command.transition(timestamp_resolve[slot], {TraceState::UNDEFINED}, {TraceState::COPY_DST});
+        command.resolve_query_set(timestamp_queries[slot], 0, 2, timestamp_resolve[slot], 0);
+        command.transition(timestamp_resolve[slot], {TraceState::COPY_DST}, {TraceState::COPY_SRC});
+        command.copy_buffer_to_buffer(timestamp_resolve[slot], 0, timestamp_readback[slot], 0, sizeof(uint64_t) * 2);
+    }
+    command.transition(texture.texture, {TraceState::COLOR_ATTACHMENT}, {TraceState::PRESENT_SRC});
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    // present this frame to swapchain
+    tracer->present(texture);
+
+    // NOTE: a failed capture stops recording at once, it is discarded by close()
+    if (tracing && (!tracer->recording() || tracer->frame_count() == TRACE_FRAMES)) {
+        tracer->close();
+        tracing = false;
+        if (tracer->failure().empty())
+            std::cout << "Trace written to " << TRACE_PATH << ": " << TRACE_FRAMES << " frames, "
+                      << double(tracer->bytes_written()) / (1024.0 * 1024.0) << " MB" << std::endl;
+        else
+            std::cout << "Trace discarded: " << tracer->failure() << std::endl;
+    }
+    frame_index++;
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+        if (std::strcmp(argv[i], "--timestamps") == 0) timestamps = true;
+
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Fifo;
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_tracer);
+    win->bind<WindowEvent::START>(setup_pipeline);
+    win->bind<WindowEvent::START>(setup_buffers);
+    win->bind<WindowEvent::START>(setup_timestamps);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
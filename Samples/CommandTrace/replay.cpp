@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+#include "TraceReplayer.h"
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+// Replays a command trace recorded by the command-trace sample, as fast as the device allows,
+// and reports the CPU time spent in the RHI once per pass over the trace.
+//
+// usage: trace-replay <trace>
+
+constexpr uint FRAMES_INFLIGHT = 3;
+
+std::unique_ptr<TraceReplayer> replayer;
+uint                           pass = 0;
+
+void setup_replay()
+{
+    auto& surface = RHI::get_current_surface();
+
+    // NOTE: pipelines that render to the swapchain were created for the format it had during recording
+    if (uint32_t(surface.get_current_format()) != replayer->header().format)
+        std::cerr << "Warning: the surface format differs from the recorded one, the trace may not replay correctly" << std::endl;
+
+    replayer->setup();
+}
+
+void report()
+{
+    auto& stats  = replayer->stats();
+    auto  frames = double(stats.frames);
+    auto  draws  = double(std::max<uint64_t>(stats.draws, 1));
+
+    std::cout << "Pass " << pass++ << ": " << stats.frames << " frames"
+              << ", CPU: " << stats.cpu_ms / frames << " ms/frame"
+              << " (" << stats.cpu_ms * 1000.0 / draws << " us/draw)"
+              << ", Frame: " << stats.frame_ms / std::max(frames - 1.0, 1.0) << " ms"
+              << ", Commands: " << double(stats.commands) / frames << "/frame"
+              << ", Draws: " << double(stats.draws) / frames << "/frame" << std::endl;
+
+    replayer->reset_stats();
+}
+
+void render()
+{
+    if (replayer->replay_frame())
+        report();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <trace>" << std::endl;
+        return 1;
+    }
+
+    try {
+        replayer = std::make_unique<TraceReplayer>(argv[1]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Trace Replay";
+        desc.width  = replayer->header().width;
+        desc.height = replayer->header().height;
+        return Window::init(desc);
+    });
+
+    // NOTE: no validation, so that the numbers reflect the backend itself
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = 0;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "replay_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "replay_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Immediate;
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)device;  // avoid unused warning
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_replay);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
@@ -0,0 +1,1034 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec3 color;
+};
+
+// NOTE: must match the layout in gbuffer.slang and lighting.slang
+struct Frame
+{
+    glm::mat4 view_proj;
+    glm::vec4 eye;
+    uint      light_count;
+    uint      padding[3];
+};
+
+struct Light
+{
+    glm::vec4 position; // xyz = world space position, w = range
+    glm::vec4 color;
+};
+
+struct DrawLight
+{
+    uint light;
+    uint padding[3];
+};
+
+// CPU side of the light animation
+struct LightMotion
+{
+    glm::vec3 center;
+    float     radius;
+    float     speed;
+    float     phase;
+};
+
+enum class LightingMode : uint
+{
+    FULLSCREEN,      // one full screen triangle per light, every pixel runs the lighting shader for every light
+    STENCIL_VOLUMES, // one sphere per light, stencil restricts shading to pixels inside of it
+};
+
+// how a lighting pipeline writes to the backbuffer
+enum class ColorOutput : uint
+{
+    OVERWRITE, // ambient, first write of every pixel
+    ADDITIVE,  // lights accumulate on top
+    DISABLED,  // stencil marking does not touch color at all
+};
+
+enum Timestamp : uint
+{
+    FRAME_BEGIN,
+    GBUFFER_END,
+    LIGHTING_END,
+    TIMESTAMP_COUNT,
+};
+
+struct ModeStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last;
+    double            gbuffer     = 0.0;
+    double            lighting    = 0.0;
+    double            frame       = 0.0;
+    uint64_t          invocations = 0;
+    uint              samples     = 0; // GPU samples
+    uint              frames      = 0;
+};
+
+constexpr uint LIGHT_COUNT       = 256;
+constexpr uint OBJECT_GRID       = 12;
+constexpr uint SPHERE_SEGMENTS   = 16;
+constexpr uint SPHERE_RINGS      = 8;
+constexpr uint FRAMES_INFLIGHT   = 3;
+constexpr uint FRAMES_PER_TOGGLE = 240;
+
+constexpr float PI = 3.14159265f;
+
+constexpr GPUTextureFormat ALBEDO_FORMAT   = GPUTextureFormat::RGBA8UNORM;
+constexpr GPUTextureFormat NORMAL_FORMAT   = GPUTextureFormat::RGBA16FLOAT;
+constexpr GPUTextureFormat POSITION_FORMAT = GPUTextureFormat::RGBA32FLOAT;
+constexpr GPUTextureFormat DEPTH_FORMAT    = GPUTextureFormat::DEPTH24PLUS_STENCIL8;
+
+const char* MODE_NAMES[] = {"FULLSCREEN", "STENCIL_VOLUMES"};
+
+GPUShaderModule    gbuffer_vshader;
+GPUShaderModule    gbuffer_fshader;
+GPUShaderModule    volume_vshader;
+GPUShaderModule    fullscreen_vshader;
+GPUShaderModule    mark_fshader;
+GPUShaderModule    ambient_fshader;
+GPUShaderModule    light_fshader;
+GPUBindGroupLayout gbuffer_blayout;
+GPUBindGroupLayout lighting_blayout;
+GPUPipelineLayout  gbuffer_playout;
+GPUPipelineLayout  lighting_playout;
+GPURenderPipeline  gbuffer_pipeline;
+GPURenderPipeline  ambient_pipeline;
+GPURenderPipeline  mark_pipeline;
+GPURenderPipeline  volume_pipeline;
+GPURenderPipeline  fullscreen_pipeline;
+GPUBindGroup       gbuffer_bind_group;
+GPUBindGroup       lighting_bind_group;
+GPUBuffer          vbuffer;
+GPUBuffer          ibuffer;
+GPUBuffer          volume_vbuffer;
+GPUBuffer          volume_ibuffer;
+GPUBuffer          frame_ubuffer;
+GPUBuffer          light_buffer;
+GPUBuffer          counter_buffer;
+GPUBuffer          counter_reset;
+GPUBuffer          counter_readback[FRAMES_INFLIGHT];
+GPUTexture         albedo_texture;
+GPUTexture         normal_texture;
+GPUTexture         position_texture;
+GPUTexture         dsbuffer;
+GPUTextureView     albedo_view;
+GPUTextureView     normal_view;
+GPUTextureView     position_view;
+GPUTextureView     dsview;
+GPUQuerySet        timestamps[FRAMES_INFLIGHT];
+GPUBuffer          timestamp_resolve[FRAMES_INFLIGHT];
+GPUBuffer          timestamp_readback[FRAMES_INFLIGHT];
+LightingMode       timestamp_mode[FRAMES_INFLIGHT];
+LightMotion        motions[LIGHT_COUNT];
+double             timestamp_period = 1.0; // nanoseconds per tick
+uint               index_count      = 0;
+uint               volume_count     = 0;
+uint64_t           frame_index      = 0;
+LightingMode       mode             = LightingMode::STENCIL_VOLUMES;
+ModeStats          stats;
+
+auto read_shader_source(const std::string& name) -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open(name);
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+// NOTE: when push_constants is given, it receives the push constant ranges reported by the shader reflection
+auto compile_shader(const std::string& name, const char* entry, const char* label,
+                    std::vector<GPUPushConstantRange>* push_constants = nullptr) -> GPUShaderModule
+{
+    auto& device = RHI::get_current_device();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = name;
+        desc.path   = name;
+        desc.source = read_shader_source(name);
+        return compiler->compile(desc);
+    });
+
+    if (push_constants) *push_constants = module->get_push_constant_ranges();
+
+    return execute([&]() {
+        auto code  = module->get_shader_blob(entry);
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = label;
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+}
+
+auto buffer_layout_entry(uint binding, uint32_t visibility, GPUBufferBindingType type) -> GPUBindGroupLayoutEntry
+{
+    auto entry                      = GPUBindGroupLayoutEntry{};
+    entry.type                      = GPUBindingResourceType::BUFFER;
+    entry.binding                   = binding;
+    entry.count                     = 1;
+    entry.visibility                = visibility;
+    entry.buffer.type               = type;
+    entry.buffer.has_dynamic_offset = false;
+    return entry;
+}
+
+auto texture_layout_entry(uint binding) -> GPUBindGroupLayoutEntry
+{
+    auto entry                   = GPUBindGroupLayoutEntry{};
+    entry.type                   = GPUBindingResourceType::TEXTURE;
+    entry.binding                = binding;
+    entry.count                  = 1;
+    entry.visibility             = GPUShaderStage::FRAGMENT;
+    entry.texture.sample_type    = GPUTextureSampleType::UNFILTERABLE_FLOAT;
+    entry.texture.view_dimension = GPUTextureViewDimension::x2D;
+    entry.texture.multisampled   = false;
+    return entry;
+}
+
+auto buffer_entry(uint binding, const GPUBuffer& buffer) -> GPUBindGroupEntry
+{
+    auto entry          = GPUBindGroupEntry{};
+    entry.type          = GPUBindingResourceType::BUFFER;
+    entry.binding       = binding;
+    entry.index         = 0;
+    entry.buffer.buffer = buffer;
+    entry.buffer.offset = 0;
+    entry.buffer.size   = 0;
+    return entry;
+}
+
+auto texture_entry(uint binding, const GPUTextureView& view) -> GPUBindGroupEntry
+{
+    auto entry    = GPUBindGroupEntry{};
+    entry.type    = GPUBindingResourceType::TEXTURE;
+    entry.binding = binding;
+    entry.index   = 0;
+    entry.texture = view;
+    return entry;
+}
+
+// Lighting pipelines only differ in their shaders, stencil state and blending, the rest is shared.
+auto create_lighting_pipeline(const GPUShaderModule& vertex, const GPUShaderModule& fragment, bool volume,
+                              const GPUDepthStencilState& depth_stencil, ColorOutput output) -> GPURenderPipeline
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    return execute([&]() {
+        // NOTE: full screen triangles are generated from the vertex index, only light volumes fetch positions
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x3;
+        position.offset          = 0;
+        position.shader_location = 0;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position};
+        layout.array_stride = sizeof(glm::vec3);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto target                   = GPUColorTargetState{};
+        target.format                 = surface.get_current_format();
+        target.blend_enable           = output == ColorOutput::ADDITIVE;
+        target.write_mask             = output == ColorOutput::DISABLED ? GPUColorWrite::NONE : GPUColorWrite::ALL;
+        target.blend.color.operation  = GPUBlendOperation::ADD;
+        target.blend.color.src_factor = GPUBlendFactor::ONE;
+        target.blend.color.dst_factor = GPUBlendFactor::ONE;
+        target.blend.alpha            = target.blend.color;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = lighting_playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil                         = depth_stencil;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vertex;
+        desc.fragment.module                       = fragment;
+        if (volume)
+            desc.vertex.buffers.push_back(layout);
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+}
+
+void setup_pipelines()
+{
+    auto& device = RHI::get_current_device();
+
+    auto lighting_push_constants = std::vector<GPUPushConstantRange>{};
+
+    gbuffer_vshader    = compile_shader("gbuffer.slang", "vsmain", "gbuffer_vertex_shader");
+    gbuffer_fshader    = compile_shader("gbuffer.slang", "fsmain", "gbuffer_fragment_shader");
+    volume_vshader     = compile_shader("lighting.slang", "vsvolume", "volume_vertex_shader", &lighting_push_constants);
+    fullscreen_vshader = compile_shader("lighting.slang", "vsfullscreen", "fullscreen_vertex_shader");
+    mark_fshader       = compile_shader("lighting.slang", "fsmark", "mark_fragment_shader");
+    ambient_fshader    = compile_shader("lighting.slang", "fsambient", "ambient_fragment_shader");
+    light_fshader      = compile_shader("lighting.slang", "fslight", "light_fragment_shader");
+
+    gbuffer_blayout = execute([&]() {
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(buffer_layout_entry(0, GPUShaderStage::VERTEX, GPUBufferBindingType::UNIFORM));
+        return device.create_bind_group_layout(desc);
+    });
+
+    lighting_blayout = execute([&]() {
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(buffer_layout_entry(0, GPUShaderStage::VERTEX | GPUShaderStage::FRAGMENT, GPUBufferBindingType::UNIFORM));
+        desc.entries.push_back(buffer_layout_entry(1, GPUShaderStage::VERTEX | GPUShaderStage::FRAGMENT, GPUBufferBindingType::READ_ONLY_STORAGE));
+        desc.entries.push_back(texture_layout_entry(2));
+        desc.entries.push_back(texture_layout_entry(3));
+        desc.entries.push_back(texture_layout_entry(4));
+        desc.entries.push_back(buffer_layout_entry(5, GPUShaderStage::FRAGMENT, GPUBufferBindingType::STORAGE));
+        return device.create_bind_group_layout(desc);
+    });
+
+    gbuffer_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {gbuffer_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    // NOTE: push constant ranges come from the reflection of lighting.slang, DrawLight has to match the reflected block
+    lighting_playout = execute([&]() {
+        auto desc                 = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts   = {lighting_blayout};
+        desc.push_constant_ranges = lighting_push_constants;
+        return device.create_pipeline_layout(desc);
+    });
+
+    gbuffer_pipeline = execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x3;
+        position.offset          = offsetof(Vertex, position);
+        position.shader_location = 0;
+
+        auto normal            = GPUVertexAttribute{};
+        normal.format          = GPUVertexFormat::FLOAT32x3;
+        normal.offset          = offsetof(Vertex, normal);
+        normal.shader_location = 1;
+
+        auto color            = GPUVertexAttribute{};
+        color.format          = GPUVertexFormat::FLOAT32x3;
+        color.offset          = offsetof(Vertex, color);
+        color.shader_location = 2;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position, normal, color};
+        layout.array_stride = sizeof(Vertex);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = gbuffer_playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.format                  = DEPTH_FORMAT;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::LESS;
+        desc.depth_stencil.depth_write_enabled     = true;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = gbuffer_vshader;
+        desc.fragment.module                       = gbuffer_fshader;
+        desc.vertex.buffers.push_back(layout);
+        for (auto format : {ALBEDO_FORMAT, NORMAL_FORMAT, POSITION_FORMAT}) {
+            auto target         = GPUColorTargetState{};
+            target.format       = format;
+            target.blend_enable = false;
+            desc.fragment.targets.push_back(target);
+        }
+
+        return device.create_render_pipeline(desc);
+    });
+
+    // no depth or stencil test, depth is only read by the light volumes
+    auto unmasked                        = GPUDepthStencilState{};
+    unmasked.format                      = DEPTH_FORMAT;
+    unmasked.depth_compare               = GPUCompareFunction::ALWAYS;
+    unmasked.depth_write_enabled         = false;
+    unmasked.stencil_read_mask           = 0x0;
+    unmasked.stencil_write_mask          = 0x0;
+    unmasked.stencil_front.compare       = GPUCompareFunction::ALWAYS;
+    unmasked.stencil_front.fail_op       = GPUStencilOperation::KEEP;
+    unmasked.stencil_front.depth_fail_op = GPUStencilOperation::KEEP;
+    unmasked.stencil_front.pass_op       = GPUStencilOperation::KEEP;
+    unmasked.stencil_back                = unmasked.stencil_front;
+
+    // Pass 1 of each light, like render_mask() in StencilTest: both sides of the volume are depth tested against
+    // the scene, without writing color. Back faces behind the scene increment, front faces behind the scene
+    // decrement, so only pixels whose surface lies inside of the volume end up with a non-zero stencil value.
+    // NOTE: wrapping operations make this work whichever side the rasterizer considers front
+    auto mark                        = unmasked;
+    mark.depth_compare               = GPUCompareFunction::LESS;
+    mark.stencil_write_mask          = 0xFF;
+    mark.stencil_front.depth_fail_op = GPUStencilOperation::DECREMENT_WRAP;
+    mark.stencil_back.depth_fail_op  = GPUStencilOperation::INCREMENT_WRAP;
+
+    // Pass 2 of each light, like render_color() in StencilTest: shade where stencil is non-zero, and reset it to
+    // zero on the way, so that the other side of the volume does not shade again, and the next light starts clean.
+    auto shade                  = unmasked;
+    shade.stencil_read_mask     = 0xFF;
+    shade.stencil_write_mask    = 0xFF;
+    shade.stencil_front.compare = GPUCompareFunction::NOT_EQUAL;
+    shade.stencil_front.pass_op = GPUStencilOperation::ZERO;
+    shade.stencil_back          = shade.stencil_front;
+
+    ambient_pipeline    = create_lighting_pipeline(fullscreen_vshader, ambient_fshader, false, unmasked, ColorOutput::OVERWRITE);
+    fullscreen_pipeline = create_lighting_pipeline(fullscreen_vshader, light_fshader, false, unmasked, ColorOutput::ADDITIVE);
+    mark_pipeline       = create_lighting_pipeline(volume_vshader, mark_fshader, true, mark, ColorOutput::DISABLED);
+    volume_pipeline     = create_lighting_pipeline(volume_vshader, light_fshader, true, shade, ColorOutput::ADDITIVE);
+}
+
+void add_box(std::vector<Vertex>& vertices, std::vector<uint>& indices, glm::vec3 center, glm::vec3 extent, glm::vec3 color)
+{
+    // 4 vertices per face, so that every face has a normal of its own
+    for (uint axis = 0; axis < 3; axis++) {
+        for (float sign : {-1.0f, 1.0f}) {
+            auto normal             = glm::vec3(0.0f);
+            auto tangent            = glm::vec3(0.0f);
+            normal[axis]            = sign;
+            tangent[(axis + 1) % 3] = 1.0f;
+
+            auto bitangent = glm::cross(normal, tangent);
+
+            auto base = static_cast<uint>(vertices.size());
+            for (uint i = 0; i < 4; i++) {
+                float u      = (i & 1) ? 0.5f : -0.5f;
+                float v      = (i & 2) ? 0.5f : -0.5f;
+                auto  corner = normal * 0.5f + tangent * u + bitangent * v;
+                vertices.push_back({center + corner * extent, normal, color});
+            }
+
+            for (uint i : {0u, 1u, 3u, 0u, 3u, 2u})
+                indices.push_back(base + i);
+        }
+    }
+}
+
+void setup_geometry()
+{
+    auto& device = RHI::get_current_device();
+
+    auto vertices = std::vector<Vertex>{};
+    auto indices  = std::vector<uint>{};
+
+    // floor and a grid of boxes
+    add_box(vertices, indices, glm::vec3(0.0f, -0.5f, -3.0f), glm::vec3(60.0f, 1.0f, 60.0f), glm::vec3(0.8f));
+    for (uint z = 0; z < OBJECT_GRID; z++) {
+        for (uint x = 0; x < OBJECT_GRID; x++) {
+            float height = 0.5f + float((x * 5 + z * 3) % 4) * 0.75f;
+            auto  center = glm::vec3((float(x) - OBJECT_GRID * 0.5f + 0.5f) * 3.0f, height * 0.5f, (float(z) - OBJECT_GRID * 0.5f + 0.5f) * 3.0f - 3.0f);
+            add_box(vertices, indices, center, glm::vec3(1.0f, height, 1.0f), glm::vec3(0.9f, 0.85f, 0.8f));
+        }
+    }
+
+    index_count = static_cast<uint>(indices.size());
+
+    vbuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "vertex_buffer";
+        desc.size               = sizeof(Vertex) * vertices.size();
+        desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    ibuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "index_buffer";
+        desc.size               = sizeof(uint32_t) * indices.size();
+        desc.usage              = GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    auto vdata = vbuffer.get_mapped_range<Vertex>();
+    for (uint i = 0; i < vertices.size(); i++)
+        vdata.at(i) = vertices.at(i);
+
+    auto idata = ibuffer.get_mapped_range<uint>();
+    for (uint i = 0; i < index_count; i++)
+        idata.at(i) = indices.at(i);
+}
+
+void setup_volume()
+{
+    auto& device = RHI::get_current_device();
+
+    // NOTE: a sphere with vertices on the unit sphere has its faces inside of it, scale it up so that
+    // the faces enclose the whole sphere, otherwise the edges of the light would be cut off
+    float scale = 1.0f / (std::cos(PI / SPHERE_SEGMENTS) * std::cos(PI / (SPHERE_RINGS * 2)));
+
+    auto positions = std::vector<glm::vec3>{};
+    auto indices   = std::vector<uint>{};
+
+    for (uint ring = 0; ring <= SPHERE_RINGS; ring++) {
+        float theta = PI * float(ring) / float(SPHERE_RINGS);
+        for (uint segment = 0; segment <= SPHERE_SEGMENTS; segment++) {
+            float phi = 2.0f * PI * float(segment) / float(SPHERE_SEGMENTS);
+            positions.push_back(glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)) * scale);
+        }
+    }
+
+    for (uint ring = 0; ring < SPHERE_RINGS; ring++) {
+        for (uint segment = 0; segment < SPHERE_SEGMENTS; segment++) {
+            uint a = ring * (SPHERE_SEGMENTS + 1) + segment;
+            uint b = a + SPHERE_SEGMENTS + 1;
+            for (uint i : {a, b, a + 1, a + 1, b, b + 1})
+                indices.push_back(i);
+        }
+    }
+
+    volume_count = static_cast<uint>(indices.size());
+
+    volume_vbuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "volume_vertex_buffer";
+        desc.size               = sizeof(glm::vec3) * positions.size();
+        desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    volume_ibuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "volume_index_buffer";
+        desc.size               = sizeof(uint32_t) * indices.size();
+        desc.usage              = GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    auto vdata = volume_vbuffer.get_mapped_range<glm::vec3>();
+    for (uint i = 0; i < positions.size(); i++)
+        vdata.at(i) = positions.at(i);
+
+    auto idata = volume_ibuffer.get_mapped_range<uint>();
+    for (uint i = 0; i < volume_count; i++)
+        idata.at(i) = indices.at(i);
+}
+
+void setup_lights()
+{
+    auto& device = RHI::get_current_device();
+
+    light_buffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "light_buffer";
+        desc.size               = sizeof(Light) * LIGHT_COUNT;
+        desc.usage              = GPUBufferUsage::STORAGE | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    frame_ubuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "frame_uniform_buffer";
+        desc.size               = sizeof(Frame);
+        desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    // NOTE: fixed seed, so that both modes light the same scene
+    auto rng    = std::mt19937(1234);
+    auto random = [&](float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); };
+
+    auto lights = light_buffer.get_mapped_range<Light>();
+    for (uint i = 0; i < LIGHT_COUNT; i++) {
+        auto color = glm::vec3(random(0.2f, 1.0f), random(0.2f, 1.0f), random(0.2f, 1.0f));
+
+        motions[i].center = glm::vec3(random(-18.0f, 18.0f), random(0.3f, 2.5f), random(-21.0f, 15.0f));
+        motions[i].radius = random(0.5f, 2.0f);
+        motions[i].speed  = random(-1.0f, 1.0f);
+        motions[i].phase  = random(0.0f, 2.0f * PI);
+
+        lights.at(i).position = glm::vec4(motions[i].center, random(2.0f, 5.0f));
+        lights.at(i).color    = glm::vec4(color * 4.0f, 0.0f);
+    }
+}
+
+void setup_gbuffer()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto create_target = [&](GPUTextureFormat format, uint32_t usage, const char* label) {
+        return execute([&]() {
+            auto desc            = GPUTextureDescriptor{};
+            desc.format          = format;
+            desc.size.width      = extent.width;
+            desc.size.height     = extent.height;
+            desc.size.depth      = 1;
+            desc.array_layers    = 1;
+            desc.mip_level_count = 1;
+            desc.usage           = usage;
+            desc.label           = label;
+            return device.create_texture(desc);
+        });
+    };
+
+    auto sampled     = GPUTextureUsage::RENDER_ATTACHMENT | GPUTextureUsage::TEXTURE_BINDING;
+    albedo_texture   = create_target(ALBEDO_FORMAT, sampled, "albedo_buffer");
+    normal_texture   = create_target(NORMAL_FORMAT, sampled, "normal_buffer");
+    position_texture = create_target(POSITION_FORMAT, sampled, "position_buffer");
+    dsbuffer         = create_target(DEPTH_FORMAT, GPUTextureUsage::RENDER_ATTACHMENT, "depth_stencil_buffer");
+
+    albedo_view   = albedo_texture.create_view();
+    normal_view   = normal_texture.create_view();
+    position_view = position_texture.create_view();
+    dsview        = dsbuffer.create_view();
+
+    // counts invocations of the lighting fragment shader, reset at the beginning of every frame
+    counter_buffer = execute([&]() {
+        auto desc  = GPUBufferDescriptor{};
+        desc.label = "counter_buffer";
+        desc.size  = sizeof(uint);
+        desc.usage = GPUBufferUsage::STORAGE | GPUBufferUsage::COPY_SRC | GPUBufferUsage::COPY_DST;
+        return device.create_buffer(desc);
+    });
+
+    counter_reset = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "counter_reset_buffer";
+        desc.size               = sizeof(uint);
+        desc.usage              = GPUBufferUsage::COPY_SRC | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    counter_reset.get_mapped_range<uint>().at(0) = 0;
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        counter_readback[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "counter_readback_buffer";
+            desc.size               = sizeof(uint);
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    }
+
+    // bind groups are fixed, because none of the resources ever change
+    gbuffer_bind_group = execute([&]() {
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = gbuffer_blayout;
+        desc.entries.push_back(buffer_entry(0, frame_ubuffer));
+        return device.create_bind_group(desc);
+    });
+
+    lighting_bind_group = execute([&]() {
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = lighting_blayout;
+        desc.entries.push_back(buffer_entry(0, frame_ubuffer));
+        desc.entries.push_back(buffer_entry(1, light_buffer));
+        desc.entries.push_back(texture_entry(2, albedo_view));
+        desc.entries.push_back(texture_entry(3, normal_view));
+        desc.entries.push_back(texture_entry(4, position_view));
+        desc.entries.push_back(buffer_entry(5, counter_buffer));
+        return device.create_bind_group(desc);
+    });
+}
+
+void setup_timestamps()
+{
+    auto& device = RHI::get_current_device();
+
+    timestamp_period = device.get_timestamp_period();
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        timestamps[i] = execute([&]() {
+            auto desc  = GPUQuerySetDescriptor{};
+            desc.label = "timestamp_queries";
+            desc.type  = GPUQueryType::TIMESTAMP;
+            desc.count = TIMESTAMP_COUNT;
+            return device.create_query_set(desc);
+        });
+
+        timestamp_resolve[i] = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "timestamp_resolve_buffer";
+            desc.size  = sizeof(uint64_t) * TIMESTAMP_COUNT;
+            desc.usage = GPUBufferUsage::QUERY_RESOLVE | GPUBufferUsage::COPY_SRC;
+            return device.create_buffer(desc);
+        });
+
+        timestamp_readback[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "timestamp_readback_buffer";
+            desc.size               = sizeof(uint64_t) * TIMESTAMP_COUNT;
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    }
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        timestamps[i].destroy();
+        timestamp_resolve[i].destroy();
+        timestamp_readback[i].destroy();
+        counter_readback[i].destroy();
+    }
+    vbuffer.destroy();
+    ibuffer.destroy();
+    volume_vbuffer.destroy();
+    volume_ibuffer.destroy();
+    frame_ubuffer.destroy();
+    light_buffer.destroy();
+    counter_buffer.destroy();
+    counter_reset.destroy();
+    albedo_texture.destroy();
+    normal_texture.destroy();
+    position_texture.destroy();
+    dsbuffer.destroy();
+    gbuffer_vshader.destroy();
+    gbuffer_fshader.destroy();
+    volume_vshader.destroy();
+    fullscreen_vshader.destroy();
+    mark_fshader.destroy();
+    ambient_fshader.destroy();
+    light_fshader.destroy();
+    gbuffer_blayout.destroy();
+    lighting_blayout.destroy();
+    gbuffer_playout.destroy();
+    lighting_playout.destroy();
+    gbuffer_pipeline.destroy();
+    ambient_pipeline.destroy();
+    mark_pipeline.destroy();
+    volume_pipeline.destroy();
+    fullscreen_pipeline.destroy();
+}
+
+void update(const WindowInput& input)
+{
+    static float time = 0.0f;
+    time += input.delta_time;
+
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto eye  = glm::vec3(0.0f, 14.0f, 20.0f);
+    auto proj = glm::perspective(1.05f, float(extent.width) / float(extent.height), 0.1f, 100.0f);
+    auto view = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, -4.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    auto frame              = frame_ubuffer.get_mapped_range<Frame>();
+    frame.at(0).view_proj   = proj * view;
+    frame.at(0).eye         = glm::vec4(eye, 1.0f);
+    frame.at(0).light_count = LIGHT_COUNT;
+
+    // lights circle around their center
+    auto lights = light_buffer.get_mapped_range<Light>();
+    for (uint i = 0; i < LIGHT_COUNT; i++) {
+        auto& motion = motions[i];
+        float angle  = time * motion.speed + motion.phase;
+        auto  offset = glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * motion.radius;
+        auto  range  = lights.at(i).position.w;
+
+        lights.at(i).position = glm::vec4(motion.center + offset, range);
+    }
+}
+
+void render_gbuffer(GPUCommandBuffer& command)
+{
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto color_attachments = std::vector<GPURenderPassColorAttachment>{};
+    for (auto& view : {albedo_view, normal_view, position_view}) {
+        auto attachment        = GPURenderPassColorAttachment{};
+        attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        attachment.load_op     = GPULoadOp::CLEAR;
+        attachment.store_op    = GPUStoreOp::STORE;
+        attachment.view        = view;
+        color_attachments.push_back(attachment);
+    }
+
+    // NOTE: depth is stored for the light volumes, stencil is cleared by the lighting pass
+    auto depth_attachment                = GPURenderPassDepthStencilAttachment{};
+    depth_attachment.view                = dsview;
+    depth_attachment.depth_clear_value   = 1.0f;
+    depth_attachment.depth_load_op       = GPULoadOp::CLEAR;
+    depth_attachment.depth_store_op      = GPUStoreOp::STORE;
+    depth_attachment.depth_read_only     = false;
+    depth_attachment.stencil_clear_value = 0;
+    depth_attachment.stencil_load_op     = GPULoadOp::CLEAR;
+    depth_attachment.stencil_store_op    = GPUStoreOp::DISCARD;
+    depth_attachment.stencil_read_only   = false;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = color_attachments;
+    render_pass.depth_stencil_attachment = depth_attachment;
+
+    command.resource_barrier(state_transition(albedo_texture, undefined_state(), color_attachment_state()));
+    command.resource_barrier(state_transition(normal_texture, undefined_state(), color_attachment_state()));
+    command.resource_barrier(state_transition(position_texture, undefined_state(), color_attachment_state()));
+    command.resource_barrier(state_transition(dsbuffer, undefined_state(), depth_stencil_attachment_state()));
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(gbuffer_pipeline);
+    command.set_vertex_buffer(0, vbuffer);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+    command.set_bind_group(0, gbuffer_bind_group);
+    command.draw_indexed(index_count, 1, 0, 0, 0);
+    command.end_render_pass();
+    command.resource_barrier(state_transition(albedo_texture, color_attachment_state(), shader_resource_state(GPUShaderStage::FRAGMENT)));
+    command.resource_barrier(state_transition(normal_texture, color_attachment_state(), shader_resource_state(GPUShaderStage::FRAGMENT)));
+    command.resource_barrier(state_transition(position_texture, color_attachment_state(), shader_resource_state(GPUShaderStage::FRAGMENT)));
+}
+
+void render_lighting(GPUCommandBuffer& command, const GPUSurfaceTexture& backbuffer)
+{
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = backbuffer.view;
+
+    // scene depth is only tested against, stencil is written by the light volumes
+    auto depth_attachment                = GPURenderPassDepthStencilAttachment{};
+    depth_attachment.view                = dsview;
+    depth_attachment.depth_clear_value   = 1.0f;
+    depth_attachment.depth_load_op       = GPULoadOp::LOAD;
+    depth_attachment.depth_store_op      = GPUStoreOp::DISCARD;
+    depth_attachment.depth_read_only     = true;
+    depth_attachment.stencil_clear_value = 0;
+    depth_attachment.stencil_load_op     = GPULoadOp::CLEAR;
+    depth_attachment.stencil_store_op    = GPUStoreOp::DISCARD;
+    depth_attachment.stencil_read_only   = false;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = {color_attachment};
+    render_pass.depth_stencil_attachment = depth_attachment;
+
+    command.resource_barrier(state_transition(counter_buffer, undefined_state(), copy_dst_state()));
+    command.copy_buffer_to_buffer(counter_reset, 0, counter_buffer, 0, sizeof(uint));
+    command.resource_barrier(state_transition(counter_buffer, copy_dst_state(), storage_state(GPUShaderStage::FRAGMENT)));
+
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_bind_group(0, lighting_bind_group);
+    command.set_stencil_reference(0);
+
+    // ambient, written once for every pixel
+    command.set_pipeline(ambient_pipeline);
+    command.draw(3, 1, 0, 0);
+
+    if (mode == LightingMode::FULLSCREEN) {
+        command.set_pipeline(fullscreen_pipeline);
+        for (uint i = 0; i < LIGHT_COUNT; i++) {
+            auto draw  = DrawLight{};
+            draw.light = i;
+            command.set_push_constants(GPUShaderStage::VERTEX | GPUShaderStage::FRAGMENT, 0, sizeof(DrawLight), &draw);
+            command.draw(3, 1, 0, 0);
+        }
+    } else {
+        command.set_vertex_buffer(0, volume_vbuffer);
+        command.set_index_buffer(volume_ibuffer, GPUIndexFormat::UINT32);
+        for (uint i = 0; i < LIGHT_COUNT; i++) {
+            auto draw  = DrawLight{};
+            draw.light = i;
+            command.set_push_constants(GPUShaderStage::VERTEX | GPUShaderStage::FRAGMENT, 0, sizeof(DrawLight), &draw);
+            command.set_pipeline(mark_pipeline);
+            command.draw_indexed(volume_count, 1, 0, 0, 0);
+            command.set_pipeline(volume_pipeline);
+            command.draw_indexed(volume_count, 1, 0, 0, 0);
+        }
+    }
+
+    command.end_render_pass();
+    command.resource_barrier(state_transition(counter_buffer, storage_state(GPUShaderStage::FRAGMENT), copy_src_state()));
+}
+
+void read_stats(uint slot)
+{
+    // the readback buffers in this slot were filled FRAMES_INFLIGHT frames ago, which is complete once its texture is acquired
+    if (frame_index < FRAMES_INFLIGHT || timestamp_mode[slot] != mode)
+        return;
+
+    auto values = timestamp_readback[slot].get_mapped_range<uint64_t>();
+    stats.gbuffer += double(values.at(GBUFFER_END) - values.at(FRAME_BEGIN)) * timestamp_period * 1e-6;
+    stats.lighting += double(values.at(LIGHTING_END) - values.at(GBUFFER_END)) * timestamp_period * 1e-6;
+    stats.invocations += counter_readback[slot].get_mapped_range<uint>().at(0);
+    stats.samples++;
+}
+
+void report()
+{
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto now = ModeStats::Clock::now();
+    if (stats.frames > 0)
+        stats.frame += std::chrono::duration<double, std::milli>(now - stats.last).count();
+    stats.last = now;
+
+    // alternate between full screen lighting and stencil masked volumes, to compare both
+    if (++stats.frames == FRAMES_PER_TOGGLE) {
+        auto samples     = double(std::max(stats.samples, 1u));
+        auto invocations = double(stats.invocations) / samples;
+        auto pixels      = double(extent.width) * double(extent.height);
+        auto padding     = std::string(15 - std::strlen(MODE_NAMES[static_cast<uint>(mode)]), ' ');
+        std::cout << "Lighting: " << MODE_NAMES[static_cast<uint>(mode)] << padding
+                  << ", Lights: " << LIGHT_COUNT
+                  << ", Fragment Invocations: " << invocations << " (" << invocations / pixels << "/pixel)"
+                  << ", G-Buffer: " << stats.gbuffer / samples << " ms"
+                  << ", Lighting: " << stats.lighting / samples << " ms"
+                  << ", Frame Time: " << stats.frame / (FRAMES_PER_TOGGLE - 1) << " ms" << std::endl;
+
+        mode  = mode == LightingMode::FULLSCREEN ? LightingMode::STENCIL_VOLUMES : LightingMode::FULLSCREEN;
+        stats = ModeStats{};
+    }
+}
+
+void render()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    auto slot = static_cast<uint>(frame_index % FRAMES_INFLIGHT);
+    read_stats(slot);
+    timestamp_mode[slot] = mode;
+
+    // create command buffer
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    // commands
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    command.write_timestamp(timestamps[slot], FRAME_BEGIN);
+    render_gbuffer(command);
+    command.write_timestamp(timestamps[slot], GBUFFER_END);
+    render_lighting(command, texture);
+    command.write_timestamp(timestamps[slot], LIGHTING_END);
+    command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+
+    // timestamps and the invocation counter are read back by the frame that reuses this slot
+    command.resource_barrier(state_transition(timestamp_resolve[slot], undefined_state(), copy_dst_state()));
+    command.resolve_query_set(timestamps[slot], 0, TIMESTAMP_COUNT, timestamp_resolve[slot], 0);
+    command.resource_barrier(state_transition(timestamp_resolve[slot], copy_dst_state(), copy_src_state()));
+    command.copy_buffer_to_buffer(timestamp_resolve[slot], 0, timestamp_readback[slot], 0, sizeof(uint64_t) * TIMESTAMP_COUNT);
+    command.copy_buffer_to_buffer(counter_buffer, 0, counter_readback[slot], 0, sizeof(uint));
+
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    // present this frame to swapchain
+    texture.present();
+
+    report();
+    frame_index++;
+}
+
+int main()
+{
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Immediate; // NOTE: do not hide frame time behind vsync
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipelines);
+    win->bind<WindowEvent::START>(setup_geometry);
+    win->bind<WindowEvent::START>(setup_volume);
+    win->bind<WindowEvent::START>(setup_lights);
+    win->bind<WindowEvent::START>(setup_gbuffer);
+    win->bind<WindowEvent::START>(setup_timestamps);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <string_view>
+#include <vector>
 #include <cmrc/cmrc.hpp>
 
 #include <Lyra/Common/GLM.h>
@@ -19,16 +24,73 @@ struct Vertex
     glm::vec3 color;
 };
 
+struct DepthConfig
+{
+    bool               reverse_z     = false;
+    bool               stress        = false;
+    GPUTextureFormat   format        = GPUTextureFormat::DEPTH16UNORM;
+    GPUCompareFunction compare       = GPUCompareFunction::LESS;
+    float              clear_value   = 1.0f;
+    float              near_plane    = 0.1f;
+    float              far_plane     = 100.0f;
+    uint               stress_layers = 32;
+};
+
+struct FrameTimer
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last;
+    double            accumulated = 0.0;
+    uint              frames      = 0;
+};
+
+// NOTE: the layout of a resolved statistics query depends on the backend (see StencilTest),
+// offsets are taken from the query set, in bytes.
+struct QueryLayout
+{
+    GPUSize64 fragment_invocations = 0; // offset within the statistics query
+    GPUSize64 statistics_stride    = 0; // of one statistics query
+    GPUSize64 samples_passed       = 0; // offset of the occlusion queries, after the statistics queries
+    GPUSize64 size                 = 0; // of the resolved queries of one frame
+};
+
+// stress frames draw the scene twice, each pass has its own queries
+enum StressPass : uint
+{
+    FRONT_TO_BACK = 0, // measures depth rejection, every red quad is hidden
+    BACK_TO_FRONT = 1, // the visible pass, measures precision, only green quads that resolve pass
+    STRESS_PASSES = 2,
+};
+
+// resolved queries of one pass, as read back
+struct QueryResults
+{
+    uint64_t fragment_invocations;
+    uint64_t samples_passed;
+};
+
+constexpr uint FRAMES_INFLIGHT   = 3;
+constexpr uint FRAMES_PER_REPORT = 240;
+
 GPUShaderModule    vshader;
 GPUShaderModule    fshader;
-GPUBindGroupLayout blayout;
 GPUPipelineLayout  playout;
 GPURenderPipeline  pipeline;
 GPUBuffer          vbuffer;
 GPUBuffer          ibuffer;
-GPUBuffer          ubuffer;
 GPUTexture         dbuffer;
 GPUTextureView     dview;
+GPUQuerySet        statistics_queries[FRAMES_INFLIGHT];
+GPUQuerySet        occlusion_queries[FRAMES_INFLIGHT];
+GPUBuffer          query_resolve[FRAMES_INFLIGHT];
+GPUBuffer          query_readback[FRAMES_INFLIGHT];
+QueryLayout        query_layout;
+DepthConfig        config;
+FrameTimer         timer;
+glm::mat4          mvp;
+uint               index_count = 0; // of one draw order
+uint64_t           frame_index = 0;
 
 auto read_shader_source() -> const char*
 {
@@ -39,6 +101,49 @@ auto read_shader_source() -> const char*
     return program;
 }
 
+auto create_projection(float aspect) -> glm::mat4
+{
+    constexpr float fovy = 1.05f;
+
+    if (!config.reverse_z)
+        return glm::perspective(fovy, aspect, config.near_plane, config.far_plane);
+
+    // NOTE: Infinite far plane with reversed depth range, i.e. near plane maps to 1.0 and infinity maps to 0.0.
+    // Floating point depth has most of its precision around 0.0, which cancels out the 1/z distribution.
+    float f    = 1.0f / std::tan(fovy * 0.5f);
+    auto  proj = glm::mat4(0.0f);
+    proj[0][0] = f / aspect;
+    proj[1][1] = f;
+    proj[2][3] = -1.0f;
+    proj[3][2] = config.near_plane;
+    return proj;
+}
+
+auto create_modelview() -> glm::mat4
+{
+    return glm::lookAt(
+        glm::vec3(0.0f, 0.0f, 3.0f),
+        glm::vec3(0.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+void setup_config(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--reverse-z") == 0) config.reverse_z = true;
+        if (std::strcmp(argv[i], "--stress") == 0) config.stress = true;
+    }
+
+    if (config.reverse_z) {
+        config.format      = GPUTextureFormat::DEPTH32FLOAT;
+        config.compare     = GPUCompareFunction::GREATER;
+        config.clear_value = 0.0f;
+    }
+
+    std::cout << "Depth Mode: " << (config.reverse_z ? "reverse-z (D32F, GREATER, infinite far)" : "standard (D16, LESS)")
+              << ", Scene: " << (config.stress ? "stress" : "basic") << std::endl;
+}
+
 void setup_pipeline()
 {
     auto& device  = RHI::get_current_device();
@@ -77,21 +182,10 @@ void setup_pipeline()
         return device.create_shader_module(desc);
     });
 
-    blayout = execute([&]() {
-        auto desc                       = GPUBindGroupLayoutDescriptor{};
-        auto entry                      = GPUBindGroupLayoutEntry{};
-        entry.type                      = GPUBindingResourceType::BUFFER;
-        entry.binding                   = 0;
-        entry.visibility                = GPUShaderStage::VERTEX;
-        entry.buffer.type               = GPUBufferBindingType::UNIFORM;
-        entry.buffer.has_dynamic_offset = false;
-        desc.entries.push_back(entry);
-        return device.create_bind_group_layout(desc);
-    });
-
+    // NOTE: the mvp is pushed with every draw, no bind group is needed (see Triangle)
     playout = execute([&]() {
-        auto desc               = GPUPipelineLayoutDescriptor{};
-        desc.bind_group_layouts = {blayout};
+        auto desc                 = GPUPipelineLayoutDescriptor{};
+        desc.push_constant_ranges = module->get_push_constant_ranges();
         return device.create_pipeline_layout(desc);
     });
 
@@ -121,8 +215,8 @@ void setup_pipeline()
         desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
         desc.primitive.front_face                  = GPUFrontFace::CCW;
         desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
-        desc.depth_stencil.format                  = GPUTextureFormat::DEPTH16UNORM;
-        desc.depth_stencil.depth_compare           = GPUCompareFunction::LESS;
+        desc.depth_stencil.format                  = config.format;
+        desc.depth_stencil.depth_compare           = config.compare;
         desc.depth_stencil.depth_write_enabled     = true;
         desc.multisample.alpha_to_coverage_enabled = false;
         desc.multisample.count                     = 1;
@@ -135,14 +229,107 @@ void setup_pipeline()
     });
 }
 
+void setup_basic_geometry(std::vector<Vertex>& vertices)
+{
+    // tri 1
+    vertices.push_back({{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}});
+    vertices.push_back({{1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}});
+    vertices.push_back({{0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}});
+
+    // tri 2
+    vertices.push_back({{0.0f - 0.25f, 0.0f - 0.25f, -1.0f}, {0.0f, 1.0f, 1.0f}});
+    vertices.push_back({{1.0f - 0.25f, 0.0f - 0.25f, -1.0f}, {0.0f, 1.0f, 1.0f}});
+    vertices.push_back({{0.0f - 0.25f, 1.0f - 0.25f, -1.0f}, {0.0f, 1.0f, 1.0f}});
+}
+
+void setup_stress_geometry(std::vector<Vertex>& vertices, float aspect)
+{
+    // Each layer is a vertical strip on screen, made of two quads that are very close in depth.
+    // The front quad (green) should always win, the back quad (red) shows through when precision runs out.
+    // Layers are placed from 1 unit to 10000 units away from the camera, with geometric spacing.
+    auto tan_half_fovy = std::tan(1.05f * 0.5f);
+    auto separation    = 1e-4f; // relative distance between the two quads of a layer
+
+    auto resolved = 0u;
+    auto clipped  = 0u;
+    auto proj     = create_projection(aspect);
+    auto view     = create_modelview();
+
+    for (uint i = 0; i < config.stress_layers; i++) {
+        float t        = float(i) / float(config.stress_layers - 1);
+        float distance = std::pow(10.0f, t * 4.0f);
+        float x0       = -1.0f + 2.0f * float(i + 0) / float(config.stress_layers);
+        float x1       = -1.0f + 2.0f * float(i + 1) / float(config.stress_layers);
+
+        // back-to-front in the vertex buffer, the front-to-back order is built from the index buffer
+        float     depths[2] = {distance * (1.0f + separation), distance};
+        glm::vec3 colors[2] = {glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)};
+        float     ndc_z[2];
+
+        for (uint k = 0; k < 2; k++) {
+            float d  = depths[k];
+            float sx = d * tan_half_fovy * aspect;
+            float sy = d * tan_half_fovy;
+            float z  = 3.0f - d; // camera sits at z = 3, looking at -z
+
+            auto p0 = glm::vec3(x0 * sx, -0.9f * sy, z);
+            auto p1 = glm::vec3(x1 * sx, -0.9f * sy, z);
+            auto p2 = glm::vec3(x1 * sx, +0.9f * sy, z);
+            auto p3 = glm::vec3(x0 * sx, +0.9f * sy, z);
+
+            vertices.push_back({p0, colors[k]});
+            vertices.push_back({p1, colors[k]});
+            vertices.push_back({p2, colors[k]});
+            vertices.push_back({p0, colors[k]});
+            vertices.push_back({p2, colors[k]});
+            vertices.push_back({p3, colors[k]});
+
+            auto clip = proj * view * glm::vec4(0.0f, 0.0f, z, 1.0f);
+            ndc_z[k]  = clip.z / clip.w;
+        }
+
+        // emulate what gets stored in the depth buffer
+        bool inside = ndc_z[0] >= 0.0f && ndc_z[0] <= 1.0f && ndc_z[1] >= 0.0f && ndc_z[1] <= 1.0f;
+        if (!inside) {
+            clipped++;
+            continue;
+        }
+
+        if (config.format == GPUTextureFormat::DEPTH16UNORM) {
+            auto q0 = uint(ndc_z[0] * 65535.0f + 0.5f);
+            auto q1 = uint(ndc_z[1] * 65535.0f + 0.5f);
+            if (q0 != q1) resolved++;
+        } else {
+            if (ndc_z[0] != ndc_z[1]) resolved++;
+        }
+    }
+
+    std::cout << "Depth Precision: " << resolved << "/" << config.stress_layers << " layers resolved, "
+              << clipped << " layers clipped by far plane" << std::endl;
+}
+
 void setup_buffers()
 {
-    auto& device = RHI::get_current_device();
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+    auto  aspect  = float(extent.width) / float(extent.height);
+
+    auto geometry = std::vector<Vertex>{};
+    if (config.stress)
+        setup_stress_geometry(geometry, aspect);
+    else
+        setup_basic_geometry(geometry);
+
+    // NOTE: the stress scene keeps a second draw order after the first one,
+    // which swaps the two quads of every layer, i.e. draws front-to-back.
+    index_count = static_cast<uint>(geometry.size());
+    auto orders = config.stress ? 2u : 1u;
 
     vbuffer = execute([&]() {
         auto desc               = GPUBufferDescriptor{};
         desc.label              = "vertex_buffer";
-        desc.size               = sizeof(Vertex) * 6;
+        desc.size               = sizeof(Vertex) * geometry.size();
         desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
         desc.mapped_at_creation = true;
         return device.create_buffer(desc);
@@ -151,62 +338,29 @@ void setup_buffers()
     ibuffer = execute([&]() {
         auto desc               = GPUBufferDescriptor{};
         desc.label              = "index_buffer";
-        desc.size               = sizeof(uint32_t) * 6;
+        desc.size               = sizeof(uint32_t) * index_count * orders;
         desc.usage              = GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE;
         desc.mapped_at_creation = true;
         return device.create_buffer(desc);
     });
 
-    ubuffer = execute([&]() {
-        auto desc               = GPUBufferDescriptor{};
-        desc.label              = "uniform_buffer";
-        desc.size               = sizeof(glm::mat4x4);
-        desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
-        desc.mapped_at_creation = true;
-        return device.create_buffer(desc);
-    });
-
+    // vertices
     auto vertices = vbuffer.get_mapped_range<Vertex>();
+    for (uint i = 0; i < index_count; i++)
+        vertices.at(i) = geometry.at(i);
 
-    // positions (tri 1)
-    vertices.at(0).position = {0.0f, 0.0f, 0.0f};
-    vertices.at(1).position = {1.0f, 0.0f, 0.0f};
-    vertices.at(2).position = {0.0f, 1.0f, 0.0f};
-
-    // colors (tri 1)
-    vertices.at(0).color = {1.0f, 1.0f, 0.0f};
-    vertices.at(1).color = {1.0f, 1.0f, 0.0f};
-    vertices.at(2).color = {1.0f, 1.0f, 0.0f};
-
-    // positions (tri 2)
-    vertices.at(3).position = {0.0f - 0.25f, 0.0f - 0.25f, -1.0f};
-    vertices.at(4).position = {1.0f - 0.25f, 0.0f - 0.25f, -1.0f};
-    vertices.at(5).position = {0.0f - 0.25f, 1.0f - 0.25f, -1.0f};
+    // indices
+    auto indices = ibuffer.get_mapped_range<uint>();
+    for (uint i = 0; i < index_count; i++)
+        indices.at(i) = i;
 
-    // colors (tri 2)
-    vertices.at(3).color = {0.0f, 1.0f, 1.0f};
-    vertices.at(4).color = {0.0f, 1.0f, 1.0f};
-    vertices.at(5).color = {0.0f, 1.0f, 1.0f};
+    // every layer is 6 red vertices followed by 6 green vertices
+    if (config.stress)
+        for (uint i = 0; i < index_count; i++)
+            indices.at(index_count + i) = i - i % 12 + (i % 12 + 6) % 12;
 
-    // indices
-    auto indices  = ibuffer.get_mapped_range<uint>();
-    indices.at(0) = 0;
-    indices.at(1) = 1;
-    indices.at(2) = 2;
-    indices.at(3) = 3;
-    indices.at(4) = 4;
-    indices.at(5) = 5;
-
-    // uniform
-    auto& surface    = RHI::get_current_surface();
-    auto  extent     = surface.get_current_extent();
-    auto  uniform    = ubuffer.get_mapped_range<glm::mat4>();
-    auto  projection = glm::perspective(1.05f, float(extent.width) / float(extent.height), 0.1f, 100.0f);
-    auto  modelview  = glm::lookAt(
-        glm::vec3(0.0f, 0.0f, 3.0f),
-        glm::vec3(0.0f, 0.0f, 0.0f),
-        glm::vec3(0.0f, 1.0f, 0.0f));
-    uniform.at(0) = projection * modelview;
+    // transform, pushed at draw time
+    mvp = create_projection(aspect) * create_modelview();
 }
 
 void setup_depth_buffer()
@@ -217,7 +371,7 @@ void setup_depth_buffer()
     dbuffer = execute([&]() {
         auto extent          = surface.get_current_extent();
         auto desc            = GPUTextureDescriptor{};
-        desc.format          = GPUTextureFormat::DEPTH16UNORM;
+        desc.format          = config.format;
         desc.size.width      = extent.width;
         desc.size.height     = extent.height;
         desc.size.depth      = 1;
@@ -231,22 +385,155 @@ void setup_depth_buffer()
     dview = dbuffer.create_view();
 }
 
+// NOTE: queries are only used by the stress scene, to measure how many fragments the depth test rejects
+void setup_queries()
+{
+    auto& device = RHI::get_current_device();
+
+    if (!config.stress)
+        return;
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        statistics_queries[i] = execute([&]() {
+            auto desc                = GPUQuerySetDescriptor{};
+            desc.label               = "statistics_queries";
+            desc.type                = GPUQueryType::PIPELINE_STATISTICS;
+            desc.count               = STRESS_PASSES;
+            desc.pipeline_statistics = GPUPipelineStatistic::FRAGMENT_SHADER_INVOCATIONS;
+            return device.create_query_set(desc);
+        });
+
+        occlusion_queries[i] = execute([&]() {
+            auto desc  = GPUQuerySetDescriptor{};
+            desc.label = "occlusion_queries";
+            desc.type  = GPUQueryType::OCCLUSION;
+            desc.count = STRESS_PASSES;
+            return device.create_query_set(desc);
+        });
+    }
+
+    auto& queries                     = statistics_queries[0];
+    query_layout.fragment_invocations = queries.get_statistic_offset(GPUPipelineStatistic::FRAGMENT_SHADER_INVOCATIONS);
+    query_layout.statistics_stride    = queries.get_result_stride();
+    query_layout.samples_passed       = query_layout.statistics_stride * STRESS_PASSES;
+    query_layout.size                 = query_layout.samples_passed + sizeof(uint64_t) * STRESS_PASSES;
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        query_resolve[i] = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "query_resolve_buffer";
+            desc.size  = query_layout.size;
+            desc.usage = GPUBufferUsage::QUERY_RESOLVE | GPUBufferUsage::COPY_SRC;
+            return device.create_buffer(desc);
+        });
+
+        query_readback[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "query_readback_buffer";
+            desc.size               = query_layout.size;
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    }
+}
+
 void cleanup()
 {
     auto& device = RHI::get_current_device();
     device.wait();
 
     // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    if (config.stress) {
+        for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+            statistics_queries[i].destroy();
+            occlusion_queries[i].destroy();
+            query_resolve[i].destroy();
+            query_readback[i].destroy();
+        }
+    }
     dbuffer.destroy();
     ibuffer.destroy();
     vbuffer.destroy();
     vshader.destroy();
     fshader.destroy();
-    blayout.destroy();
     playout.destroy();
     pipeline.destroy();
 }
 
+auto read_queries(uint slot, uint pass) -> QueryResults
+{
+    auto data       = query_readback[slot].get_mapped_range<uint8_t>().data();
+    auto statistics = query_layout.statistics_stride * pass + query_layout.fragment_invocations;
+    auto occlusion  = query_layout.samples_passed + sizeof(uint64_t) * pass;
+    auto results    = QueryResults{};
+    std::memcpy(&results.fragment_invocations, data + statistics, sizeof(uint64_t));
+    std::memcpy(&results.samples_passed, data + occlusion, sizeof(uint64_t));
+    return results;
+}
+
+// Both quads of a layer cover the same pixels, and drawn front-to-back, every red sample fails the depth test,
+// even where the stored depths are equal. The front-to-back pass therefore rasterizes twice the samples that pass,
+// and rejects half of them. Rejected fragments which never invoke the fragment shader were rejected before shading
+// (early-z), the others after it (late-z). Drawn back-to-front, every red sample passes, and green samples only pass
+// where the depth buffer tells the quads apart, so the samples missing from the visible pass are the precision loss.
+void report_queries(uint slot)
+{
+    static QueryResults total[STRESS_PASSES] = {};
+
+    // the readback buffer in this slot was filled FRAMES_INFLIGHT frames ago, which is complete once its texture is acquired
+    if (frame_index < FRAMES_INFLIGHT)
+        return;
+
+    for (uint pass = 0; pass < STRESS_PASSES; pass++) {
+        auto results = read_queries(slot, pass);
+        total[pass].fragment_invocations += results.fragment_invocations;
+        total[pass].samples_passed += results.samples_passed;
+    }
+
+    if ((frame_index - FRAMES_INFLIGHT + 1) % FRAMES_PER_REPORT != 0)
+        return;
+
+    auto front      = std::max(double(total[FRONT_TO_BACK].samples_passed) / FRAMES_PER_REPORT, 1.0);
+    auto rasterized = front * 2.0;
+    auto shaded     = double(total[FRONT_TO_BACK].fragment_invocations) / FRAMES_PER_REPORT;
+    auto visible    = double(total[BACK_TO_FRONT].samples_passed) / FRAMES_PER_REPORT;
+    auto early_z    = std::clamp(rasterized - shaded, 0.0, front);
+    std::cout << "Rasterized: " << uint64_t(rasterized)
+              << ", Fragments: " << uint64_t(shaded)
+              << ", Samples Passed: " << uint64_t(front)
+              << ", Early-Z Rejected: " << 100.0 * early_z / front << "%"
+              << ", Late-Z Rejected: " << 100.0 * (front - early_z) / front << "%"
+              << ", Precision Loss: " << 100.0 * std::max(rasterized - visible, 0.0) / front << "%" << std::endl;
+
+    total[FRONT_TO_BACK] = {};
+    total[BACK_TO_FRONT] = {};
+}
+
+void draw_scene(GPUCommandBuffer& command, GPURenderPassDescriptor& render_pass, uint first_index)
+{
+    auto extent = RHI::get_current_surface().get_current_extent();
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(pipeline);
+    command.set_vertex_buffer(0, vbuffer);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+    command.set_push_constants(GPUShaderStage::VERTEX, 0, sizeof(glm::mat4), &mvp);
+    command.draw_indexed(index_count, 1, first_index, 0, 0);
+    command.end_render_pass();
+}
+
+void draw_stress_pass(GPUCommandBuffer& command, GPURenderPassDescriptor& render_pass, uint slot, StressPass pass)
+{
+    auto first_index = pass == FRONT_TO_BACK ? index_count : 0u;
+    command.begin_query(statistics_queries[slot], pass);
+    command.begin_query(occlusion_queries[slot], pass);
+    draw_scene(command, render_pass, first_index);
+    command.end_query(occlusion_queries[slot], pass);
+    command.end_query(statistics_queries[slot], pass);
+}
+
 void render()
 {
     auto& device  = RHI::get_current_device();
@@ -256,6 +543,10 @@ void render()
     auto texture = surface.get_current_texture();
     if (texture.suboptimal) return;
 
+    auto slot = static_cast<uint>(frame_index % FRAMES_INFLIGHT);
+    if (config.stress)
+        report_queries(slot);
+
     // create command buffer
     auto command = execute([&]() {
         auto desc  = GPUCommandBufferDescriptor{};
@@ -263,21 +554,6 @@ void render()
         return device.create_command_buffer(desc);
     });
 
-    // create bind group
-    auto bind_group = execute([&]() {
-        auto entry          = GPUBindGroupEntry{};
-        entry.type          = GPUBindingResourceType::BUFFER;
-        entry.binding       = 0;
-        entry.buffer.buffer = ubuffer;
-        entry.buffer.offset = 0;
-        entry.buffer.size   = 0;
-
-        auto desc   = GPUBindGroupDescriptor{};
-        desc.layout = blayout;
-        desc.entries.push_back(entry);
-        return device.create_bind_group(desc);
-    });
-
     auto color_attachment        = GPURenderPassColorAttachment{};
     color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
     color_attachment.load_op     = GPULoadOp::CLEAR;
@@ -286,7 +562,7 @@ void render()
 
     auto depth_attachment              = GPURenderPassDepthStencilAttachment{};
     depth_attachment.view              = dview;
-    depth_attachment.depth_clear_value = 1.0f;
+    depth_attachment.depth_clear_value = config.clear_value;
     depth_attachment.depth_load_op     = GPULoadOp::CLEAR;
     depth_attachment.depth_store_op    = GPUStoreOp::STORE;
     depth_attachment.depth_read_only   = false;
@@ -295,29 +571,52 @@ void render()
     render_pass.color_attachments        = {color_attachment};
     render_pass.depth_stencil_attachment = depth_attachment;
 
-    auto extent = surface.get_current_extent();
     command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
     command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
     command.resource_barrier(state_transition(dbuffer, undefined_state(), depth_stencil_attachment_state()));
-    command.begin_render_pass(render_pass);
-    command.set_viewport(0, 0, extent.width, extent.height);
-    command.set_scissor_rect(0, 0, extent.width, extent.height);
-    command.set_pipeline(pipeline);
-    command.set_vertex_buffer(0, vbuffer);
-    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
-    command.set_bind_group(0, bind_group);
-    command.draw_indexed(6, 1, 0, 0, 0);
-    command.end_render_pass();
+    if (!config.stress) {
+        draw_scene(command, render_pass, 0);
+    } else {
+        // NOTE: the front-to-back pass is only measured, the visible pass clears both targets again.
+        draw_stress_pass(command, render_pass, slot, FRONT_TO_BACK);
+        command.resource_barrier(state_transition(texture.texture, color_attachment_state(), color_attachment_state()));
+        command.resource_barrier(state_transition(dbuffer, depth_stencil_attachment_state(), depth_stencil_attachment_state()));
+        draw_stress_pass(command, render_pass, slot, BACK_TO_FRONT);
+    }
+
+    // queries are resolved on the GPU, and read back by the frame that reuses this slot
+    if (config.stress) {
+        command.resource_barrier(state_transition(query_resolve[slot], undefined_state(), copy_dst_state()));
+        command.resolve_query_set(statistics_queries[slot], 0, STRESS_PASSES, query_resolve[slot], 0);
+        command.resolve_query_set(occlusion_queries[slot], 0, STRESS_PASSES, query_resolve[slot], query_layout.samples_passed);
+        command.resource_barrier(state_transition(query_resolve[slot], copy_dst_state(), copy_src_state()));
+        command.copy_buffer_to_buffer(query_resolve[slot], 0, query_readback[slot], 0, query_layout.size);
+    }
     command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
     command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
     command.submit();
 
     // present this frame to swapchain
     texture.present();
+
+    // report average frame time
+    auto now = FrameTimer::Clock::now();
+    if (timer.frames > 0)
+        timer.accumulated += std::chrono::duration<double, std::milli>(now - timer.last).count();
+    timer.last = now;
+    if (++timer.frames % 240 == 0) {
+        std::cout << "Frame Time: " << timer.accumulated / 239.0 << " ms" << std::endl;
+        timer.accumulated = 0.0;
+        timer.frames      = 0;
+    }
+
+    frame_index++;
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    setup_config(argc, argv);
+
     auto win = execute([&]() {
         auto desc   = WindowDescriptor{};
         desc.title  = "Lyra Engine :: Sample";
@@ -358,6 +657,7 @@ int main()
     win->bind<WindowEvent::START>(setup_pipeline);
     win->bind<WindowEvent::START>(setup_buffers);
     win->bind<WindowEvent::START>(setup_depth_buffer);
+    win->bind<WindowEvent::START>(setup_queries);
     win->bind<WindowEvent::CLOSE>(cleanup);
     win->bind<WindowEvent::RENDER>(render);
     win->loop();
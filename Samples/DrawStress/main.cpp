@@ -0,0 +1,662 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+// NOTE: must match the layout in shader.slang
+struct FrameUniform
+{
+    float     time;
+    uint      grid;
+    glm::vec2 padding;
+};
+
+// NOTE: must match the layout in shader.slang
+struct ObjectUniform
+{
+    glm::vec4 color;
+    float     speed;
+    uint      index;
+    glm::vec2 padding;
+};
+
+// per instance vertex attributes of the instanced mode, the same data without the padding of uniforms
+struct Instance
+{
+    glm::vec4 color;
+    float     speed;
+};
+
+// How the per-draw data of each object reaches the vertex shader.
+enum class DrawMode : uint
+{
+    BIND_GROUP,     // a new bind group per draw, pointing at the uniforms of the object
+    DYNAMIC_OFFSET, // a single bind group, rebound with a dynamic offset per draw
+    PUSH_CONSTANTS, // uniforms of the object are pushed into the command buffer per draw
+    INSTANCED,      // a single draw, per object data comes from an instance buffer
+    COUNT,
+};
+
+enum Timestamp : uint
+{
+    PASS_BEGIN,
+    PASS_END,
+    TIMESTAMP_COUNT,
+};
+
+struct CaseStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last;
+    double            cpu     = 0.0;
+    double            gpu     = 0.0;
+    double            frame   = 0.0;
+    uint              samples = 0; // GPU samples
+    uint              frames  = 0;
+};
+
+constexpr uint     DRAW_COUNTS[]     = {10000, 25000, 50000, 100000};
+constexpr uint     MAX_DRAWS         = 100000;
+constexpr uint     MODE_COUNT        = static_cast<uint>(DrawMode::COUNT);
+constexpr uint     CASE_COUNT        = MODE_COUNT * std::size(DRAW_COUNTS);
+constexpr uint     FRAMES_PER_CASE   = 120;
+constexpr uint     FRAMES_INFLIGHT   = 3;
+constexpr uint64_t UNIFORM_ALIGNMENT = 256; // NOTE: minimum dynamic uniform buffer offset alignment
+
+const char* MODE_NAMES[] = {"BIND_GROUP", "DYNAMIC_OFFSET", "PUSH_CONSTANTS", "INSTANCED"};
+
+GPUShaderModule    vshader;
+GPUShaderModule    push_vshader;
+GPUShaderModule    instanced_vshader;
+GPUShaderModule    fshader;
+GPUBindGroupLayout static_blayout;
+GPUBindGroupLayout dynamic_blayout;
+GPUPipelineLayout  static_playout;
+GPUPipelineLayout  dynamic_playout;
+GPUPipelineLayout  push_playout;
+GPURenderPipeline  static_pipeline;
+GPURenderPipeline  dynamic_pipeline;
+GPURenderPipeline  push_pipeline;
+GPURenderPipeline  instanced_pipeline;
+GPUBuffer          vbuffer;
+GPUBuffer          ibuffer;
+GPUBuffer          object_buffer;
+GPUBuffer          instance_buffer;
+GPUBuffer          frame_buffers[FRAMES_INFLIGHT];
+GPUBindGroup       dynamic_bind_groups[FRAMES_INFLIGHT];
+GPUQuerySet        timestamps[FRAMES_INFLIGHT];
+GPUBuffer          timestamp_resolve[FRAMES_INFLIGHT];
+GPUBuffer          timestamp_readback[FRAMES_INFLIGHT];
+uint               timestamp_case[FRAMES_INFLIGHT];
+ObjectUniform      objects[MAX_DRAWS]; // CPU copy of the object buffer, for push constants
+double             timestamp_period = 1.0; // nanoseconds per tick
+uint64_t           frame_index      = 0;
+uint               current_case     = 0;
+float              elapsed          = 0.0f;
+CaseStats          stats;
+
+auto case_mode(uint index) -> DrawMode
+{
+    return static_cast<DrawMode>(index % MODE_COUNT);
+}
+
+auto case_draws(uint index) -> uint
+{
+    return DRAW_COUNTS[index / MODE_COUNT];
+}
+
+auto read_shader_source(const std::string& name) -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open(name);
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+// NOTE: when push_constants is given, it receives the push constant ranges reported by the shader reflection
+auto compile_shader(const std::string& name, const char* entry, const char* label,
+                    std::vector<GPUPushConstantRange>* push_constants = nullptr) -> GPUShaderModule
+{
+    auto& device = RHI::get_current_device();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = name;
+        desc.path   = name;
+        desc.source = read_shader_source(name);
+        return compiler->compile(desc);
+    });
+
+    if (push_constants) *push_constants = module->get_push_constant_ranges();
+
+    return execute([&]() {
+        auto code  = module->get_shader_blob(entry);
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = label;
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+}
+
+auto create_bind_group_layout(bool dynamic) -> GPUBindGroupLayout
+{
+    auto& device = RHI::get_current_device();
+
+    return execute([&]() {
+        auto frame                      = GPUBindGroupLayoutEntry{};
+        frame.type                      = GPUBindingResourceType::BUFFER;
+        frame.binding                   = 0;
+        frame.count                     = 1;
+        frame.visibility                = GPUShaderStage::VERTEX;
+        frame.buffer.type               = GPUBufferBindingType::UNIFORM;
+        frame.buffer.has_dynamic_offset = false;
+
+        auto object                      = GPUBindGroupLayoutEntry{};
+        object.type                      = GPUBindingResourceType::BUFFER;
+        object.binding                   = 1;
+        object.count                     = 1;
+        object.visibility                = GPUShaderStage::VERTEX;
+        object.buffer.type               = GPUBufferBindingType::UNIFORM;
+        object.buffer.has_dynamic_offset = dynamic;
+
+        auto desc    = GPUBindGroupLayoutDescriptor{};
+        desc.entries = {frame, object};
+        return device.create_bind_group_layout(desc);
+    });
+}
+
+auto create_pipeline(const GPUPipelineLayout& layout, const GPUShaderModule& vertex, bool instanced) -> GPURenderPipeline
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    return execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x2;
+        position.offset          = 0;
+        position.shader_location = 0;
+
+        auto vertices         = GPUVertexBufferLayout{};
+        vertices.attributes   = {position};
+        vertices.array_stride = sizeof(glm::vec2);
+        vertices.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto color            = GPUVertexAttribute{};
+        color.format          = GPUVertexFormat::FLOAT32x4;
+        color.offset          = offsetof(Instance, color);
+        color.shader_location = 1;
+
+        auto speed            = GPUVertexAttribute{};
+        speed.format          = GPUVertexFormat::FLOAT32;
+        speed.offset          = offsetof(Instance, speed);
+        speed.shader_location = 2;
+
+        auto instances         = GPUVertexBufferLayout{};
+        instances.attributes   = {color, speed};
+        instances.array_stride = sizeof(Instance);
+        instances.step_mode    = GPUVertexStepMode::INSTANCE;
+
+        auto target         = GPUColorTargetState{};
+        target.format       = surface.get_current_format();
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = layout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::ALWAYS;
+        desc.depth_stencil.depth_write_enabled     = false;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vertex;
+        desc.fragment.module                       = fshader;
+        desc.vertex.buffers.push_back(vertices);
+        if (instanced) desc.vertex.buffers.push_back(instances);
+        desc.fragment.targets.push_back(target);
+        return device.create_render_pipeline(desc);
+    });
+}
+
+void setup_pipelines()
+{
+    auto& device = RHI::get_current_device();
+
+    auto push_constants = std::vector<GPUPushConstantRange>{};
+
+    vshader           = compile_shader("shader.slang", "vsmain", "vertex_shader");
+    push_vshader      = compile_shader("shader.slang", "vspush", "push_vertex_shader", &push_constants);
+    instanced_vshader = compile_shader("shader.slang", "vsinstanced", "instanced_vertex_shader");
+    fshader           = compile_shader("shader.slang", "fsmain", "fragment_shader");
+
+    // NOTE: both layouts describe the same bindings, they only differ in how the object uniform is addressed
+    static_blayout  = create_bind_group_layout(false);
+    dynamic_blayout = create_bind_group_layout(true);
+
+    static_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {static_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    dynamic_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {dynamic_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    // NOTE: push constant ranges come from the shader reflection, ObjectUniform has to match the reflected block
+    push_playout = execute([&]() {
+        auto desc                 = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts   = {dynamic_blayout};
+        desc.push_constant_ranges = push_constants;
+        return device.create_pipeline_layout(desc);
+    });
+
+    // the push constant and instanced pipelines only read the frame uniform, and reuse the dynamic layout at offset 0
+    static_pipeline    = create_pipeline(static_playout, vshader, false);
+    dynamic_pipeline   = create_pipeline(dynamic_playout, vshader, false);
+    push_pipeline      = create_pipeline(push_playout, push_vshader, false);
+    instanced_pipeline = create_pipeline(dynamic_playout, instanced_vshader, true);
+}
+
+void setup_buffers()
+{
+    auto& device = RHI::get_current_device();
+
+    auto create_buffer = [&](const char* label, uint64_t size, uint usage) {
+        return execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = label;
+            desc.size               = size;
+            desc.usage              = usage | GPUBufferUsage::MAP_WRITE;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    };
+
+    vbuffer         = create_buffer("vertex_buffer", sizeof(glm::vec2) * 3, GPUBufferUsage::VERTEX);
+    ibuffer         = create_buffer("index_buffer", sizeof(uint32_t) * 3, GPUBufferUsage::INDEX);
+    object_buffer   = create_buffer("object_buffer", UNIFORM_ALIGNMENT * MAX_DRAWS, GPUBufferUsage::UNIFORM);
+    instance_buffer = create_buffer("instance_buffer", sizeof(Instance) * MAX_DRAWS, GPUBufferUsage::VERTEX);
+
+    auto vertices  = vbuffer.get_mapped_range<glm::vec2>();
+    vertices.at(0) = glm::vec2(-0.3f, -0.3f);
+    vertices.at(1) = glm::vec2(+0.3f, -0.3f);
+    vertices.at(2) = glm::vec2(+0.0f, +0.3f);
+
+    auto indices  = ibuffer.get_mapped_range<uint32_t>();
+    indices.at(0) = 0;
+    indices.at(1) = 1;
+    indices.at(2) = 2;
+
+    // every mode draws the same objects, with the same colors and speeds
+    auto rng       = std::mt19937(42);
+    auto unit      = std::uniform_real_distribution<float>(0.0f, 1.0f);
+    auto uniforms  = object_buffer.get_mapped_range<uint8_t>();
+    auto instances = instance_buffer.get_mapped_range<Instance>();
+    for (uint i = 0; i < MAX_DRAWS; i++) {
+        auto& object = objects[i];
+        object.color = glm::vec4(unit(rng), unit(rng), unit(rng), 1.0f);
+        object.speed = unit(rng) * 4.0f - 2.0f;
+        object.index = i;
+        std::memcpy(&uniforms.at(i * UNIFORM_ALIGNMENT), &object, sizeof(object));
+
+        instances.at(i).color = object.color;
+        instances.at(i).speed = object.speed;
+    }
+
+    // one small frame uniform per frame in flight, so that the CPU never writes what the GPU is reading
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        frame_buffers[i] = create_buffer("frame_buffer", UNIFORM_ALIGNMENT, GPUBufferUsage::UNIFORM);
+
+        dynamic_bind_groups[i] = execute([&]() {
+            auto frame          = GPUBindGroupEntry{};
+            frame.type          = GPUBindingResourceType::BUFFER;
+            frame.binding       = 0;
+            frame.index         = 0;
+            frame.buffer.buffer = frame_buffers[i];
+            frame.buffer.offset = 0;
+            frame.buffer.size   = sizeof(FrameUniform);
+
+            auto object          = GPUBindGroupEntry{};
+            object.type          = GPUBindingResourceType::BUFFER;
+            object.binding       = 1;
+            object.index         = 0;
+            object.buffer.buffer = object_buffer;
+            object.buffer.offset = 0;
+            object.buffer.size   = sizeof(ObjectUniform);
+
+            auto desc    = GPUBindGroupDescriptor{};
+            desc.layout  = dynamic_blayout;
+            desc.entries = {frame, object};
+            return device.create_bind_group(desc);
+        });
+    }
+}
+
+void setup_timestamps()
+{
+    auto& device = RHI::get_current_device();
+
+    timestamp_period = device.get_timestamp_period();
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        timestamps[i] = execute([&]() {
+            auto desc  = GPUQuerySetDescriptor{};
+            desc.label = "timestamp_queries";
+            desc.type  = GPUQueryType::TIMESTAMP;
+            desc.count = TIMESTAMP_COUNT;
+            return device.create_query_set(desc);
+        });
+
+        timestamp_resolve[i] = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "timestamp_resolve_buffer";
+            desc.size  = sizeof(uint64_t) * TIMESTAMP_COUNT;
+            desc.usage = GPUBufferUsage::QUERY_RESOLVE | GPUBufferUsage::COPY_SRC;
+            return device.create_buffer(desc);
+        });
+
+        timestamp_readback[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "timestamp_readback_buffer";
+            desc.size               = sizeof(uint64_t) * TIMESTAMP_COUNT;
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    }
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        timestamps[i].destroy();
+        timestamp_resolve[i].destroy();
+        timestamp_readback[i].destroy();
+        frame_buffers[i].destroy();
+    }
+    vbuffer.destroy();
+    ibuffer.destroy();
+    object_buffer.destroy();
+    instance_buffer.destroy();
+    vshader.destroy();
+    push_vshader.destroy();
+    instanced_vshader.destroy();
+    fshader.destroy();
+    static_blayout.destroy();
+    dynamic_blayout.destroy();
+    static_playout.destroy();
+    dynamic_playout.destroy();
+    push_playout.destroy();
+    static_pipeline.destroy();
+    dynamic_pipeline.destroy();
+    push_pipeline.destroy();
+    instanced_pipeline.destroy();
+}
+
+void update(const WindowInput& input)
+{
+    elapsed += input.delta_time;
+}
+
+void draw_objects(GPUCommandBuffer& command, DrawMode mode, uint draws, uint slot)
+{
+    auto& device = RHI::get_current_device();
+
+    switch (mode) {
+        case DrawMode::BIND_GROUP:
+            // the way render() of the basic samples binds its uniforms, once per draw instead of once per frame
+            command.set_pipeline(static_pipeline);
+            command.set_vertex_buffer(0, vbuffer);
+            for (uint i = 0; i < draws; i++) {
+                auto bind_group = execute([&]() {
+                    auto frame          = GPUBindGroupEntry{};
+                    frame.type          = GPUBindingResourceType::BUFFER;
+                    frame.binding       = 0;
+                    frame.index         = 0;
+                    frame.buffer.buffer = frame_buffers[slot];
+                    frame.buffer.offset = 0;
+                    frame.buffer.size   = sizeof(FrameUniform);
+
+                    auto object          = GPUBindGroupEntry{};
+                    object.type          = GPUBindingResourceType::BUFFER;
+                    object.binding       = 1;
+                    object.index         = 0;
+                    object.buffer.buffer = object_buffer;
+                    object.buffer.offset = i * UNIFORM_ALIGNMENT;
+                    object.buffer.size   = sizeof(ObjectUniform);
+
+                    auto desc    = GPUBindGroupDescriptor{};
+                    desc.layout  = static_blayout;
+                    desc.entries = {frame, object};
+                    return device.create_bind_group(desc);
+                });
+                command.set_bind_group(0, bind_group);
+                command.draw_indexed(3, 1, 0, 0, 0);
+            }
+            break;
+
+        case DrawMode::DYNAMIC_OFFSET:
+            command.set_pipeline(dynamic_pipeline);
+            command.set_vertex_buffer(0, vbuffer);
+            for (uint i = 0; i < draws; i++) {
+                command.set_bind_group(0, dynamic_bind_groups[slot], {static_cast<uint32_t>(i * UNIFORM_ALIGNMENT)});
+                command.draw_indexed(3, 1, 0, 0, 0);
+            }
+            break;
+
+        case DrawMode::PUSH_CONSTANTS:
+            command.set_pipeline(push_pipeline);
+            command.set_vertex_buffer(0, vbuffer);
+            command.set_bind_group(0, dynamic_bind_groups[slot], {0});
+            for (uint i = 0; i < draws; i++) {
+                command.set_push_constants(GPUShaderStage::VERTEX, 0, sizeof(ObjectUniform), &objects[i]);
+                command.draw_indexed(3, 1, 0, 0, 0);
+            }
+            break;
+
+        case DrawMode::INSTANCED:
+            command.set_pipeline(instanced_pipeline);
+            command.set_vertex_buffer(0, vbuffer);
+            command.set_vertex_buffer(1, instance_buffer);
+            command.set_bind_group(0, dynamic_bind_groups[slot], {0});
+            command.draw_indexed(3, draws, 0, 0, 0);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void read_timestamps(uint slot)
+{
+    // the readback buffer in this slot was filled FRAMES_INFLIGHT frames ago, which is complete once its texture is acquired
+    if (frame_index < FRAMES_INFLIGHT || timestamp_case[slot] != current_case)
+        return;
+
+    auto values = timestamp_readback[slot].get_mapped_range<uint64_t>();
+    stats.gpu += double(values.at(PASS_END) - values.at(PASS_BEGIN)) * timestamp_period * 1e-6;
+    stats.samples++;
+}
+
+void report(double cpu_time)
+{
+    auto now = CaseStats::Clock::now();
+    if (stats.frames > 0)
+        stats.frame += std::chrono::duration<double, std::milli>(now - stats.last).count();
+    stats.last = now;
+    stats.cpu += cpu_time;
+
+    // every case runs for a fixed number of frames, then the next mode or draw count takes over
+    if (++stats.frames == FRAMES_PER_CASE) {
+        auto draws   = double(case_draws(current_case));
+        auto cpu     = stats.cpu / FRAMES_PER_CASE;
+        auto gpu     = stats.gpu / double(std::max(stats.samples, 1u));
+        auto padding = std::string(14 - std::strlen(MODE_NAMES[current_case % MODE_COUNT]), ' ');
+        std::cout << "Mode: " << MODE_NAMES[current_case % MODE_COUNT] << padding
+                  << ", Draws: " << draws
+                  << ", CPU: " << cpu << " ms (" << cpu * 1000.0 / draws << " us/draw)"
+                  << ", GPU: " << gpu << " ms (" << gpu * 1000.0 / draws << " us/draw)"
+                  << ", Frame Time: " << stats.frame / (FRAMES_PER_CASE - 1) << " ms" << std::endl;
+
+        current_case = (current_case + 1) % CASE_COUNT;
+        stats        = CaseStats{};
+    }
+}
+
+void render()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    auto slot  = static_cast<uint>(frame_index % FRAMES_INFLIGHT);
+    auto mode  = case_mode(current_case);
+    auto draws = case_draws(current_case);
+
+    read_timestamps(slot);
+    timestamp_case[slot] = current_case;
+
+    auto frame       = frame_buffers[slot].get_mapped_range<FrameUniform>();
+    frame.at(0).time = elapsed;
+    frame.at(0).grid = static_cast<uint>(std::ceil(std::sqrt(double(draws))));
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = texture.view;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = {color_attachment};
+    render_pass.depth_stencil_attachment = {};
+
+    // NOTE: CPU time covers recording and submitting the pass, which is where the cost of each mode differs
+    auto start = CaseStats::Clock::now();
+
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    command.write_timestamp(timestamps[slot], PASS_BEGIN);
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+    draw_objects(command, mode, draws, slot);
+    command.end_render_pass();
+    command.write_timestamp(timestamps[slot], PASS_END);
+    command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+
+    // timestamps are read back by the frame that reuses this slot
+    command.resource_barrier(state_transition(timestamp_resolve[slot], undefined_state(), copy_dst_state()));
+    command.resolve_query_set(timestamps[slot], 0, TIMESTAMP_COUNT, timestamp_resolve[slot], 0);
+    command.resource_barrier(state_transition(timestamp_resolve[slot], copy_dst_state(), copy_src_state()));
+    command.copy_buffer_to_buffer(timestamp_resolve[slot], 0, timestamp_readback[slot], 0, sizeof(uint64_t) * TIMESTAMP_COUNT);
+
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    auto cpu = std::chrono::duration<double, std::milli>(CaseStats::Clock::now() - start).count();
+
+    // present this frame to swapchain
+    texture.present();
+
+    report(cpu);
+    frame_index++;
+}
+
+int main()
+{
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    // NOTE: validation is disabled, it would dominate the CPU cost of every draw
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Immediate; // NOTE: do not hide frame time behind vsync
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipelines);
+    win->bind<WindowEvent::START>(setup_buffers);
+    win->bind<WindowEvent::START>(setup_timestamps);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cmath>
+
+#include "BC1.h"
+
+namespace
+{
+    auto to_565(const float* color) -> uint16_t
+    {
+        auto r = static_cast<uint16_t>(std::clamp(std::lround(color[0] * 31.0f / 255.0f), 0l, 31l));
+        auto g = static_cast<uint16_t>(std::clamp(std::lround(color[1] * 63.0f / 255.0f), 0l, 63l));
+        auto b = static_cast<uint16_t>(std::clamp(std::lround(color[2] * 31.0f / 255.0f), 0l, 31l));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    // expands to 8 bits the way the hardware does, by replicating the high bits
+    void from_565(uint16_t packed, int* color)
+    {
+        auto r   = (packed >> 11) & 31;
+        auto g   = (packed >> 5) & 63;
+        auto b   = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+} // namespace
+
+void bc1_compress_block(const uint8_t* rgba, uint8_t* block)
+{
+    // mean and covariance of the 16 colors
+    float mean[3] = {};
+    for (uint32_t i = 0; i < 16; i++)
+        for (uint32_t c = 0; c < 3; c++)
+            mean[c] += rgba[i * 4 + c] / 16.0f;
+
+    float covariance[6] = {}; // rr, rg, rb, gg, gb, bb
+    for (uint32_t i = 0; i < 16; i++) {
+        float r = rgba[i * 4 + 0] - mean[0];
+        float g = rgba[i * 4 + 1] - mean[1];
+        float b = rgba[i * 4 + 2] - mean[2];
+        covariance[0] += r * r;
+        covariance[1] += r * g;
+        covariance[2] += r * b;
+        covariance[3] += g * g;
+        covariance[4] += g * b;
+        covariance[5] += b * b;
+    }
+
+    // principal axis by power iteration, a handful of steps is plenty for 16 points
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (uint32_t step = 0; step < 8; step++) {
+        float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+        float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+        float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+        float n = std::max({std::abs(x), std::abs(y), std::abs(z)});
+        if (n == 0.0f)
+            break;
+        axis[0] = x / n;
+        axis[1] = y / n;
+        axis[2] = z / n;
+    }
+
+    float length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+    // the extremes along the axis become the endpoints
+    float lo = 0.0f, hi = 0.0f;
+    for (uint32_t i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (uint32_t c = 0; c < 3; c++)
+            t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+        t /= length;
+        lo = std::min(lo, t);
+        hi = std::max(hi, t);
+    }
+
+    float e0[3], e1[3];
+    for (uint32_t c = 0; c < 3; c++) {
+        e0[c] = mean[c] + axis[c] * hi;
+        e1[c] = mean[c] + axis[c] * lo;
+    }
+
+    // NOTE: color0 > color1 selects the 4 color mode, equal endpoints fall back to 3 colors, where index 0 is still color0
+    auto c0 = to_565(e0);
+    auto c1 = to_565(e1);
+    if (c0 < c1)
+        std::swap(c0, c1);
+
+    int palette[4][3];
+    from_565(c0, palette[0]);
+    from_565(c1, palette[1]);
+    for (uint32_t c = 0; c < 3; c++) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    auto indices = uint32_t(0);
+    if (c0 != c1) {
+        for (uint32_t i = 0; i < 16; i++) {
+            auto best     = uint32_t(0);
+            auto distance = 1 << 30;
+            for (uint32_t p = 0; p < 4; p++) {
+                int dr = rgba[i * 4 + 0] - palette[p][0];
+                int dg = rgba[i * 4 + 1] - palette[p][1];
+                int db = rgba[i * 4 + 2] - palette[p][2];
+                int d  = dr * dr + dg * dg + db * db;
+                if (d < distance) {
+                    distance = d;
+                    best     = p;
+                }
+            }
+            indices |= best << (i * 2);
+        }
+    }
+
+    block[0] = static_cast<uint8_t>(c0 & 0xFF);
+    block[1] = static_cast<uint8_t>(c0 >> 8);
+    block[2] = static_cast<uint8_t>(c1 & 0xFF);
+    block[3] = static_cast<uint8_t>(c1 >> 8);
+    for (uint32_t i = 0; i < 4; i++)
+        block[4 + i] = static_cast<uint8_t>(indices >> (i * 8));
+}
+
+void bc1_compress(const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* blocks)
+{
+    auto columns = (width + 3) / 4;
+    auto rows    = (height + 3) / 4;
+
+    uint8_t texels[64];
+    for (uint32_t by = 0; by < rows; by++) {
+        for (uint32_t bx = 0; bx < columns; bx++) {
+            for (uint32_t y = 0; y < 4; y++) {
+                for (uint32_t x = 0; x < 4; x++) {
+                    auto sx = std::min(bx * 4 + x, width - 1);
+                    auto sy = std::min(by * 4 + y, height - 1);
+                    std::copy_n(rgba + (size_t(sy) * width + sx) * 4, 4, texels + (y * 4 + x) * 4);
+                }
+            }
+            bc1_compress_block(texels, blocks + (size_t(by) * columns + bx) * 8);
+        }
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// BC1 (DXT1) block compression, 4x4 texels into 8 bytes, 4 color mode only.
+// The compressor picks endpoints along the principal axis of each block, then the closest of the
+// 4 palette colors for every texel: a fraction of the quality of a real encoder, at a fraction of its cost.
+
+// Compresses one block of 16 RGBA8 texels, row major.
+void bc1_compress_block(const uint8_t* rgba, uint8_t* block);
+
+// Compresses a whole image, rows of blocks are written without padding.
+// Partial blocks at the right and bottom edges repeat the last column and row.
+void bc1_compress(const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* blocks);
@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <cstring>
+
+#include "FileMapping.h"
+#include "MipContainer.h"
+
+auto MipContainer::load(const std::string& path) -> std::unique_ptr<MipContainer>
+{
+    auto container     = std::unique_ptr<MipContainer>(new MipContainer());
+    container->mapping = map_file(path, container->mapping_size, container->handle);
+    if (!container->mapping)
+        return nullptr;
+
+    // validate the whole level index once, so that streaming never has to
+    auto  size   = container->mapping_size;
+    auto* header = reinterpret_cast<const MipHeader*>(container->mapping);
+    if (size < sizeof(MipHeader) || std::memcmp(header->magic, MIP_MAGIC, sizeof(MIP_MAGIC)) != 0 || header->version != MIP_VERSION ||
+        header->format != MipFormat::BC1 || header->texture_count == 0 || header->level_count == 0 || header->level_count > 16)
+        return nullptr;
+
+    auto index_size = uint64_t(header->texture_count) * header->level_count * sizeof(MipLevel);
+    if (header->index_offset % alignof(MipLevel) != 0 || header->index_offset > size || index_size > size - header->index_offset)
+        return nullptr;
+
+    container->header = header;
+    container->levels = reinterpret_cast<const MipLevel*>(container->mapping + header->index_offset);
+
+    for (uint t = 0; t < header->texture_count; t++) {
+        for (uint l = 0; l < header->level_count; l++) {
+            auto& level  = container->level(t, l);
+            auto  width  = std::max(header->width >> l, 1u);
+            auto  height = std::max(header->height >> l, 1u);
+            if (level.width != width || level.height != height ||
+                level.row_bytes != mip_blocks(width) * MIP_BLOCK_BYTES || level.rows != mip_blocks(height) ||
+                level.size != uint64_t(level.rows) * level.row_bytes ||
+                level.offset < header->data_offset || level.offset > size || level.size > size - level.offset)
+                return nullptr;
+        }
+    }
+
+    return container;
+}
+
+MipContainer::~MipContainer()
+{
+    if (mapping)
+        unmap_file(mapping, mapping_size, handle);
+}
+
+auto MipContainer::chain_bytes(uint texture, uint first) const -> uint64_t
+{
+    auto bytes = uint64_t(0);
+    for (uint l = first; l < header->level_count; l++)
+        bytes += level(texture, l).size;
+    return bytes;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <Lyra/Common.hpp>
+
+// On-disk layout of a mip container, little endian, modelled after KTX2:
+//
+//   MipHeader
+//   level index: texture_count x level_count MipLevel, texture major
+//   level data, each aligned to MIP_ALIGNMENT, coarsest level of every texture first
+//
+// All textures in a container share their format, size and number of levels. Levels are stored from the
+// coarsest to the finest across all textures, so the tails that are loaded up front are one contiguous
+// range at the start of the data, and the finest levels, which are streamed on demand, come last.
+
+constexpr char     MIP_MAGIC[8]  = {'L', 'Y', 'R', 'A', 'M', 'I', 'P', 'S'};
+constexpr uint32_t MIP_VERSION   = 1;
+constexpr uint64_t MIP_ALIGNMENT = 16;
+
+enum class MipFormat : uint32_t
+{
+    BC1, // 4x4 blocks of 8 bytes, RGB with 1 bit alpha
+};
+
+struct MipHeader
+{
+    char      magic[8];
+    uint32_t  version;
+    MipFormat format;
+    uint32_t  texture_count;
+    uint32_t  level_count;
+    uint32_t  width;  // of level 0
+    uint32_t  height; // of level 0
+    uint64_t  index_offset;
+    uint64_t  data_offset;
+};
+
+struct MipLevel
+{
+    uint64_t offset; // from the start of the file
+    uint64_t size;   // rows x row_bytes
+    uint32_t width;  // in texels, may be smaller than a block
+    uint32_t height;
+    uint32_t row_bytes; // one row of blocks
+    uint32_t rows;      // rows of blocks
+};
+
+constexpr uint MIP_BLOCK_SIZE  = 4;
+constexpr uint MIP_BLOCK_BYTES = 8;
+
+inline auto mip_blocks(uint texels) -> uint { return (texels + MIP_BLOCK_SIZE - 1) / MIP_BLOCK_SIZE; }
+
+// Read-only memory mapped mip container.
+// Nothing is read at load time beyond the header and the level index, levels are paged in by the
+// operating system when they are first copied into staging memory.
+class MipContainer
+{
+public:
+    // Returns nullptr when the file cannot be mapped or is not a valid container.
+    static auto load(const std::string& path) -> std::unique_ptr<MipContainer>;
+
+    ~MipContainer();
+
+    MipContainer(const MipContainer&)            = delete;
+    MipContainer& operator=(const MipContainer&) = delete;
+
+    auto texture_count() const -> uint { return header->texture_count; }
+    auto level_count() const -> uint { return header->level_count; }
+    auto format() const -> MipFormat { return header->format; }
+    auto file_bytes() const -> uint64_t { return mapping_size; }
+
+    auto level(uint texture, uint level) const -> const MipLevel& { return levels[texture * header->level_count + level]; }
+    auto data(const MipLevel& level) const -> const uint8_t* { return mapping + level.offset; }
+
+    // bytes of the levels [first, level_count) of one texture, which is what a texture with that top level occupies
+    auto chain_bytes(uint texture, uint first) const -> uint64_t;
+
+private:
+    MipContainer() = default;
+
+private:
+    const uint8_t*   mapping      = nullptr;
+    uint64_t         mapping_size = 0;
+    void*            handle       = nullptr; // platform file mapping
+    const MipHeader* header       = nullptr;
+    const MipLevel*  levels       = nullptr;
+};
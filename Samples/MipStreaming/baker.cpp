@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BC1.h"
+#include "MipContainer.h"
+
+// Bakes a mip container of procedural textures.
+//
+//   texture-baker <output> <count> <size>
+//
+// Every texture gets a full mip chain down to 1x1, box filtered from the level above, and BC1 compressed.
+// The patterns have detail at every scale, so that the level being sampled is visible on screen.
+
+using Image = std::vector<uint8_t>; // RGBA8
+
+auto hue(float h) -> std::array<float, 3>
+{
+    auto channel = [&](float offset) { return std::clamp(std::abs(std::fmod(h * 6.0f + offset, 6.0f) - 3.0f) - 1.0f, 0.0f, 1.0f); };
+    return {channel(0.0f), channel(4.0f), channel(2.0f)};
+}
+
+// rings around the center, a checker of 8x8 cells, and a grid of thin lines every 16 texels
+auto generate(uint index, uint count, uint size) -> Image
+{
+    auto image = Image(size_t(size) * size * 4);
+    auto base  = hue(float(index) / float(count));
+    auto other = hue(float(index) / float(count) + 0.5f);
+
+    for (uint y = 0; y < size; y++) {
+        for (uint x = 0; x < size; x++) {
+            float u      = (float(x) + 0.5f) / float(size) - 0.5f;
+            float v      = (float(y) + 0.5f) / float(size) - 0.5f;
+            float ring   = 0.5f + 0.5f * std::cos(std::sqrt(u * u + v * v) * 80.0f);
+            bool  check  = ((x * 8 / size) + (y * 8 / size)) % 2 == 0;
+            bool  line   = x % 16 == 0 || y % 16 == 0;
+            float shade  = (check ? 0.9f : 0.6f) * (0.7f + 0.3f * ring);
+            auto* texel  = &image[(size_t(y) * size + x) * 4];
+            for (uint c = 0; c < 3; c++) {
+                float value = line ? 0.1f : base[c] * shade + other[c] * (1.0f - shade) * 0.3f;
+                texel[c]    = static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+            texel[3] = 255;
+        }
+    }
+    return image;
+}
+
+// 2x2 box filter, odd sizes repeat the last row and column
+auto downsample(const Image& src, uint width, uint height) -> Image
+{
+    auto w   = std::max(width / 2, 1u);
+    auto h   = std::max(height / 2, 1u);
+    auto dst = Image(size_t(w) * h * 4);
+    for (uint y = 0; y < h; y++) {
+        for (uint x = 0; x < w; x++) {
+            auto x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+            auto y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+            for (uint c = 0; c < 4; c++) {
+                auto sum = src[(size_t(y0) * width + x0) * 4 + c] + src[(size_t(y0) * width + x1) * 4 + c] +
+                           src[(size_t(y1) * width + x0) * 4 + c] + src[(size_t(y1) * width + x1) * 4 + c];
+                dst[(size_t(y) * w + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+void pad_to(std::ofstream& out, uint64_t& offset, uint64_t alignment)
+{
+    static const char zeros[MIP_ALIGNMENT] = {};
+    auto padding = (alignment - offset % alignment) % alignment;
+    out.write(zeros, static_cast<std::streamsize>(padding));
+    offset += padding;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 4) {
+        std::cerr << "usage: texture-baker <output> <count> <size>" << std::endl;
+        return 1;
+    }
+
+    auto output = std::string(argv[1]);
+    auto count  = static_cast<uint>(std::stoul(argv[2]));
+    auto size   = static_cast<uint>(std::stoul(argv[3]));
+    if (count == 0 || size == 0 || (size & (size - 1)) != 0) {
+        std::cerr << "texture count must be positive, and size a power of two" << std::endl;
+        return 1;
+    }
+
+    auto level_count = uint(1);
+    while ((size >> level_count) > 0)
+        level_count++;
+
+    // compress every level of every texture first, the file is written coarsest level first
+    auto blocks = std::vector<std::vector<uint8_t>>(size_t(count) * level_count);
+    auto levels = std::vector<MipLevel>(size_t(count) * level_count);
+    for (uint t = 0; t < count; t++) {
+        auto image = generate(t, count, size);
+        for (uint l = 0; l < level_count; l++) {
+            auto  extent    = std::max(size >> l, 1u);
+            auto& level     = levels[t * level_count + l];
+            level.width     = extent;
+            level.height    = extent;
+            level.row_bytes = mip_blocks(extent) * MIP_BLOCK_BYTES;
+            level.rows      = mip_blocks(extent);
+            level.size      = uint64_t(level.rows) * level.row_bytes;
+
+            auto& data = blocks[t * level_count + l];
+            data.resize(level.size);
+            bc1_compress(image.data(), extent, extent, data.data());
+
+            if (l + 1 < level_count)
+                image = downsample(image, extent, extent);
+        }
+    }
+
+    auto out = std::ofstream(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "failed to open " << output << std::endl;
+        return 1;
+    }
+
+    auto header          = MipHeader{};
+    header.version       = MIP_VERSION;
+    header.format        = MipFormat::BC1;
+    header.texture_count = count;
+    header.level_count   = level_count;
+    header.width         = size;
+    header.height        = size;
+    header.index_offset  = sizeof(MipHeader);
+    header.data_offset   = header.index_offset + levels.size() * sizeof(MipLevel);
+    std::copy(std::begin(MIP_MAGIC), std::end(MIP_MAGIC), header.magic);
+
+    // the index is written last, once the offsets are known
+    auto offset = header.data_offset;
+    out.seekp(static_cast<std::streamoff>(offset));
+    for (uint l = level_count; l-- > 0;) {
+        for (uint t = 0; t < count; t++) {
+            pad_to(out, offset, MIP_ALIGNMENT);
+            auto& level  = levels[t * level_count + l];
+            auto& data   = blocks[t * level_count + l];
+            level.offset = offset;
+            out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            offset += data.size();
+        }
+    }
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(levels.data()), static_cast<std::streamsize>(levels.size() * sizeof(MipLevel)));
+    if (!out) {
+        std::cerr << "failed to write " << output << std::endl;
+        return 1;
+    }
+
+    std::cout << "Baked " << count << " textures of " << size << "x" << size << " with " << level_count << " levels"
+              << ", " << double(offset) / (1024.0 * 1024.0) << " MB" << std::endl;
+    return 0;
+}
@@ -0,0 +1,810 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+#include "MipContainer.h"
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+// NOTE: must match the layout in shader.slang
+struct Frame
+{
+    glm::mat4 view_proj;
+    uint      show_levels;
+    uint      padding[3];
+};
+
+// NOTE: must match the layout in shader.slang, pushed with every draw
+struct DrawPanel
+{
+    glm::vec4 origin;
+    glm::vec4 axis_u;
+    glm::vec4 axis_v;
+    uint      texture;
+    uint      level;
+    uint      padding[2];
+};
+
+// One texture of the container, and the part of its mip chain which is on the GPU.
+// A GPU texture always holds the levels [resident, level_count), finer levels are added by replacing it.
+struct StreamedTexture
+{
+    GPUTexture     texture;
+    GPUTextureView view;
+    uint           resident   = 0;    // finest level on the GPU, level_count when nothing is
+    uint           desired    = 0;    // finest level worth having, from the footprint on screen
+    uint           target     = 0;    // desired level, after the residency budget
+    float          footprint  = 0.0f; // edge length on screen in pixels, 0 when off screen
+    uint64_t       generation = 0;    // bumped whenever texture is replaced
+};
+
+// textures replaced by streaming, kept alive until no frame in flight uses them
+struct RetiredTexture
+{
+    GPUTexture     texture;
+    GPUTextureView view;
+    uint64_t       frame;
+};
+
+struct StreamingConfig
+{
+    bool show_levels = false;
+};
+
+struct StreamingStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last;
+    double            elapsed   = 0.0; // seconds
+    double            frame     = 0.0; // milliseconds
+    uint64_t          uploaded  = 0;   // bytes copied from the container
+    uint              uploads   = 0;   // textures replaced with more levels
+    uint              evictions = 0;   // textures replaced with fewer levels
+    uint64_t          peak      = 0;   // resident bytes
+    uint              frames    = 0;
+};
+
+constexpr uint     TAIL_SIZE             = 64;       // levels of this size and below are loaded first, and never evicted
+constexpr uint64_t RESIDENCY_BUDGET      = 16 << 20; // bytes of texture levels on the GPU
+constexpr uint64_t STAGING_SIZE          = 4 << 20;  // bytes of uploads per frame
+constexpr uint     COPY_PITCH_ALIGNMENT  = 256;      // NOTE: row pitch alignment of buffer to texture copies in D3D12
+constexpr uint     COPY_OFFSET_ALIGNMENT = 512;      // NOTE: placement alignment of buffer to texture copies in D3D12
+constexpr float    PANEL_SIZE            = 4.0f;     // width and height of a panel, in meters
+constexpr float    PANEL_SPACING         = 4.5f;     // distance between panels along a wall
+constexpr float    CORRIDOR_WIDTH        = 6.0f;
+constexpr float    CAMERA_SPEED          = 4.0f; // meters per second
+constexpr float    FOVY                  = 1.05f;
+constexpr float    NEAR_PLANE            = 0.1f;
+constexpr float    FAR_PLANE             = 200.0f;
+constexpr uint     FRAMES_INFLIGHT       = 3;
+constexpr uint     FRAMES_PER_REPORT     = 120;
+
+GPUShaderModule               vshader;
+GPUShaderModule               fshader;
+GPUBindGroupLayout            blayout;
+GPUPipelineLayout             playout;
+GPURenderPipeline             pipeline;
+GPUSampler                    sampler;
+GPUBuffer                     frame_ubuffer;
+GPUBuffer                     staging[FRAMES_INFLIGHT];
+GPUBindGroup                  bind_groups[FRAMES_INFLIGHT];
+std::vector<uint64_t>         bound_generations[FRAMES_INFLIGHT]; // generation of every texture in each bind group
+std::vector<StreamedTexture>  textures;
+std::vector<DrawPanel>        panels;
+std::deque<RetiredTexture>    retired;
+std::unique_ptr<MipContainer> container;
+uint                          tail_level     = 0;
+uint64_t                      resident_bytes = 0;
+float                         camera_z       = 0.0f;
+float                         camera_dir     = -1.0f;
+uint64_t                      frame_index    = 0;
+StreamingConfig               config;
+StreamingStats                stats;
+
+auto align_up(uint64_t value, uint64_t alignment) -> uint64_t
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+auto read_shader_source() -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open("shader.slang");
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+void setup_config(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+        if (std::strcmp(argv[i], "--show-levels") == 0) config.show_levels = true;
+}
+
+void setup_container()
+{
+    // NOTE: only the header and level index are touched here, levels are paged in when they are first uploaded
+    container = MipContainer::load(LYRA_MIP_CONTAINER);
+    if (!container) {
+        std::cerr << "Failed to load mip container: " << LYRA_MIP_CONTAINER << std::endl;
+        std::exit(1);
+    }
+
+    // the tail is every level no larger than TAIL_SIZE, the coarsest level if even that is larger
+    auto levels = container->level_count();
+    tail_level  = levels - 1;
+    for (uint l = 0; l < levels; l++) {
+        if (container->level(0, l).width <= TAIL_SIZE) {
+            tail_level = l;
+            break;
+        }
+    }
+
+    textures.resize(container->texture_count());
+    for (auto& texture : textures) {
+        texture.resident = levels;
+        texture.desired  = tail_level;
+        texture.target   = tail_level;
+    }
+
+    std::cout << "Mip container: " << container->texture_count() << " textures, " << levels << " levels"
+              << ", " << double(container->file_bytes()) / (1024.0 * 1024.0) << " MB mapped" << std::endl;
+}
+
+void setup_pipeline()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = "mip-streaming";
+        desc.path   = "shader.slang";
+        desc.source = read_shader_source();
+        return compiler->compile(desc);
+    });
+
+    vshader = execute([&]() {
+        auto code  = module->get_shader_blob("vsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "vertex_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+
+    fshader = execute([&]() {
+        auto code  = module->get_shader_blob("fsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "fragment_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+
+    // NOTE: each frame slot has a bind group of its own, which is only written once the previous frame using it
+    // has completed, so the texture array does not need UPDATE_AFTER_BIND, only PARTIALLY_BOUND for the textures
+    // that are not resident yet.
+    blayout = execute([&]() {
+        auto uniform                      = GPUBindGroupLayoutEntry{};
+        uniform.type                      = GPUBindingResourceType::BUFFER;
+        uniform.binding                   = 0;
+        uniform.count                     = 1;
+        uniform.visibility                = GPUShaderStage::VERTEX | GPUShaderStage::FRAGMENT;
+        uniform.buffer.type               = GPUBufferBindingType::UNIFORM;
+        uniform.buffer.has_dynamic_offset = false;
+
+        auto filtering         = GPUBindGroupLayoutEntry{};
+        filtering.type         = GPUBindingResourceType::SAMPLER;
+        filtering.binding      = 1;
+        filtering.count        = 1;
+        filtering.visibility   = GPUShaderStage::FRAGMENT;
+        filtering.sampler.type = GPUSamplerBindingType::FILTERING;
+
+        auto images                   = GPUBindGroupLayoutEntry{};
+        images.type                   = GPUBindingResourceType::TEXTURE;
+        images.binding                = 2;
+        images.count                  = container->texture_count();
+        images.flags                  = GPUBindingFlag::PARTIALLY_BOUND;
+        images.visibility             = GPUShaderStage::FRAGMENT;
+        images.texture.sample_type    = GPUTextureSampleType::FLOAT;
+        images.texture.view_dimension = GPUTextureViewDimension::x2D;
+        images.texture.multisampled   = false;
+
+        auto desc    = GPUBindGroupLayoutDescriptor{};
+        desc.entries = {uniform, filtering, images};
+        return device.create_bind_group_layout(desc);
+    });
+
+    // NOTE: push constant ranges come from the shader reflection, DrawPanel has to match the reflected block
+    playout = execute([&]() {
+        auto desc                 = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts   = {blayout};
+        desc.push_constant_ranges = module->get_push_constant_ranges();
+        return device.create_pipeline_layout(desc);
+    });
+
+    // NOTE: panels never overlap on screen, so there is no depth buffer
+    pipeline = execute([&]() {
+        auto target         = GPUColorTargetState{};
+        target.format       = surface.get_current_format();
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::ALWAYS;
+        desc.depth_stencil.depth_write_enabled     = false;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vshader;
+        desc.fragment.module                       = fshader;
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+}
+
+void setup_scene()
+{
+    auto& device = RHI::get_current_device();
+
+    // a corridor with one panel per texture, alternating between the left and the right wall
+    for (uint t = 0; t < container->texture_count(); t++) {
+        float side = (t % 2 == 0) ? -1.0f : 1.0f;
+        float z    = -float(t / 2) * PANEL_SPACING;
+
+        auto panel    = DrawPanel{};
+        panel.origin  = glm::vec4(side * CORRIDOR_WIDTH * 0.5f, 0.0f, z, 1.0f);
+        panel.axis_u  = glm::vec4(0.0f, 0.0f, -PANEL_SIZE, 0.0f);
+        panel.axis_v  = glm::vec4(0.0f, PANEL_SIZE, 0.0f, 0.0f);
+        panel.texture = t;
+        panels.push_back(panel);
+    }
+
+    frame_ubuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "frame_uniform_buffer";
+        desc.size               = sizeof(Frame);
+        desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    // NOTE: trilinear and anisotropic, the panels are mostly seen at grazing angles
+    sampler = execute([&]() {
+        auto desc           = GPUSamplerDescriptor{};
+        desc.label          = "linear_sampler";
+        desc.address_mode_u = GPUAddressMode::CLAMP_TO_EDGE;
+        desc.address_mode_v = GPUAddressMode::CLAMP_TO_EDGE;
+        desc.address_mode_w = GPUAddressMode::CLAMP_TO_EDGE;
+        desc.mag_filter     = GPUFilterMode::LINEAR;
+        desc.min_filter     = GPUFilterMode::LINEAR;
+        desc.mipmap_filter  = GPUMipmapFilterMode::LINEAR;
+        desc.max_anisotropy = 8;
+        return device.create_sampler(desc);
+    });
+}
+
+void setup_streaming()
+{
+    auto& device = RHI::get_current_device();
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        // written by the CPU while recording, read by the copies of the same frame
+        staging[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "staging_buffer";
+            desc.size               = STAGING_SIZE;
+            desc.usage              = GPUBufferUsage::COPY_SRC | GPUBufferUsage::MAP_WRITE;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+
+        // no texture is bound yet, they are written in once resident
+        bind_groups[i] = execute([&]() {
+            auto uniform          = GPUBindGroupEntry{};
+            uniform.type          = GPUBindingResourceType::BUFFER;
+            uniform.binding       = 0;
+            uniform.index         = 0;
+            uniform.buffer.buffer = frame_ubuffer;
+            uniform.buffer.offset = 0;
+            uniform.buffer.size   = 0;
+
+            auto filtering    = GPUBindGroupEntry{};
+            filtering.type    = GPUBindingResourceType::SAMPLER;
+            filtering.binding = 1;
+            filtering.index   = 0;
+            filtering.sampler = sampler;
+
+            auto desc    = GPUBindGroupDescriptor{};
+            desc.layout  = blayout;
+            desc.entries = {uniform, filtering};
+            return device.create_bind_group(desc);
+        });
+
+        bound_generations[i].assign(textures.size(), 0);
+    }
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    for (auto& old : retired)
+        old.texture.destroy();
+    retired.clear();
+    for (auto& texture : textures)
+        if (texture.resident < container->level_count())
+            texture.texture.destroy();
+    for (auto& buffer : staging)
+        buffer.destroy();
+    frame_ubuffer.destroy();
+    sampler.destroy();
+    vshader.destroy();
+    fshader.destroy();
+    blayout.destroy();
+    playout.destroy();
+    pipeline.destroy();
+    container.reset();
+}
+
+// Edge length in pixels of the panel on screen, the square root of its projected area.
+// Returns 0 when the panel is off screen, and the screen height when it crosses the near plane.
+auto measure_footprint(const DrawPanel& panel, const glm::mat4& view_proj, float width, float height) -> float
+{
+    glm::vec3 corners[4] = {
+        glm::vec3(panel.origin),
+        glm::vec3(panel.origin + panel.axis_u),
+        glm::vec3(panel.origin + panel.axis_u + panel.axis_v),
+        glm::vec3(panel.origin + panel.axis_v),
+    };
+
+    glm::vec2 screen[4];
+    uint      behind = 0;
+    for (uint i = 0; i < 4; i++) {
+        auto clip = view_proj * glm::vec4(corners[i], 1.0f);
+        if (clip.w <= NEAR_PLANE) {
+            behind++;
+            continue;
+        }
+        screen[i] = glm::vec2((clip.x / clip.w * 0.5f + 0.5f) * width, (clip.y / clip.w * 0.5f + 0.5f) * height);
+    }
+
+    if (behind == 4)
+        return 0.0f;
+
+    // NOTE: a panel crossing the near plane is next to the camera, it wants its finest level
+    if (behind > 0)
+        return height;
+
+    auto lo = glm::min(glm::min(screen[0], screen[1]), glm::min(screen[2], screen[3]));
+    auto hi = glm::max(glm::max(screen[0], screen[1]), glm::max(screen[2], screen[3]));
+    if (hi.x < 0.0f || hi.y < 0.0f || lo.x > width || lo.y > height)
+        return 0.0f;
+
+    // shoelace formula over the projected quad
+    float area = 0.0f;
+    for (uint i = 0; i < 4; i++) {
+        auto& a = screen[i];
+        auto& b = screen[(i + 1) % 4];
+        area += a.x * b.y - b.x * a.y;
+    }
+    return std::sqrt(std::abs(area) * 0.5f);
+}
+
+// Picks the target level of every texture: the desired level, unless the total exceeds the budget,
+// in which case the textures with the fewest pixels per texel give up their finest level first.
+void plan_residency()
+{
+    auto levels = container->level_count();
+    auto total  = uint64_t(0);
+
+    for (uint t = 0; t < textures.size(); t++) {
+        auto& texture  = textures.at(t);
+        texture.target = texture.desired;
+
+        // NOTE: hysteresis, a level already resident is only dropped once it is two levels finer than needed
+        if (texture.resident < levels && texture.resident + 1 == texture.desired)
+            texture.target = texture.resident;
+
+        total += container->chain_bytes(t, texture.target);
+    }
+
+    while (total > RESIDENCY_BUDGET) {
+        auto victim = uint(textures.size());
+        auto lowest = 0.0f;
+        for (uint t = 0; t < textures.size(); t++) {
+            auto& texture = textures.at(t);
+            if (texture.target >= tail_level)
+                continue;
+
+            // pixels per texel at the target level, off screen textures are 0 and go first
+            auto density = texture.footprint / float(container->level(t, texture.target).width);
+            if (victim == textures.size() || density < lowest) {
+                victim = t;
+                lowest = density;
+            }
+        }
+
+        // NOTE: only tails are left, the budget is smaller than the tails of all textures
+        if (victim == textures.size())
+            break;
+
+        auto& texture = textures.at(victim);
+        total -= container->level(victim, texture.target).size;
+        texture.target++;
+    }
+}
+
+void update(const WindowInput& input)
+{
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // the camera walks down the corridor and back, turning around at either end
+    auto length = float(container->texture_count() / 2) * PANEL_SPACING;
+    camera_z += camera_dir * CAMERA_SPEED * input.delta_time;
+    if (camera_z < -length) camera_dir = 1.0f;
+    if (camera_z > PANEL_SIZE) camera_dir = -1.0f;
+    camera_z = glm::clamp(camera_z, -length, PANEL_SIZE);
+
+    auto eye       = glm::vec3(0.0f, PANEL_SIZE * 0.5f, camera_z);
+    auto view      = glm::lookAt(eye, eye + glm::vec3(0.0f, 0.0f, camera_dir), glm::vec3(0.0f, 1.0f, 0.0f));
+    auto proj      = glm::perspective(FOVY, float(extent.width) / float(extent.height), NEAR_PLANE, FAR_PLANE);
+    auto view_proj = proj * view;
+
+    auto frame              = frame_ubuffer.get_mapped_range<Frame>();
+    frame.at(0).view_proj   = view_proj;
+    frame.at(0).show_levels = config.show_levels ? 1 : 0;
+
+    // the level whose texels are closest to one per pixel along the edge of the panel
+    for (uint t = 0; t < textures.size(); t++) {
+        auto& texture     = textures.at(t);
+        texture.footprint = measure_footprint(panels.at(t), view_proj, float(extent.width), float(extent.height));
+        texture.desired   = tail_level;
+        if (texture.footprint > 0.0f) {
+            auto texels     = float(container->level(t, 0).width);
+            auto level      = std::floor(std::log2(std::max(texels / texture.footprint, 1.0f)));
+            texture.desired = std::min(static_cast<uint>(level), tail_level);
+        }
+    }
+
+    plan_residency();
+}
+
+// Replaces a texture with one that holds the levels [first, level_count), all uploaded from the container
+// through the staging buffer of this frame. Returns false when they do not fit into what is left of it.
+// NOTE: levels that were already resident are uploaded again rather than copied on the GPU, they are at most
+// a third of the size of the new finest level.
+auto replace_texture(GPUCommandBuffer& command, uint slot, uint index, uint first, uint64_t& offset) -> bool
+{
+    auto& device  = RHI::get_current_device();
+    auto& texture = textures.at(index);
+    auto  levels  = container->level_count();
+
+    // everything has to fit, a texture is never bound with levels missing
+    auto needed = offset;
+    for (uint l = first; l < levels; l++) {
+        auto& level = container->level(index, l);
+        needed      = align_up(needed, COPY_OFFSET_ALIGNMENT) + align_up(level.row_bytes, COPY_PITCH_ALIGNMENT) * level.rows;
+    }
+    if (needed > STAGING_SIZE)
+        return false;
+
+    auto replacement = execute([&]() {
+        auto desc            = GPUTextureDescriptor{};
+        desc.format          = GPUTextureFormat::BC1_RGBA_UNORM;
+        desc.size.width      = container->level(index, first).width;
+        desc.size.height     = container->level(index, first).height;
+        desc.size.depth      = 1;
+        desc.array_layers    = 1;
+        desc.mip_level_count = levels - first;
+        desc.usage           = GPUTextureUsage::COPY_DST | GPUTextureUsage::TEXTURE_BINDING;
+        desc.label           = "streamed_texture";
+        return device.create_texture(desc);
+    });
+
+    auto memory = staging[slot].get_mapped_range<uint8_t>();
+    command.resource_barrier(state_transition(replacement, undefined_state(), copy_dst_state()));
+    for (uint l = first; l < levels; l++) {
+        auto& level = container->level(index, l);
+        auto  pitch = static_cast<uint>(align_up(level.row_bytes, COPY_PITCH_ALIGNMENT));
+        auto* data  = container->data(level);
+
+        // rows of blocks are packed in the container, and padded to the copy pitch in staging memory
+        offset = align_up(offset, COPY_OFFSET_ALIGNMENT);
+        for (uint row = 0; row < level.rows; row++)
+            std::memcpy(&memory.at(offset + uint64_t(row) * pitch), data + uint64_t(row) * level.row_bytes, level.row_bytes);
+
+        auto src           = GPUImageCopyBuffer{};
+        src.buffer         = staging[slot];
+        src.offset         = offset;
+        src.bytes_per_row  = pitch;
+        src.rows_per_image = level.rows;
+
+        auto dst      = GPUImageCopyTexture{};
+        dst.texture   = replacement;
+        dst.mip_level = l - first;
+
+        // NOTE: copies of block compressed levels cover whole blocks, even for levels smaller than a block
+        auto size   = GPUExtent3D{};
+        size.width  = level.row_bytes / MIP_BLOCK_BYTES * MIP_BLOCK_SIZE;
+        size.height = level.rows * MIP_BLOCK_SIZE;
+        size.depth  = 1;
+
+        command.copy_buffer_to_texture(src, dst, size);
+        offset += uint64_t(pitch) * level.rows;
+        stats.uploaded += level.size;
+    }
+    command.resource_barrier(state_transition(replacement, copy_dst_state(), shader_resource_state(GPUShaderStage::FRAGMENT)));
+
+    // NOTE: no device.wait() here, frames in flight keep sampling the old texture until they retire
+    if (texture.resident < levels) {
+        retired.push_back({texture.texture, texture.view, frame_index});
+        resident_bytes -= container->chain_bytes(index, texture.resident);
+    }
+
+    if (first < texture.resident)
+        stats.uploads++;
+    else
+        stats.evictions++;
+
+    texture.texture  = replacement;
+    texture.view     = replacement.create_view();
+    texture.resident = first;
+    texture.generation++;
+    resident_bytes += container->chain_bytes(index, first);
+    stats.peak = std::max(stats.peak, resident_bytes);
+    return true;
+}
+
+// Records this frame's uploads, evictions first so that loads have room in the budget.
+void stream_textures(GPUCommandBuffer& command, uint slot)
+{
+    auto levels = container->level_count();
+    auto offset = uint64_t(0);
+
+    // release textures replaced FRAMES_INFLIGHT frames ago
+    while (!retired.empty() && retired.front().frame + FRAMES_INFLIGHT <= frame_index) {
+        retired.front().texture.destroy();
+        retired.pop_front();
+    }
+
+    for (uint t = 0; t < textures.size(); t++) {
+        auto& texture = textures.at(t);
+        if (texture.resident < levels && texture.target > texture.resident)
+            replace_texture(command, slot, t, texture.target, offset);
+    }
+
+    // textures without any level first, then the ones furthest from their target
+    auto loads = std::vector<uint>{};
+    for (uint t = 0; t < textures.size(); t++)
+        if (textures.at(t).target < textures.at(t).resident)
+            loads.push_back(t);
+
+    std::sort(loads.begin(), loads.end(), [&](uint a, uint b) {
+        auto missing_a = textures.at(a).resident == levels;
+        auto missing_b = textures.at(b).resident == levels;
+        if (missing_a != missing_b)
+            return missing_a;
+        return textures.at(a).resident - textures.at(a).target > textures.at(b).resident - textures.at(b).target;
+    });
+
+    for (uint t : loads) {
+        auto& texture = textures.at(t);
+
+        // NOTE: low levels first, a texture without any level only gets its tail, finer levels follow in later frames
+        auto first = texture.resident == levels ? tail_level : texture.target;
+        auto old   = texture.resident == levels ? uint64_t(0) : container->chain_bytes(t, texture.resident);
+        if (resident_bytes - old + container->chain_bytes(t, first) > RESIDENCY_BUDGET && first < tail_level)
+            continue;
+
+        replace_texture(command, slot, t, first, offset);
+    }
+}
+
+// Writes the textures replaced since this slot was last recorded into its bind group.
+// NOTE: the previous frame using this bind group has completed once this slot's swapchain texture is acquired.
+void update_bind_group(uint slot)
+{
+    auto& device = RHI::get_current_device();
+
+    auto entries = std::vector<GPUBindGroupEntry>{};
+    for (uint t = 0; t < textures.size(); t++) {
+        auto& texture = textures.at(t);
+        if (texture.resident == container->level_count() || bound_generations[slot].at(t) == texture.generation)
+            continue;
+
+        auto entry    = GPUBindGroupEntry{};
+        entry.type    = GPUBindingResourceType::TEXTURE;
+        entry.binding = 2;
+        entry.index   = t;
+        entry.texture = texture.view;
+        entries.push_back(entry);
+
+        bound_generations[slot].at(t) = texture.generation;
+    }
+
+    if (!entries.empty())
+        device.update_bind_group(bind_groups[slot], entries);
+}
+
+void report()
+{
+    auto now = StreamingStats::Clock::now();
+    if (stats.frames > 0) {
+        auto elapsed = std::chrono::duration<double>(now - stats.last).count();
+        stats.elapsed += elapsed;
+        stats.frame += elapsed * 1000.0;
+    }
+    stats.last = now;
+
+    if (++stats.frames == FRAMES_PER_REPORT) {
+        auto full    = uint(0);
+        auto pending = uint(0);
+        for (auto& texture : textures) {
+            full += texture.resident == 0 ? 1 : 0;
+            pending += texture.resident != texture.target ? 1 : 0;
+        }
+
+        auto mb = 1.0 / (1024.0 * 1024.0);
+        std::cout << "Resident: " << double(resident_bytes) * mb << " MB (peak " << double(stats.peak) * mb << " MB)"
+                  << " / " << double(RESIDENCY_BUDGET) * mb << " MB"
+                  << ", Full Detail: " << full << "/" << textures.size()
+                  << ", Upload: " << double(stats.uploaded) * mb / std::max(stats.elapsed, 1e-6) << " MB/s"
+                  << " (" << stats.uploads << " loads, " << stats.evictions << " evictions)"
+                  << ", Pending: " << pending
+                  << ", Frame Time: " << stats.frame / (FRAMES_PER_REPORT - 1) << " ms" << std::endl;
+
+        stats      = StreamingStats{};
+        stats.last = now;
+        stats.peak = resident_bytes;
+    }
+}
+
+void render()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    auto slot = static_cast<uint>(frame_index % FRAMES_INFLIGHT);
+
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    stream_textures(command, slot);
+    update_bind_group(slot);
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.05f, 0.05f, 0.05f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = texture.view;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = {color_attachment};
+    render_pass.depth_stencil_attachment = {};
+
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(pipeline);
+    command.set_bind_group(0, bind_groups[slot]);
+
+    // NOTE: a texture without any resident level is not bound, its panel is skipped until its tail arrives
+    for (auto& panel : panels) {
+        auto& streamed = textures.at(panel.texture);
+        if (streamed.resident == container->level_count())
+            continue;
+
+        auto draw  = panel;
+        draw.level = streamed.resident;
+        command.set_push_constants(GPUShaderStage::VERTEX | GPUShaderStage::FRAGMENT, 0, sizeof(DrawPanel), &draw);
+        command.draw(6, 1, 0, 0);
+    }
+
+    command.end_render_pass();
+    command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    // present this frame to swapchain
+    texture.present();
+
+    report();
+    frame_index++;
+}
+
+int main(int argc, char** argv)
+{
+    setup_config(argc, argv);
+    setup_container();
+
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    // NOTE: BC formats need textureCompressionBC (Vulkan) which every desktop GPU has, descriptor arrays as in Bindless
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Fifo;
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipeline);
+    win->bind<WindowEvent::START>(setup_scene);
+    win->bind<WindowEvent::START>(setup_streaming);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
@@ -0,0 +1,811 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string_view>
+#include <vector>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+// NOTE: must match the layout in shader.slang and cull.slang
+struct Object
+{
+    glm::mat4 model;
+    glm::vec4 sphere;
+    glm::vec4 color;
+    uint      occluder;
+    uint      padding[3];
+};
+
+struct Frame
+{
+    glm::mat4 view_proj;
+};
+
+struct Cull
+{
+    glm::mat4 view_proj;
+    uint      object_count;
+    uint      enabled;
+    uint      mip_count;
+    uint      padding;
+};
+
+struct DrawIndexedIndirect
+{
+    uint index_count;
+    uint instance_count;
+    uint first_index;
+    int  base_vertex;
+    uint first_instance;
+};
+
+struct FrameStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last;
+    double            accumulated = 0.0;
+    uint64_t          visible     = 0;
+    uint              frames      = 0;
+};
+
+constexpr uint OBJECT_GRID       = 128;
+constexpr uint OCCLUDER_COUNT    = 3;
+constexpr uint OBJECT_COUNT      = OBJECT_GRID * OBJECT_GRID + OCCLUDER_COUNT;
+constexpr uint FRAMES_INFLIGHT   = 3;
+constexpr uint FRAMES_PER_TOGGLE = 240;
+
+GPUShaderModule             vshader;
+GPUShaderModule             fshader;
+GPUShaderModule             copy_shader;
+GPUShaderModule             reduce_shader;
+GPUShaderModule             cull_shader;
+GPUBindGroupLayout          draw_blayout;
+GPUBindGroupLayout          copy_blayout;
+GPUBindGroupLayout          reduce_blayout;
+GPUBindGroupLayout          cull_blayout;
+GPUPipelineLayout           draw_playout;
+GPUPipelineLayout           copy_playout;
+GPUPipelineLayout           reduce_playout;
+GPUPipelineLayout           cull_playout;
+GPURenderPipeline           draw_pipeline;
+GPUComputePipeline          copy_pipeline;
+GPUComputePipeline          reduce_pipeline;
+GPUComputePipeline          cull_pipeline;
+GPUBuffer                   vbuffer;
+GPUBuffer                   ibuffer;
+GPUBuffer                   obuffer;
+GPUBuffer                   visbuffer;
+GPUBuffer                   frame_ubuffer;
+GPUBuffer                   cull_ubuffer;
+GPUBuffer                   args_buffer;
+GPUBuffer                   args_reset;
+GPUBuffer                   args_readback[FRAMES_INFLIGHT];
+GPUTexture                  dbuffer;
+GPUTextureView              dview;
+GPUTexture                  pyramid;
+GPUTextureView              pyramid_view;
+std::vector<GPUTextureView> pyramid_levels;
+std::vector<GPUBindGroup>   pyramid_bind_groups;
+uint                        pyramid_mips = 0;
+glm::mat4                   prev_view_proj;
+uint64_t                    frame_index = 0;
+bool                        culling     = true;
+FrameStats                  stats;
+
+auto read_shader_source(const std::string& name) -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open(name);
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+auto compile_shader(const std::string& name, const char* entry, const char* label) -> GPUShaderModule
+{
+    auto& device = RHI::get_current_device();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = name;
+        desc.path   = name;
+        desc.source = read_shader_source(name);
+        return compiler->compile(desc);
+    });
+
+    return execute([&]() {
+        auto code  = module->get_shader_blob(entry);
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = label;
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+}
+
+auto buffer_layout_entry(uint binding, uint32_t visibility, GPUBufferBindingType type) -> GPUBindGroupLayoutEntry
+{
+    auto entry                      = GPUBindGroupLayoutEntry{};
+    entry.type                      = GPUBindingResourceType::BUFFER;
+    entry.binding                   = binding;
+    entry.count                     = 1;
+    entry.visibility                = visibility;
+    entry.buffer.type               = type;
+    entry.buffer.has_dynamic_offset = false;
+    return entry;
+}
+
+auto texture_layout_entry(uint binding, GPUTextureSampleType type) -> GPUBindGroupLayoutEntry
+{
+    auto entry                   = GPUBindGroupLayoutEntry{};
+    entry.type                   = GPUBindingResourceType::TEXTURE;
+    entry.binding                = binding;
+    entry.count                  = 1;
+    entry.visibility             = GPUShaderStage::COMPUTE;
+    entry.texture.sample_type    = type;
+    entry.texture.view_dimension = GPUTextureViewDimension::x2D;
+    entry.texture.multisampled   = false;
+    return entry;
+}
+
+auto storage_texture_layout_entry(uint binding) -> GPUBindGroupLayoutEntry
+{
+    auto entry                           = GPUBindGroupLayoutEntry{};
+    entry.type                           = GPUBindingResourceType::STORAGE_TEXTURE;
+    entry.binding                        = binding;
+    entry.count                          = 1;
+    entry.visibility                     = GPUShaderStage::COMPUTE;
+    entry.storage_texture.access         = GPUStorageTextureAccess::WRITE_ONLY;
+    entry.storage_texture.format         = GPUTextureFormat::RG32FLOAT;
+    entry.storage_texture.view_dimension = GPUTextureViewDimension::x2D;
+    return entry;
+}
+
+auto buffer_entry(uint binding, const GPUBuffer& buffer) -> GPUBindGroupEntry
+{
+    auto entry          = GPUBindGroupEntry{};
+    entry.type          = GPUBindingResourceType::BUFFER;
+    entry.binding       = binding;
+    entry.index         = 0;
+    entry.buffer.buffer = buffer;
+    entry.buffer.offset = 0;
+    entry.buffer.size   = 0;
+    return entry;
+}
+
+auto texture_entry(uint binding, GPUBindingResourceType type, const GPUTextureView& view) -> GPUBindGroupEntry
+{
+    auto entry    = GPUBindGroupEntry{};
+    entry.type    = type;
+    entry.binding = binding;
+    entry.index   = 0;
+    entry.texture = view;
+    return entry;
+}
+
+auto create_compute_pipeline(const GPUPipelineLayout& layout, const GPUShaderModule& module) -> GPUComputePipeline
+{
+    auto& device = RHI::get_current_device();
+
+    return execute([&]() {
+        auto desc           = GPUComputePipelineDescriptor{};
+        desc.layout         = layout;
+        desc.compute.module = module;
+        return device.create_compute_pipeline(desc);
+    });
+}
+
+void setup_pipelines()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    vshader       = compile_shader("shader.slang", "vsmain", "vertex_shader");
+    fshader       = compile_shader("shader.slang", "fsmain", "fragment_shader");
+    copy_shader   = compile_shader("hiz_copy.slang", "csmain", "hiz_copy_shader");
+    reduce_shader = compile_shader("hiz_reduce.slang", "csmain", "hiz_reduce_shader");
+    cull_shader   = compile_shader("cull.slang", "csmain", "cull_shader");
+
+    draw_blayout = execute([&]() {
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(buffer_layout_entry(0, GPUShaderStage::VERTEX, GPUBufferBindingType::UNIFORM));
+        desc.entries.push_back(buffer_layout_entry(1, GPUShaderStage::VERTEX, GPUBufferBindingType::READ_ONLY_STORAGE));
+        desc.entries.push_back(buffer_layout_entry(2, GPUShaderStage::VERTEX, GPUBufferBindingType::READ_ONLY_STORAGE));
+        return device.create_bind_group_layout(desc);
+    });
+
+    copy_blayout = execute([&]() {
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(texture_layout_entry(0, GPUTextureSampleType::DEPTH));
+        desc.entries.push_back(storage_texture_layout_entry(1));
+        return device.create_bind_group_layout(desc);
+    });
+
+    reduce_blayout = execute([&]() {
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(texture_layout_entry(0, GPUTextureSampleType::UNFILTERABLE_FLOAT));
+        desc.entries.push_back(storage_texture_layout_entry(1));
+        return device.create_bind_group_layout(desc);
+    });
+
+    cull_blayout = execute([&]() {
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(buffer_layout_entry(0, GPUShaderStage::COMPUTE, GPUBufferBindingType::UNIFORM));
+        desc.entries.push_back(buffer_layout_entry(1, GPUShaderStage::COMPUTE, GPUBufferBindingType::READ_ONLY_STORAGE));
+        desc.entries.push_back(buffer_layout_entry(2, GPUShaderStage::COMPUTE, GPUBufferBindingType::STORAGE));
+        desc.entries.push_back(buffer_layout_entry(3, GPUShaderStage::COMPUTE, GPUBufferBindingType::STORAGE));
+        desc.entries.push_back(texture_layout_entry(4, GPUTextureSampleType::UNFILTERABLE_FLOAT));
+        return device.create_bind_group_layout(desc);
+    });
+
+    draw_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {draw_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    copy_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {copy_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    reduce_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {reduce_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    cull_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {cull_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    draw_pipeline = execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x3;
+        position.offset          = 0;
+        position.shader_location = 0;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position};
+        layout.array_stride = sizeof(glm::vec3);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto target         = GPUColorTargetState{};
+        target.format       = surface.get_current_format();
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = draw_playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.format                  = GPUTextureFormat::DEPTH32FLOAT;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::LESS;
+        desc.depth_stencil.depth_write_enabled     = true;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vshader;
+        desc.fragment.module                       = fshader;
+        desc.vertex.buffers.push_back(layout);
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+
+    copy_pipeline   = create_compute_pipeline(copy_playout, copy_shader);
+    reduce_pipeline = create_compute_pipeline(reduce_playout, reduce_shader);
+    cull_pipeline   = create_compute_pipeline(cull_playout, cull_shader);
+}
+
+void setup_geometry()
+{
+    auto& device = RHI::get_current_device();
+
+    vbuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "vertex_buffer";
+        desc.size               = sizeof(glm::vec3) * 8;
+        desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    ibuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "index_buffer";
+        desc.size               = sizeof(uint32_t) * 36;
+        desc.usage              = GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    // unit cube centered at origin
+    auto vertices = vbuffer.get_mapped_range<glm::vec3>();
+    for (uint i = 0; i < 8; i++)
+        vertices.at(i) = glm::vec3((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f);
+
+    const uint faces[36] = {
+        0, 2, 1, 1, 2, 3, // -z
+        4, 5, 6, 5, 7, 6, // +z
+        0, 1, 4, 1, 5, 4, // -y
+        2, 6, 3, 3, 6, 7, // +y
+        0, 4, 2, 2, 4, 6, // -x
+        1, 3, 5, 3, 7, 5, // +x
+    };
+
+    auto indices = ibuffer.get_mapped_range<uint>();
+    for (uint i = 0; i < 36; i++)
+        indices.at(i) = faces[i];
+}
+
+void setup_objects()
+{
+    auto& device = RHI::get_current_device();
+
+    obuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "object_buffer";
+        desc.size               = sizeof(Object) * OBJECT_COUNT;
+        desc.usage              = GPUBufferUsage::STORAGE | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    visbuffer = execute([&]() {
+        auto desc  = GPUBufferDescriptor{};
+        desc.label = "visible_buffer";
+        desc.size  = sizeof(uint) * OBJECT_COUNT;
+        desc.usage = GPUBufferUsage::STORAGE;
+        return device.create_buffer(desc);
+    });
+
+    auto objects = obuffer.get_mapped_range<Object>();
+
+    // dense grid of small cubes on the ground, behind the occluders
+    for (uint z = 0; z < OBJECT_GRID; z++) {
+        for (uint x = 0; x < OBJECT_GRID; x++) {
+            auto  center = glm::vec3(float(x) - OBJECT_GRID * 0.5f, 0.5f, -float(z) - 8.0f);
+            auto& object = objects.at(z * OBJECT_GRID + x);
+
+            object.model    = glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(0.6f));
+            object.sphere   = glm::vec4(center, 0.6f * 0.8660254f); // half diagonal of the scaled cube
+            object.color    = glm::vec4(float(x) / OBJECT_GRID, 0.5f, float(z) / OBJECT_GRID, 1.0f);
+            object.occluder = 0;
+        }
+    }
+
+    // a few large walls close to the camera
+    for (uint i = 0; i < OCCLUDER_COUNT; i++) {
+        auto  center = glm::vec3((float(i) - 1.0f) * 22.0f, 6.0f, -4.0f);
+        auto  extent = glm::vec3(20.0f, 12.0f, 1.0f);
+        auto& object = objects.at(OBJECT_GRID * OBJECT_GRID + i);
+
+        object.model    = glm::scale(glm::translate(glm::mat4(1.0f), center), extent);
+        object.sphere   = glm::vec4(center, glm::length(extent) * 0.5f);
+        object.color    = glm::vec4(0.8f, 0.8f, 0.8f, 1.0f);
+        object.occluder = 1;
+    }
+}
+
+void setup_indirect_buffers()
+{
+    auto& device = RHI::get_current_device();
+
+    args_buffer = execute([&]() {
+        auto desc  = GPUBufferDescriptor{};
+        desc.label = "indirect_buffer";
+        desc.size  = sizeof(DrawIndexedIndirect);
+        desc.usage = GPUBufferUsage::STORAGE | GPUBufferUsage::INDIRECT | GPUBufferUsage::COPY_SRC | GPUBufferUsage::COPY_DST;
+        return device.create_buffer(desc);
+    });
+
+    // template for resetting the indirect arguments at the beginning of every frame
+    args_reset = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "indirect_reset_buffer";
+        desc.size               = sizeof(DrawIndexedIndirect);
+        desc.usage              = GPUBufferUsage::COPY_SRC | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    auto args                 = args_reset.get_mapped_range<DrawIndexedIndirect>();
+    args.at(0).index_count    = 36;
+    args.at(0).instance_count = 0;
+    args.at(0).first_index    = 0;
+    args.at(0).base_vertex    = 0;
+    args.at(0).first_instance = 0;
+
+    // one readback buffer per frame in flight, read back when the slot comes around again
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        args_readback[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "indirect_readback_buffer";
+            desc.size               = sizeof(DrawIndexedIndirect);
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    }
+
+    frame_ubuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "frame_uniform_buffer";
+        desc.size               = sizeof(Frame);
+        desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    cull_ubuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "cull_uniform_buffer";
+        desc.size               = sizeof(Cull);
+        desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+}
+
+void setup_depth_pyramid()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    dbuffer = execute([&]() {
+        auto desc            = GPUTextureDescriptor{};
+        desc.format          = GPUTextureFormat::DEPTH32FLOAT;
+        desc.size.width      = extent.width;
+        desc.size.height     = extent.height;
+        desc.size.depth      = 1;
+        desc.array_layers    = 1;
+        desc.mip_level_count = 1;
+        desc.usage           = GPUTextureUsage::RENDER_ATTACHMENT | GPUTextureUsage::TEXTURE_BINDING;
+        desc.label           = "depth_buffer";
+        return device.create_texture(desc);
+    });
+
+    dview = dbuffer.create_view();
+
+    pyramid_mips = static_cast<uint>(std::floor(std::log2(std::max(extent.width, extent.height)))) + 1;
+
+    pyramid = execute([&]() {
+        auto desc            = GPUTextureDescriptor{};
+        desc.format          = GPUTextureFormat::RG32FLOAT;
+        desc.size.width      = extent.width;
+        desc.size.height     = extent.height;
+        desc.size.depth      = 1;
+        desc.array_layers    = 1;
+        desc.mip_level_count = pyramid_mips;
+        desc.usage           = GPUTextureUsage::STORAGE_BINDING | GPUTextureUsage::TEXTURE_BINDING;
+        desc.label           = "depth_pyramid";
+        return device.create_texture(desc);
+    });
+
+    pyramid_view = pyramid.create_view();
+
+    // one view per level, each used as storage when it is written, and as texture when it is read
+    for (uint i = 0; i < pyramid_mips; i++) {
+        auto desc              = GPUTextureViewDescriptor{};
+        desc.format            = GPUTextureFormat::RG32FLOAT;
+        desc.dimension         = GPUTextureViewDimension::x2D;
+        desc.aspect            = GPUTextureAspect::ALL;
+        desc.base_mip_level    = i;
+        desc.mip_level_count   = 1;
+        desc.base_array_layer  = 0;
+        desc.array_layer_count = 1;
+        pyramid_levels.push_back(pyramid.create_view(desc));
+    }
+
+    // bind groups are fixed, because the pyramid never changes
+    for (uint i = 0; i < pyramid_mips; i++) {
+        auto bind_group = execute([&]() {
+            auto desc = GPUBindGroupDescriptor{};
+            if (i == 0) {
+                desc.layout = copy_blayout;
+                desc.entries.push_back(texture_entry(0, GPUBindingResourceType::TEXTURE, dview));
+            } else {
+                desc.layout = reduce_blayout;
+                desc.entries.push_back(texture_entry(0, GPUBindingResourceType::TEXTURE, pyramid_levels.at(i - 1)));
+            }
+            desc.entries.push_back(texture_entry(1, GPUBindingResourceType::STORAGE_TEXTURE, pyramid_levels.at(i)));
+            return device.create_bind_group(desc);
+        });
+        pyramid_bind_groups.push_back(bind_group);
+    }
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    for (auto& readback : args_readback)
+        readback.destroy();
+    args_buffer.destroy();
+    args_reset.destroy();
+    frame_ubuffer.destroy();
+    cull_ubuffer.destroy();
+    visbuffer.destroy();
+    obuffer.destroy();
+    ibuffer.destroy();
+    vbuffer.destroy();
+    pyramid.destroy();
+    dbuffer.destroy();
+    vshader.destroy();
+    fshader.destroy();
+    copy_shader.destroy();
+    reduce_shader.destroy();
+    cull_shader.destroy();
+    draw_blayout.destroy();
+    copy_blayout.destroy();
+    reduce_blayout.destroy();
+    cull_blayout.destroy();
+    draw_playout.destroy();
+    copy_playout.destroy();
+    reduce_playout.destroy();
+    cull_playout.destroy();
+    draw_pipeline.destroy();
+    copy_pipeline.destroy();
+    reduce_pipeline.destroy();
+    cull_pipeline.destroy();
+}
+
+void update(const WindowInput& input)
+{
+    static float time = 0.0f;
+    time += input.delta_time;
+
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // slowly sway the camera, so that the occluders reveal different parts of the grid
+    auto eye  = glm::vec3(std::sin(time * 0.3f) * 12.0f, 3.0f, 10.0f);
+    auto proj = glm::perspective(1.05f, float(extent.width) / float(extent.height), 0.1f, 300.0f);
+    auto view = glm::lookAt(eye, glm::vec3(0.0f, 2.0f, -30.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    // the pyramid is always one frame behind, so culling must use the transform it was rendered with
+    auto cull               = cull_ubuffer.get_mapped_range<Cull>();
+    cull.at(0).view_proj    = frame_index == 0 ? proj * view : prev_view_proj;
+    cull.at(0).object_count = OBJECT_COUNT;
+    cull.at(0).enabled      = (culling && frame_index > 0) ? 1 : 0;
+    cull.at(0).mip_count    = pyramid_mips;
+
+    auto frame            = frame_ubuffer.get_mapped_range<Frame>();
+    frame.at(0).view_proj = proj * view;
+    prev_view_proj        = proj * view;
+}
+
+void cull_objects(GPUCommandBuffer& command)
+{
+    auto& device = RHI::get_current_device();
+
+    auto bind_group = execute([&]() {
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = cull_blayout;
+        desc.entries.push_back(buffer_entry(0, cull_ubuffer));
+        desc.entries.push_back(buffer_entry(1, obuffer));
+        desc.entries.push_back(buffer_entry(2, visbuffer));
+        desc.entries.push_back(buffer_entry(3, args_buffer));
+        desc.entries.push_back(texture_entry(4, GPUBindingResourceType::TEXTURE, pyramid_view));
+        return device.create_bind_group(desc);
+    });
+
+    command.resource_barrier(state_transition(args_buffer, undefined_state(), copy_dst_state()));
+    command.copy_buffer_to_buffer(args_reset, 0, args_buffer, 0, sizeof(DrawIndexedIndirect));
+    command.resource_barrier(state_transition(args_buffer, copy_dst_state(), storage_state(GPUShaderStage::COMPUTE)));
+    command.resource_barrier(state_transition(visbuffer, undefined_state(), storage_state(GPUShaderStage::COMPUTE)));
+    command.resource_barrier(state_transition(pyramid, frame_index == 0 ? undefined_state() : shader_resource_state(GPUShaderStage::COMPUTE), shader_resource_state(GPUShaderStage::COMPUTE)));
+    command.set_pipeline(cull_pipeline);
+    command.set_bind_group(0, bind_group);
+    command.dispatch_workgroups((OBJECT_COUNT + 63) / 64);
+    command.resource_barrier(state_transition(args_buffer, storage_state(GPUShaderStage::COMPUTE), indirect_state()));
+    command.resource_barrier(state_transition(visbuffer, storage_state(GPUShaderStage::COMPUTE), shader_resource_state(GPUShaderStage::VERTEX)));
+}
+
+void draw_objects(GPUCommandBuffer& command, const GPUSurfaceTexture& backbuffer)
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto bind_group = execute([&]() {
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = draw_blayout;
+        desc.entries.push_back(buffer_entry(0, frame_ubuffer));
+        desc.entries.push_back(buffer_entry(1, obuffer));
+        desc.entries.push_back(buffer_entry(2, visbuffer));
+        return device.create_bind_group(desc);
+    });
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.1f, 0.1f, 0.1f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = backbuffer.view;
+
+    auto depth_attachment              = GPURenderPassDepthStencilAttachment{};
+    depth_attachment.view              = dview;
+    depth_attachment.depth_clear_value = 1.0f;
+    depth_attachment.depth_load_op     = GPULoadOp::CLEAR;
+    depth_attachment.depth_store_op    = GPUStoreOp::STORE; // NOTE: stored for the depth pyramid
+    depth_attachment.depth_read_only   = false;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = {color_attachment};
+    render_pass.depth_stencil_attachment = depth_attachment;
+
+    command.resource_barrier(state_transition(dbuffer, undefined_state(), depth_stencil_attachment_state()));
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(draw_pipeline);
+    command.set_vertex_buffer(0, vbuffer);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+    command.set_bind_group(0, bind_group);
+    command.draw_indexed_indirect(args_buffer, 0);
+    command.end_render_pass();
+}
+
+void build_depth_pyramid(GPUCommandBuffer& command)
+{
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    command.resource_barrier(state_transition(dbuffer, depth_stencil_attachment_state(), shader_resource_state(GPUShaderStage::COMPUTE)));
+    command.resource_barrier(state_transition(pyramid, shader_resource_state(GPUShaderStage::COMPUTE), storage_state(GPUShaderStage::COMPUTE)));
+
+    for (uint i = 0; i < pyramid_mips; i++) {
+        uint width  = std::max(extent.width >> i, 1u);
+        uint height = std::max(extent.height >> i, 1u);
+
+        command.set_pipeline(i == 0 ? copy_pipeline : reduce_pipeline);
+        command.set_bind_group(0, pyramid_bind_groups.at(i));
+        command.dispatch_workgroups((width + 7) / 8, (height + 7) / 8);
+
+        // NOTE: the next level reads from this one
+        command.resource_barrier(state_transition(pyramid, storage_state(GPUShaderStage::COMPUTE), storage_state(GPUShaderStage::COMPUTE)));
+    }
+
+    command.resource_barrier(state_transition(pyramid, storage_state(GPUShaderStage::COMPUTE), shader_resource_state(GPUShaderStage::COMPUTE)));
+}
+
+void report(GPUCommandBuffer& command)
+{
+    auto slot = frame_index % FRAMES_INFLIGHT;
+
+    // the readback buffer in this slot was written FRAMES_INFLIGHT frames ago, and is complete by now
+    if (frame_index >= FRAMES_INFLIGHT) {
+        auto args = args_readback[slot].get_mapped_range<DrawIndexedIndirect>();
+        stats.visible += args.at(0).instance_count;
+    }
+
+    command.resource_barrier(state_transition(args_buffer, indirect_state(), copy_src_state()));
+    command.copy_buffer_to_buffer(args_buffer, 0, args_readback[slot], 0, sizeof(DrawIndexedIndirect));
+
+    auto now = FrameStats::Clock::now();
+    if (stats.frames > 0)
+        stats.accumulated += std::chrono::duration<double, std::milli>(now - stats.last).count();
+    stats.last = now;
+
+    // alternate between culling on and off, to compare frame times of both
+    if (++stats.frames == FRAMES_PER_TOGGLE) {
+        auto visible = double(stats.visible) / double(FRAMES_PER_TOGGLE);
+        std::cout << "Culling: " << (culling ? "ON " : "OFF")
+                  << ", Visible: " << visible << "/" << OBJECT_COUNT
+                  << ", Culled: " << (OBJECT_COUNT - visible)
+                  << ", Frame Time: " << stats.accumulated / (FRAMES_PER_TOGGLE - 1) << " ms" << std::endl;
+
+        culling = !culling;
+        stats   = FrameStats{};
+    }
+}
+
+void render()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    // create command buffer
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    // commands
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    cull_objects(command);
+    draw_objects(command, texture);
+    build_depth_pyramid(command);
+    report(command);
+    command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    // present this frame to swapchain
+    texture.present();
+
+    frame_index++;
+}
+
+int main()
+{
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Immediate; // NOTE: do not hide frame time behind vsync
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipelines);
+    win->bind<WindowEvent::START>(setup_geometry);
+    win->bind<WindowEvent::START>(setup_objects);
+    win->bind<WindowEvent::START>(setup_indirect_buffers);
+    win->bind<WindowEvent::START>(setup_depth_pyramid);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
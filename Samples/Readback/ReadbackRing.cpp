@@ -0,0 +1,128 @@
+#include "ReadbackRing.h"
+
+using namespace lyra;
+using namespace lyra::rhi;
+
+// NOTE: D3D12 requires texture copy rows to be 256 byte aligned, Vulkan does not care
+constexpr uint ROW_ALIGNMENT = 256;
+
+ReadbackRing::ReadbackRing(const ReadbackRingDescriptor& descriptor) : descriptor(descriptor)
+{
+    auto& device = RHI::get_current_device();
+
+    row_pitch = (descriptor.width * 4 + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT;
+
+    slots.resize(descriptor.slot_count);
+    for (auto& slot : slots) {
+        slot.staging = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "readback_buffer";
+            desc.size               = uint64_t(row_pitch) * descriptor.height;
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+        slot.fence = device.create_fence();
+    }
+}
+
+ReadbackRing::~ReadbackRing()
+{
+    // NOTE: pending callbacks are dropped, call flush() first to receive them
+    for (auto& slot : slots)
+        slot.staging.destroy();
+}
+
+auto ReadbackRing::enqueue(const GPUTexture& texture, GPUState state, uint64_t frame, ReadbackCallback callback) -> bool
+{
+    auto& device = RHI::get_current_device();
+
+    if (count == slots.size()) {
+        statistics.dropped++;
+        return false;
+    }
+
+    auto& slot    = slots.at((head + count) % slots.size());
+    slot.frame    = frame;
+    slot.callback = std::move(callback);
+    count++;
+
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.label = "readback_command_buffer";
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    auto src    = GPUImageCopyTexture{};
+    src.texture = texture;
+
+    auto dst           = GPUImageCopyBuffer{};
+    dst.buffer         = slot.staging;
+    dst.offset         = 0;
+    dst.bytes_per_row  = row_pitch;
+    dst.rows_per_image = descriptor.height;
+
+    auto extent   = GPUExtent3D{};
+    extent.width  = descriptor.width;
+    extent.height = descriptor.height;
+    extent.depth  = 1;
+
+    command.resource_barrier(state_transition(texture, state, copy_src_state()));
+    command.resource_barrier(state_transition(slot.staging, undefined_state(), copy_dst_state()));
+    command.copy_texture_to_buffer(src, dst, extent);
+    command.resource_barrier(state_transition(texture, copy_src_state(), state));
+    command.submit(slot.fence);
+    return true;
+}
+
+void ReadbackRing::poll(uint64_t frame)
+{
+    // copies complete in submission order, so the first one still running ends the scan
+    while (count > 0) {
+        auto& slot = slots.at(head);
+        if (!slot.fence.ready())
+            break;
+
+        statistics.latency = frame - slot.frame;
+        deliver(slot);
+    }
+}
+
+void ReadbackRing::flush()
+{
+    while (count > 0) {
+        auto& slot = slots.at(head);
+        slot.fence.wait();
+        deliver(slot);
+    }
+}
+
+void ReadbackRing::deliver(Slot& slot)
+{
+    auto pixels = slot.staging.get_mapped_range<uint8_t>();
+
+    auto image          = ReadbackImage{};
+    image.data          = pixels.data();
+    image.width         = descriptor.width;
+    image.height        = descriptor.height;
+    image.bytes_per_row = row_pitch;
+    image.format        = descriptor.format;
+    image.frame         = slot.frame;
+
+    // NOTE: the slot is only reused after the callback, which may enqueue again
+    if (slot.callback)
+        slot.callback(image);
+
+    slot.callback = nullptr;
+    head          = (head + 1) % static_cast<uint>(slots.size());
+    count--;
+    statistics.delivered++;
+}
+
+auto ReadbackRing::stats() const -> ReadbackStats
+{
+    auto result    = statistics;
+    result.pending = count;
+    return result;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+
+// Pixels of one readback, only valid during the callback.
+// NOTE: rows are padded to bytes_per_row, which is larger than width * 4 unless the width is a multiple of 64.
+struct ReadbackImage
+{
+    const uint8_t*              data          = nullptr;
+    uint                        width         = 0;
+    uint                        height        = 0;
+    uint                        bytes_per_row = 0;
+    lyra::rhi::GPUTextureFormat format        = lyra::rhi::GPUTextureFormat::RGBA8UNORM;
+    uint64_t                    frame         = 0;
+};
+
+using ReadbackCallback = std::function<void(const ReadbackImage&)>;
+
+struct ReadbackRingDescriptor
+{
+    uint                        width      = 0;
+    uint                        height     = 0;
+    lyra::rhi::GPUTextureFormat format     = lyra::rhi::GPUTextureFormat::RGBA8UNORM; // 4 bytes per texel
+    uint                        slot_count = 4; // frames in flight + 1, so that a steady stream never drops
+};
+
+struct ReadbackStats
+{
+    uint64_t delivered = 0;
+    uint64_t dropped   = 0; // readbacks refused because every staging buffer was in flight
+    uint     pending   = 0;
+    uint64_t latency   = 0; // frames between the last copy and its delivery
+};
+
+// Copies textures back to the CPU without waiting for the GPU.
+//
+// Every enqueue() copies the texture into the next MAP_READ staging buffer, in a submission of its own,
+// right after everything already submitted on the graphics queue. poll() checks the fences of the copies
+// in flight, and hands completed images to their callbacks, typically a few frames later. When every staging
+// buffer is still in flight, the readback is dropped instead of waiting for the GPU.
+class ReadbackRing
+{
+public:
+    explicit ReadbackRing(const ReadbackRingDescriptor& descriptor);
+    ~ReadbackRing();
+
+    ReadbackRing(const ReadbackRing&)            = delete;
+    ReadbackRing& operator=(const ReadbackRing&) = delete;
+
+    // The texture must be in the given state, and is returned to it after the copy.
+    auto enqueue(const lyra::rhi::GPUTexture& texture, lyra::rhi::GPUState state, uint64_t frame, ReadbackCallback callback) -> bool;
+
+    // Deliver completed readbacks in order, on the calling thread. Never waits.
+    void poll(uint64_t frame);
+
+    // Wait for every readback in flight, and deliver it.
+    void flush();
+
+    auto stats() const -> ReadbackStats;
+
+    auto bytes_per_row() const -> uint { return row_pitch; }
+
+private:
+    struct Slot
+    {
+        lyra::rhi::GPUBuffer staging;
+        lyra::rhi::GPUFence  fence;
+        ReadbackCallback     callback;
+        uint64_t             frame = 0;
+    };
+
+    void deliver(Slot& slot);
+
+private:
+    ReadbackRingDescriptor descriptor;
+    std::vector<Slot>      slots;
+    uint                   row_pitch = 0;
+    uint                   head      = 0; // oldest slot in flight
+    uint                   count     = 0; // slots in flight, starting at head
+    ReadbackStats          statistics;
+};
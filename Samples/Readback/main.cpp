@@ -0,0 +1,546 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+#include "ReadbackRing.h"
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 color;
+};
+
+struct FrameStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last;
+    double            accumulated = 0.0;
+    uint              frames      = 0;
+    glm::vec3         average     = glm::vec3(0.0f); // average color of the last delivered image
+};
+
+constexpr uint FRAMES_INFLIGHT   = 3;
+constexpr uint FRAMES_PER_TOGGLE = 240;
+constexpr uint SAMPLE_STRIDE     = 16; // texels between samples of the average color, in both directions
+
+GPUShaderModule               scene_vshader;
+GPUShaderModule               scene_fshader;
+GPUShaderModule               composite_vshader;
+GPUShaderModule               composite_fshader;
+GPUBindGroupLayout            scene_blayout;
+GPUBindGroupLayout            composite_blayout;
+GPUPipelineLayout             scene_playout;
+GPUPipelineLayout             composite_playout;
+GPURenderPipeline             scene_pipeline;
+GPURenderPipeline             composite_pipeline;
+GPUBuffer                     vbuffer;
+GPUBuffer                     ibuffer;
+GPUBuffer                     ubuffer;
+GPUBindGroup                  scene_bind_group;
+GPUTexture                    color;
+GPUTextureView                color_view;
+GPUBindGroup                  composite_bind_group;
+std::unique_ptr<ReadbackRing> readback;
+uint64_t                      frame_index          = 0;
+bool                          async                = true;
+bool                          screenshot_requested = false;
+FrameStats                    stats;
+
+auto read_shader_source(const std::string& name) -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open(name);
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+auto compile_shader(const std::string& name, const char* entry, const char* label) -> GPUShaderModule
+{
+    auto& device = RHI::get_current_device();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = name;
+        desc.path   = name;
+        desc.source = read_shader_source(name);
+        return compiler->compile(desc);
+    });
+
+    return execute([&]() {
+        auto code  = module->get_shader_blob(entry);
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = label;
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+}
+
+void setup_pipelines()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    scene_vshader     = compile_shader("scene.slang", "vsmain", "scene_vertex_shader");
+    scene_fshader     = compile_shader("scene.slang", "fsmain", "scene_fragment_shader");
+    composite_vshader = compile_shader("composite.slang", "vsmain", "composite_vertex_shader");
+    composite_fshader = compile_shader("composite.slang", "fsmain", "composite_fragment_shader");
+
+    scene_blayout = execute([&]() {
+        auto entry                      = GPUBindGroupLayoutEntry{};
+        entry.type                      = GPUBindingResourceType::BUFFER;
+        entry.binding                   = 0;
+        entry.count                     = 1;
+        entry.visibility                = GPUShaderStage::VERTEX;
+        entry.buffer.type               = GPUBufferBindingType::UNIFORM;
+        entry.buffer.has_dynamic_offset = false;
+
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(entry);
+        return device.create_bind_group_layout(desc);
+    });
+
+    composite_blayout = execute([&]() {
+        auto entry                   = GPUBindGroupLayoutEntry{};
+        entry.type                   = GPUBindingResourceType::TEXTURE;
+        entry.binding                = 0;
+        entry.count                  = 1;
+        entry.visibility             = GPUShaderStage::FRAGMENT;
+        entry.texture.sample_type    = GPUTextureSampleType::UNFILTERABLE_FLOAT;
+        entry.texture.view_dimension = GPUTextureViewDimension::x2D;
+        entry.texture.multisampled   = false;
+
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(entry);
+        return device.create_bind_group_layout(desc);
+    });
+
+    scene_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {scene_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    composite_playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {composite_blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    scene_pipeline = execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x3;
+        position.offset          = 0;
+        position.shader_location = 0;
+
+        auto vertex_color            = GPUVertexAttribute{};
+        vertex_color.format          = GPUVertexFormat::FLOAT32x3;
+        vertex_color.offset          = sizeof(float) * 3;
+        vertex_color.shader_location = 1;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position, vertex_color};
+        layout.array_stride = sizeof(Vertex);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto target         = GPUColorTargetState{};
+        target.format       = GPUTextureFormat::RGBA8UNORM;
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = scene_playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::ALWAYS;
+        desc.depth_stencil.depth_write_enabled     = false;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = scene_vshader;
+        desc.fragment.module                       = scene_fshader;
+        desc.vertex.buffers.push_back(layout);
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+
+    composite_pipeline = execute([&]() {
+        auto target         = GPUColorTargetState{};
+        target.format       = surface.get_current_format();
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = composite_playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::ALWAYS;
+        desc.depth_stencil.depth_write_enabled     = false;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = composite_vshader;
+        desc.fragment.module                       = composite_fshader;
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+}
+
+void setup_buffers()
+{
+    auto& device = RHI::get_current_device();
+
+    vbuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "vertex_buffer";
+        desc.size               = sizeof(Vertex) * 3;
+        desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    ibuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "index_buffer";
+        desc.size               = sizeof(uint32_t) * 3;
+        desc.usage              = GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    ubuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "uniform_buffer";
+        desc.size               = sizeof(glm::mat4x4);
+        desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    auto vertices           = vbuffer.get_mapped_range<Vertex>();
+    vertices.at(0).position = {-0.5f, -0.5f, 0.0f};
+    vertices.at(1).position = {0.5f, -0.5f, 0.0f};
+    vertices.at(2).position = {0.0f, 0.5f, 0.0f};
+    vertices.at(0).color    = {1.0f, 0.0f, 0.0f};
+    vertices.at(1).color    = {0.0f, 1.0f, 0.0f};
+    vertices.at(2).color    = {0.0f, 0.0f, 1.0f};
+
+    auto indices  = ibuffer.get_mapped_range<uint>();
+    indices.at(0) = 0;
+    indices.at(1) = 1;
+    indices.at(2) = 2;
+
+    scene_bind_group = execute([&]() {
+        auto entry          = GPUBindGroupEntry{};
+        entry.type          = GPUBindingResourceType::BUFFER;
+        entry.binding       = 0;
+        entry.index         = 0;
+        entry.buffer.buffer = ubuffer;
+        entry.buffer.offset = 0;
+        entry.buffer.size   = 0;
+
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = scene_blayout;
+        desc.entries.push_back(entry);
+        return device.create_bind_group(desc);
+    });
+}
+
+void setup_target()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // NOTE: the scene is rendered off-screen, in a format known to the CPU, and copied to the swapchain
+    color = execute([&]() {
+        auto desc            = GPUTextureDescriptor{};
+        desc.format          = GPUTextureFormat::RGBA8UNORM;
+        desc.size.width      = extent.width;
+        desc.size.height     = extent.height;
+        desc.size.depth      = 1;
+        desc.array_layers    = 1;
+        desc.mip_level_count = 1;
+        desc.usage           = GPUTextureUsage::RENDER_ATTACHMENT | GPUTextureUsage::TEXTURE_BINDING | GPUTextureUsage::COPY_SRC;
+        desc.label           = "scene_color";
+        return device.create_texture(desc);
+    });
+
+    color_view = color.create_view();
+
+    composite_bind_group = execute([&]() {
+        auto entry    = GPUBindGroupEntry{};
+        entry.type    = GPUBindingResourceType::TEXTURE;
+        entry.binding = 0;
+        entry.index   = 0;
+        entry.texture = color_view;
+
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = composite_blayout;
+        desc.entries.push_back(entry);
+        return device.create_bind_group(desc);
+    });
+
+    auto desc       = ReadbackRingDescriptor{};
+    desc.width      = extent.width;
+    desc.height     = extent.height;
+    desc.format     = GPUTextureFormat::RGBA8UNORM;
+    desc.slot_count = FRAMES_INFLIGHT + 1;
+    readback        = std::make_unique<ReadbackRing>(desc);
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    // deliver whatever is still in flight, then release the staging buffers
+    readback->flush();
+    readback.reset();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    color.destroy();
+    vbuffer.destroy();
+    ibuffer.destroy();
+    ubuffer.destroy();
+    scene_vshader.destroy();
+    scene_fshader.destroy();
+    composite_vshader.destroy();
+    composite_fshader.destroy();
+    scene_blayout.destroy();
+    composite_blayout.destroy();
+    scene_playout.destroy();
+    composite_playout.destroy();
+    scene_pipeline.destroy();
+    composite_pipeline.destroy();
+}
+
+void update(const WindowInput& input)
+{
+    static float time         = 0.0f;
+    static bool  key_was_down = false;
+    time += input.delta_time;
+
+    // F2 saves the next image that comes back from the GPU
+    auto key_down = input.is_key_down(KeyButton::F2);
+    if (key_down && !key_was_down)
+        screenshot_requested = true;
+    key_was_down = key_down;
+
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+    auto  aspect  = float(extent.width) / float(extent.height);
+
+    auto uniform  = ubuffer.get_mapped_range<glm::mat4>();
+    uniform.at(0) = glm::perspective(1.05f, aspect, 0.1f, 100.0f) *
+                    glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)) *
+                    glm::rotate(glm::mat4(1.0f), time, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+// NOTE: runs on the render thread, inside ReadbackRing::poll(), so it should stay cheap
+void on_readback(const ReadbackImage& image)
+{
+    auto sum   = glm::vec3(0.0f);
+    auto count = 0u;
+    for (uint y = 0; y < image.height; y += SAMPLE_STRIDE) {
+        auto* row = image.data + uint64_t(y) * image.bytes_per_row;
+        for (uint x = 0; x < image.width; x += SAMPLE_STRIDE) {
+            sum += glm::vec3(row[x * 4 + 0], row[x * 4 + 1], row[x * 4 + 2]) / 255.0f;
+            count++;
+        }
+    }
+    stats.average = count > 0 ? sum / float(count) : glm::vec3(0.0f);
+
+    if (!screenshot_requested)
+        return;
+    screenshot_requested = false;
+
+    // binary PPM, rows are written without their padding
+    auto path = "readback_" + std::to_string(image.frame) + ".ppm";
+    auto file = std::ofstream(path, std::ios::binary);
+    file << "P6\n" << image.width << " " << image.height << "\n255\n";
+    for (uint y = 0; y < image.height; y++) {
+        auto* row = image.data + uint64_t(y) * image.bytes_per_row;
+        for (uint x = 0; x < image.width; x++)
+            file.write(reinterpret_cast<const char*>(row + x * 4), 3);
+    }
+    std::cout << "Screenshot of frame " << image.frame << " saved to " << path << std::endl;
+}
+
+void report()
+{
+    auto now = FrameStats::Clock::now();
+    if (stats.frames > 0)
+        stats.accumulated += std::chrono::duration<double, std::milli>(now - stats.last).count();
+    stats.last = now;
+
+    // alternate between the readback ring and waiting for the device, to compare both
+    if (++stats.frames == FRAMES_PER_TOGGLE) {
+        auto readbacks = readback->stats();
+        std::cout << "Readback: " << (async ? "ASYNC" : "SYNC ")
+                  << ", Frame Time: " << stats.accumulated / (FRAMES_PER_TOGGLE - 1) << " ms"
+                  << ", Delivered: " << readbacks.delivered
+                  << ", Dropped: " << readbacks.dropped
+                  << ", Latency: " << readbacks.latency << " frames"
+                  << ", Average Color: (" << stats.average.x << ", " << stats.average.y << ", " << stats.average.z << ")" << std::endl;
+
+        async = !async;
+        stats = FrameStats{};
+    }
+}
+
+void render()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    // hand out the images whose copies have completed since the last frame
+    readback->poll(frame_index);
+
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    auto scene_attachment        = GPURenderPassColorAttachment{};
+    scene_attachment.clear_value = GPUColor{0.1f, 0.1f, 0.1f, 1.0f};
+    scene_attachment.load_op     = GPULoadOp::CLEAR;
+    scene_attachment.store_op    = GPUStoreOp::STORE;
+    scene_attachment.view        = color_view;
+
+    auto scene_pass                     = GPURenderPassDescriptor{};
+    scene_pass.color_attachments        = {scene_attachment};
+    scene_pass.depth_stencil_attachment = {};
+
+    auto present_attachment        = GPURenderPassColorAttachment{};
+    present_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 1.0f};
+    present_attachment.load_op     = GPULoadOp::CLEAR;
+    present_attachment.store_op    = GPUStoreOp::STORE;
+    present_attachment.view        = texture.view;
+
+    auto present_pass                     = GPURenderPassDescriptor{};
+    present_pass.color_attachments        = {present_attachment};
+    present_pass.depth_stencil_attachment = {};
+
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    command.resource_barrier(state_transition(color, undefined_state(), color_attachment_state()));
+    command.begin_render_pass(scene_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(scene_pipeline);
+    command.set_vertex_buffer(0, vbuffer);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+    command.set_bind_group(0, scene_bind_group);
+    command.draw_indexed(3, 1, 0, 0, 0);
+    command.end_render_pass();
+
+    command.resource_barrier(state_transition(color, color_attachment_state(), shader_resource_state(GPUShaderStage::FRAGMENT)));
+    command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    command.begin_render_pass(present_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(composite_pipeline);
+    command.set_bind_group(0, composite_bind_group);
+    command.draw(3, 1, 0, 0);
+    command.end_render_pass();
+    command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    // copy this frame back, in a submission right after the frame
+    readback->enqueue(color, shader_resource_state(GPUShaderStage::FRAGMENT), frame_index, on_readback);
+
+    // the naive way: wait for the copy right away, which drains the GPU every frame
+    if (!async) {
+        device.wait();
+        readback->poll(frame_index);
+    }
+
+    // present this frame to swapchain
+    texture.present();
+
+    report();
+    frame_index++;
+}
+
+int main()
+{
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Immediate; // NOTE: do not hide frame time behind vsync
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipelines);
+    win->bind<WindowEvent::START>(setup_buffers);
+    win->bind<WindowEvent::START>(setup_target);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
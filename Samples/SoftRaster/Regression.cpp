@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "Regression.h"
+
+// largest possible YIQ delta between two RGB8 colors
+constexpr float MAX_YIQ_DELTA = 35215.0f;
+
+auto yiq_delta(const uint8_t* a, const uint8_t* b) -> float
+{
+    auto r = float(a[0]) - float(b[0]);
+    auto g = float(a[1]) - float(b[1]);
+    auto l = float(a[2]) - float(b[2]);
+
+    auto y = r * 0.29889531f + g * 0.58662247f + l * 0.11448223f;
+    auto i = r * 0.59597799f - g * 0.27417610f - l * 0.32180189f;
+    auto q = r * 0.21147017f - g * 0.52261711f + l * 0.31114694f;
+    return 0.5053f * y * y + 0.299f * i * i + 0.1957f * q * q;
+}
+
+auto to_image(const SoftColorTarget& target) -> Image
+{
+    auto image   = Image{};
+    image.width  = target.width;
+    image.height = target.height;
+    image.rgb.reserve(target.pixels.size() * 3);
+    for (auto pixel : target.pixels) {
+        image.rgb.push_back(uint8_t(pixel & 0xFF));
+        image.rgb.push_back(uint8_t(pixel >> 8 & 0xFF));
+        image.rgb.push_back(uint8_t(pixel >> 16 & 0xFF));
+    }
+    return image;
+}
+
+auto load_ppm(const std::string& path, Image& image) -> bool
+{
+    auto file = std::ifstream(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    auto magic = std::string{};
+    auto depth = uint(0);
+    file >> magic >> image.width >> image.height >> depth;
+    if (!file || magic != "P6" || depth != 255)
+        return false;
+
+    // NOTE: a single whitespace separates the header from the pixels
+    file.get();
+
+    image.rgb.resize(size_t(image.width) * image.height * 3);
+    file.read(reinterpret_cast<char*>(image.rgb.data()), image.rgb.size());
+    return bool(file);
+}
+
+auto save_ppm(const std::string& path, const Image& image) -> bool
+{
+    auto file = std::ofstream(path, std::ios::binary);
+    file << "P6\n" << image.width << " " << image.height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(image.rgb.data()), image.rgb.size());
+    return bool(file);
+}
+
+auto compare_images(const Image& image, const Image& reference, float threshold, Image* diff) -> ImageDifference
+{
+    auto result  = ImageDifference{};
+    result.total = uint64_t(reference.width) * reference.height;
+    if (image.width != reference.width || image.height != reference.height) {
+        result.different = result.total;
+        result.max_delta = 1.0f;
+        return result;
+    }
+
+    if (diff) {
+        diff->width  = reference.width;
+        diff->height = reference.height;
+        diff->rgb.resize(reference.rgb.size());
+    }
+
+    auto limit = MAX_YIQ_DELTA * threshold * threshold;
+    for (size_t i = 0; i < result.total; i++) {
+        auto delta       = yiq_delta(&image.rgb[i * 3], &reference.rgb[i * 3]);
+        auto different   = delta > limit;
+        result.max_delta = std::max(result.max_delta, std::sqrt(delta / MAX_YIQ_DELTA));
+        result.different += different;
+
+        if (diff) {
+            auto luma  = (reference.rgb[i * 3] * 77 + reference.rgb[i * 3 + 1] * 150 + reference.rgb[i * 3 + 2] * 29) >> 8;
+            auto faded = uint8_t(255 - (255 - luma) / 4);
+            auto pixel = &diff->rgb[i * 3];
+            pixel[0]   = different ? 255 : faded;
+            pixel[1]   = different ? 0 : faded;
+            pixel[2]   = different ? 0 : faded;
+        }
+    }
+    return result;
+}
+
+auto load_baseline(const std::string& path, std::map<std::string, double>& baseline) -> bool
+{
+    auto file = std::ifstream(path);
+    if (!file)
+        return false;
+
+    auto scene = std::string{};
+    auto ms    = 0.0;
+    while (file >> scene >> ms)
+        baseline[scene] = ms;
+    return file.eof();
+}
+
+auto save_baseline(const std::string& path, const std::map<std::string, double>& baseline) -> bool
+{
+    auto file = std::ofstream(path);
+    for (auto& [scene, ms] : baseline)
+        file << scene << " " << ms << "\n";
+    return bool(file);
+}
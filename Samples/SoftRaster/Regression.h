@@ -0,0 +1,37 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SoftRasterizer.h"
+
+// RGB8 image, as stored in binary PPM files.
+struct Image
+{
+    uint                 width  = 0;
+    uint                 height = 0;
+    std::vector<uint8_t> rgb;
+};
+
+struct ImageDifference
+{
+    uint64_t different = 0; // pixels above the threshold
+    uint64_t total     = 0;
+    float    max_delta = 0.0f; // largest perceptual difference, in [0, 1]
+
+    auto fraction() const -> double { return total == 0 ? 1.0 : double(different) / double(total); }
+};
+
+auto to_image(const SoftColorTarget& target) -> Image;
+auto load_ppm(const std::string& path, Image& image) -> bool;
+auto save_ppm(const std::string& path, const Image& image) -> bool;
+
+// Compares two images with the YIQ color difference of pixelmatch, which weighs luma above chroma,
+// the same way the eye does. A pixel differs when its difference is above threshold (0 to 1).
+// Differing pixels are marked red in diff, on top of a faded copy of the reference.
+auto compare_images(const Image& image, const Image& reference, float threshold, Image* diff = nullptr) -> ImageDifference;
+
+// Frame time baselines, one "scene ms/frame" pair per line.
+auto load_baseline(const std::string& path, std::map<std::string, double>& baseline) -> bool;
+auto save_baseline(const std::string& path, const std::map<std::string, double>& baseline) -> bool;
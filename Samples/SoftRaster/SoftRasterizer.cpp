@@ -0,0 +1,755 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LYRA_SOFT_SSE2 1
+#endif
+
+#include "SoftRasterizer.h"
+
+using namespace lyra;
+using namespace lyra::rhi;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint  VERTEX_BLOCK = 1024;          // vertices shaded per job
+    constexpr float GUARD_BAND   = 16.0f;         // x and y are only clipped beyond 16 viewports, to keep edge functions precise
+    constexpr float MIN_W        = 1e-6f;         // NOTE: guards the perspective divide, near plane clipping normally comes first
+    constexpr uint  CLIP_PLANES  = 7;             // near, far, left, right, bottom, top, w
+    constexpr uint  MAX_CLIPPED  = 3 + CLIP_PLANES; // each plane adds at most one vertex
+
+    inline auto elapsed_ms(Clock::time_point start) -> double
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+#if defined(LYRA_SOFT_SSE2)
+    struct Lanes
+    {
+        __m128 v;
+    };
+
+    inline auto splat(float x) -> Lanes { return {_mm_set1_ps(x)}; }
+    inline auto lanes(float a, float b, float c, float d) -> Lanes { return {_mm_setr_ps(a, b, c, d)}; }
+    inline auto operator+(Lanes a, Lanes b) -> Lanes { return {_mm_add_ps(a.v, b.v)}; }
+    inline auto operator-(Lanes a, Lanes b) -> Lanes { return {_mm_sub_ps(a.v, b.v)}; }
+    inline auto operator*(Lanes a, Lanes b) -> Lanes { return {_mm_mul_ps(a.v, b.v)}; }
+    inline auto operator/(Lanes a, Lanes b) -> Lanes { return {_mm_div_ps(a.v, b.v)}; }
+    inline void store(Lanes a, float* p) { _mm_storeu_ps(p, a.v); }
+
+    // bit i is set when the comparison holds for lane i
+    inline auto greater(Lanes a, Lanes b) -> uint { return uint(_mm_movemask_ps(_mm_cmpgt_ps(a.v, b.v))); }
+    inline auto equal(Lanes a, Lanes b) -> uint { return uint(_mm_movemask_ps(_mm_cmpeq_ps(a.v, b.v))); }
+#else
+    struct Lanes
+    {
+        float v[4];
+    };
+
+    template <typename F>
+    inline auto map(Lanes a, Lanes b, F f) -> Lanes
+    {
+        return {{f(a.v[0], b.v[0]), f(a.v[1], b.v[1]), f(a.v[2], b.v[2]), f(a.v[3], b.v[3])}};
+    }
+
+    template <typename F>
+    inline auto mask(Lanes a, Lanes b, F f) -> uint
+    {
+        return uint(f(a.v[0], b.v[0])) | uint(f(a.v[1], b.v[1])) << 1 | uint(f(a.v[2], b.v[2])) << 2 | uint(f(a.v[3], b.v[3])) << 3;
+    }
+
+    inline auto splat(float x) -> Lanes { return {{x, x, x, x}}; }
+    inline auto lanes(float a, float b, float c, float d) -> Lanes { return {{a, b, c, d}}; }
+    inline auto operator+(Lanes a, Lanes b) -> Lanes { return map(a, b, [](float x, float y) { return x + y; }); }
+    inline auto operator-(Lanes a, Lanes b) -> Lanes { return map(a, b, [](float x, float y) { return x - y; }); }
+    inline auto operator*(Lanes a, Lanes b) -> Lanes { return map(a, b, [](float x, float y) { return x * y; }); }
+    inline auto operator/(Lanes a, Lanes b) -> Lanes { return map(a, b, [](float x, float y) { return x / y; }); }
+    inline void store(Lanes a, float* p) { std::copy(a.v, a.v + 4, p); }
+
+    inline auto greater(Lanes a, Lanes b) -> uint { return mask(a, b, [](float x, float y) { return x > y; }); }
+    inline auto equal(Lanes a, Lanes b) -> uint { return mask(a, b, [](float x, float y) { return x == y; }); }
+#endif
+
+    template <typename T>
+    inline auto compare(GPUCompareFunction function, T value, T reference) -> bool
+    {
+        switch (function) {
+            case GPUCompareFunction::NEVER:
+                return false;
+            case GPUCompareFunction::LESS:
+                return value < reference;
+            case GPUCompareFunction::EQUAL:
+                return value == reference;
+            case GPUCompareFunction::LESS_EQUAL:
+                return value <= reference;
+            case GPUCompareFunction::GREATER:
+                return value > reference;
+            case GPUCompareFunction::NOT_EQUAL:
+                return value != reference;
+            case GPUCompareFunction::GREATER_EQUAL:
+                return value >= reference;
+            default:
+                return true;
+        }
+    }
+
+    inline auto stencil_operation(GPUStencilOperation operation, uint8_t value, uint8_t reference) -> uint8_t
+    {
+        switch (operation) {
+            case GPUStencilOperation::ZERO:
+                return 0;
+            case GPUStencilOperation::REPLACE:
+                return reference;
+            case GPUStencilOperation::INVERT:
+                return uint8_t(~value);
+            case GPUStencilOperation::INCREMENT_CLAMP:
+                return value == 0xFF ? value : uint8_t(value + 1);
+            case GPUStencilOperation::DECREMENT_CLAMP:
+                return value == 0x00 ? value : uint8_t(value - 1);
+            case GPUStencilOperation::INCREMENT_WRAP:
+                return uint8_t(value + 1);
+            case GPUStencilOperation::DECREMENT_WRAP:
+                return uint8_t(value - 1);
+            default:
+                return value;
+        }
+    }
+
+    // depth is tested and stored with the precision of the format
+    inline auto quantize_depth(GPUTextureFormat format, float depth) -> float
+    {
+        depth = std::clamp(depth, 0.0f, 1.0f);
+        switch (format) {
+            case GPUTextureFormat::DEPTH16UNORM:
+                return std::round(depth * 65535.0f) / 65535.0f;
+            case GPUTextureFormat::DEPTH24PLUS:
+            case GPUTextureFormat::DEPTH24PLUS_STENCIL8:
+                return float(std::round(double(depth) * 16777215.0) / 16777215.0);
+            default:
+                return depth;
+        }
+    }
+
+    inline auto pack_color(const glm::vec4& color) -> uint32_t
+    {
+        auto unorm = [](float x) { return uint32_t(std::clamp(x, 0.0f, 1.0f) * 255.0f + 0.5f); };
+        return unorm(color.x) | unorm(color.y) << 8 | unorm(color.z) << 16 | unorm(color.w) << 24;
+    }
+
+    inline auto color_byte_mask(uint write_mask) -> uint32_t
+    {
+        auto mask = 0u;
+        if (write_mask & GPUColorWrite::RED) mask |= 0x000000FFu;
+        if (write_mask & GPUColorWrite::GREEN) mask |= 0x0000FF00u;
+        if (write_mask & GPUColorWrite::BLUE) mask |= 0x00FF0000u;
+        if (write_mask & GPUColorWrite::ALPHA) mask |= 0xFF000000u;
+        return mask;
+    }
+
+    inline auto has_stencil(GPUTextureFormat format) -> bool
+    {
+        return format == GPUTextureFormat::DEPTH24PLUS_STENCIL8;
+    }
+
+    // signed distance of a clip space position to each clipping plane, inside is >= 0
+    inline void clip_distances(const glm::vec4& p, float distances[CLIP_PLANES])
+    {
+        distances[0] = p.z;
+        distances[1] = p.w - p.z;
+        distances[2] = p.x + GUARD_BAND * p.w;
+        distances[3] = GUARD_BAND * p.w - p.x;
+        distances[4] = p.y + GUARD_BAND * p.w;
+        distances[5] = GUARD_BAND * p.w - p.y;
+        distances[6] = p.w - MIN_W;
+    }
+
+    inline auto clip_distance(const glm::vec4& p, uint plane) -> float
+    {
+        float distances[CLIP_PLANES];
+        clip_distances(p, distances);
+        return distances[plane];
+    }
+
+    inline auto lerp_vertex(const SoftVertex& a, const SoftVertex& b, float t, uint varying_count) -> SoftVertex
+    {
+        auto v     = SoftVertex{};
+        v.position = a.position + (b.position - a.position) * t;
+        for (uint i = 0; i < varying_count; i++)
+            v.varyings[i] = a.varyings[i] + (b.varyings[i] - a.varyings[i]) * t;
+        return v;
+    }
+} // namespace
+
+struct SoftRasterizer::Triangle
+{
+    double a[3], b[3], c[3];   // edge functions, E(x, y) = a * x + b * y + c, positive inside
+    bool   top_left[3];        // pixels exactly on top and left edges belong to the triangle
+    float  inv_area = 0.0f;    // barycentrics are E1 * inv_area and E2 * inv_area
+    float  depth[3];           // z0, z1 - z0, z2 - z0, interpolated linearly in screen space
+    float  inv_w[3];           // same layout, for perspective correction
+    float  varyings[SOFT_MAX_VARYINGS][3];
+    int    min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+    uint   pipeline   = 0;
+    uint   reference  = 0;
+    bool   front_face = true;
+};
+
+struct SoftRasterizer::Bin
+{
+    std::vector<Triangle>              triangles;
+    std::vector<std::vector<uint32_t>> tiles; // triangles overlapping each tile, in submission order
+};
+
+SoftRasterizer::SoftRasterizer(uint thread_count)
+{
+    if (thread_count == 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+    for (uint i = 0; i < thread_count; i++)
+        bins.push_back(std::make_unique<Bin>());
+    quads.resize(thread_count);
+
+    for (uint i = 1; i < thread_count; i++)
+        workers.emplace_back([this, i]() { worker_loop(i); });
+}
+
+SoftRasterizer::~SoftRasterizer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void SoftRasterizer::begin_render_pass(const SoftRenderPass& desc)
+{
+    if (in_pass)
+        throw std::runtime_error("begin_render_pass called inside of a render pass");
+    if (!desc.color && !desc.depth_stencil)
+        throw std::runtime_error("render pass requires at least one attachment");
+    if (desc.color && desc.depth_stencil &&
+        (desc.color->width != desc.depth_stencil->width || desc.color->height != desc.depth_stencil->height))
+        throw std::runtime_error("render pass attachments differ in size");
+
+    auto width  = desc.color ? desc.color->width : desc.depth_stencil->width;
+    auto height = desc.color ? desc.color->height : desc.depth_stencil->height;
+
+    pass    = desc;
+    in_pass = true;
+    tiles_x = (width + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    tiles_y = (height + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+
+    for (auto& bin : bins)
+        bin->tiles.resize(tiles_x * tiles_y);
+}
+
+void SoftRasterizer::set_pipeline(const SoftPipeline& pipeline)
+{
+    if (pipeline.primitive.topology != GPUPrimitiveTopology::TRIANGLE_LIST)
+        throw std::runtime_error("software rasterizer only supports triangle lists");
+    if (pipeline.varying_count > SOFT_MAX_VARYINGS)
+        throw std::runtime_error("too many varyings for the software rasterizer");
+
+    pipelines.push_back(pipeline);
+}
+
+void SoftRasterizer::set_stencil_reference(uint value)
+{
+    reference = value;
+}
+
+void SoftRasterizer::draw(uint vertex_count, uint first_vertex)
+{
+    if (pipelines.empty())
+        throw std::runtime_error("draw called without a pipeline");
+
+    auto draw      = Draw{};
+    draw.pipeline  = static_cast<uint>(pipelines.size() - 1);
+    draw.reference = reference;
+    draw.first     = first_vertex;
+    draw.count     = vertex_count / 3 * 3;
+    draw.base      = first_vertex;
+    draws.push_back(std::move(draw));
+}
+
+void SoftRasterizer::draw_indexed(const uint32_t* indices, uint index_count)
+{
+    if (pipelines.empty())
+        throw std::runtime_error("draw_indexed called without a pipeline");
+
+    auto draw      = Draw{};
+    draw.pipeline  = static_cast<uint>(pipelines.size() - 1);
+    draw.reference = reference;
+    draw.count     = index_count / 3 * 3;
+    draw.indices.assign(indices, indices + draw.count);
+    draw.base = draw.indices.empty() ? 0 : *std::min_element(draw.indices.begin(), draw.indices.end());
+    draws.push_back(std::move(draw));
+}
+
+void SoftRasterizer::end_render_pass()
+{
+    if (!in_pass)
+        throw std::runtime_error("end_render_pass called outside of a render pass");
+
+    auto start = Clock::now();
+    shade_vertices();
+    statistics.vertex_ms += elapsed_ms(start);
+
+    start = Clock::now();
+    bin_triangles();
+    statistics.binning_ms += elapsed_ms(start);
+
+    start = Clock::now();
+    std::fill(quads.begin(), quads.end(), 0);
+    parallel_for(tiles_x * tiles_y, [&](uint tile, uint thread) { rasterize_tile(tile, thread); });
+    statistics.raster_ms += elapsed_ms(start);
+
+    for (auto& draw : draws)
+        statistics.triangles += draw.count / 3;
+    for (auto& bin : bins)
+        statistics.rasterized += bin->triangles.size();
+    for (auto count : quads)
+        statistics.quads += count;
+
+    draws.clear();
+    pipelines.clear();
+    in_pass = false;
+}
+
+void SoftRasterizer::shade_vertices()
+{
+    // split every draw into blocks of vertices, so that a single large draw still spreads over all threads
+    struct Block
+    {
+        Draw* draw;
+        uint  begin;
+    };
+
+    auto blocks = std::vector<Block>{};
+    for (auto& draw : draws) {
+        auto count = draw.count;
+        if (!draw.indices.empty())
+            count = *std::max_element(draw.indices.begin(), draw.indices.end()) - draw.base + 1;
+
+        draw.vertices.resize(count);
+        for (uint begin = 0; begin < count; begin += VERTEX_BLOCK)
+            blocks.push_back({&draw, begin});
+    }
+
+    parallel_for(static_cast<uint>(blocks.size()), [&](uint index, uint) {
+        auto& block  = blocks.at(index);
+        auto& draw   = *block.draw;
+        auto& shader = pipelines.at(draw.pipeline).vertex;
+        auto  end    = std::min(block.begin + VERTEX_BLOCK, static_cast<uint>(draw.vertices.size()));
+        for (uint i = block.begin; i < end; i++)
+            shader(draw.base + i, draw.vertices[i]);
+    });
+}
+
+void SoftRasterizer::bin_triangles()
+{
+    // triangle offset of each draw, followed by the total
+    auto offsets = std::vector<uint64_t>{0};
+    for (auto& draw : draws)
+        offsets.push_back(offsets.back() + draw.count / 3);
+
+    auto total  = offsets.back();
+    auto chunks = static_cast<uint>(bins.size());
+
+    parallel_for(chunks, [&](uint chunk, uint) {
+        auto& bin = *bins.at(chunk);
+        bin.triangles.clear();
+        for (auto& tile : bin.tiles)
+            tile.clear();
+
+        auto begin = total * chunk / chunks;
+        auto end   = total * (chunk + 1) / chunks;
+        auto d     = size_t(std::upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin() - 1);
+
+        for (auto t = begin; t < end; t++) {
+            while (t >= offsets[d + 1])
+                d++;
+
+            auto& draw  = draws[d];
+            auto  local = uint(t - offsets[d]) * 3;
+
+            const SoftVertex* vertices[3];
+            for (uint k = 0; k < 3; k++) {
+                auto index  = draw.indices.empty() ? draw.first + local + k : draw.indices[local + k];
+                vertices[k] = &draw.vertices[index - draw.base];
+            }
+            clip_triangle(draw, vertices, bin);
+        }
+    });
+}
+
+void SoftRasterizer::clip_triangle(const Draw& draw, const SoftVertex* vertices[3], Bin& bin)
+{
+    float distances[3][CLIP_PLANES];
+    for (uint k = 0; k < 3; k++)
+        clip_distances(vertices[k]->position, distances[k]);
+
+    auto clipped = false;
+    for (uint plane = 0; plane < CLIP_PLANES; plane++) {
+        auto outside = uint(distances[0][plane] < 0.0f) + uint(distances[1][plane] < 0.0f) + uint(distances[2][plane] < 0.0f);
+        if (outside == 3)
+            return;
+        clipped |= outside > 0;
+    }
+
+    if (!clipped) {
+        setup_triangle(draw, vertices, bin);
+        return;
+    }
+
+    // Sutherland-Hodgman against each plane, varyings are interpolated linearly in clip space
+    auto varying_count = pipelines.at(draw.pipeline).varying_count;
+
+    SoftVertex polygon[2][MAX_CLIPPED];
+    uint       count[2] = {3, 0};
+    for (uint k = 0; k < 3; k++)
+        polygon[0][k] = *vertices[k];
+
+    auto current = 0u;
+    for (uint plane = 0; plane < CLIP_PLANES; plane++) {
+        auto& input  = polygon[current];
+        auto& output = polygon[current ^ 1];
+        auto  n      = 0u;
+
+        for (uint i = 0; i < count[current]; i++) {
+            auto& a  = input[i];
+            auto& b  = input[(i + 1) % count[current]];
+            auto  da = clip_distance(a.position, plane);
+            auto  db = clip_distance(b.position, plane);
+
+            if (da >= 0.0f)
+                output[n++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+                output[n++] = lerp_vertex(a, b, da / (da - db), varying_count);
+        }
+
+        count[current ^ 1] = n;
+        current ^= 1;
+        if (n < 3)
+            return;
+    }
+
+    for (uint i = 1; i + 1 < count[current]; i++) {
+        const SoftVertex* triangle[3] = {&polygon[current][0], &polygon[current][i], &polygon[current][i + 1]};
+        setup_triangle(draw, triangle, bin);
+    }
+}
+
+void SoftRasterizer::setup_triangle(const Draw& draw, const SoftVertex* vertices[3], Bin& bin)
+{
+    auto& pipeline = pipelines.at(draw.pipeline);
+    auto  width    = pass.color ? pass.color->width : pass.depth_stencil->width;
+    auto  height   = pass.color ? pass.color->height : pass.depth_stencil->height;
+
+    // viewport transform, y points down in pixels
+    double x[3], y[3];
+    float  z[3], inv_w[3];
+    for (uint k = 0; k < 3; k++) {
+        auto& p  = vertices[k]->position;
+        inv_w[k] = 1.0f / p.w;
+        x[k]     = (double(p.x) * inv_w[k] * 0.5 + 0.5) * width;
+        y[k]     = (0.5 - double(p.y) * inv_w[k] * 0.5) * height;
+        z[k]     = p.z * inv_w[k];
+    }
+
+    auto area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area == 0.0)
+        return;
+
+    // NOTE: y is flipped, so counter-clockwise in normalized device coordinates is clockwise in pixels
+    auto ccw   = area < 0.0;
+    auto front = (pipeline.primitive.front_face == GPUFrontFace::CCW) == ccw;
+    if (pipeline.primitive.cull_mode == GPUCullMode::FRONT && front) return;
+    if (pipeline.primitive.cull_mode == GPUCullMode::BACK && !front) return;
+
+    // reorder to a positive area, so that every edge function is positive inside
+    uint order[3] = {0, 1, 2};
+    if (area < 0.0) {
+        std::swap(order[1], order[2]);
+        area = -area;
+    }
+
+    auto tri       = Triangle{};
+    tri.pipeline   = draw.pipeline;
+    tri.reference  = draw.reference;
+    tri.front_face = front;
+    tri.inv_area   = float(1.0 / area);
+
+    for (uint k = 0; k < 3; k++) {
+        auto i = order[(k + 1) % 3];
+        auto j = order[(k + 2) % 3];
+
+        tri.a[k]        = y[i] - y[j];
+        tri.b[k]        = x[j] - x[i];
+        tri.c[k]        = -(tri.a[k] * x[i] + tri.b[k] * y[i]);
+        tri.top_left[k] = tri.a[k] > 0.0 || (tri.a[k] == 0.0 && tri.b[k] > 0.0);
+    }
+
+    auto v0 = order[0], v1 = order[1], v2 = order[2];
+
+    tri.depth[0] = z[v0];
+    tri.depth[1] = z[v1] - z[v0];
+    tri.depth[2] = z[v2] - z[v0];
+    tri.inv_w[0] = inv_w[v0];
+    tri.inv_w[1] = inv_w[v1] - inv_w[v0];
+    tri.inv_w[2] = inv_w[v2] - inv_w[v0];
+    for (uint i = 0; i < pipeline.varying_count; i++) {
+        auto a0            = vertices[v0]->varyings[i] * inv_w[v0];
+        auto a1            = vertices[v1]->varyings[i] * inv_w[v1];
+        auto a2            = vertices[v2]->varyings[i] * inv_w[v2];
+        tri.varyings[i][0] = a0;
+        tri.varyings[i][1] = a1 - a0;
+        tri.varyings[i][2] = a2 - a0;
+    }
+
+    // bounding box of pixel centres, clamped to the target
+    tri.min_x = std::max(0, int(std::floor(std::min({x[0], x[1], x[2]}) - 0.5)));
+    tri.min_y = std::max(0, int(std::floor(std::min({y[0], y[1], y[2]}) - 0.5)));
+    tri.max_x = std::min(int(width) - 1, int(std::ceil(std::max({x[0], x[1], x[2]}) - 0.5)));
+    tri.max_y = std::min(int(height) - 1, int(std::ceil(std::max({y[0], y[1], y[2]}) - 0.5)));
+    if (tri.min_x > tri.max_x || tri.min_y > tri.max_y)
+        return;
+
+    auto index = static_cast<uint32_t>(bin.triangles.size());
+    bin.triangles.push_back(tri);
+
+    for (uint ty = uint(tri.min_y) / SOFT_TILE_SIZE; ty <= uint(tri.max_y) / SOFT_TILE_SIZE; ty++)
+        for (uint tx = uint(tri.min_x) / SOFT_TILE_SIZE; tx <= uint(tri.max_x) / SOFT_TILE_SIZE; tx++)
+            bin.tiles[ty * tiles_x + tx].push_back(index);
+}
+
+void SoftRasterizer::rasterize_tile(uint tile, uint thread)
+{
+    auto  width  = pass.color ? pass.color->width : pass.depth_stencil->width;
+    auto  height = pass.color ? pass.color->height : pass.depth_stencil->height;
+    auto  tx0    = (tile % tiles_x) * SOFT_TILE_SIZE;
+    auto  ty0    = (tile / tiles_x) * SOFT_TILE_SIZE;
+    auto  tx1    = std::min(tx0 + SOFT_TILE_SIZE, width);
+    auto  ty1    = std::min(ty0 + SOFT_TILE_SIZE, height);
+    auto* color  = pass.color;
+    auto* ds     = pass.depth_stencil;
+
+    // clears are tile local as well, so they run in parallel with no extra pass
+    if (color && pass.color_load_op == GPULoadOp::CLEAR) {
+        auto value = pack_color(pass.color_clear_value);
+        for (auto y = ty0; y < ty1; y++)
+            std::fill_n(color->pixels.data() + size_t(y) * width + tx0, tx1 - tx0, value);
+    }
+    if (ds && pass.depth_load_op == GPULoadOp::CLEAR) {
+        auto value = quantize_depth(ds->format, pass.depth_clear_value);
+        for (auto y = ty0; y < ty1; y++)
+            std::fill_n(ds->depth.data() + size_t(y) * width + tx0, tx1 - tx0, value);
+    }
+    if (ds && has_stencil(ds->format) && pass.stencil_load_op == GPULoadOp::CLEAR) {
+        auto value = uint8_t(pass.stencil_clear_value);
+        for (auto y = ty0; y < ty1; y++)
+            std::fill_n(ds->stencil.data() + size_t(y) * width + tx0, tx1 - tx0, value);
+    }
+
+    auto lane_x  = lanes(0.0f, 1.0f, 0.0f, 1.0f);
+    auto lane_y  = lanes(0.0f, 0.0f, 1.0f, 1.0f);
+    auto zero    = splat(0.0f);
+    auto shaded  = uint64_t(0);
+    auto quad    = SoftQuad{};
+    auto output  = SoftFragmentOutput{};
+
+    for (auto& bin : bins) {
+        for (auto index : bin->tiles[tile]) {
+            auto& tri      = bin->triangles[index];
+            auto& pipeline = pipelines[tri.pipeline];
+            auto& state    = pipeline.depth_stencil;
+            auto& face     = tri.front_face ? state.stencil_front : state.stencil_back;
+
+            auto stencil_active = ds && has_stencil(ds->format) &&
+                                  (face.compare != GPUCompareFunction::ALWAYS || face.fail_op != GPUStencilOperation::KEEP ||
+                                   face.depth_fail_op != GPUStencilOperation::KEEP || face.pass_op != GPUStencilOperation::KEEP);
+            auto depth_active   = ds && (state.depth_compare != GPUCompareFunction::ALWAYS || state.depth_write_enabled);
+            auto color_mask     = color ? color_byte_mask(pipeline.color_write_mask) : 0u;
+            auto reference      = uint8_t(tri.reference & state.stencil_read_mask);
+            auto read_mask      = uint8_t(state.stencil_read_mask);
+            auto write_mask     = uint8_t(state.stencil_write_mask);
+
+            // quads start on even pixels, so that a quad never straddles two tiles
+            auto x0 = std::max(uint(tri.min_x), tx0) & ~1u;
+            auto y0 = std::max(uint(tri.min_y), ty0) & ~1u;
+            auto x1 = std::min(uint(tri.max_x) + 1, tx1);
+            auto y1 = std::min(uint(tri.max_y) + 1, ty1);
+
+            // edge functions relative to the first quad, computed in double, stepped in float
+            Lanes edge_row[3], step_x[3], step_y[3];
+            for (uint k = 0; k < 3; k++) {
+                auto origin = tri.a[k] * (x0 + 0.5) + tri.b[k] * (y0 + 0.5) + tri.c[k];
+                edge_row[k] = splat(float(origin)) + splat(float(tri.a[k])) * lane_x + splat(float(tri.b[k])) * lane_y;
+                step_x[k]   = splat(float(tri.a[k] * 2.0));
+                step_y[k]   = splat(float(tri.b[k] * 2.0));
+            }
+
+            for (auto qy = y0; qy < y1; qy += 2) {
+                Lanes edge[3] = {edge_row[0], edge_row[1], edge_row[2]};
+
+                for (auto qx = x0; qx < x1; qx += 2) {
+                    auto covered = 0xFu;
+                    for (uint k = 0; k < 3; k++)
+                        covered &= greater(edge[k], zero) | (tri.top_left[k] ? equal(edge[k], zero) : 0u);
+
+                    // lanes beyond the target, for odd sizes
+                    if (qx + 1 >= width) covered &= 0x5u;
+                    if (qy + 1 >= height) covered &= 0x3u;
+
+                    if (covered) {
+                        auto l1 = edge[1] * splat(tri.inv_area);
+                        auto l2 = edge[2] * splat(tri.inv_area);
+                        auto z  = splat(tri.depth[0]) + l1 * splat(tri.depth[1]) + l2 * splat(tri.depth[2]);
+                        store(z, quad.depth);
+
+                        size_t offsets[4];
+                        for (uint i = 0; i < 4; i++)
+                            offsets[i] = size_t(qy + (i >> 1)) * width + qx + (i & 1);
+
+                        auto stencil_failed = 0u;
+                        auto depth_failed   = 0u;
+
+                        if (stencil_active) {
+                            for (uint i = 0; i < 4; i++)
+                                if ((covered >> i & 1) && !compare(face.compare, reference, uint8_t(ds->stencil[offsets[i]] & read_mask)))
+                                    stencil_failed |= 1u << i;
+                        }
+
+                        auto passed = covered & ~stencil_failed;
+                        if (ds) {
+                            for (uint i = 0; i < 4; i++) {
+                                quad.depth[i] = quantize_depth(ds->format, quad.depth[i]);
+                                if (depth_active && (passed >> i & 1) && !compare(state.depth_compare, quad.depth[i], ds->depth[offsets[i]]))
+                                    depth_failed |= 1u << i;
+                            }
+                        }
+
+                        passed &= ~depth_failed;
+                        auto written = passed;
+
+                        if (passed && pipeline.fragment) {
+                            quad.x          = qx;
+                            quad.y          = qy;
+                            quad.coverage   = covered;
+                            quad.front_face = tri.front_face;
+
+                            auto w = splat(1.0f) / (splat(tri.inv_w[0]) + l1 * splat(tri.inv_w[1]) + l2 * splat(tri.inv_w[2]));
+                            for (uint v = 0; v < pipeline.varying_count; v++) {
+                                auto& plane = tri.varyings[v];
+                                store((splat(plane[0]) + l1 * splat(plane[1]) + l2 * splat(plane[2])) * w, quad.varyings[v]);
+                            }
+
+                            output.discard = 0;
+                            pipeline.fragment(quad, output);
+                            written &= ~output.discard;
+                            shaded++;
+                        }
+
+                        if (stencil_active) {
+                            for (uint i = 0; i < 4; i++) {
+                                auto bit = 1u << i;
+                                if (!(covered & bit) || ((passed & bit) && !(written & bit)))
+                                    continue; // discarded fragments leave the stencil untouched
+
+                                auto operation = (stencil_failed & bit) ? face.fail_op
+                                                 : (depth_failed & bit) ? face.depth_fail_op
+                                                                        : face.pass_op;
+
+                                auto& value = ds->stencil[offsets[i]];
+                                auto  next  = stencil_operation(operation, value, uint8_t(tri.reference));
+                                value       = uint8_t((value & ~write_mask) | (next & write_mask));
+                            }
+                        }
+
+                        if (ds && state.depth_write_enabled) {
+                            for (uint i = 0; i < 4; i++)
+                                if (written >> i & 1)
+                                    ds->depth[offsets[i]] = quad.depth[i];
+                        }
+
+                        if (color_mask && pipeline.fragment) {
+                            for (uint i = 0; i < 4; i++) {
+                                if (!(written >> i & 1))
+                                    continue;
+                                auto& pixel = color->pixels[offsets[i]];
+                                pixel       = (pixel & ~color_mask) | (pack_color(output.color[i]) & color_mask);
+                            }
+                        }
+                    }
+
+                    for (uint k = 0; k < 3; k++)
+                        edge[k] = edge[k] + step_x[k];
+                }
+
+                for (uint k = 0; k < 3; k++)
+                    edge_row[k] = edge_row[k] + step_y[k];
+            }
+        }
+    }
+
+    quads[thread] += shaded;
+}
+
+void SoftRasterizer::parallel_for(uint count, const Job& function)
+{
+    if (workers.empty() || count <= 1) {
+        for (uint i = 0; i < count; i++)
+            function(i, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job        = &function;
+        job_count  = count;
+        job_next   = 0;
+        job_active = static_cast<uint>(workers.size());
+        generation++;
+    }
+    wake.notify_all();
+
+    for (auto i = job_next++; i < count; i = job_next++)
+        function(i, 0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return job_active == 0; });
+    job = nullptr;
+}
+
+void SoftRasterizer::worker_loop(uint thread)
+{
+    auto seen = uint64_t(0);
+    while (true) {
+        const Job* current = nullptr;
+        auto       count   = 0u;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping)
+                return;
+
+            seen    = generation;
+            current = job;
+            count   = job_count;
+        }
+
+        for (auto i = job_next++; i < count; i = job_next++)
+            (*current)(i, thread);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--job_active == 0)
+            done.notify_one();
+    }
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+
+constexpr uint SOFT_MAX_VARYINGS = 8;
+constexpr uint SOFT_TILE_SIZE    = 64; // pixels, tiles are rasterized independently by the workers
+
+// Output of a vertex shader, position is in clip space (z in [0, w], like D3D12 and Vulkan).
+struct SoftVertex
+{
+    glm::vec4 position;
+    float     varyings[SOFT_MAX_VARYINGS];
+};
+
+// A 2x2 block of pixels, the unit fragment shaders run on.
+// Lane i is the pixel (x + (i & 1), y + (i >> 1)). Lanes outside of the triangle are helper lanes,
+// they are shaded so that derivatives work, but their output is thrown away.
+struct SoftQuad
+{
+    uint  x          = 0;
+    uint  y          = 0;
+    uint  coverage   = 0; // bit i is set when lane i is inside the triangle
+    bool  front_face = true;
+    float depth[4];
+    float varyings[SOFT_MAX_VARYINGS][4]; // perspective correct
+
+    // coarse derivatives, the same for the whole quad
+    auto ddx(uint varying) const -> float { return varyings[varying][1] - varyings[varying][0]; }
+    auto ddy(uint varying) const -> float { return varyings[varying][2] - varyings[varying][0]; }
+    auto fwidth(uint varying) const -> float { return std::abs(ddx(varying)) + std::abs(ddy(varying)); }
+};
+
+struct SoftFragmentOutput
+{
+    glm::vec4 color[4];
+    uint      discard = 0; // bit i discards lane i
+};
+
+using SoftVertexShader   = std::function<void(uint vertex_index, SoftVertex& output)>;
+using SoftFragmentShader = std::function<void(const SoftQuad& quad, SoftFragmentOutput& output)>;
+
+// Fixed function state comes from the RHI descriptors, shaders are C++ functions.
+struct SoftPipeline
+{
+    SoftVertexShader                vertex;
+    SoftFragmentShader              fragment;
+    uint                            varying_count    = 0;
+    uint                            color_write_mask = lyra::rhi::GPUColorWrite::ALL;
+    lyra::rhi::GPUPrimitiveState    primitive        = {};
+    lyra::rhi::GPUDepthStencilState depth_stencil    = {};
+};
+
+// RGBA8 color target.
+struct SoftColorTarget
+{
+    uint                  width  = 0;
+    uint                  height = 0;
+    std::vector<uint32_t> pixels;
+
+    explicit SoftColorTarget(uint width, uint height) : width(width), height(height), pixels(size_t(width) * height) {}
+};
+
+// Depth is stored as float, but rounded to the precision of the format on write.
+// Stencil is only available with DEPTH24PLUS_STENCIL8.
+struct SoftDepthStencilTarget
+{
+    uint                       width  = 0;
+    uint                       height = 0;
+    lyra::rhi::GPUTextureFormat format;
+    std::vector<float>         depth;
+    std::vector<uint8_t>       stencil;
+
+    explicit SoftDepthStencilTarget(uint width, uint height, lyra::rhi::GPUTextureFormat format)
+        : width(width), height(height), format(format), depth(size_t(width) * height), stencil(size_t(width) * height)
+    {
+    }
+};
+
+struct SoftRenderPass
+{
+    SoftColorTarget*        color               = nullptr;
+    SoftDepthStencilTarget* depth_stencil       = nullptr;
+    lyra::rhi::GPULoadOp    color_load_op       = lyra::rhi::GPULoadOp::CLEAR;
+    lyra::rhi::GPULoadOp    depth_load_op       = lyra::rhi::GPULoadOp::CLEAR;
+    lyra::rhi::GPULoadOp    stencil_load_op     = lyra::rhi::GPULoadOp::CLEAR;
+    glm::vec4               color_clear_value   = glm::vec4(0.0f);
+    float                   depth_clear_value   = 1.0f;
+    uint                    stencil_clear_value = 0;
+};
+
+struct SoftRasterStats
+{
+    uint64_t triangles  = 0; // submitted
+    uint64_t rasterized = 0; // after clipping and culling
+    uint64_t quads      = 0; // 2x2 quads shaded
+    double   vertex_ms  = 0.0;
+    double   binning_ms = 0.0;
+    double   raster_ms  = 0.0;
+};
+
+// Tile based software rasterizer.
+//
+// Draws are only recorded until end_render_pass(), which runs three stages, each spread over the worker threads:
+// vertex shading, triangle setup and binning into tiles, and rasterization of each tile. Triangles are binned
+// per worker in submission order, and each tile walks the bins in worker order, so primitive order is preserved
+// without any locking. Edge functions are evaluated on 2x2 quads with SSE2 (or a scalar fallback).
+class SoftRasterizer
+{
+public:
+    // 0 threads uses every hardware thread.
+    explicit SoftRasterizer(uint thread_count = 0);
+    ~SoftRasterizer();
+
+    SoftRasterizer(const SoftRasterizer&)            = delete;
+    SoftRasterizer& operator=(const SoftRasterizer&) = delete;
+
+    void begin_render_pass(const SoftRenderPass& pass);
+    void set_pipeline(const SoftPipeline& pipeline);
+    void set_stencil_reference(uint reference);
+    void draw(uint vertex_count, uint first_vertex = 0);
+    void draw_indexed(const uint32_t* indices, uint index_count);
+    void end_render_pass();
+
+    auto thread_count() const -> uint { return static_cast<uint>(workers.size()) + 1; }
+
+    auto stats() const -> const SoftRasterStats& { return statistics; }
+    void reset_stats() { statistics = SoftRasterStats{}; }
+
+private:
+    using Job = std::function<void(uint index, uint thread)>;
+
+    struct Draw
+    {
+        uint                    pipeline  = 0;
+        uint                    reference = 0;
+        uint                    first     = 0; // first vertex of non-indexed draws
+        uint                    count     = 0;
+        uint                    base      = 0; // lowest vertex index, vertices are shaded from here
+        std::vector<uint32_t>   indices;
+        std::vector<SoftVertex> vertices;
+    };
+
+    struct Triangle;
+    struct Bin;
+
+    void shade_vertices();
+    void bin_triangles();
+    void rasterize_tile(uint tile, uint thread);
+    void clip_triangle(const Draw& draw, const SoftVertex* vertices[3], Bin& bin);
+    void setup_triangle(const Draw& draw, const SoftVertex* vertices[3], Bin& bin);
+
+    // runs function(index, thread) for every index in [0, count), on the workers and the calling thread (thread 0)
+    void parallel_for(uint count, const Job& function);
+    void worker_loop(uint thread);
+
+private:
+    SoftRenderPass                    pass;
+    std::vector<SoftPipeline>         pipelines;
+    std::vector<Draw>                 draws;
+    std::vector<std::unique_ptr<Bin>> bins; // one per thread, each holding a contiguous range of triangles
+    std::vector<uint64_t>             quads; // per thread
+    uint                              reference = 0;
+    uint                              tiles_x   = 0;
+    uint                              tiles_y   = 0;
+    bool                              in_pass   = false;
+    SoftRasterStats                   statistics;
+
+    // worker pool
+    std::vector<std::thread> workers;
+    std::mutex               mutex;
+    std::condition_variable  wake;
+    std::condition_variable  done;
+    const Job*               job        = nullptr;
+    uint                     job_count  = 0;
+    std::atomic<uint>        job_next   = 0;
+    uint                     job_active = 0;
+    uint64_t                 generation = 0;
+    bool                     stopping   = false;
+};
@@ -0,0 +1,530 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+
+#include "Regression.h"
+#include "SoftRasterizer.h"
+
+using namespace lyra;
+using namespace lyra::rhi;
+
+// Renders the scenes of the Triangle, DepthTest, StencilTest and Window samples on the CPU, without a window or a GPU,
+// and writes the last frame of each scene to a PPM file.
+//
+// usage: soft-raster [--threads N] [--frames N] [--size WxH] [--reference DIR] [--baseline FILE] [--update]
+//                    [--threshold T] [--max-regression P] [scene...]
+//
+// With --reference, each scene is compared against DIR/<scene>.ppm, with --baseline, its median frame time against
+// the one recorded in FILE, and the exit code is non-zero when any of them fails. --update writes the given
+// references and baseline instead. Frame times only compare on the same machine, so they are never checked by default.
+//
+// Shaders are C++ translations of the shader.slang of each sample, fixed function state is set up
+// with the same RHI descriptors as the samples.
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 color;
+};
+
+struct InverseTransform
+{
+    glm::mat4 inv_view_proj;
+    glm::vec3 camera_pos;
+    glm::vec2 fade_range;
+};
+
+struct Config
+{
+    uint                     width   = 1920;
+    uint                     height  = 1080;
+    uint                     frames  = 60;
+    uint                     threads = 0;
+    std::vector<std::string> scenes;
+
+    // regression checks
+    std::string reference      = "";
+    std::string baseline       = "";
+    bool        update         = false;
+    float       threshold      = 0.1f;  // perceptual difference of a pixel, 0 to 1
+    double      max_different  = 0.001; // fraction of pixels allowed to differ
+    double      max_regression = 20.0;  // percent over the baseline frame time
+};
+
+// A pixel of which the color is known, so that a scene is checked even without a reference image.
+struct Probe
+{
+    const char* scene;
+    const char* what;
+    glm::vec3   position; // world space, projected with the camera of the scene
+    glm::vec3   color;
+};
+
+struct Targets
+{
+    SoftColorTarget        color;
+    SoftDepthStencilTarget depth;         // DEPTH16UNORM, like the DepthTest sample
+    SoftDepthStencilTarget depth_stencil; // DEPTH24PLUS_STENCIL8, like the StencilTest sample
+};
+
+struct Scene
+{
+    const char* name;
+    void (*render)(SoftRasterizer& raster, Targets& targets);
+};
+
+Config              config;
+glm::mat4           mvp;
+InverseTransform    xform;
+std::vector<Vertex> triangle_vertices;
+std::vector<Vertex> depth_vertices;
+std::vector<Vertex> mask_vertices;
+std::vector<Vertex> draw_vertices;
+
+void setup_config(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            config.threads = static_cast<uint>(std::stoul(argv[++i]));
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            config.frames = std::max(1u, static_cast<uint>(std::stoul(argv[++i])));
+        else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc && std::sscanf(argv[i + 1], "%ux%u", &config.width, &config.height) == 2)
+            i++;
+        else if (std::strcmp(argv[i], "--reference") == 0 && i + 1 < argc)
+            config.reference = argv[++i];
+        else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            config.baseline = argv[++i];
+        else if (std::strcmp(argv[i], "--update") == 0)
+            config.update = true;
+        else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+            config.threshold = std::stof(argv[++i]);
+        else if (std::strcmp(argv[i], "--max-regression") == 0 && i + 1 < argc)
+            config.max_regression = std::stod(argv[++i]);
+        else
+            config.scenes.push_back(argv[i]);
+    }
+}
+
+void setup_scenes()
+{
+    auto aspect     = float(config.width) / float(config.height);
+    auto projection = glm::perspective(1.05f, aspect, 0.1f, 100.0f);
+    auto modelview  = glm::lookAt(
+        glm::vec3(0.0f, 0.0f, 3.0f),
+        glm::vec3(0.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f));
+    mvp = projection * modelview;
+
+    // Triangle
+    triangle_vertices.push_back({{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}});
+    triangle_vertices.push_back({{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}});
+    triangle_vertices.push_back({{0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}});
+
+    // DepthTest, the second triangle is behind the first one
+    depth_vertices.push_back({{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}});
+    depth_vertices.push_back({{1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}});
+    depth_vertices.push_back({{0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}});
+    depth_vertices.push_back({{0.0f - 0.25f, 0.0f - 0.25f, -1.0f}, {0.0f, 1.0f, 1.0f}});
+    depth_vertices.push_back({{1.0f - 0.25f, 0.0f - 0.25f, -1.0f}, {0.0f, 1.0f, 1.0f}});
+    depth_vertices.push_back({{0.0f - 0.25f, 1.0f - 0.25f, -1.0f}, {0.0f, 1.0f, 1.0f}});
+
+    // StencilTest, the second triangle is in front of the first one, but only shows through the mask
+    mask_vertices.push_back({{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}});
+    mask_vertices.push_back({{1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}});
+    mask_vertices.push_back({{0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}});
+    draw_vertices = mask_vertices;
+    draw_vertices.push_back({{0.0f - 0.25f, 0.0f - 0.25f, +1.0f}, {0.0f, 1.0f, 1.0f}});
+    draw_vertices.push_back({{1.0f - 0.25f, 0.0f - 0.25f, +1.0f}, {0.0f, 1.0f, 1.0f}});
+    draw_vertices.push_back({{0.0f - 0.25f, 1.0f - 0.25f, +1.0f}, {0.0f, 1.0f, 1.0f}});
+
+    // Window, camera at its starting position
+    auto camera_pos     = glm::vec3(0.0f, 1.0f, 3.0f);
+    auto view           = glm::lookAt(camera_pos, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    xform.inv_view_proj = glm::inverse(projection * view);
+    xform.camera_pos    = camera_pos;
+    xform.fade_range    = glm::vec2(5.0f, 10.0f);
+}
+
+// shader.slang of Triangle, DepthTest and StencilTest
+auto color_pipeline(const std::vector<Vertex>& vertices) -> SoftPipeline
+{
+    auto pipeline          = SoftPipeline{};
+    pipeline.varying_count = 3;
+
+    pipeline.vertex = [&vertices](uint index, SoftVertex& output) {
+        auto& input        = vertices.at(index);
+        output.position    = mvp * glm::vec4(input.position, 1.0f);
+        output.varyings[0] = input.color.x;
+        output.varyings[1] = input.color.y;
+        output.varyings[2] = input.color.z;
+    };
+
+    pipeline.fragment = [](const SoftQuad& quad, SoftFragmentOutput& output) {
+        for (uint i = 0; i < 4; i++)
+            output.color[i] = glm::vec4(quad.varyings[0][i], quad.varyings[1][i], quad.varyings[2][i], 1.0f);
+    };
+
+    pipeline.primitive.cull_mode          = GPUCullMode::NONE;
+    pipeline.primitive.topology           = GPUPrimitiveTopology::TRIANGLE_LIST;
+    pipeline.primitive.front_face         = GPUFrontFace::CCW;
+    pipeline.primitive.strip_index_format = GPUIndexFormat::UINT32;
+
+    // NOTE: stencil is disabled unless a scene sets it up
+    auto keep          = GPUStencilFaceState{};
+    keep.compare       = GPUCompareFunction::ALWAYS;
+    keep.fail_op       = GPUStencilOperation::KEEP;
+    keep.depth_fail_op = GPUStencilOperation::KEEP;
+    keep.pass_op       = GPUStencilOperation::KEEP;
+
+    pipeline.depth_stencil.depth_compare       = GPUCompareFunction::ALWAYS;
+    pipeline.depth_stencil.depth_write_enabled = false;
+    pipeline.depth_stencil.stencil_front       = keep;
+    pipeline.depth_stencil.stencil_back        = keep;
+    return pipeline;
+}
+
+void render_triangle(SoftRasterizer& raster, Targets& targets)
+{
+    auto pass  = SoftRenderPass{};
+    pass.color = &targets.color;
+
+    raster.begin_render_pass(pass);
+    raster.set_pipeline(color_pipeline(triangle_vertices));
+    raster.draw(3);
+    raster.end_render_pass();
+}
+
+void render_depth_test(SoftRasterizer& raster, Targets& targets)
+{
+    auto pipeline                              = color_pipeline(depth_vertices);
+    pipeline.depth_stencil.format              = GPUTextureFormat::DEPTH16UNORM;
+    pipeline.depth_stencil.depth_compare       = GPUCompareFunction::LESS;
+    pipeline.depth_stencil.depth_write_enabled = true;
+
+    auto pass              = SoftRenderPass{};
+    pass.color             = &targets.color;
+    pass.depth_stencil     = &targets.depth;
+    pass.depth_clear_value = 1.0f;
+
+    uint32_t indices[] = {0, 1, 2, 3, 4, 5};
+
+    raster.begin_render_pass(pass);
+    raster.set_pipeline(pipeline);
+    raster.draw_indexed(indices, 6);
+    raster.end_render_pass();
+}
+
+void render_stencil_test(SoftRasterizer& raster, Targets& targets)
+{
+    auto mask                                      = color_pipeline(mask_vertices);
+    mask.color_write_mask                          = GPUColorWrite::NONE; // NOTE: disable color write
+    mask.depth_stencil.format                      = GPUTextureFormat::DEPTH24PLUS_STENCIL8;
+    mask.depth_stencil.stencil_read_mask           = 0x0;
+    mask.depth_stencil.stencil_write_mask          = 0x1;
+    mask.depth_stencil.stencil_front.depth_fail_op = GPUStencilOperation::KEEP;
+    mask.depth_stencil.stencil_front.compare       = GPUCompareFunction::ALWAYS;
+    mask.depth_stencil.stencil_front.pass_op       = GPUStencilOperation::REPLACE;
+    mask.depth_stencil.stencil_front.fail_op       = GPUStencilOperation::REPLACE;
+    mask.depth_stencil.stencil_back                = mask.depth_stencil.stencil_front;
+
+    auto draw                                      = color_pipeline(draw_vertices);
+    draw.depth_stencil.format                      = GPUTextureFormat::DEPTH24PLUS_STENCIL8;
+    draw.depth_stencil.depth_write_enabled         = true;
+    draw.depth_stencil.stencil_read_mask           = 0x1;
+    draw.depth_stencil.stencil_write_mask          = 0x0;
+    draw.depth_stencil.stencil_front.depth_fail_op = GPUStencilOperation::KEEP;
+    draw.depth_stencil.stencil_front.compare       = GPUCompareFunction::EQUAL;
+    draw.depth_stencil.stencil_front.pass_op       = GPUStencilOperation::KEEP;
+    draw.depth_stencil.stencil_front.fail_op       = GPUStencilOperation::KEEP;
+    draw.depth_stencil.stencil_back                = draw.depth_stencil.stencil_front;
+
+    // mask pass writes 1 into the stencil wherever the first triangle is
+    auto mask_pass                = SoftRenderPass{};
+    mask_pass.color               = &targets.color;
+    mask_pass.depth_stencil       = &targets.depth_stencil;
+    mask_pass.stencil_clear_value = 0;
+
+    raster.begin_render_pass(mask_pass);
+    raster.set_pipeline(mask);
+    raster.set_stencil_reference(0x1);
+    raster.draw(3);
+    raster.end_render_pass();
+
+    // color pass keeps the stencil, and only draws where it equals 1
+    auto color_pass            = SoftRenderPass{};
+    color_pass.color           = &targets.color;
+    color_pass.depth_stencil   = &targets.depth_stencil;
+    color_pass.stencil_load_op = GPULoadOp::LOAD;
+
+    raster.begin_render_pass(color_pass);
+    raster.set_pipeline(draw);
+    raster.set_stencil_reference(0x1);
+    raster.draw(6);
+    raster.end_render_pass();
+}
+
+// shader.slang of Window, an infinite grid on the ground plane
+void render_grid(SoftRasterizer& raster, Targets& targets)
+{
+    auto pipeline          = color_pipeline(triangle_vertices);
+    pipeline.varying_count = 2;
+
+    // a single triangle covering the whole screen
+    pipeline.vertex = [](uint index, SoftVertex& output) {
+        const glm::vec3 vertices[3] = {{-1.0f, -1.0f, 0.0f}, {+3.0f, -1.0f, 0.0f}, {-1.0f, +3.0f, 0.0f}};
+        output.position    = glm::vec4(vertices[index], 1.0f);
+        output.varyings[0] = output.position.x * 0.5f + 0.5f;
+        output.varyings[1] = output.position.y * 0.5f + 0.5f;
+    };
+
+    pipeline.fragment = [](const SoftQuad& quad, SoftFragmentOutput& output) {
+        auto frac       = [](float x) { return x - std::floor(x); };
+        auto smoothstep = [](float a, float b, float x) {
+            auto t = std::clamp((x - a) / (b - a), 0.0f, 1.0f);
+            return t * t * (3.0f - 2.0f * t);
+        };
+
+        // every lane is evaluated first, fwidth needs the neighbours
+        glm::vec2 grid_uv[4];
+        float     dist[4];
+        for (uint i = 0; i < 4; i++) {
+            // reconstruct ray in world space
+            auto ndc   = glm::vec4(quad.varyings[0][i] * 2.0f - 1.0f, quad.varyings[1][i] * 2.0f - 1.0f, 0.0f, 1.0f);
+            auto world = xform.inv_view_proj * ndc;
+            world      = world / world.w;
+
+            auto ray_dir = glm::normalize(glm::vec3(world.x, world.y, world.z) - xform.camera_pos);
+            if (ray_dir.y >= 0.0f) output.discard |= 1u << i;
+
+            // intersect with y = 0 ground
+            auto t     = std::abs(xform.camera_pos.y / -ray_dir.y);
+            auto hit   = xform.camera_pos + ray_dir * t;
+            grid_uv[i] = glm::vec2(hit.x, hit.z);
+            dist[i]    = glm::distance(hit, xform.camera_pos);
+        }
+
+        // coarse derivatives, as on most GPUs
+        auto fwidth = glm::vec2(
+            std::abs(grid_uv[1].x - grid_uv[0].x) + std::abs(grid_uv[2].x - grid_uv[0].x),
+            std::abs(grid_uv[1].y - grid_uv[0].y) + std::abs(grid_uv[2].y - grid_uv[0].y));
+
+        for (uint i = 0; i < 4; i++) {
+            // procedural grid
+            auto grid_x = std::abs(frac(grid_uv[i].x - 0.5f) - 0.5f) / fwidth.x;
+            auto grid_y = std::abs(frac(grid_uv[i].y - 0.5f) - 0.5f) / fwidth.y;
+            auto line   = std::min(grid_x, grid_y);
+
+            // grid color, faded at skyline
+            auto alpha = std::exp(-line * line * 0.5f);
+            auto color = 0.2f + (1.0f - 0.2f) * alpha;
+            auto fade  = smoothstep(xform.fade_range.x, xform.fade_range.y, dist[i]);
+
+            output.color[i] = glm::vec4(color * fade, color * fade, color * fade, 1.0f);
+        }
+    };
+
+    auto pass  = SoftRenderPass{};
+    pass.color = &targets.color;
+
+    raster.begin_render_pass(pass);
+    raster.set_pipeline(pipeline);
+    raster.draw(3);
+    raster.end_render_pass();
+}
+
+// NOTE: points are picked away from the edges, so that they do not depend on the resolution.
+const Probe probes[] = {
+    {"triangle", "inside", {0.25f, 0.25f, 0.0f}, {0.5f, 0.25f, 0.25f}},
+    {"triangle", "outside", {0.75f, 0.75f, 0.0f}, {0.0f, 0.0f, 0.0f}},
+    {"depth_test", "front triangle over the back one", {0.1f, 0.1f, 0.0f}, {1.0f, 1.0f, 0.0f}},
+    {"depth_test", "back triangle alone", {-0.2f, -0.2f, -1.0f}, {0.0f, 1.0f, 1.0f}},
+    {"stencil_test", "second triangle inside the mask", {0.05f, 0.05f, 1.0f}, {0.0f, 1.0f, 1.0f}},
+    {"stencil_test", "second triangle outside the mask", {-0.2f, -0.2f, 1.0f}, {0.0f, 0.0f, 0.0f}},
+    {"stencil_test", "mask triangle alone", {0.6f, 0.3f, 0.0f}, {1.0f, 1.0f, 0.0f}},
+};
+
+auto check_probes(const std::string& scene, const SoftColorTarget& target) -> uint
+{
+    auto failures = uint(0);
+    for (auto& probe : probes) {
+        if (scene != probe.scene)
+            continue;
+
+        auto clip  = mvp * glm::vec4(probe.position, 1.0f);
+        auto x     = uint((clip.x / clip.w * 0.5f + 0.5f) * float(target.width));
+        auto y     = uint((0.5f - clip.y / clip.w * 0.5f) * float(target.height));
+        auto pixel = target.pixels.at(size_t(y) * target.width + x);
+        auto color = glm::vec3(float(pixel & 0xFF), float(pixel >> 8 & 0xFF), float(pixel >> 16 & 0xFF)) / 255.0f;
+
+        auto error = glm::abs(color - probe.color);
+        if (std::max({error.x, error.y, error.z}) > 2.0f / 255.0f) {
+            std::cerr << scene << ": " << probe.what << " at (" << x << ", " << y << ") is ("
+                      << color.x << ", " << color.y << ", " << color.z << "), expected ("
+                      << probe.color.x << ", " << probe.color.y << ", " << probe.color.z << ")" << std::endl;
+            failures++;
+        }
+    }
+    return failures;
+}
+
+auto check_reference(const std::string& scene, const Image& image) -> uint
+{
+    auto path      = config.reference + "/" + scene + ".ppm";
+    auto reference = Image{};
+    if (!load_ppm(path, reference)) {
+        std::cerr << scene << ": failed to read reference " << path << std::endl;
+        return 1;
+    }
+
+    auto diff       = Image{};
+    auto difference = compare_images(image, reference, config.threshold, &diff);
+    if (difference.fraction() <= config.max_different)
+        return 0;
+
+    auto diff_path = scene + ".diff.ppm";
+    save_ppm(diff_path, diff);
+    std::cerr << scene << ": " << difference.different << " of " << difference.total << " pixels differ from " << path
+              << " (max difference " << difference.max_delta << "), saved to " << diff_path << std::endl;
+    return 1;
+}
+
+auto check_baseline(const std::string& scene, const std::map<std::string, double>& baseline, double ms) -> uint
+{
+    auto it = baseline.find(scene);
+    if (it == baseline.end()) {
+        std::cerr << scene << ": no baseline frame time" << std::endl;
+        return 1;
+    }
+
+    auto limit = it->second * (1.0 + config.max_regression / 100.0);
+    if (ms <= limit)
+        return 0;
+
+    std::cerr << scene << ": " << ms << " ms/frame is over the baseline of " << it->second << " ms/frame by more than "
+              << config.max_regression << "%" << std::endl;
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    setup_config(argc, argv);
+    setup_scenes();
+
+    // NOTE: references are only ever written to the given paths, never relative to the root
+    if (config.update) {
+        if (config.reference.empty() && config.baseline.empty()) {
+            std::cerr << "--update requires --reference DIR or --baseline FILE" << std::endl;
+            return 1;
+        }
+
+        auto directories = {config.reference, std::filesystem::path(config.baseline).parent_path().string()};
+        for (auto& directory : directories) {
+            auto error = std::error_code{};
+            if (!directory.empty())
+                std::filesystem::create_directories(directory, error);
+            if (error) {
+                std::cerr << "failed to create " << directory << ": " << error.message() << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    const Scene scenes[] = {
+        {"triangle", render_triangle},
+        {"depth_test", render_depth_test},
+        {"stencil_test", render_stencil_test},
+        {"window", render_grid},
+    };
+
+    auto raster  = SoftRasterizer(config.threads);
+    auto targets = Targets{
+        SoftColorTarget(config.width, config.height),
+        SoftDepthStencilTarget(config.width, config.height, GPUTextureFormat::DEPTH16UNORM),
+        SoftDepthStencilTarget(config.width, config.height, GPUTextureFormat::DEPTH24PLUS_STENCIL8),
+    };
+
+    // NOTE: a baseline being updated is loaded as well, so that the scenes which are not run keep their times
+    auto baseline = std::map<std::string, double>{};
+    if (!config.baseline.empty() && !load_baseline(config.baseline, baseline) && !config.update) {
+        std::cerr << "failed to read baseline " << config.baseline << std::endl;
+        return 1;
+    }
+
+    std::cout << "Resolution: " << config.width << "x" << config.height << ", Threads: " << raster.thread_count()
+              << ", Frames: " << config.frames << std::endl;
+
+    auto failures = uint(0);
+    for (auto& scene : scenes) {
+        if (!config.scenes.empty() && std::find(config.scenes.begin(), config.scenes.end(), scene.name) == config.scenes.end())
+            continue;
+
+        // first frame warms up the threads and the allocations
+        scene.render(raster, targets);
+        raster.reset_stats();
+
+        // NOTE: the median frame time is compared against the baseline, it is not thrown off by a few slow frames
+        auto times = std::vector<double>{};
+        for (uint i = 0; i < config.frames; i++) {
+            auto start = std::chrono::steady_clock::now();
+            scene.render(raster, targets);
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        auto& stats  = raster.stats();
+        auto  frames = double(config.frames);
+        auto  total  = std::accumulate(times.begin(), times.end(), 0.0);
+        std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+        auto median = times[times.size() / 2];
+
+        auto image = to_image(targets.color);
+        auto path  = std::string(scene.name) + ".ppm";
+        save_ppm(path, image);
+
+        std::cout << scene.name << ": " << total / frames << " ms/frame, median " << median << " ms"
+                  << " (vertex " << stats.vertex_ms / frames << ", binning " << stats.binning_ms / frames
+                  << ", raster " << stats.raster_ms / frames << ")"
+                  << ", Triangles: " << double(stats.rasterized) / frames << "/frame"
+                  << ", Quads: " << double(stats.quads) / frames << "/frame"
+                  << ", saved to " << path << std::endl;
+
+        failures += check_probes(scene.name, targets.color);
+
+        if (!config.reference.empty()) {
+            if (config.update)
+                save_ppm(config.reference + "/" + path, image);
+            else
+                failures += check_reference(scene.name, image);
+        }
+
+        if (!config.baseline.empty()) {
+            if (config.update)
+                baseline[scene.name] = median;
+            else
+                failures += check_baseline(scene.name, baseline, median);
+        }
+    }
+
+    if (config.update && !config.baseline.empty() && !save_baseline(config.baseline, baseline)) {
+        std::cerr << "failed to write " << config.baseline << std::endl;
+        return 1;
+    }
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
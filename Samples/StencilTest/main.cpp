@@ -1,3 +1,4 @@
+#include <cstring>
 #include <iostream>
 #include <string_view>
 #include <cmrc/cmrc.hpp>
@@ -19,6 +20,44 @@ struct Vertex
     glm::vec3 color;
 };
 
+struct PipelineStatistics
+{
+    uint64_t vertex_invocations;
+    uint64_t primitives;
+    uint64_t fragment_invocations;
+};
+
+// NOTE: the layout of a resolved statistics query depends on the backend. Vulkan packs the enabled statistics in the
+// order of the GPUPipelineStatistic bits, D3D12 always writes the whole D3D12_QUERY_DATA_PIPELINE_STATISTICS.
+// The stride of a query and the offset of each statistic are taken from the query set, in bytes.
+struct QueryLayout
+{
+    GPUSize64 stride               = 0; // of one statistics query
+    GPUSize64 vertex_invocations   = 0; // offsets within one statistics query
+    GPUSize64 primitives           = 0;
+    GPUSize64 fragment_invocations = 0;
+    GPUSize64 samples_passed       = 0; // offset of the occlusion query, after all statistics queries
+    GPUSize64 size                 = 0; // of the resolved queries of one frame
+};
+
+// resolved queries of one frame, as read back
+struct QueryResults
+{
+    PipelineStatistics mask;
+    PipelineStatistics color;
+    uint64_t           samples_passed;
+};
+
+enum StatisticsQuery : uint
+{
+    MASK_PASS,
+    COLOR_PASS,
+    STATISTICS_QUERY_COUNT,
+};
+
+constexpr uint FRAMES_INFLIGHT   = 3;
+constexpr uint FRAMES_PER_REPORT = 120;
+
 GPUShaderModule    vshader;
 GPUShaderModule    fshader;
 GPUBindGroupLayout blayout;
@@ -32,6 +71,12 @@ GPUBuffer          ibuffer_draw;
 GPUBuffer          ubuffer;
 GPUTexture         dsbuffer;
 GPUTextureView     dsview;
+GPUQuerySet        statistics_queries[FRAMES_INFLIGHT];
+GPUQuerySet        occlusion_queries[FRAMES_INFLIGHT];
+GPUBuffer          query_resolve[FRAMES_INFLIGHT];
+GPUBuffer          query_readback[FRAMES_INFLIGHT];
+QueryLayout        query_layout;
+uint64_t           frame_index = 0;
 
 auto read_shader_source() -> const char*
 {
@@ -334,12 +379,72 @@ void setup_stencil_buffer()
     dsview = dsbuffer.create_view();
 }
 
+void setup_queries()
+{
+    auto& device = RHI::get_current_device();
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        statistics_queries[i] = execute([&]() {
+            auto desc                = GPUQuerySetDescriptor{};
+            desc.label               = "statistics_queries";
+            desc.type                = GPUQueryType::PIPELINE_STATISTICS;
+            desc.count               = STATISTICS_QUERY_COUNT;
+            desc.pipeline_statistics = GPUPipelineStatistic::VERTEX_SHADER_INVOCATIONS |
+                                       GPUPipelineStatistic::CLIPPER_INVOCATIONS |
+                                       GPUPipelineStatistic::FRAGMENT_SHADER_INVOCATIONS;
+            return device.create_query_set(desc);
+        });
+
+        occlusion_queries[i] = execute([&]() {
+            auto desc  = GPUQuerySetDescriptor{};
+            desc.label = "occlusion_queries";
+            desc.type  = GPUQueryType::OCCLUSION;
+            desc.count = 1;
+            return device.create_query_set(desc);
+        });
+    }
+
+    // NOTE: every statistics query set has the same layout, which is only known once one has been created
+    auto& queries                     = statistics_queries[0];
+    query_layout.stride               = queries.get_result_stride();
+    query_layout.vertex_invocations   = queries.get_statistic_offset(GPUPipelineStatistic::VERTEX_SHADER_INVOCATIONS);
+    query_layout.primitives           = queries.get_statistic_offset(GPUPipelineStatistic::CLIPPER_INVOCATIONS);
+    query_layout.fragment_invocations = queries.get_statistic_offset(GPUPipelineStatistic::FRAGMENT_SHADER_INVOCATIONS);
+    query_layout.samples_passed       = query_layout.stride * STATISTICS_QUERY_COUNT;
+    query_layout.size                 = query_layout.samples_passed + sizeof(uint64_t);
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        query_resolve[i] = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "query_resolve_buffer";
+            desc.size  = query_layout.size;
+            desc.usage = GPUBufferUsage::QUERY_RESOLVE | GPUBufferUsage::COPY_SRC;
+            return device.create_buffer(desc);
+        });
+
+        query_readback[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "query_readback_buffer";
+            desc.size               = query_layout.size;
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    }
+}
+
 void cleanup()
 {
     auto& device = RHI::get_current_device();
     device.wait();
 
     // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        statistics_queries[i].destroy();
+        occlusion_queries[i].destroy();
+        query_resolve[i].destroy();
+        query_readback[i].destroy();
+    }
     dsbuffer.destroy();
     ibuffer_mask.destroy();
     vbuffer_mask.destroy();
@@ -353,7 +458,7 @@ void cleanup()
     playout.destroy();
 }
 
-void render_mask(GPUCommandBuffer& command, const GPUSurfaceTexture& backbuffer, const GPUBindGroup& bind_group)
+void render_mask(GPUCommandBuffer& command, const GPUSurfaceTexture& backbuffer, const GPUBindGroup& bind_group, uint slot)
 {
     auto& surface = RHI::get_current_surface();
     auto  extent  = surface.get_current_extent();
@@ -390,11 +495,13 @@ void render_mask(GPUCommandBuffer& command, const GPUSurfaceTexture& backbuffer,
     command.set_index_buffer(ibuffer_mask, GPUIndexFormat::UINT32);
     command.set_bind_group(0, bind_group);
     command.set_stencil_reference(0x1);
+    command.begin_query(statistics_queries[slot], MASK_PASS);
     command.draw_indexed(3, 1, 0, 0, 0);
+    command.end_query(statistics_queries[slot], MASK_PASS);
     command.end_render_pass();
 }
 
-void render_color(GPUCommandBuffer& command, const GPUSurfaceTexture& backbuffer, const GPUBindGroup& bind_group)
+void render_color(GPUCommandBuffer& command, const GPUSurfaceTexture& backbuffer, const GPUBindGroup& bind_group, uint slot)
 {
     auto& surface = RHI::get_current_surface();
     auto  extent  = surface.get_current_extent();
@@ -431,10 +538,65 @@ void render_color(GPUCommandBuffer& command, const GPUSurfaceTexture& backbuffer
     command.set_index_buffer(ibuffer_draw, GPUIndexFormat::UINT32);
     command.set_bind_group(0, bind_group);
     command.set_stencil_reference(0x1);
+    command.begin_query(statistics_queries[slot], COLOR_PASS);
+    command.begin_query(occlusion_queries[slot], 0); // NOTE: counts samples passing both stencil and depth test
     command.draw_indexed(6, 1, 0, 0, 0);
+    command.end_query(occlusion_queries[slot], 0);
+    command.end_query(statistics_queries[slot], COLOR_PASS);
     command.end_render_pass();
 }
 
+auto read_statistics(const uint8_t* data, uint query) -> PipelineStatistics
+{
+    auto base       = data + query_layout.stride * query;
+    auto statistics = PipelineStatistics{};
+    std::memcpy(&statistics.vertex_invocations, base + query_layout.vertex_invocations, sizeof(uint64_t));
+    std::memcpy(&statistics.primitives, base + query_layout.primitives, sizeof(uint64_t));
+    std::memcpy(&statistics.fragment_invocations, base + query_layout.fragment_invocations, sizeof(uint64_t));
+    return statistics;
+}
+
+auto read_queries(uint slot) -> QueryResults
+{
+    auto data    = query_readback[slot].get_mapped_range<uint8_t>().data();
+    auto results = QueryResults{};
+    results.mask  = read_statistics(data, MASK_PASS);
+    results.color = read_statistics(data, COLOR_PASS);
+    std::memcpy(&results.samples_passed, data + query_layout.samples_passed, sizeof(uint64_t));
+    return results;
+}
+
+void report(uint slot)
+{
+    static QueryResults total = {};
+
+    // the readback buffer in this slot was filled FRAMES_INFLIGHT frames ago, which is complete once its texture is acquired
+    if (frame_index < FRAMES_INFLIGHT)
+        return;
+
+    auto results = read_queries(slot);
+    total.mask.vertex_invocations += results.mask.vertex_invocations;
+    total.mask.primitives += results.mask.primitives;
+    total.mask.fragment_invocations += results.mask.fragment_invocations;
+    total.color.vertex_invocations += results.color.vertex_invocations;
+    total.color.primitives += results.color.primitives;
+    total.color.fragment_invocations += results.color.fragment_invocations;
+    total.samples_passed += results.samples_passed;
+
+    if ((frame_index - FRAMES_INFLIGHT + 1) % FRAMES_PER_REPORT != 0)
+        return;
+
+    std::cout << "Mask Pass: " << total.mask.vertex_invocations / FRAMES_PER_REPORT << " vertices"
+              << ", " << total.mask.primitives / FRAMES_PER_REPORT << " primitives"
+              << ", " << total.mask.fragment_invocations / FRAMES_PER_REPORT << " fragments"
+              << ", Color Pass: " << total.color.vertex_invocations / FRAMES_PER_REPORT << " vertices"
+              << ", " << total.color.primitives / FRAMES_PER_REPORT << " primitives"
+              << ", " << total.color.fragment_invocations / FRAMES_PER_REPORT << " fragments"
+              << ", " << total.samples_passed / FRAMES_PER_REPORT << " samples passed" << std::endl;
+
+    total = {};
+}
+
 void render()
 {
     auto& device  = RHI::get_current_device();
@@ -444,6 +606,9 @@ void render()
     auto texture = surface.get_current_texture();
     if (texture.suboptimal) return;
 
+    auto slot = static_cast<uint>(frame_index % FRAMES_INFLIGHT);
+    report(slot);
+
     // create command buffer
     auto command = execute([&]() {
         auto desc  = GPUCommandBufferDescriptor{};
@@ -470,14 +635,24 @@ void render()
     command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
     command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
     command.resource_barrier(state_transition(dsbuffer, undefined_state(), depth_stencil_attachment_state()));
-    render_mask(command, texture, bind_group);
-    render_color(command, texture, bind_group);
+    render_mask(command, texture, bind_group, slot);
+    render_color(command, texture, bind_group, slot);
     command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+
+    // queries are resolved on the GPU, and read back by the frame that reuses this slot
+    command.resource_barrier(state_transition(query_resolve[slot], undefined_state(), copy_dst_state()));
+    command.resolve_query_set(statistics_queries[slot], 0, STATISTICS_QUERY_COUNT, query_resolve[slot], 0);
+    command.resolve_query_set(occlusion_queries[slot], 0, 1, query_resolve[slot], query_layout.samples_passed);
+    command.resource_barrier(state_transition(query_resolve[slot], copy_dst_state(), copy_src_state()));
+    command.copy_buffer_to_buffer(query_resolve[slot], 0, query_readback[slot], 0, query_layout.size);
+
     command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
     command.submit();
 
     // present this frame to swapchain
     texture.present();
+
+    frame_index++;
 }
 
 int main()
@@ -510,10 +685,11 @@ int main()
     });
 
     auto surface = execute([&]() {
-        auto desc         = GPUSurfaceDescriptor{};
-        desc.label        = "main_surface";
-        desc.window       = win->handle;
-        desc.present_mode = GPUPresentMode::Fifo;
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Fifo;
+        desc.frames_inflight = FRAMES_INFLIGHT;
         return rhi->request_surface(desc);
     });
 
@@ -524,6 +700,7 @@ int main()
     win->bind<WindowEvent::START>(setup_draw_geometry);
     win->bind<WindowEvent::START>(setup_uniform_buffer);
     win->bind<WindowEvent::START>(setup_stencil_buffer);
+    win->bind<WindowEvent::START>(setup_queries);
     win->bind<WindowEvent::CLOSE>(cleanup);
     win->bind<WindowEvent::RENDER>(render);
     win->loop();
@@ -0,0 +1,274 @@
+#include "StreamingLoader.h"
+
+using namespace lyra;
+using namespace lyra::rhi;
+
+StreamingLoader::StreamingLoader(const StreamingLoaderDescriptor& descriptor) : descriptor(descriptor)
+{
+    auto& device = RHI::get_current_device();
+
+    // staging buffers stay mapped for the lifetime of the loader, the decode thread writes into them directly
+    slots.resize(descriptor.staging_slots);
+    for (auto& slot : slots) {
+        slot.staging = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "staging_buffer";
+            desc.size               = tile_bytes();
+            desc.usage              = GPUBufferUsage::COPY_SRC | GPUBufferUsage::MAP_WRITE;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+        slot.data = slot.staging.get_mapped_range<uint8_t>().data();
+    }
+
+    thread = std::thread([this]() { decode_loop(); });
+}
+
+StreamingLoader::~StreamingLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+
+    // NOTE: the caller is expected to have waited for the device
+    for (auto& slot : slots)
+        slot.staging.destroy();
+}
+
+void StreamingLoader::enqueue(const TextureUpload& upload)
+{
+    requests.push_back(upload);
+    start_decoding();
+}
+
+auto StreamingLoader::update(GPUCommandBuffer& graphics, uint64_t frame_index) -> std::vector<TextureUpload>
+{
+    auto completed = std::vector<TextureUpload>{};
+
+    retire_batches(graphics, frame_index, completed);
+
+    // collect slots finished by the decode thread since the last frame
+    auto ready = std::vector<uint>{};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(decoded);
+    }
+    for (uint index : ready)
+        slots.at(index).state = SlotState::READY;
+
+    // include slots left over from previous frames, when the frame budget did not cover them
+    ready.clear();
+    for (uint i = 0; i < slots.size(); i++)
+        if (slots.at(i).state == SlotState::READY)
+            ready.push_back(i);
+
+    if (!ready.empty()) {
+        if (transfer) {
+            submit_transfer(ready, frame_index);
+        } else {
+            record_inline(graphics, ready, frame_index);
+            for (uint index : ready)
+                completed.push_back(slots.at(index).upload);
+        }
+    }
+
+    start_decoding();
+    return completed;
+}
+
+void StreamingLoader::retire_batches(GPUCommandBuffer& graphics, uint64_t frame_index, std::vector<TextureUpload>& completed)
+{
+    while (!inflight.empty()) {
+        auto& batch = inflight.front();
+
+        // inline copies complete with their frame, transfer batches are tracked by their own fence
+        if (batch.transfer ? !batch.fence.ready() : batch.frame + descriptor.frames_inflight > frame_index)
+            break;
+
+        if (batch.transfer) {
+            // NOTE: the semaphore is already signaled, this wait only orders the acquire after the release
+            graphics.wait(batch.semaphore, GPUBarrierSync::PIXEL_SHADING);
+            for (uint index : batch.slots) {
+                auto barrier      = state_transition(slots.at(index).upload.texture, copy_dst_state(), shader_resource_state(GPUShaderStage::FRAGMENT));
+                barrier.src_queue = GPUQueueType::TRANSFER;
+                barrier.dst_queue = GPUQueueType::DEFAULT;
+                graphics.resource_barrier(barrier);
+                completed.push_back(slots.at(index).upload);
+            }
+        }
+
+        for (uint index : batch.slots)
+            slots.at(index).state = SlotState::FREE;
+
+        uploaded += tile_bytes() * batch.slots.size();
+        batch.slots.clear();
+        batch_pool.push_back(std::move(batch));
+        inflight.pop_front();
+    }
+}
+
+void StreamingLoader::submit_transfer(std::vector<uint>& ready, uint64_t frame_index)
+{
+    auto& device = RHI::get_current_device();
+
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.label = "transfer_command_buffer";
+        desc.queue = GPUQueueType::TRANSFER;
+        return device.create_command_buffer(desc);
+    });
+
+    auto batch     = acquire_batch();
+    batch.frame    = frame_index;
+    batch.transfer = true;
+
+    for (uint index : ready) {
+        auto& slot = slots.at(index);
+        record_copy(command, slot);
+
+        // release ownership to the graphics queue, which records the matching acquire in retire_batches()
+        auto barrier      = state_transition(slot.upload.texture, copy_dst_state(), shader_resource_state(GPUShaderStage::FRAGMENT));
+        barrier.src_queue = GPUQueueType::TRANSFER;
+        barrier.dst_queue = GPUQueueType::DEFAULT;
+        command.resource_barrier(barrier);
+
+        slot.state = SlotState::UPLOADING;
+        batch.slots.push_back(index);
+    }
+
+    command.signal(batch.semaphore, GPUBarrierSync::COPY);
+    command.submit(batch.fence);
+
+    inflight.push_back(std::move(batch));
+}
+
+void StreamingLoader::record_inline(GPUCommandBuffer& graphics, std::vector<uint>& ready, uint64_t frame_index)
+{
+    auto batch     = acquire_batch();
+    batch.frame    = frame_index;
+    batch.transfer = false;
+
+    // the graphics queue pays for these copies inside the frame, so they are capped by the frame budget
+    if (ready.size() > descriptor.frame_budget)
+        ready.resize(descriptor.frame_budget);
+
+    for (uint index : ready) {
+        auto& slot = slots.at(index);
+        record_copy(graphics, slot);
+        graphics.resource_barrier(state_transition(slot.upload.texture, copy_dst_state(), shader_resource_state(GPUShaderStage::FRAGMENT)));
+
+        slot.state = SlotState::UPLOADING;
+        batch.slots.push_back(index);
+    }
+
+    inflight.push_back(std::move(batch));
+}
+
+void StreamingLoader::record_copy(GPUCommandBuffer& command, const Slot& slot)
+{
+    auto src           = GPUImageCopyBuffer{};
+    src.buffer         = slot.staging;
+    src.offset         = 0;
+    src.bytes_per_row  = descriptor.tile_size * 4;
+    src.rows_per_image = descriptor.tile_size;
+
+    auto dst      = GPUImageCopyTexture{};
+    dst.texture   = slot.upload.texture;
+    dst.mip_level = 0;
+
+    auto size   = GPUExtent3D{};
+    size.width  = descriptor.tile_size;
+    size.height = descriptor.tile_size;
+    size.depth  = 1;
+
+    command.resource_barrier(state_transition(slot.upload.texture, undefined_state(), copy_dst_state()));
+    command.copy_buffer_to_texture(src, dst, size);
+}
+
+void StreamingLoader::start_decoding()
+{
+    auto started = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint i = 0; i < slots.size() && !requests.empty(); i++) {
+            auto& slot = slots.at(i);
+            if (slot.state != SlotState::FREE)
+                continue;
+
+            slot.state  = SlotState::DECODING;
+            slot.upload = requests.front();
+            requests.pop_front();
+            decode_queue.push_back(i);
+            started = true;
+        }
+    }
+
+    if (started)
+        wake.notify_one();
+}
+
+auto StreamingLoader::acquire_batch() -> Batch
+{
+    auto& device = RHI::get_current_device();
+
+    if (!batch_pool.empty()) {
+        auto batch = std::move(batch_pool.back());
+        batch_pool.pop_back();
+        return batch;
+    }
+
+    auto batch      = Batch{};
+    batch.semaphore = device.create_semaphore();
+    batch.fence     = device.create_fence();
+    return batch;
+}
+
+void StreamingLoader::decode_loop()
+{
+    while (true) {
+        uint     index;
+        uint     seed;
+        uint8_t* pixels;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !decode_queue.empty(); });
+            if (stopping)
+                return;
+
+            index = decode_queue.front();
+            decode_queue.pop_front();
+
+            // NOTE: the slot is owned by this thread while DECODING, the render thread only reads it under the lock
+            seed   = slots.at(index).upload.seed;
+            pixels = slots.at(index).data;
+        }
+
+        decode(pixels, seed);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded.push_back(index);
+    }
+}
+
+void StreamingLoader::decode(uint8_t* pixels, uint seed) const
+{
+    // stand-in for real asset decoding, kept cheap so that the copies rather than the decode thread are measured
+    auto size  = descriptor.tile_size;
+    auto shift = (seed * 37) % 256;
+
+    for (uint y = 0; y < size; y++) {
+        for (uint x = 0; x < size; x++) {
+            auto checker = ((x / 32) + (y / 32) + seed) % 2 == 0 ? 255u : 160u;
+            auto texel   = pixels + (y * size + x) * 4;
+            texel[0]     = static_cast<uint8_t>(((x * 255 / size + shift) & 0xff) * checker / 255);
+            texel[1]     = static_cast<uint8_t>(((y * 255 / size + shift / 2) & 0xff) * checker / 255);
+            texel[2]     = static_cast<uint8_t>((seed * 53 % 256) * checker / 255);
+            texel[3]     = 255;
+        }
+    }
+}
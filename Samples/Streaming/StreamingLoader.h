@@ -0,0 +1,119 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+
+// A texture to be filled by the loader.
+// NOTE: the texture must not be in use by the graphics queue, its previous contents are discarded.
+struct TextureUpload
+{
+    lyra::rhi::GPUTexture texture;
+    uint       tile;
+    uint       seed;
+};
+
+struct StreamingLoaderDescriptor
+{
+    uint tile_size       = 256; // width and height of every texture, in texels (RGBA8)
+    uint staging_slots   = 64;  // number of staging buffers, one texture each
+    uint frame_budget    = 4;   // uploads recorded per frame on the graphics queue
+    uint frames_inflight = 3;
+};
+
+// Streams textures to the GPU while frames continue.
+//
+// Pixels are produced ("decoded") on a background thread straight into persistently mapped staging buffers.
+// The render thread records the copies, either on the dedicated transfer queue, or inline in the frame's
+// graphics command buffer, so that both can be compared. The loader never touches the device from the
+// background thread.
+//
+// With the transfer queue, every batch is submitted with its own semaphore and fence:
+//
+//   transfer: [barrier: UNDEFINED -> COPY_DST] [copy] [release: COPY_DST -> SHADER_RESOURCE] [signal]
+//   graphics:                                              [wait] [acquire: COPY_DST -> SHADER_RESOURCE]
+//
+// The acquire is only recorded after the fence has been observed on the CPU, so the graphics queue
+// never stalls on an upload that is still running.
+class StreamingLoader
+{
+public:
+    explicit StreamingLoader(const StreamingLoaderDescriptor& descriptor);
+    ~StreamingLoader();
+
+    StreamingLoader(const StreamingLoader&) = delete;
+    StreamingLoader& operator=(const StreamingLoader&) = delete;
+
+    void enqueue(const TextureUpload& upload);
+
+    // Called once per frame on the render thread, with the frame's graphics command buffer.
+    // Returns the uploads that can be sampled by the graphics queue, starting with this command buffer.
+    auto update(lyra::rhi::GPUCommandBuffer& graphics, uint64_t frame_index) -> std::vector<TextureUpload>;
+
+    // Switch between the transfer queue and inline copies. Batches already in flight complete as recorded.
+    void use_transfer_queue(bool enabled) { transfer = enabled; }
+
+    auto uses_transfer_queue() const -> bool { return transfer; }
+
+    // Total number of bytes whose upload has completed.
+    auto uploaded_bytes() const -> uint64_t { return uploaded; }
+
+    auto tile_bytes() const -> uint64_t { return uint64_t(descriptor.tile_size) * descriptor.tile_size * 4; }
+
+private:
+    enum class SlotState
+    {
+        FREE,
+        DECODING,
+        READY,
+        UPLOADING,
+    };
+
+    struct Slot
+    {
+        lyra::rhi::GPUBuffer staging;
+        uint8_t*             data  = nullptr;
+        SlotState            state = SlotState::FREE;
+        TextureUpload        upload;
+    };
+
+    struct Batch
+    {
+        std::vector<uint>       slots;
+        lyra::rhi::GPUSemaphore semaphore;
+        lyra::rhi::GPUFence     fence;
+        uint64_t                frame    = 0;
+        bool                    transfer = false;
+    };
+
+    void decode_loop();
+    void decode(uint8_t* pixels, uint seed) const;
+    void retire_batches(lyra::rhi::GPUCommandBuffer& graphics, uint64_t frame_index, std::vector<TextureUpload>& completed);
+    void submit_transfer(std::vector<uint>& ready, uint64_t frame_index);
+    void record_inline(lyra::rhi::GPUCommandBuffer& graphics, std::vector<uint>& ready, uint64_t frame_index);
+    void record_copy(lyra::rhi::GPUCommandBuffer& command, const Slot& slot);
+    void start_decoding();
+    auto acquire_batch() -> Batch;
+
+private:
+    StreamingLoaderDescriptor descriptor;
+    std::vector<Slot>         slots;
+    std::deque<TextureUpload> requests;
+    std::deque<Batch>         inflight;
+    std::vector<Batch>        batch_pool;
+    uint64_t                  uploaded = 0;
+    bool                      transfer = true;
+
+    // shared with the decode thread, guarded by mutex
+    std::thread             thread;
+    std::mutex              mutex;
+    std::condition_variable wake;
+    std::deque<uint>        decode_queue;
+    std::vector<uint>       decoded;
+    bool                    stopping = false;
+};
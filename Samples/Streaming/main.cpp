@@ -0,0 +1,444 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+#include "StreamingLoader.h"
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+struct Vertex
+{
+    glm::vec2 position;
+    glm::vec2 uv;
+};
+
+// Every tile owns two textures: one is sampled (front), the other one is streamed into (back).
+struct Tile
+{
+    GPUTexture     textures[2];
+    GPUTextureView views[2];
+    GPUBindGroup   bind_groups[2];
+    int            front   = -1; // -1 until the first upload completes
+    uint64_t       retired = 0;  // frame in which the back texture was last sampled
+    uint           seed    = 0;
+    bool           loading = false;
+};
+
+struct FrameStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last;
+    double            accumulated = 0.0;
+    double            worst       = 0.0;
+    uint64_t          uploaded    = 0;
+    uint              frames      = 0;
+};
+
+constexpr uint TILE_GRID         = 8;
+constexpr uint TILE_COUNT        = TILE_GRID * TILE_GRID;
+constexpr uint TILE_SIZE         = 256;
+constexpr uint FRAMES_INFLIGHT   = 3;
+constexpr uint FRAMES_PER_TOGGLE = 480;
+
+GPUShaderModule                  vshader;
+GPUShaderModule                  fshader;
+GPUBindGroupLayout               blayout;
+GPUPipelineLayout                playout;
+GPURenderPipeline                pipeline;
+GPUBuffer                        vbuffer;
+GPUBuffer                        ibuffer;
+Tile                             tiles[TILE_COUNT];
+std::unique_ptr<StreamingLoader> loader;
+uint64_t                         frame_index = 0;
+FrameStats                       stats;
+
+auto read_shader_source() -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open("shader.slang");
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+void setup_pipeline()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = "test";
+        desc.path   = "test.slang";
+        desc.source = read_shader_source();
+        return compiler->compile(desc);
+    });
+
+    vshader = execute([&]() {
+        auto code  = module->get_shader_blob("vsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "vertex_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+
+    fshader = execute([&]() {
+        auto code  = module->get_shader_blob("fsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "fragment_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+
+    blayout = execute([&]() {
+        auto entry                   = GPUBindGroupLayoutEntry{};
+        entry.type                   = GPUBindingResourceType::TEXTURE;
+        entry.binding                = 0;
+        entry.count                  = 1;
+        entry.visibility             = GPUShaderStage::FRAGMENT;
+        entry.texture.sample_type    = GPUTextureSampleType::FLOAT;
+        entry.texture.view_dimension = GPUTextureViewDimension::x2D;
+        entry.texture.multisampled   = false;
+
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(entry);
+        return device.create_bind_group_layout(desc);
+    });
+
+    playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    pipeline = execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x2;
+        position.offset          = offsetof(Vertex, position);
+        position.shader_location = 0;
+
+        auto uv            = GPUVertexAttribute{};
+        uv.format          = GPUVertexFormat::FLOAT32x2;
+        uv.offset          = offsetof(Vertex, uv);
+        uv.shader_location = 1;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position, uv};
+        layout.array_stride = sizeof(Vertex);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto target         = GPUColorTargetState{};
+        target.format       = surface.get_current_format();
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::ALWAYS;
+        desc.depth_stencil.depth_write_enabled     = false;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vshader;
+        desc.fragment.module                       = fshader;
+        desc.vertex.buffers.push_back(layout);
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+}
+
+void setup_buffers()
+{
+    auto& device = RHI::get_current_device();
+
+    vbuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "vertex_buffer";
+        desc.size               = sizeof(Vertex) * 4 * TILE_COUNT;
+        desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    ibuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "index_buffer";
+        desc.size               = sizeof(uint32_t) * 6;
+        desc.usage              = GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    // one quad per tile, covering the screen in a grid with a small gap
+    auto vertices = vbuffer.get_mapped_range<Vertex>();
+    for (uint i = 0; i < TILE_COUNT; i++) {
+        auto size = 2.0f / TILE_GRID;
+        auto gap  = size * 0.02f;
+        auto x0   = -1.0f + float(i % TILE_GRID) * size + gap;
+        auto y0   = -1.0f + float(i / TILE_GRID) * size + gap;
+        auto x1   = x0 + size - gap * 2.0f;
+        auto y1   = y0 + size - gap * 2.0f;
+
+        vertices.at(i * 4 + 0) = Vertex{{x0, y0}, {0.0f, 1.0f}};
+        vertices.at(i * 4 + 1) = Vertex{{x1, y0}, {1.0f, 1.0f}};
+        vertices.at(i * 4 + 2) = Vertex{{x1, y1}, {1.0f, 0.0f}};
+        vertices.at(i * 4 + 3) = Vertex{{x0, y1}, {0.0f, 0.0f}};
+    }
+
+    auto indices  = ibuffer.get_mapped_range<uint>();
+    indices.at(0) = 0;
+    indices.at(1) = 1;
+    indices.at(2) = 2;
+    indices.at(3) = 0;
+    indices.at(4) = 2;
+    indices.at(5) = 3;
+}
+
+void setup_tiles()
+{
+    auto& device = RHI::get_current_device();
+
+    for (auto& tile : tiles) {
+        for (uint i = 0; i < 2; i++) {
+            tile.textures[i] = execute([&]() {
+                auto desc            = GPUTextureDescriptor{};
+                desc.format          = GPUTextureFormat::RGBA8UNORM;
+                desc.size.width      = TILE_SIZE;
+                desc.size.height     = TILE_SIZE;
+                desc.size.depth      = 1;
+                desc.array_layers    = 1;
+                desc.mip_level_count = 1;
+                desc.usage           = GPUTextureUsage::COPY_DST | GPUTextureUsage::TEXTURE_BINDING;
+                desc.label           = "tile_texture";
+                return device.create_texture(desc);
+            });
+
+            tile.views[i] = tile.textures[i].create_view();
+
+            tile.bind_groups[i] = execute([&]() {
+                auto entry    = GPUBindGroupEntry{};
+                entry.type    = GPUBindingResourceType::TEXTURE;
+                entry.binding = 0;
+                entry.index   = 0;
+                entry.texture = tile.views[i];
+
+                auto desc   = GPUBindGroupDescriptor{};
+                desc.layout = blayout;
+                desc.entries.push_back(entry);
+                return device.create_bind_group(desc);
+            });
+        }
+    }
+}
+
+void setup_loader()
+{
+    auto desc            = StreamingLoaderDescriptor{};
+    desc.tile_size       = TILE_SIZE;
+    desc.staging_slots   = 64;
+    desc.frame_budget    = 4;
+    desc.frames_inflight = FRAMES_INFLIGHT;
+    loader               = std::make_unique<StreamingLoader>(desc);
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    loader.reset();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    for (auto& tile : tiles)
+        for (auto& texture : tile.textures)
+            texture.destroy();
+    vbuffer.destroy();
+    ibuffer.destroy();
+    vshader.destroy();
+    fshader.destroy();
+    blayout.destroy();
+    playout.destroy();
+    pipeline.destroy();
+}
+
+void stream_tiles(GPUCommandBuffer& command)
+{
+    // swap in every tile whose upload has become visible to the graphics queue
+    for (auto& upload : loader->update(command, frame_index)) {
+        auto& tile   = tiles[upload.tile];
+        tile.front   = tile.front == 0 ? 1 : 0;
+        tile.retired = frame_index;
+        tile.loading = false;
+    }
+
+    // keep requesting new contents for every tile, the old front texture is reused once no frame samples it
+    for (uint i = 0; i < TILE_COUNT; i++) {
+        auto& tile = tiles[i];
+        if (tile.loading || tile.retired + FRAMES_INFLIGHT > frame_index)
+            continue;
+
+        auto upload    = TextureUpload{};
+        upload.texture = tile.textures[tile.front == 0 ? 1 : 0];
+        upload.tile    = i;
+        upload.seed    = tile.seed++;
+        loader->enqueue(upload);
+        tile.loading = true;
+    }
+}
+
+void report()
+{
+    auto now = FrameStats::Clock::now();
+    if (stats.frames > 0) {
+        auto ms = std::chrono::duration<double, std::milli>(now - stats.last).count();
+        stats.accumulated += ms;
+        stats.worst = std::max(stats.worst, ms);
+    } else {
+        stats.uploaded = loader->uploaded_bytes();
+    }
+    stats.last = now;
+
+    // alternate between transfer queue and inline copies, to compare both
+    if (++stats.frames == FRAMES_PER_TOGGLE) {
+        auto seconds   = stats.accumulated / 1000.0;
+        auto megabytes = double(loader->uploaded_bytes() - stats.uploaded) / (1024.0 * 1024.0);
+        std::cout << "Uploads: " << (loader->uses_transfer_queue() ? "TRANSFER" : "DEFAULT ")
+                  << ", Bandwidth: " << megabytes / seconds << " MB/s"
+                  << ", Frame Time: " << stats.accumulated / (FRAMES_PER_TOGGLE - 1) << " ms"
+                  << " (worst " << stats.worst << " ms)" << std::endl;
+
+        loader->use_transfer_queue(!loader->uses_transfer_queue());
+        stats = FrameStats{};
+    }
+}
+
+void render()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    // create command buffer
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.1f, 0.1f, 0.1f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = texture.view;
+
+    auto render_pass              = GPURenderPassDescriptor{};
+    render_pass.color_attachments = {color_attachment};
+
+    // commands
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    stream_tiles(command);
+    command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(pipeline);
+    command.set_vertex_buffer(0, vbuffer);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+    for (uint i = 0; i < TILE_COUNT; i++) {
+        if (tiles[i].front < 0)
+            continue;
+        command.set_bind_group(0, tiles[i].bind_groups[tiles[i].front]);
+        command.draw_indexed(6, 1, 0, i * 4, 0);
+    }
+    command.end_render_pass();
+    command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    // present this frame to swapchain
+    texture.present();
+
+    report();
+    frame_index++;
+}
+
+int main()
+{
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Immediate; // NOTE: do not hide frame time behind vsync
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipeline);
+    win->bind<WindowEvent::START>(setup_buffers);
+    win->bind<WindowEvent::START>(setup_tiles);
+    win->bind<WindowEvent::START>(setup_loader);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <cassert>
+#include <cstring>
+
+#include "BufferPool.h"
+
+using namespace lyra;
+using namespace lyra::rhi;
+
+BufferPool::BufferPool(std::string label, uint32_t usage, const SubAllocatorDescriptor& descriptor, MemoryTracker* tracker)
+    : label(std::move(label)), usage(usage), allocator(descriptor), tracker(tracker)
+{
+    allocator.on_block_created = [this](uint index, uint64_t size) {
+        auto& device = RHI::get_current_device();
+
+        if (index >= blocks.size()) {
+            blocks.resize(index + 1);
+            alive.resize(index + 1, false);
+            tracked.resize(index + 1, 0);
+        }
+
+        blocks.at(index) = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = this->label;
+            desc.size               = size;
+            desc.usage              = this->usage;
+            desc.mapped_at_creation = (this->usage & GPUBufferUsage::MAP_WRITE) != 0;
+            return device.create_buffer(desc);
+        });
+        alive.at(index) = true;
+
+        if (this->tracker)
+            tracked.at(index) = this->tracker->track(MemoryType::BUFFER, this->label, size);
+    };
+
+    allocator.on_block_released = [this](uint index) {
+        blocks.at(index).destroy();
+        alive.at(index) = false;
+
+        if (this->tracker)
+            this->tracker->release(tracked.at(index));
+    };
+}
+
+BufferPool::~BufferPool()
+{
+    // NOTE: the owner is expected to have waited for the device
+    for (uint i = 0; i < blocks.size(); i++) {
+        if (!alive.at(i))
+            continue;
+        blocks.at(i).destroy();
+        if (tracker)
+            tracker->release(tracked.at(i));
+    }
+}
+
+auto BufferPool::allocate(uint64_t size, uint64_t alignment) -> BufferAllocation
+{
+    auto allocation   = BufferAllocation{};
+    allocation.handle = allocator.allocate(size, alignment);
+    if (!allocation.handle.valid())
+        return allocation;
+
+    allocation.buffer = blocks.at(allocation.handle.block);
+    allocation.offset = allocation.handle.range.offset;
+    allocation.size   = size;
+    return allocation;
+}
+
+void BufferPool::free(const BufferAllocation& allocation)
+{
+    allocator.free(allocation.handle);
+}
+
+void BufferPool::reset()
+{
+    allocator.reset();
+}
+
+void BufferPool::write(const BufferAllocation& allocation, const void* data, uint64_t size, uint64_t offset)
+{
+    assert(offset + size <= allocation.size && "write out of the allocated range");
+
+    auto mapped = blocks.at(allocation.handle.block).get_mapped_range<uint8_t>();
+    std::memcpy(&mapped.at(allocation.offset + offset), data, size);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+
+#include "MemoryTracker.h"
+#include "SubAllocator.h"
+
+// A range of a shared GPU buffer.
+struct BufferAllocation
+{
+    lyra::rhi::GPUBuffer buffer;
+    uint64_t             offset = 0;
+    uint64_t             size   = 0;
+    SubAllocation        handle;
+};
+
+// GPU buffers for one memory type (usage flags), sub-allocated from large blocks.
+// Every block is one GPUBuffer created with the pool's usage, and mapped when the usage includes MAP_WRITE.
+// Blocks are reported to the memory tracker under the pool's label, when one is given.
+//
+// NOTE: like GPUBuffer::destroy(), free() must only be called after the GPU has finished using the range.
+class BufferPool
+{
+public:
+    explicit BufferPool(std::string label, uint32_t usage, const SubAllocatorDescriptor& descriptor, MemoryTracker* tracker = nullptr);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    auto allocate(uint64_t size, uint64_t alignment = 16) -> BufferAllocation;
+    void free(const BufferAllocation& allocation);
+    void reset();
+
+    // Copy data into a mapped allocation.
+    void write(const BufferAllocation& allocation, const void* data, uint64_t size, uint64_t offset = 0);
+
+    auto stats() const -> SubAllocatorStats { return allocator.stats(); }
+
+    auto block(uint index) const -> const lyra::rhi::GPUBuffer& { return blocks.at(index); }
+
+private:
+    std::string                       label;
+    uint32_t                          usage;
+    SubAllocator                      allocator;
+    std::vector<lyra::rhi::GPUBuffer> blocks;
+    std::vector<bool>                 alive; // blocks released by the allocator are destroyed right away
+    std::vector<uint>                 tracked;
+    MemoryTracker*                    tracker;
+};
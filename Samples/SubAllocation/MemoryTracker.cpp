@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <fstream>
+
+#include "MemoryTracker.h"
+
+using namespace lyra::rhi;
+
+namespace
+{
+    struct FormatInfo
+    {
+        uint block_size  = 1; // texels per block edge
+        uint block_bytes = 4;
+    };
+
+    auto format_info(GPUTextureFormat format) -> FormatInfo
+    {
+        switch (format) {
+            case GPUTextureFormat::DEPTH16UNORM:
+                return {1, 2};
+            case GPUTextureFormat::RG32FLOAT:
+            case GPUTextureFormat::RGBA16FLOAT:
+            case GPUTextureFormat::DEPTH24PLUS_STENCIL8: // NOTE: D32S8 on most hardware, stencil in a separate plane
+                return {1, 8};
+            case GPUTextureFormat::RGBA32FLOAT:
+                return {1, 16};
+            case GPUTextureFormat::BC1_RGBA_UNORM:
+                return {4, 8};
+            case GPUTextureFormat::BC3_RGBA_UNORM:
+            case GPUTextureFormat::BC7_RGBA_UNORM:
+                return {4, 16};
+            default:
+                return {1, 4};
+        }
+    }
+
+    void write_string(std::ostream& out, const std::string& value)
+    {
+        out << '"';
+        for (char c : value) {
+            switch (c) {
+                case '"':
+                    out << "\\\"";
+                    break;
+                case '\\':
+                    out << "\\\\";
+                    break;
+                case '\n':
+                    out << "\\n";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        out << ' ';
+                    else
+                        out << c;
+            }
+        }
+        out << '"';
+    }
+
+    void write_usage(std::ostream& out, const MemoryUsage& usage)
+    {
+        out << "\"count\": " << usage.count
+            << ", \"bytes\": " << usage.bytes
+            << ", \"peak_count\": " << usage.peak_count
+            << ", \"peak_bytes\": " << usage.peak_bytes;
+    }
+} // namespace
+
+auto to_string(MemoryType type) -> const char*
+{
+    switch (type) {
+        case MemoryType::BUFFER:
+            return "BUFFER";
+        case MemoryType::TEXTURE:
+            return "TEXTURE";
+        case MemoryType::QUERY_SET:
+            return "QUERY_SET";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+void MemoryTracker::add(MemoryUsage& usage, uint64_t bytes)
+{
+    usage.count++;
+    usage.bytes += bytes;
+    usage.peak_count = std::max(usage.peak_count, usage.count);
+    usage.peak_bytes = std::max(usage.peak_bytes, usage.bytes);
+}
+
+void MemoryTracker::remove(MemoryUsage& usage, uint64_t bytes)
+{
+    usage.count--;
+    usage.bytes -= bytes;
+}
+
+auto MemoryTracker::track(MemoryType type, const std::string& label, uint64_t bytes) -> uint
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+
+    auto id         = next_id++;
+    allocations[id] = Allocation{type, label, bytes};
+
+    add(per_label[{type, label}], bytes);
+    add(per_type[static_cast<uint>(type)], bytes);
+    add(overall, bytes);
+    return id;
+}
+
+void MemoryTracker::release(uint id)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+
+    auto it = allocations.find(id);
+    if (it == allocations.end())
+        return;
+
+    auto& allocation = it->second;
+    remove(per_label[{allocation.type, allocation.label}], allocation.bytes);
+    remove(per_type[static_cast<uint>(allocation.type)], allocation.bytes);
+    remove(overall, allocation.bytes);
+    allocations.erase(it);
+}
+
+auto MemoryTracker::track(const GPUBufferDescriptor& desc) -> uint
+{
+    return track(MemoryType::BUFFER, std::string(desc.label), desc.size);
+}
+
+auto MemoryTracker::track(const GPUTextureDescriptor& desc) -> uint
+{
+    auto info  = format_info(desc.format);
+    auto bytes = uint64_t(0);
+    for (uint level = 0; level < desc.mip_level_count; level++) {
+        auto width  = std::max(desc.size.width >> level, 1u);
+        auto height = std::max(desc.size.height >> level, 1u);
+        auto depth  = std::max(desc.size.depth >> level, 1u);
+        auto blocks = uint64_t((width + info.block_size - 1) / info.block_size) * ((height + info.block_size - 1) / info.block_size);
+        bytes += blocks * info.block_bytes * depth;
+    }
+    bytes *= desc.array_layers * desc.sample_count;
+    return track(MemoryType::TEXTURE, std::string(desc.label), bytes);
+}
+
+auto MemoryTracker::track(const GPUQuerySetDescriptor& desc, const GPUQuerySet& queries) -> uint
+{
+    // NOTE: a statistics query resolves to one 64 bit value per enabled statistic on Vulkan,
+    // but to the whole D3D12_QUERY_DATA_PIPELINE_STATISTICS on D3D12, whatever the descriptor enables.
+    return track(MemoryType::QUERY_SET, std::string(desc.label), uint64_t(desc.count) * queries.get_result_stride());
+}
+
+auto MemoryTracker::total() const -> MemoryUsage
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return overall;
+}
+
+auto MemoryTracker::usage(MemoryType type) const -> MemoryUsage
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return per_type[static_cast<uint>(type)];
+}
+
+auto MemoryTracker::usage(MemoryType type, const std::string& label) const -> MemoryUsage
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+
+    auto it = per_label.find({type, label});
+    return it == per_label.end() ? MemoryUsage{} : it->second;
+}
+
+auto MemoryTracker::labels() const -> std::vector<LabelUsage>
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return collect_labels();
+}
+
+auto MemoryTracker::collect_labels() const -> std::vector<LabelUsage>
+{
+    // NOTE: labels that are no longer resident are kept, their peak is still useful
+    auto result = std::vector<LabelUsage>{};
+    result.reserve(per_label.size());
+    for (auto& [key, usage] : per_label)
+        result.push_back(LabelUsage{key.second, key.first, usage});
+
+    std::sort(result.begin(), result.end(), [](const LabelUsage& a, const LabelUsage& b) {
+        return a.usage.bytes != b.usage.bytes ? a.usage.bytes > b.usage.bytes : a.usage.peak_bytes > b.usage.peak_bytes;
+    });
+    return result;
+}
+
+auto MemoryTracker::dump(const std::string& path) const -> bool
+{
+    // NOTE: one lock for the whole snapshot, so that labels, types and totals agree with each other
+    auto lock    = std::lock_guard<std::mutex>(mutex);
+    auto entries = collect_labels();
+
+    auto out = std::ofstream(path);
+    if (!out)
+        return false;
+
+    out << "{\n";
+    out << "  \"total\": {";
+    write_usage(out, overall);
+    out << "},\n";
+
+    out << "  \"types\": {\n";
+    for (uint i = 0; i < static_cast<uint>(MemoryType::COUNT); i++) {
+        out << "    \"" << to_string(static_cast<MemoryType>(i)) << "\": {";
+        write_usage(out, per_type[i]);
+        out << (i + 1 < static_cast<uint>(MemoryType::COUNT) ? "},\n" : "}\n");
+    }
+    out << "  },\n";
+
+    out << "  \"labels\": [\n";
+    for (size_t i = 0; i < entries.size(); i++) {
+        out << "    {\"label\": ";
+        write_string(out, entries[i].label);
+        out << ", \"type\": \"" << to_string(entries[i].type) << "\", ";
+        write_usage(out, entries[i].usage);
+        out << (i + 1 < entries.size() ? "},\n" : "}\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+    return bool(out);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+
+enum class MemoryType : uint
+{
+    BUFFER,
+    TEXTURE,
+    QUERY_SET,
+    COUNT,
+};
+
+struct MemoryUsage
+{
+    uint     count      = 0;
+    uint64_t bytes      = 0;
+    uint     peak_count = 0;
+    uint64_t peak_bytes = 0; // high-water mark since the tracker was created
+};
+
+struct LabelUsage
+{
+    std::string label;
+    MemoryType  type;
+    MemoryUsage usage;
+};
+
+// Accounts GPU memory by label and type, fed by whoever creates and destroys resources.
+// Every query returns a copy, so it can be called at any time, from any thread.
+class MemoryTracker
+{
+public:
+    auto track(MemoryType type, const std::string& label, uint64_t bytes) -> uint;
+    void release(uint id);
+
+    // Track a resource under the label of its descriptor, with the size its descriptor implies.
+    // NOTE: sizes are what the resource holds, drivers add their own alignment and metadata on top.
+    auto track(const lyra::rhi::GPUBufferDescriptor& desc) -> uint;
+    auto track(const lyra::rhi::GPUTextureDescriptor& desc) -> uint;
+
+    // Query sets are sized from the created set, whose result stride depends on the backend (see StencilTest).
+    auto track(const lyra::rhi::GPUQuerySetDescriptor& desc, const lyra::rhi::GPUQuerySet& queries) -> uint;
+
+    auto total() const -> MemoryUsage;
+    auto usage(MemoryType type) const -> MemoryUsage;
+    auto usage(MemoryType type, const std::string& label) const -> MemoryUsage;
+
+    // All labels, largest first.
+    auto labels() const -> std::vector<LabelUsage>;
+
+    // Write totals, per type and per label usage to a JSON file, returns false if the file cannot be written.
+    auto dump(const std::string& path) const -> bool;
+
+private:
+    struct Allocation
+    {
+        MemoryType  type;
+        std::string label;
+        uint64_t    bytes = 0;
+    };
+
+    static void add(MemoryUsage& usage, uint64_t bytes);
+    static void remove(MemoryUsage& usage, uint64_t bytes);
+
+    // NOTE: expects the mutex to be held
+    auto collect_labels() const -> std::vector<LabelUsage>;
+
+private:
+    mutable std::mutex                                        mutex;
+    std::map<uint, Allocation>                                allocations;
+    std::map<std::pair<MemoryType, std::string>, MemoryUsage> per_label;
+    MemoryUsage                                               per_type[static_cast<uint>(MemoryType::COUNT)];
+    MemoryUsage                                               overall;
+    uint                                                      next_id = 0;
+};
+
+auto to_string(MemoryType type) -> const char*;
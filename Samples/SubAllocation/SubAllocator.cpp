@@ -0,0 +1,613 @@
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "SubAllocator.h"
+
+namespace
+{
+    constexpr uint64_t GRANULARITY = 16; // smallest unit handed out by any strategy
+
+    auto align_up(uint64_t value, uint64_t alignment) -> uint64_t
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // index of the highest set bit, value must not be 0
+    auto log2_floor(uint64_t value) -> uint
+    {
+        uint result = 0;
+        while (value >>= 1)
+            result++;
+        return result;
+    }
+
+    // index of the lowest set bit, value must not be 0
+    auto lowest_bit(uint64_t value) -> uint
+    {
+        uint result = 0;
+        while ((value & 1) == 0) {
+            value >>= 1;
+            result++;
+        }
+        return result;
+    }
+
+    // Bump pointer. Frees are only counted, the block is rewound when the last allocation goes away.
+    class LinearAllocator : public RangeAllocator
+    {
+    public:
+        explicit LinearAllocator(uint64_t capacity) : capacity(capacity) {}
+
+        auto allocate(uint64_t size, uint64_t alignment, Range& range) -> bool override
+        {
+            auto offset = align_up(top, std::max(alignment, GRANULARITY));
+            auto end    = align_up(offset + size, GRANULARITY);
+            if (end > capacity)
+                return false;
+
+            range.offset    = offset;
+            range.size      = end - top; // NOTE: the alignment gap in front is lost until the block is rewound
+            range.requested = size;
+            top             = end;
+            count++;
+            return true;
+        }
+
+        void free(const Range&) override
+        {
+            if (--count == 0)
+                top = 0;
+        }
+
+        void reset() override
+        {
+            top   = 0;
+            count = 0;
+        }
+
+        auto free_bytes() const -> uint64_t override { return capacity - top; }
+        auto largest_free() const -> uint64_t override { return capacity - top; }
+        auto allocation_count() const -> uint override { return count; }
+
+    private:
+        uint64_t capacity;
+        uint64_t top   = 0;
+        uint     count = 0;
+    };
+
+    // Binary buddy allocator over a power of two capacity.
+    // Every allocation is rounded up to a power of two, which is also its alignment.
+    class BuddyAllocator : public RangeAllocator
+    {
+    public:
+        explicit BuddyAllocator(uint64_t capacity)
+        {
+            max_order = log2_floor(capacity / MIN_SIZE);
+            free_lists.resize(max_order + 1);
+            reset();
+        }
+
+        auto allocate(uint64_t size, uint64_t alignment, Range& range) -> bool override
+        {
+            auto order = order_of(std::max(size, alignment));
+            if (order > max_order)
+                return false;
+
+            // smallest free block that fits
+            auto found = order;
+            while (found <= max_order && free_lists[found].empty())
+                found++;
+            if (found > max_order)
+                return false;
+
+            auto offset = *free_lists[found].begin();
+            free_lists[found].erase(offset);
+
+            // split down to the requested order, putting the upper halves on the free lists
+            while (found > order) {
+                found--;
+                free_lists[found].insert(offset + (MIN_SIZE << found));
+            }
+
+            orders[offset]  = order;
+            range.offset    = offset;
+            range.size      = MIN_SIZE << order;
+            range.requested = size;
+            return true;
+        }
+
+        void free(const Range& range) override
+        {
+            auto it = orders.find(range.offset);
+            assert(it != orders.end() && "freeing a range that was not allocated");
+
+            auto offset = range.offset;
+            auto order  = it->second;
+            orders.erase(it);
+
+            // merge with the buddy for as long as it is free
+            while (order < max_order) {
+                auto buddy = offset ^ (MIN_SIZE << order);
+                auto found = free_lists[order].find(buddy);
+                if (found == free_lists[order].end())
+                    break;
+
+                free_lists[order].erase(found);
+                offset = std::min(offset, buddy);
+                order++;
+            }
+            free_lists[order].insert(offset);
+        }
+
+        void reset() override
+        {
+            for (auto& list : free_lists)
+                list.clear();
+            orders.clear();
+            free_lists[max_order].insert(0);
+        }
+
+        auto free_bytes() const -> uint64_t override
+        {
+            uint64_t total = 0;
+            for (uint order = 0; order <= max_order; order++)
+                total += free_lists[order].size() * (MIN_SIZE << order);
+            return total;
+        }
+
+        auto largest_free() const -> uint64_t override
+        {
+            for (uint order = max_order + 1; order > 0; order--)
+                if (!free_lists[order - 1].empty())
+                    return MIN_SIZE << (order - 1);
+            return 0;
+        }
+
+        auto allocation_count() const -> uint override { return static_cast<uint>(orders.size()); }
+
+    private:
+        static constexpr uint64_t MIN_SIZE = 256;
+
+        auto order_of(uint64_t size) const -> uint
+        {
+            uint order = 0;
+            while ((MIN_SIZE << order) < size)
+                order++;
+            return order;
+        }
+
+    private:
+        uint                                      max_order = 0;
+        std::vector<std::unordered_set<uint64_t>> free_lists;
+        std::unordered_map<uint64_t, uint>        orders;
+    };
+
+    // Two-level segregated fit allocator.
+    // Free ranges are binned by the position of their highest bit (first level), and 16 linear subdivisions
+    // of that (second level). Bitmaps over the bins find a fitting range in constant time, and physical
+    // neighbours are merged when a range is freed.
+    class TLSFAllocator : public RangeAllocator
+    {
+    public:
+        explicit TLSFAllocator(uint64_t capacity) : capacity(capacity)
+        {
+            reset();
+        }
+
+        auto allocate(uint64_t size, uint64_t alignment, Range& range) -> bool override
+        {
+            auto requested = size;
+
+            alignment = std::max(alignment, GRANULARITY);
+            size      = align_up(std::max(size, GRANULARITY), GRANULARITY);
+
+            // over-allocate so that the aligned offset always fits in the range found
+            auto search = size + alignment - GRANULARITY;
+            auto index  = find_free(search);
+            if (index == NONE)
+                return false;
+
+            remove_free(index);
+
+            // split off the alignment gap in front, it stays a free range of its own
+            auto aligned = align_up(nodes[index].offset, alignment);
+            if (aligned > nodes[index].offset) {
+                auto front = split(index, aligned - nodes[index].offset);
+                insert_free(index);
+                index = front;
+            }
+
+            // return the tail when it is large enough to be useful
+            if (nodes[index].size - size >= GRANULARITY) {
+                auto tail = split(index, size);
+                insert_free(tail);
+            }
+
+            nodes[index].free              = false;
+            allocated[nodes[index].offset] = index;
+
+            range.offset    = nodes[index].offset;
+            range.size      = nodes[index].size;
+            range.requested = requested;
+            return true;
+        }
+
+        void free(const Range& range) override
+        {
+            auto it = allocated.find(range.offset);
+            assert(it != allocated.end() && "freeing a range that was not allocated");
+
+            auto index = it->second;
+            allocated.erase(it);
+            nodes[index].free = true;
+
+            // merge with the physical neighbours when they are free
+            auto next = nodes[index].next_phys;
+            if (next != NONE && nodes[next].free) {
+                remove_free(next);
+                merge(index, next);
+            }
+
+            auto prev = nodes[index].prev_phys;
+            if (prev != NONE && nodes[prev].free) {
+                remove_free(prev);
+                merge(prev, index);
+                index = prev;
+            }
+
+            insert_free(index);
+        }
+
+        void reset() override
+        {
+            nodes.clear();
+            spare.clear();
+            allocated.clear();
+            fl_bitmap = 0;
+            std::fill(std::begin(sl_bitmap), std::end(sl_bitmap), 0u);
+            for (auto& row : heads)
+                std::fill(std::begin(row), std::end(row), NONE);
+
+            auto index          = create_node();
+            nodes[index].offset = 0;
+            nodes[index].size   = capacity;
+            insert_free(index);
+        }
+
+        auto free_bytes() const -> uint64_t override
+        {
+            uint64_t total = 0;
+            for (auto& node : nodes)
+                if (node.free && node.size > 0)
+                    total += node.size;
+            return total;
+        }
+
+        auto largest_free() const -> uint64_t override
+        {
+            if (fl_bitmap == 0)
+                return 0;
+
+            // only the highest non-empty bin can hold the largest range, but it is not sorted
+            auto     fl      = log2_floor(fl_bitmap);
+            auto     sl      = log2_floor(sl_bitmap[fl]);
+            uint64_t largest = 0;
+            for (auto index = heads[fl][sl]; index != NONE; index = nodes[index].next_free)
+                largest = std::max(largest, nodes[index].size);
+            return largest;
+        }
+
+        auto allocation_count() const -> uint override { return static_cast<uint>(allocated.size()); }
+
+    private:
+        static constexpr uint NONE     = ~0u;
+        static constexpr uint SL_LOG2  = 4;
+        static constexpr uint SL_COUNT = 1 << SL_LOG2;
+        static constexpr uint FL_COUNT = 64;
+
+        struct Node
+        {
+            uint64_t offset    = 0;
+            uint64_t size      = 0;
+            uint     prev_phys = NONE;
+            uint     next_phys = NONE;
+            uint     prev_free = NONE;
+            uint     next_free = NONE;
+            bool     free      = true;
+        };
+
+        // bin of a range of the given size, every range in it is at least as large as the bin's lower bound
+        static void mapping(uint64_t size, uint& fl, uint& sl)
+        {
+            fl = log2_floor(size);
+            sl = fl < SL_LOG2 ? 0 : static_cast<uint>((size >> (fl - SL_LOG2)) - SL_COUNT);
+        }
+
+        auto find_free(uint64_t size) const -> uint
+        {
+            // round up to the next bin, so that any range found is large enough
+            uint fl, sl;
+            mapping(size, fl, sl);
+            if (fl >= SL_LOG2)
+                size += (1ull << (fl - SL_LOG2)) - 1;
+            mapping(size, fl, sl);
+            if (fl >= FL_COUNT)
+                return NONE;
+
+            auto sl_map = sl_bitmap[fl] & (~0u << sl);
+            if (sl_map == 0) {
+                auto fl_map = fl + 1 < FL_COUNT ? fl_bitmap & (~0ull << (fl + 1)) : 0;
+                if (fl_map == 0)
+                    return NONE;
+                fl     = lowest_bit(fl_map);
+                sl_map = sl_bitmap[fl];
+            }
+            sl = lowest_bit(sl_map);
+            return heads[fl][sl];
+        }
+
+        void insert_free(uint index)
+        {
+            uint fl, sl;
+            mapping(nodes[index].size, fl, sl);
+
+            auto& node     = nodes[index];
+            node.free      = true;
+            node.prev_free = NONE;
+            node.next_free = heads[fl][sl];
+            if (node.next_free != NONE)
+                nodes[node.next_free].prev_free = index;
+            heads[fl][sl] = index;
+
+            fl_bitmap |= 1ull << fl;
+            sl_bitmap[fl] |= 1u << sl;
+        }
+
+        void remove_free(uint index)
+        {
+            uint fl, sl;
+            mapping(nodes[index].size, fl, sl);
+
+            auto& node = nodes[index];
+            if (node.prev_free != NONE)
+                nodes[node.prev_free].next_free = node.next_free;
+            else
+                heads[fl][sl] = node.next_free;
+            if (node.next_free != NONE)
+                nodes[node.next_free].prev_free = node.prev_free;
+
+            if (heads[fl][sl] == NONE) {
+                sl_bitmap[fl] &= ~(1u << sl);
+                if (sl_bitmap[fl] == 0)
+                    fl_bitmap &= ~(1ull << fl);
+            }
+        }
+
+        // split the first size bytes off a node, returns the node holding the remainder
+        auto split(uint index, uint64_t size) -> uint
+        {
+            auto rest = create_node();
+
+            nodes[rest].offset    = nodes[index].offset + size;
+            nodes[rest].size      = nodes[index].size - size;
+            nodes[rest].prev_phys = index;
+            nodes[rest].next_phys = nodes[index].next_phys;
+            if (nodes[rest].next_phys != NONE)
+                nodes[nodes[rest].next_phys].prev_phys = rest;
+
+            nodes[index].size      = size;
+            nodes[index].next_phys = rest;
+            return rest;
+        }
+
+        // absorb a physical neighbour into the node before it
+        void merge(uint index, uint next)
+        {
+            nodes[index].size += nodes[next].size;
+            nodes[index].next_phys = nodes[next].next_phys;
+            if (nodes[index].next_phys != NONE)
+                nodes[nodes[index].next_phys].prev_phys = index;
+
+            nodes[next] = Node{};
+            spare.push_back(next);
+        }
+
+        auto create_node() -> uint
+        {
+            if (!spare.empty()) {
+                auto index = spare.back();
+                spare.pop_back();
+                nodes[index] = Node{};
+                return index;
+            }
+            nodes.emplace_back();
+            return static_cast<uint>(nodes.size() - 1);
+        }
+
+    private:
+        uint64_t                           capacity;
+        std::vector<Node>                  nodes;
+        std::vector<uint>                  spare;
+        std::unordered_map<uint64_t, uint> allocated;
+        uint64_t                           fl_bitmap = 0;
+        uint32_t                           sl_bitmap[FL_COUNT];
+        uint                               heads[FL_COUNT][SL_COUNT];
+    };
+} // namespace
+
+auto RangeAllocator::create(AllocationStrategy strategy, uint64_t capacity) -> std::unique_ptr<RangeAllocator>
+{
+    switch (strategy) {
+        case AllocationStrategy::LINEAR:
+            return std::make_unique<LinearAllocator>(capacity);
+        case AllocationStrategy::BUDDY:
+            return std::make_unique<BuddyAllocator>(capacity);
+        case AllocationStrategy::TLSF:
+            return std::make_unique<TLSFAllocator>(capacity);
+    }
+    return nullptr;
+}
+
+SubAllocator::SubAllocator(const SubAllocatorDescriptor& descriptor) : desc(descriptor)
+{
+    // NOTE: the buddy allocator needs a power of two block
+    if (desc.strategy == AllocationStrategy::BUDDY)
+        desc.block_size = 1ull << log2_floor(desc.block_size);
+
+    desc.dedicated_threshold = std::min(desc.dedicated_threshold, desc.block_size);
+}
+
+auto SubAllocator::allocate(uint64_t size, uint64_t alignment) -> SubAllocation
+{
+    auto allocation = SubAllocation{};
+
+    if (size > desc.dedicated_threshold) {
+        allocation.block           = create_block(size, true);
+        allocation.dedicated       = true;
+        allocation.range.offset    = 0;
+        allocation.range.size      = size;
+        allocation.range.requested = size;
+    } else {
+        // the block that served the last allocation usually has room, try it before scanning
+        auto fits = [&](uint index) {
+            auto& block = blocks[index];
+            return block.used && block.ranges && block.ranges->allocate(size, alignment, allocation.range);
+        };
+
+        if (last_block < blocks.size() && fits(last_block)) {
+            allocation.block = last_block;
+        } else {
+            for (uint i = 0; i < blocks.size(); i++) {
+                if (i != last_block && fits(i)) {
+                    allocation.block = i;
+                    break;
+                }
+            }
+        }
+
+        if (!allocation.valid()) {
+            allocation.block = create_block(desc.block_size, false);
+            if (!blocks[allocation.block].ranges->allocate(size, alignment, allocation.range)) {
+                release_block(allocation.block);
+                return SubAllocation{};
+            }
+        }
+        last_block = allocation.block;
+    }
+
+    allocated += allocation.range.requested;
+    wasted += allocation.range.size - allocation.range.requested;
+    live++;
+    return allocation;
+}
+
+void SubAllocator::free(const SubAllocation& allocation)
+{
+    if (!allocation.valid())
+        return;
+
+    allocated -= allocation.range.requested;
+    wasted -= allocation.range.size - allocation.range.requested;
+    live--;
+
+    if (allocation.dedicated) {
+        release_block(allocation.block);
+        return;
+    }
+
+    auto& block = blocks[allocation.block];
+    block.ranges->free(allocation.range);
+
+    // keep one empty block around, so that a free/allocate pattern at the boundary does not thrash blocks
+    if (block.ranges->allocation_count() == 0) {
+        auto empty = std::count_if(blocks.begin(), blocks.end(), [](const Block& b) {
+            return b.used && b.ranges && b.ranges->allocation_count() == 0;
+        });
+        if (empty > 1)
+            release_block(allocation.block);
+    }
+}
+
+void SubAllocator::reset()
+{
+    for (uint i = 0; i < blocks.size(); i++) {
+        if (!blocks[i].used)
+            continue;
+        if (blocks[i].ranges)
+            blocks[i].ranges->reset();
+        else
+            release_block(i);
+    }
+
+    allocated = 0;
+    wasted    = 0;
+    live      = 0;
+}
+
+auto SubAllocator::stats() const -> SubAllocatorStats
+{
+    auto stats             = SubAllocatorStats{};
+    stats.dedicated_count  = dedicated;
+    stats.allocation_count = live;
+    stats.reserved_bytes   = reserved;
+    stats.allocated_bytes  = allocated;
+    stats.wasted_bytes     = wasted;
+    stats.peak_reserved    = peak_reserved;
+
+    for (auto& block : blocks) {
+        if (!block.used || !block.ranges)
+            continue;
+        auto free    = block.ranges->free_bytes();
+        auto largest = block.ranges->largest_free();
+
+        stats.block_count++;
+        stats.free_bytes += free;
+        stats.fragmented_bytes += free - largest;
+        stats.largest_free = std::max(stats.largest_free, largest);
+    }
+    return stats;
+}
+
+auto SubAllocator::create_block(uint64_t size, bool is_dedicated) -> uint
+{
+    uint index;
+    if (!unused.empty()) {
+        index = unused.back();
+        unused.pop_back();
+    } else {
+        index = static_cast<uint>(blocks.size());
+        blocks.emplace_back();
+    }
+
+    auto& block  = blocks[index];
+    block.size   = size;
+    block.used   = true;
+    block.ranges = is_dedicated ? nullptr : RangeAllocator::create(desc.strategy, size);
+
+    reserved += size;
+    peak_reserved = std::max(peak_reserved, reserved);
+    if (is_dedicated)
+        dedicated++;
+
+    if (on_block_created)
+        on_block_created(index, size);
+    return index;
+}
+
+void SubAllocator::release_block(uint index)
+{
+    auto& block = blocks[index];
+    if (!block.ranges)
+        dedicated--;
+
+    reserved -= block.size;
+    block.ranges.reset();
+    block.size = 0;
+    block.used = false;
+    unused.push_back(index);
+
+    if (on_block_released)
+        on_block_released(index);
+}
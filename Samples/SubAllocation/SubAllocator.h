@@ -0,0 +1,127 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <Lyra/Common.hpp>
+
+// How ranges are carved out of a block.
+enum class AllocationStrategy
+{
+    LINEAR, // bump pointer, memory is only reclaimed once every allocation in the block is freed
+    BUDDY,  // power of two splitting, fast and predictable, but rounds every allocation up
+    TLSF,   // two-level segregated fit, good fit in constant time, coalesces neighbours on free
+};
+
+struct Range
+{
+    uint64_t offset    = 0;
+    uint64_t size      = 0; // bytes taken from the block, including alignment and rounding
+    uint64_t requested = 0; // bytes asked for
+};
+
+// Manages offsets within a single block of fixed capacity. It never touches memory.
+class RangeAllocator
+{
+public:
+    virtual ~RangeAllocator() = default;
+
+    // Returns false when no free range is large enough.
+    virtual auto allocate(uint64_t size, uint64_t alignment, Range& range) -> bool = 0;
+    virtual void free(const Range& range)                                          = 0;
+    virtual void reset()                                                           = 0;
+
+    virtual auto free_bytes() const -> uint64_t   = 0;
+    virtual auto largest_free() const -> uint64_t = 0;
+    virtual auto allocation_count() const -> uint = 0;
+
+    static auto create(AllocationStrategy strategy, uint64_t capacity) -> std::unique_ptr<RangeAllocator>;
+};
+
+struct SubAllocatorDescriptor
+{
+    AllocationStrategy strategy            = AllocationStrategy::TLSF;
+    uint64_t           block_size          = 16ull << 20;
+    uint64_t           dedicated_threshold = 4ull << 20; // larger requests get a block of their own
+};
+
+struct SubAllocation
+{
+    static constexpr uint INVALID = ~0u;
+
+    uint  block = INVALID;
+    Range range;
+    bool  dedicated = false;
+
+    auto valid() const -> bool { return block != INVALID; }
+};
+
+struct SubAllocatorStats
+{
+    uint     block_count      = 0; // shared blocks, each one backing allocation
+    uint     dedicated_count  = 0; // blocks holding exactly one large allocation
+    uint     allocation_count = 0;
+    uint64_t reserved_bytes   = 0; // sum of all block sizes
+    uint64_t allocated_bytes  = 0; // sum of requested sizes
+    uint64_t wasted_bytes     = 0; // alignment and rounding inside allocations
+    uint64_t free_bytes       = 0; // free space left in shared blocks
+    uint64_t fragmented_bytes = 0; // free space outside of the largest free range of each block
+    uint64_t largest_free     = 0; // largest allocation that still fits without a new block
+    uint64_t peak_reserved    = 0;
+
+    // 0 when the free space of every block is one contiguous range, approaching 1 as it gets split into small pieces
+    auto fragmentation() const -> double
+    {
+        return free_bytes == 0 ? 0.0 : double(fragmented_bytes) / double(free_bytes);
+    }
+};
+
+// Sub-allocates ranges out of large blocks, with one RangeAllocator per block.
+// Blocks are only identified by index; the owner creates the actual memory in on_block_created,
+// and releases it in on_block_released. Allocations above the dedicated threshold get their own block.
+class SubAllocator
+{
+public:
+    using BlockCreated  = std::function<void(uint block, uint64_t size)>;
+    using BlockReleased = std::function<void(uint block)>;
+
+    explicit SubAllocator(const SubAllocatorDescriptor& descriptor);
+
+    auto allocate(uint64_t size, uint64_t alignment) -> SubAllocation;
+    void free(const SubAllocation& allocation);
+
+    // Release every allocation at once, typically used for per-frame linear pools.
+    void reset();
+
+    auto stats() const -> SubAllocatorStats;
+
+    auto descriptor() const -> const SubAllocatorDescriptor& { return desc; }
+
+public:
+    BlockCreated  on_block_created;
+    BlockReleased on_block_released;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<RangeAllocator> ranges; // null for dedicated blocks and unused slots
+        uint64_t                        size = 0;
+        bool                            used = false;
+    };
+
+    auto create_block(uint64_t size, bool is_dedicated) -> uint;
+    void release_block(uint index);
+
+private:
+    SubAllocatorDescriptor desc;
+    std::vector<Block>     blocks;
+    std::vector<uint>      unused;
+    uint64_t               allocated     = 0;
+    uint64_t               wasted        = 0;
+    uint64_t               reserved      = 0;
+    uint64_t               peak_reserved = 0;
+    uint                   dedicated     = 0;
+    uint                   live          = 0;
+    uint                   last_block    = 0; // block that served the last allocation, tried first
+};
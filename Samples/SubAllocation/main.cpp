@@ -0,0 +1,474 @@
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string_view>
+#include <vector>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+#include "BufferPool.h"
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+// NOTE: must match the layout in shader.slang
+struct ObjectUniform
+{
+    glm::vec2 offset;
+    float     scale;
+    float     angle;
+    glm::vec4 color;
+};
+
+// A small polygon, with its own vertex and index range in the geometry pool.
+struct Object
+{
+    BufferAllocation vertices;
+    BufferAllocation indices;
+    uint             index_count = 0;
+    glm::vec2        offset;
+    float            scale = 0.0f;
+    float            speed = 0.0f;
+    glm::vec4        color;
+};
+
+// Geometry freed during a frame, kept alive until the GPU is done with it.
+struct RetiredAllocation
+{
+    BufferAllocation allocation;
+    uint64_t         frame = 0;
+};
+
+// Bind groups over the blocks of one uniform pool, created when a block is first used.
+struct UniformPool
+{
+    std::unique_ptr<BufferPool>  pool;
+    std::map<uint, GPUBindGroup> bind_groups;
+};
+
+constexpr uint     OBJECT_GRID       = 64;
+constexpr uint     OBJECT_COUNT      = OBJECT_GRID * OBJECT_GRID;
+constexpr uint     FRAMES_INFLIGHT   = 3;
+constexpr uint     FRAMES_PER_TOGGLE = 240;
+constexpr uint     CHURN_PER_FRAME   = 32;  // objects whose geometry is replaced every frame
+constexpr uint64_t UNIFORM_ALIGNMENT = 256; // NOTE: minimum dynamic uniform buffer offset alignment
+constexpr auto     MEMORY_DUMP_PATH  = "suballocation_memory.json";
+
+GPUShaderModule               vshader;
+GPUShaderModule               fshader;
+GPUBindGroupLayout            blayout;
+GPUPipelineLayout             playout;
+GPURenderPipeline             pipeline;
+std::unique_ptr<BufferPool>   geometry;
+UniformPool                   uniforms[FRAMES_INFLIGHT];
+std::vector<Object>           objects;
+std::deque<RetiredAllocation> retired;
+MemoryTracker                 memory;
+std::mt19937                  rng(42);
+float                         elapsed     = 0.0f;
+uint64_t                      frame_index = 0;
+
+auto read_shader_source() -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open("shader.slang");
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    return program;
+}
+
+void setup_pipeline()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = "test";
+        desc.path   = "test.slang";
+        desc.source = read_shader_source();
+        return compiler->compile(desc);
+    });
+
+    vshader = execute([&]() {
+        auto code  = module->get_shader_blob("vsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "vertex_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+
+    fshader = execute([&]() {
+        auto code  = module->get_shader_blob("fsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "fragment_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+
+    blayout = execute([&]() {
+        auto entry                      = GPUBindGroupLayoutEntry{};
+        entry.type                      = GPUBindingResourceType::BUFFER;
+        entry.binding                   = 0;
+        entry.count                     = 1;
+        entry.visibility                = GPUShaderStage::VERTEX;
+        entry.buffer.type               = GPUBufferBindingType::UNIFORM;
+        entry.buffer.has_dynamic_offset = true;
+
+        auto desc = GPUBindGroupLayoutDescriptor{};
+        desc.entries.push_back(entry);
+        return device.create_bind_group_layout(desc);
+    });
+
+    playout = execute([&]() {
+        auto desc               = GPUPipelineLayoutDescriptor{};
+        desc.bind_group_layouts = {blayout};
+        return device.create_pipeline_layout(desc);
+    });
+
+    pipeline = execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x2;
+        position.offset          = 0;
+        position.shader_location = 0;
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = {position};
+        layout.array_stride = sizeof(glm::vec2);
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto target         = GPUColorTargetState{};
+        target.format       = surface.get_current_format();
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::ALWAYS;
+        desc.depth_stencil.depth_write_enabled     = false;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vshader;
+        desc.fragment.module                       = fshader;
+        desc.vertex.buffers.push_back(layout);
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+}
+
+// Polygon with a random number of sides, as a triangle fan around its center.
+// Every object asks for a different amount of memory, which is what makes the pool fragment over time.
+void create_geometry(Object& object)
+{
+    auto sides = std::uniform_int_distribution<uint>(3, 48)(rng);
+
+    object.vertices    = geometry->allocate(sizeof(glm::vec2) * (sides + 1));
+    object.indices     = geometry->allocate(sizeof(uint32_t) * sides * 3);
+    object.index_count = sides * 3;
+
+    auto vertices = std::vector<glm::vec2>(sides + 1);
+    auto indices  = std::vector<uint32_t>(sides * 3);
+
+    vertices[0] = glm::vec2(0.0f, 0.0f);
+    for (uint i = 0; i < sides; i++) {
+        auto angle         = 6.2831853f * float(i) / float(sides);
+        vertices[i + 1]    = glm::vec2(std::cos(angle), std::sin(angle));
+        indices[i * 3 + 0] = 0;
+        indices[i * 3 + 1] = i + 1;
+        indices[i * 3 + 2] = (i + 1) % sides + 1;
+    }
+
+    geometry->write(object.vertices, vertices.data(), object.vertices.size);
+    geometry->write(object.indices, indices.data(), object.indices.size);
+}
+
+void retire_geometry(Object& object)
+{
+    retired.push_back(RetiredAllocation{object.vertices, frame_index});
+    retired.push_back(RetiredAllocation{object.indices, frame_index});
+}
+
+void setup_pools()
+{
+    // geometry lives for many frames and is freed in any order
+    auto geometry_desc       = SubAllocatorDescriptor{};
+    geometry_desc.strategy   = AllocationStrategy::TLSF;
+    geometry_desc.block_size = 4ull << 20;
+    geometry                 = std::make_unique<BufferPool>("geometry_pool", GPUBufferUsage::VERTEX | GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE, geometry_desc, &memory);
+
+    // uniforms are written every frame and thrown away as a whole, one pool per frame in flight
+    auto uniform_desc       = SubAllocatorDescriptor{};
+    uniform_desc.strategy   = AllocationStrategy::LINEAR;
+    uniform_desc.block_size = 1ull << 20;
+    for (auto& uniform : uniforms)
+        uniform.pool = std::make_unique<BufferPool>("uniform_pool", GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE, uniform_desc, &memory);
+
+    auto unit = std::uniform_real_distribution<float>(0.0f, 1.0f);
+
+    objects.resize(OBJECT_COUNT);
+    for (uint i = 0; i < OBJECT_COUNT; i++) {
+        auto& object  = objects[i];
+        auto  cell    = glm::vec2(float(i % OBJECT_GRID), float(i / OBJECT_GRID));
+        object.offset = (cell + 0.5f) / float(OBJECT_GRID) * 2.0f - 1.0f;
+        object.scale  = 0.6f / float(OBJECT_GRID);
+        object.speed  = unit(rng) * 4.0f - 2.0f;
+        object.color  = glm::vec4(unit(rng), unit(rng), unit(rng), 1.0f);
+        create_geometry(object);
+    }
+}
+
+void dump_memory()
+{
+    if (memory.dump(MEMORY_DUMP_PATH))
+        std::cout << "Memory usage written to " << MEMORY_DUMP_PATH << std::endl;
+    else
+        std::cerr << "Failed to write " << MEMORY_DUMP_PATH << std::endl;
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    // NOTE: dumped before anything is destroyed, so that the file shows what was resident at the end
+    dump_memory();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    retired.clear();
+    objects.clear();
+    geometry.reset();
+    for (auto& uniform : uniforms) {
+        uniform.bind_groups.clear();
+        uniform.pool.reset();
+    }
+    vshader.destroy();
+    fshader.destroy();
+    blayout.destroy();
+    playout.destroy();
+    pipeline.destroy();
+}
+
+void update(const WindowInput& input)
+{
+    static bool dump_requested = false;
+
+    elapsed += input.delta_time;
+
+    // F1 writes the current memory usage, once per key press
+    auto dump_pressed = input.is_key_down(KeyButton::F1);
+    if (dump_pressed && !dump_requested)
+        dump_memory();
+    dump_requested = dump_pressed;
+
+    // replace the geometry of a few objects every frame, to keep allocating and freeing
+    auto pick = std::uniform_int_distribution<uint>(0, OBJECT_COUNT - 1);
+    for (uint i = 0; i < CHURN_PER_FRAME; i++) {
+        auto& object = objects[pick(rng)];
+        retire_geometry(object);
+        create_geometry(object);
+    }
+
+    // the GPU is at most FRAMES_INFLIGHT frames behind, older geometry can go back to the pool
+    while (!retired.empty() && retired.front().frame + FRAMES_INFLIGHT <= frame_index) {
+        geometry->free(retired.front().allocation);
+        retired.pop_front();
+    }
+}
+
+auto get_bind_group(UniformPool& uniform, const BufferAllocation& allocation) -> const GPUBindGroup&
+{
+    auto& device = RHI::get_current_device();
+
+    auto it = uniform.bind_groups.find(allocation.handle.block);
+    if (it != uniform.bind_groups.end())
+        return it->second;
+
+    auto bind_group = execute([&]() {
+        auto entry          = GPUBindGroupEntry{};
+        entry.type          = GPUBindingResourceType::BUFFER;
+        entry.binding       = 0;
+        entry.index         = 0;
+        entry.buffer.buffer = allocation.buffer;
+        entry.buffer.offset = 0;
+        entry.buffer.size   = sizeof(ObjectUniform);
+
+        auto desc   = GPUBindGroupDescriptor{};
+        desc.layout = blayout;
+        desc.entries.push_back(entry);
+        return device.create_bind_group(desc);
+    });
+    return uniform.bind_groups.emplace(allocation.handle.block, bind_group).first->second;
+}
+
+void print_pool(const char* label, const SubAllocatorStats& stats)
+{
+    auto mb = [](uint64_t bytes) { return double(bytes) / (1024.0 * 1024.0); };
+
+    std::cout << "    " << label
+              << ": allocations " << stats.allocation_count
+              << ", buffers " << stats.block_count + stats.dedicated_count
+              << ", reserved " << mb(stats.reserved_bytes) << " MB"
+              << ", allocated " << mb(stats.allocated_bytes) << " MB"
+              << ", wasted " << mb(stats.wasted_bytes) << " MB"
+              << ", fragmentation " << stats.fragmentation() * 100.0 << "%" << std::endl;
+}
+
+void report()
+{
+    if ((frame_index + 1) % FRAMES_PER_TOGGLE != 0)
+        return;
+
+    auto geometry_stats = geometry->stats();
+    auto uniform_stats  = uniforms[frame_index % FRAMES_INFLIGHT].pool->stats();
+
+    // without sub-allocation, every vertex, index and uniform range would be a buffer of its own
+    auto buffers    = geometry_stats.block_count + geometry_stats.dedicated_count;
+    auto standalone = geometry_stats.allocation_count + uniform_stats.allocation_count * FRAMES_INFLIGHT;
+    for (auto& uniform : uniforms)
+        buffers += uniform.pool->stats().block_count;
+
+    auto total = memory.total();
+    auto mb    = [](uint64_t bytes) { return double(bytes) / (1024.0 * 1024.0); };
+
+    std::cout << "Frame " << frame_index + 1 << ": " << buffers << " GPU buffers instead of " << standalone
+              << ", resident " << mb(total.bytes) << " MB (peak " << mb(total.peak_bytes) << " MB)" << std::endl;
+    print_pool("geometry", geometry_stats);
+    print_pool("uniform ", uniform_stats);
+}
+
+void render()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    // the uniform pool of this frame was last used FRAMES_INFLIGHT frames ago, it can be reset as a whole
+    auto& uniform = uniforms[frame_index % FRAMES_INFLIGHT];
+    uniform.pool->reset();
+
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = texture.view;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = {color_attachment};
+    render_pass.depth_stencil_attachment = {};
+
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(pipeline);
+
+    for (auto& object : objects) {
+        auto data   = ObjectUniform{};
+        data.offset = object.offset;
+        data.scale  = object.scale;
+        data.angle  = object.speed * elapsed;
+        data.color  = object.color;
+
+        auto allocation = uniform.pool->allocate(sizeof(ObjectUniform), UNIFORM_ALIGNMENT);
+        uniform.pool->write(allocation, &data, sizeof(ObjectUniform));
+
+        // NOTE: consecutive objects mostly share the same buffers, only the offsets change
+        command.set_bind_group(0, get_bind_group(uniform, allocation), {static_cast<uint32_t>(allocation.offset)});
+        command.set_vertex_buffer(0, object.vertices.buffer, object.vertices.offset, object.vertices.size);
+        command.set_index_buffer(object.indices.buffer, GPUIndexFormat::UINT32, object.indices.offset, object.indices.size);
+        command.draw_indexed(object.index_count, 1, 0, 0, 0);
+    }
+
+    command.end_render_pass();
+    command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    // present this frame to swapchain
+    texture.present();
+
+    report();
+    frame_index++;
+}
+
+int main()
+{
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Fifo;
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipeline);
+    win->bind<WindowEvent::START>(setup_pools);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
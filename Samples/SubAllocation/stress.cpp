@@ -0,0 +1,223 @@
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "SubAllocator.h"
+
+// Stress test for the sub-allocator, creating and destroying 100k buffers worth of allocations.
+// It only exercises the offset management, blocks are never backed by GPU memory, so it runs without a device.
+
+constexpr uint ALLOCATION_COUNT = 100000;
+
+struct Request
+{
+    uint64_t size;
+    uint64_t alignment;
+    bool     free_one; // free a random live allocation after this one
+};
+
+// sizes follow what the samples create: many tiny index/uniform buffers, some vertex buffers, a few large ones
+auto generate_requests(uint seed) -> std::vector<Request>
+{
+    auto rng      = std::mt19937(seed);
+    auto uniform  = std::uniform_real_distribution<double>(0.0, 1.0);
+    auto requests = std::vector<Request>{};
+    requests.reserve(ALLOCATION_COUNT);
+
+    for (uint i = 0; i < ALLOCATION_COUNT; i++) {
+        auto pick    = uniform(rng);
+        auto request = Request{};
+        if (pick < 0.6) {
+            request.size      = 12 + uint64_t(uniform(rng) * 244); // index buffers, uniform buffers
+            request.alignment = uniform(rng) < 0.5 ? 256 : 16;
+        } else if (pick < 0.95) {
+            request.size      = 256 + uint64_t(uniform(rng) * 16 * 1024); // vertex buffers
+            request.alignment = 16;
+        } else if (pick < 0.999) {
+            request.size      = 16 * 1024 + uint64_t(uniform(rng) * 1024 * 1024); // meshes
+            request.alignment = 256;
+        } else {
+            request.size      = 8ull << 20; // above the dedicated threshold
+            request.alignment = 256;
+        }
+        request.free_one = uniform(rng) < 0.5;
+        requests.push_back(request);
+    }
+    return requests;
+}
+
+auto strategy_name(AllocationStrategy strategy) -> const char*
+{
+    switch (strategy) {
+        case AllocationStrategy::LINEAR:
+            return "LINEAR";
+        case AllocationStrategy::BUDDY:
+            return "BUDDY ";
+        case AllocationStrategy::TLSF:
+            return "TLSF  ";
+    }
+    return "";
+}
+
+// checks that no two live allocations overlap, and that every allocation is aligned
+bool validate(AllocationStrategy strategy, const std::vector<Request>& requests)
+{
+    auto desc     = SubAllocatorDescriptor{};
+    desc.strategy = strategy;
+
+    auto allocator = SubAllocator(desc);
+    auto live      = std::vector<SubAllocation>{};
+    auto ranges    = std::map<std::pair<uint, uint64_t>, uint64_t>{}; // (block, offset) -> end
+    auto rng       = std::mt19937(7);
+
+    auto overlaps = [&](const SubAllocation& allocation) {
+        auto key  = std::make_pair(allocation.block, allocation.range.offset);
+        auto next = ranges.lower_bound(key);
+        if (next != ranges.end() && next->first.first == allocation.block && next->first.second < allocation.range.offset + allocation.range.requested)
+            return true;
+        if (next != ranges.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first.first == allocation.block && prev->second > allocation.range.offset)
+                return true;
+        }
+        return false;
+    };
+
+    for (auto& request : requests) {
+        auto allocation = allocator.allocate(request.size, request.alignment);
+        if (!allocation.valid() || allocation.range.offset % request.alignment != 0 || overlaps(allocation)) {
+            std::cerr << strategy_name(strategy) << ": invalid allocation of " << request.size << " bytes" << std::endl;
+            return false;
+        }
+        ranges[{allocation.block, allocation.range.offset}] = allocation.range.offset + allocation.range.requested;
+        live.push_back(allocation);
+
+        if (request.free_one && strategy != AllocationStrategy::LINEAR) {
+            auto index = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+            ranges.erase({live[index].block, live[index].range.offset});
+            allocator.free(live[index]);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    for (auto& allocation : live)
+        allocator.free(allocation);
+
+    auto stats = allocator.stats();
+    if (stats.allocation_count != 0 || stats.allocated_bytes != 0 || stats.wasted_bytes != 0) {
+        std::cerr << strategy_name(strategy) << ": allocations leaked after freeing everything" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void print_stats(const char* label, const SubAllocatorStats& stats)
+{
+    auto mb = [](uint64_t bytes) { return double(bytes) / (1024.0 * 1024.0); };
+
+    std::cout << "    " << label
+              << ": allocations " << stats.allocation_count
+              << ", blocks " << stats.block_count << " (+" << stats.dedicated_count << " dedicated)"
+              << ", reserved " << mb(stats.reserved_bytes) << " MB"
+              << ", allocated " << mb(stats.allocated_bytes) << " MB"
+              << ", wasted " << mb(stats.wasted_bytes) << " MB"
+              << ", fragmentation " << stats.fragmentation() * 100.0 << "%" << std::endl;
+}
+
+// random allocations and frees, half of all allocations are freed along the way, the rest at the end
+void run_general(AllocationStrategy strategy, const std::vector<Request>& requests)
+{
+    using Clock = std::chrono::steady_clock;
+
+    auto desc     = SubAllocatorDescriptor{};
+    desc.strategy = strategy;
+
+    auto allocator = SubAllocator(desc);
+    auto live      = std::vector<SubAllocation>{};
+    auto rng       = std::mt19937(7);
+    auto created   = uint(0);
+    auto peak      = SubAllocatorStats{};
+
+    allocator.on_block_created = [&](uint, uint64_t) { created++; };
+    live.reserve(requests.size());
+
+    auto start = Clock::now();
+    for (auto& request : requests) {
+        live.push_back(allocator.allocate(request.size, request.alignment));
+
+        if (request.free_one) {
+            auto index = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+            allocator.free(live[index]);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+    peak = allocator.stats();
+
+    for (auto& allocation : live)
+        allocator.free(allocation);
+    auto end = Clock::now();
+
+    auto operations = double(requests.size() * 2);
+    auto ns         = std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::cout << strategy_name(strategy) << ": " << ns / operations << " ns/op"
+              << ", " << created << " blocks created for " << requests.size() << " buffers" << std::endl;
+    print_stats("live  ", peak);
+    print_stats("freed ", allocator.stats());
+}
+
+// linear pools are meant for transient data, which is allocated during a frame and released all at once
+void run_linear(const std::vector<Request>& requests)
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint PER_FRAME = 100;
+
+    auto desc     = SubAllocatorDescriptor{};
+    desc.strategy = AllocationStrategy::LINEAR;
+
+    auto allocator = SubAllocator(desc);
+    auto created   = uint(0);
+    auto peak      = SubAllocatorStats{};
+
+    allocator.on_block_created = [&](uint, uint64_t) { created++; };
+
+    auto start = Clock::now();
+    for (uint i = 0; i < requests.size(); i++) {
+        allocator.allocate(requests[i].size, requests[i].alignment);
+        if ((i + 1) % PER_FRAME == 0) {
+            if (allocator.stats().reserved_bytes > peak.reserved_bytes)
+                peak = allocator.stats();
+            allocator.reset();
+        }
+    }
+    auto end = Clock::now();
+
+    auto ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::cout << strategy_name(AllocationStrategy::LINEAR) << ": " << ns / requests.size() << " ns/op"
+              << ", " << created << " blocks created for " << requests.size() << " buffers"
+              << " (" << PER_FRAME << " per frame, reset every frame)" << std::endl;
+    print_stats("peak  ", peak);
+}
+
+int main()
+{
+    auto requests   = generate_requests(42);
+    auto strategies = {AllocationStrategy::LINEAR, AllocationStrategy::BUDDY, AllocationStrategy::TLSF};
+
+    for (auto strategy : strategies) {
+        if (!validate(strategy, requests))
+            return 1;
+    }
+    std::cout << "Validated " << requests.size() << " allocations per strategy" << std::endl;
+
+    run_linear(requests);
+    run_general(AllocationStrategy::BUDDY, requests);
+    run_general(AllocationStrategy::TLSF, requests);
+    return 0;
+}
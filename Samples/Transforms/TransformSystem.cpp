@@ -0,0 +1,393 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRANSFORM_KERNEL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORM_KERNEL_SSE2
+#endif
+
+#include "TransformSystem.h"
+
+namespace
+{
+    // NOTE: Every lane type provides the same minimal set of operations, so that the kernels below
+    // are written once and instantiated for the widest instruction set available at compile time.
+    struct ScalarLanes
+    {
+        using V = float;
+
+        static constexpr uint WIDTH = 1;
+
+        static auto load(const float* p) -> V { return *p; }
+        static void store(float* p, V v) { *p = v; }
+        static auto set1(float f) -> V { return f; }
+        static auto add(V a, V b) -> V { return a + b; }
+        static auto sub(V a, V b) -> V { return a - b; }
+        static auto mul(V a, V b) -> V { return a * b; }
+        static auto fmadd(V a, V b, V c) -> V { return a * b + c; }
+        static auto rsqrt(V a) -> V { return 1.0f / std::sqrt(a); }
+
+        // write world and mvp of WIDTH consecutive objects
+        static void store_instances(InstanceTransform* out, const V (&world)[4][4], const V (&mvp)[4][4])
+        {
+            for (uint c = 0; c < 4; c++) {
+                for (uint r = 0; r < 4; r++) {
+                    out->world[c][r] = world[c][r];
+                    out->mvp[c][r]   = mvp[c][r];
+                }
+            }
+        }
+
+        static void fence() {}
+    };
+
+#if defined(TRANSFORM_KERNEL_SSE2) || defined(TRANSFORM_KERNEL_AVX2)
+    // Write world and mvp of 4 consecutive objects, given one register per matrix element with one object per lane.
+    inline void stream_instances(InstanceTransform* out, const __m128 (&world)[4][4], const __m128 (&mvp)[4][4])
+    {
+        // columns[k][i] is column k of object i, where columns 0-3 belong to world and 4-7 to mvp
+        __m128 columns[8][4];
+        for (uint c = 0; c < 4; c++) {
+            columns[c + 0][0] = world[c][0];
+            columns[c + 0][1] = world[c][1];
+            columns[c + 0][2] = world[c][2];
+            columns[c + 0][3] = world[c][3];
+            _MM_TRANSPOSE4_PS(columns[c + 0][0], columns[c + 0][1], columns[c + 0][2], columns[c + 0][3]);
+
+            columns[c + 4][0] = mvp[c][0];
+            columns[c + 4][1] = mvp[c][1];
+            columns[c + 4][2] = mvp[c][2];
+            columns[c + 4][3] = mvp[c][3];
+            _MM_TRANSPOSE4_PS(columns[c + 4][0], columns[c + 4][1], columns[c + 4][2], columns[c + 4][3]);
+        }
+
+        // NOTE: Mapped GPU memory is usually write-combined, so streaming stores avoid reading it into cache.
+        // Every object is written front to back, so that write-combining buffers are flushed as full cache lines.
+        for (uint i = 0; i < 4; i++) {
+            auto dst = reinterpret_cast<float*>(out + i);
+            for (uint k = 0; k < 8; k++)
+                _mm_stream_ps(dst + k * 4, columns[k][i]);
+        }
+    }
+#endif
+
+#if defined(TRANSFORM_KERNEL_SSE2)
+    struct SSELanes
+    {
+        using V = __m128;
+
+        static constexpr uint WIDTH = 4;
+
+        static auto load(const float* p) -> V { return _mm_loadu_ps(p); }
+        static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+        static auto set1(float f) -> V { return _mm_set1_ps(f); }
+        static auto add(V a, V b) -> V { return _mm_add_ps(a, b); }
+        static auto sub(V a, V b) -> V { return _mm_sub_ps(a, b); }
+        static auto mul(V a, V b) -> V { return _mm_mul_ps(a, b); }
+        static auto fmadd(V a, V b, V c) -> V { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static auto rsqrt(V a) -> V { return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(a)); }
+
+        static void store_instances(InstanceTransform* out, const V (&world)[4][4], const V (&mvp)[4][4])
+        {
+            stream_instances(out, world, mvp);
+        }
+
+        static void fence() { _mm_sfence(); }
+    };
+
+    using WideLanes = SSELanes;
+#elif defined(TRANSFORM_KERNEL_AVX2)
+    struct AVXLanes
+    {
+        using V = __m256;
+
+        static constexpr uint WIDTH = 8;
+
+        static auto load(const float* p) -> V { return _mm256_loadu_ps(p); }
+        static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+        static auto set1(float f) -> V { return _mm256_set1_ps(f); }
+        static auto add(V a, V b) -> V { return _mm256_add_ps(a, b); }
+        static auto sub(V a, V b) -> V { return _mm256_sub_ps(a, b); }
+        static auto mul(V a, V b) -> V { return _mm256_mul_ps(a, b); }
+        static auto fmadd(V a, V b, V c) -> V { return _mm256_fmadd_ps(a, b, c); }
+        static auto rsqrt(V a) -> V { return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(a)); }
+
+        static void store_instances(InstanceTransform* out, const V (&world)[4][4], const V (&mvp)[4][4])
+        {
+            __m128 lower_world[4][4], lower_mvp[4][4];
+            __m128 upper_world[4][4], upper_mvp[4][4];
+            for (uint c = 0; c < 4; c++) {
+                for (uint r = 0; r < 4; r++) {
+                    lower_world[c][r] = _mm256_castps256_ps128(world[c][r]);
+                    upper_world[c][r] = _mm256_extractf128_ps(world[c][r], 1);
+                    lower_mvp[c][r]   = _mm256_castps256_ps128(mvp[c][r]);
+                    upper_mvp[c][r]   = _mm256_extractf128_ps(mvp[c][r], 1);
+                }
+            }
+            stream_instances(out + 0, lower_world, lower_mvp);
+            stream_instances(out + 4, upper_world, upper_mvp);
+        }
+
+        static void fence() { _mm_sfence(); }
+    };
+
+    using WideLanes = AVXLanes;
+#else
+    using WideLanes = ScalarLanes;
+#endif
+
+    struct TransformStreams
+    {
+        const float* px;
+        const float* py;
+        const float* pz;
+        const float* qx;
+        const float* qy;
+        const float* qz;
+        const float* qw;
+        const float* sx;
+        const float* sy;
+        const float* sz;
+    };
+
+    struct RotationStreams
+    {
+        float*       qx;
+        float*       qy;
+        float*       qz;
+        float*       qw;
+        const float* speed;
+    };
+
+    template <typename L>
+    void compute_transforms(const TransformStreams& s, const glm::mat4& view_proj, InstanceTransform* output, uint begin, uint end)
+    {
+        using V = typename L::V;
+
+        // broadcast view projection once
+        V vp[4][4];
+        for (uint c = 0; c < 4; c++)
+            for (uint r = 0; r < 4; r++)
+                vp[c][r] = L::set1(view_proj[c][r]);
+
+        const V zero = L::set1(0.0f);
+        const V one  = L::set1(1.0f);
+        const V two  = L::set1(2.0f);
+
+        for (uint i = begin; i + L::WIDTH <= end; i += L::WIDTH) {
+            V x = L::load(s.qx + i);
+            V y = L::load(s.qy + i);
+            V z = L::load(s.qz + i);
+            V w = L::load(s.qw + i);
+
+            V xx = L::mul(x, x), yy = L::mul(y, y), zz = L::mul(z, z);
+            V xy = L::mul(x, y), xz = L::mul(x, z), yz = L::mul(y, z);
+            V wx = L::mul(w, x), wy = L::mul(w, y), wz = L::mul(w, z);
+
+            V scale_x = L::load(s.sx + i);
+            V scale_y = L::load(s.sy + i);
+            V scale_z = L::load(s.sz + i);
+
+            // world = translate * rotate * scale, same as glm::mat3_cast for the rotation part
+            V world[4][4];
+            world[0][0] = L::mul(L::sub(one, L::mul(two, L::add(yy, zz))), scale_x);
+            world[0][1] = L::mul(L::mul(two, L::add(xy, wz)), scale_x);
+            world[0][2] = L::mul(L::mul(two, L::sub(xz, wy)), scale_x);
+            world[0][3] = zero;
+            world[1][0] = L::mul(L::mul(two, L::sub(xy, wz)), scale_y);
+            world[1][1] = L::mul(L::sub(one, L::mul(two, L::add(xx, zz))), scale_y);
+            world[1][2] = L::mul(L::mul(two, L::add(yz, wx)), scale_y);
+            world[1][3] = zero;
+            world[2][0] = L::mul(L::mul(two, L::add(xz, wy)), scale_z);
+            world[2][1] = L::mul(L::mul(two, L::sub(yz, wx)), scale_z);
+            world[2][2] = L::mul(L::sub(one, L::mul(two, L::add(xx, yy))), scale_z);
+            world[2][3] = zero;
+            world[3][0] = L::load(s.px + i);
+            world[3][1] = L::load(s.py + i);
+            world[3][2] = L::load(s.pz + i);
+            world[3][3] = one;
+
+            // mvp[c] = view_proj * world[c], the last row of world is known to be (0, 0, 0, 1)
+            V mvp[4][4];
+            for (uint c = 0; c < 4; c++) {
+                for (uint r = 0; r < 4; r++) {
+                    V sum     = L::mul(vp[0][r], world[c][0]);
+                    sum       = L::fmadd(vp[1][r], world[c][1], sum);
+                    sum       = L::fmadd(vp[2][r], world[c][2], sum);
+                    mvp[c][r] = c == 3 ? L::add(vp[3][r], sum) : sum;
+                }
+            }
+
+            L::store_instances(output + i, world, mvp);
+        }
+    }
+
+    template <typename L>
+    void integrate_rotations(const RotationStreams& s, float delta_time, uint begin, uint end)
+    {
+        using V = typename L::V;
+
+        const V half_dt = L::set1(0.5f * delta_time);
+
+        for (uint i = begin; i + L::WIDTH <= end; i += L::WIDTH) {
+            V x = L::load(s.qx + i);
+            V y = L::load(s.qy + i);
+            V z = L::load(s.qz + i);
+            V w = L::load(s.qw + i);
+
+            // q' = q + 0.5 * dt * q * (0, omega, 0, 0), followed by renormalization
+            V h  = L::mul(half_dt, L::load(s.speed + i));
+            V nx = L::sub(x, L::mul(h, z));
+            V ny = L::fmadd(h, w, y);
+            V nz = L::fmadd(h, x, z);
+            V nw = L::sub(w, L::mul(h, y));
+
+            V length2 = L::mul(nx, nx);
+            length2   = L::fmadd(ny, ny, length2);
+            length2   = L::fmadd(nz, nz, length2);
+            length2   = L::fmadd(nw, nw, length2);
+
+            V inv = L::rsqrt(length2);
+            L::store(s.qx + i, L::mul(nx, inv));
+            L::store(s.qy + i, L::mul(ny, inv));
+            L::store(s.qz + i, L::mul(nz, inv));
+            L::store(s.qw + i, L::mul(nw, inv));
+        }
+    }
+
+    // process full SIMD batches with the wide kernel, and the remainder one by one
+    template <template <typename> class Kernel, typename... Args>
+    void dispatch(uint begin, uint end, Args&&... args)
+    {
+        uint tail = end - (end - begin) % WideLanes::WIDTH;
+        Kernel<WideLanes>::run(args..., begin, tail);
+        Kernel<ScalarLanes>::run(args..., tail, end);
+    }
+
+    template <typename L>
+    struct TransformKernel
+    {
+        static void run(const TransformStreams& s, const glm::mat4& view_proj, InstanceTransform* output, uint begin, uint end)
+        {
+            compute_transforms<L>(s, view_proj, output, begin, end);
+        }
+    };
+
+    template <typename L>
+    struct RotationKernel
+    {
+        static void run(const RotationStreams& s, float delta_time, uint begin, uint end)
+        {
+            integrate_rotations<L>(s, delta_time, begin, end);
+        }
+    };
+} // namespace
+
+auto TransformSystem::add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, float spin) -> uint
+{
+    px.push_back(position.x);
+    py.push_back(position.y);
+    pz.push_back(position.z);
+    qx.push_back(rotation.x);
+    qy.push_back(rotation.y);
+    qz.push_back(rotation.z);
+    qw.push_back(rotation.w);
+    sx.push_back(scale.x);
+    sy.push_back(scale.y);
+    sz.push_back(scale.z);
+    spin_speed.push_back(spin);
+    return count++;
+}
+
+void TransformSystem::set_position(uint index, const glm::vec3& position)
+{
+    px.at(index) = position.x;
+    py.at(index) = position.y;
+    pz.at(index) = position.z;
+}
+
+void TransformSystem::set_rotation(uint index, const glm::quat& rotation)
+{
+    qx.at(index) = rotation.x;
+    qy.at(index) = rotation.y;
+    qz.at(index) = rotation.z;
+    qw.at(index) = rotation.w;
+}
+
+void TransformSystem::set_scale(uint index, const glm::vec3& scale)
+{
+    sx.at(index) = scale.x;
+    sy.at(index) = scale.y;
+    sz.at(index) = scale.z;
+}
+
+void TransformSystem::spin(float delta_time, WorkerPool& pool)
+{
+    auto streams  = RotationStreams{};
+    streams.qx    = qx.data();
+    streams.qy    = qy.data();
+    streams.qz    = qz.data();
+    streams.qw    = qw.data();
+    streams.speed = spin_speed.data();
+
+    pool.parallel_for(count, GRAIN, [&](uint begin, uint end) {
+        dispatch<RotationKernel>(begin, end, streams, delta_time);
+    });
+}
+
+void TransformSystem::update(const glm::mat4& view_proj, InstanceTransform* output, WorkerPool& pool) const
+{
+    pool.parallel_for(count, GRAIN, [&](uint begin, uint end) {
+        update(view_proj, output, begin, end);
+    });
+}
+
+void TransformSystem::update(const glm::mat4& view_proj, InstanceTransform* output, uint begin, uint end) const
+{
+    // streaming stores require 16 byte alignment, which mapped buffers always satisfy
+    assert(reinterpret_cast<uintptr_t>(output) % 16 == 0);
+
+    auto streams = TransformStreams{};
+    streams.px   = px.data();
+    streams.py   = py.data();
+    streams.pz   = pz.data();
+    streams.qx   = qx.data();
+    streams.qy   = qy.data();
+    streams.qz   = qz.data();
+    streams.qw   = qw.data();
+    streams.sx   = sx.data();
+    streams.sy   = sy.data();
+    streams.sz   = sz.data();
+
+    dispatch<TransformKernel>(begin, end, streams, view_proj, output);
+
+    // make streaming stores visible before the buffer is submitted
+    WideLanes::fence();
+}
+
+void TransformSystem::update_scalar(const glm::mat4& view_proj, InstanceTransform* output) const
+{
+    for (uint i = 0; i < count; i++) {
+        auto translation = glm::translate(glm::mat4(1.0f), glm::vec3(px[i], py[i], pz[i]));
+        auto rotation    = glm::mat4_cast(glm::quat(qw[i], qx[i], qy[i], qz[i]));
+        auto scale       = glm::scale(glm::mat4(1.0f), glm::vec3(sx[i], sy[i], sz[i]));
+
+        output[i].world = translation * rotation * scale;
+        output[i].mvp   = view_proj * output[i].world;
+    }
+}
+
+auto TransformSystem::kernel_name() -> const char*
+{
+#if defined(TRANSFORM_KERNEL_AVX2)
+    return "AVX2";
+#elif defined(TRANSFORM_KERNEL_SSE2)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+
+#include "WorkerPool.h"
+
+// Per-instance data written by the transform system.
+// NOTE: must match the instance attributes in shader.slang
+struct InstanceTransform
+{
+    glm::mat4 world;
+    glm::mat4 mvp;
+};
+
+// Transforms of many objects, stored as structure of arrays.
+// Every component lives in its own array, so that SIMD kernels can load 4 (SSE) or 8 (AVX) objects at once.
+class TransformSystem
+{
+public:
+    auto add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, float spin = 0.0f) -> uint;
+
+    void set_position(uint index, const glm::vec3& position);
+    void set_rotation(uint index, const glm::quat& rotation);
+    void set_scale(uint index, const glm::vec3& scale);
+
+    // Rotate every object around its local y axis, by a per-object angular velocity.
+    void spin(float delta_time, WorkerPool& pool);
+
+    // Compute world and world-view-projection matrices for every object, and write them to output.
+    // The output is expected to be a mapped instance buffer, so it is written with streaming stores and never read.
+    void update(const glm::mat4& view_proj, InstanceTransform* output, WorkerPool& pool) const;
+
+    // Same as above, but single threaded for a range of objects.
+    void update(const glm::mat4& view_proj, InstanceTransform* output, uint begin, uint end) const;
+
+    // Reference implementation with plain glm, used for validation and benchmarking.
+    void update_scalar(const glm::mat4& view_proj, InstanceTransform* output) const;
+
+    auto size() const -> uint { return count; }
+
+    // Name of the SIMD kernel compiled in, one of "AVX2", "SSE2" or "Scalar".
+    static auto kernel_name() -> const char*;
+
+public:
+    // number of objects handled by one task on the worker pool
+    static constexpr uint GRAIN = 1024;
+
+private:
+    uint count = 0;
+
+    std::vector<float> px, py, pz;
+    std::vector<float> qx, qy, qz, qw;
+    std::vector<float> sx, sy, sz;
+    std::vector<float> spin_speed;
+};
@@ -0,0 +1,79 @@
+#include <algorithm>
+
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(uint workers)
+{
+    for (uint i = 0; i < workers; i++)
+        threads.emplace_back([this]() { worker_loop(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void WorkerPool::parallel_for(uint count, uint grain, const Task& task)
+{
+    if (count == 0) return;
+
+    // not worth waking anyone up
+    if (threads.empty() || count <= grain) {
+        task(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task   = &task;
+        this->count  = count;
+        this->grain  = std::max(grain, 1u);
+        this->next   = 0;
+        this->active = static_cast<uint>(threads.size());
+        this->generation++;
+    }
+    wake.notify_all();
+
+    run_chunks();
+
+    // wait for the workers to drain, so that task is not referenced after returning
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return active == 0; });
+    this->task = nullptr;
+}
+
+void WorkerPool::worker_loop()
+{
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        run_chunks();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--active == 0) done.notify_one();
+    }
+}
+
+void WorkerPool::run_chunks()
+{
+    while (true) {
+        uint begin = next.fetch_add(grain, std::memory_order_relaxed);
+        if (begin >= count) break;
+
+        uint end = std::min(begin + grain, count);
+        (*task)(begin, end);
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Lyra/Common.hpp>
+
+// A minimal fork-join worker pool.
+// The calling thread takes part in the work, so a pool with N workers runs on N + 1 threads.
+class WorkerPool
+{
+public:
+    using Task = std::function<void(uint begin, uint end)>;
+
+    explicit WorkerPool(uint workers = default_worker_count());
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&)            = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Split [0, count) into chunks of grain items, and run task over all of them.
+    // Returns after every chunk has been processed.
+    void parallel_for(uint count, uint grain, const Task& task);
+
+    auto thread_count() const -> uint { return static_cast<uint>(threads.size()) + 1; }
+
+    static auto default_worker_count() -> uint
+    {
+        auto hardware = std::thread::hardware_concurrency();
+        return hardware > 1 ? hardware - 1 : 0;
+    }
+
+private:
+    void worker_loop();
+    void run_chunks();
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex               mutex;
+    std::condition_variable  wake;
+    std::condition_variable  done;
+    const Task*              task       = nullptr;
+    uint                     count      = 0;
+    uint                     grain      = 0;
+    uint64_t                 generation = 0;
+    uint                     active     = 0;
+    bool                     stopping   = false;
+    std::atomic<uint>        next       = 0;
+};
@@ -0,0 +1,82 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+
+#include "TransformSystem.h"
+#include "WorkerPool.h"
+
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+auto measure(uint iterations, F&& func) -> double
+{
+    // warm up caches and worker threads
+    func();
+
+    auto start = Clock::now();
+    for (uint i = 0; i < iterations; i++)
+        func();
+    auto end = Clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+void report(const char* name, double ms, uint count, double baseline)
+{
+    std::cout << "  " << name << ": "
+              << ms << " ms/frame, "
+              << ms * 1e6 / count << " ns/object, "
+              << baseline / ms << "x" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    uint count      = argc > 1 ? static_cast<uint>(std::atoi(argv[1])) : 65536;
+    uint iterations = argc > 2 ? static_cast<uint>(std::atoi(argv[2])) : 100;
+
+    auto pool       = WorkerPool{};
+    auto transforms = TransformSystem{};
+    for (uint i = 0; i < count; i++) {
+        auto angle    = float(i) * 0.01f;
+        auto position = glm::vec3(float(i % 256), 0.0f, float(i / 256));
+        auto rotation = glm::angleAxis(angle, glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f)));
+        auto scale    = glm::vec3(0.5f + 0.5f * std::sin(angle));
+        transforms.add(position, rotation, scale, 1.0f);
+    }
+
+    auto proj      = glm::perspective(1.05f, 16.0f / 9.0f, 0.1f, 500.0f);
+    auto view      = glm::lookAt(glm::vec3(128.0f, 50.0f, -20.0f), glm::vec3(128.0f, 0.0f, 128.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    auto view_proj = proj * view;
+    auto output    = std::vector<InstanceTransform>(count);
+    auto reference = std::vector<InstanceTransform>(count);
+
+    // validate against glm before measuring anything
+    transforms.update_scalar(view_proj, reference.data());
+    transforms.update(view_proj, output.data(), pool);
+
+    float max_error = 0.0f;
+    for (uint i = 0; i < count; i++)
+        for (uint c = 0; c < 4; c++)
+            for (uint r = 0; r < 4; r++)
+                max_error = std::max(max_error, std::abs(output[i].mvp[c][r] - reference[i].mvp[c][r]));
+
+    std::cout << "Objects: " << count << ", Iterations: " << iterations
+              << ", Kernel: " << TransformSystem::kernel_name()
+              << ", Threads: " << pool.thread_count()
+              << ", Max Error: " << max_error << std::endl;
+
+    auto scalar = measure(iterations, [&]() { transforms.update_scalar(view_proj, output.data()); });
+    auto simd   = measure(iterations, [&]() { transforms.update(view_proj, output.data(), 0, count); });
+    auto pooled = measure(iterations, [&]() { transforms.update(view_proj, output.data(), pool); });
+
+    report("glm scalar loop  ", scalar, count, scalar);
+    report("SIMD (1 thread)  ", simd, count, scalar);
+    report("SIMD (all thread)", pooled, count, scalar);
+
+    return 0;
+}
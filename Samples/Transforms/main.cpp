@@ -0,0 +1,422 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string_view>
+#include <cmrc/cmrc.hpp>
+
+#include <Lyra/Common/GLM.h>
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+#include <Lyra/Window.hpp>
+
+#include "TransformSystem.h"
+#include "WorkerPool.h"
+
+using namespace lyra;
+using namespace lyra::wsi;
+using namespace lyra::rhi;
+
+CMRC_DECLARE(resources);
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+struct FrameTimer
+{
+    double accumulated = 0.0;
+    uint   frames      = 0;
+};
+
+constexpr uint GRID_SIZE       = 256;
+constexpr uint OBJECT_COUNT    = GRID_SIZE * GRID_SIZE;
+constexpr uint FRAMES_INFLIGHT = 3;
+
+GPUShaderModule    vshader;
+GPUShaderModule    fshader;
+GPUPipelineLayout  playout;
+GPURenderPipeline  pipeline;
+GPUBuffer          vbuffer;
+GPUBuffer          ibuffer;
+GPUBuffer          instances[FRAMES_INFLIGHT];
+GPUTexture         dbuffer;
+GPUTextureView     dview;
+TransformSystem    transforms;
+WorkerPool         workers;
+glm::mat4          view_proj;
+uint64_t           frame_index = 0;
+FrameTimer         timer;
+
+auto read_shader_source() -> const char*
+{
+    auto fs      = cmrc::resources::get_filesystem();
+    auto data    = fs.open("shader.slang");
+    auto program = std::string_view(data.begin(), data.end() - data.begin()).data();
+    std::cout << program << std::endl;
+    return program;
+}
+
+void setup_pipeline()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    auto compiler = execute([&]() {
+        auto desc   = CompilerDescriptor{};
+        desc.target = LYRA_RHI_COMPILER;
+        desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+        return Compiler::init(desc);
+    });
+
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = "test";
+        desc.path   = "test.slang";
+        desc.source = read_shader_source();
+        return compiler->compile(desc);
+    });
+
+    vshader = execute([&]() {
+        auto code  = module->get_shader_blob("vsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "vertex_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+
+    fshader = execute([&]() {
+        auto code  = module->get_shader_blob("fsmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "fragment_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+
+    // NOTE: no bind groups at all, every per-object transform comes from the instance buffer
+    playout = execute([&]() {
+        auto desc = GPUPipelineLayoutDescriptor{};
+        return device.create_pipeline_layout(desc);
+    });
+
+    pipeline = execute([&]() {
+        auto position            = GPUVertexAttribute{};
+        position.format          = GPUVertexFormat::FLOAT32x3;
+        position.offset          = offsetof(Vertex, position);
+        position.shader_location = 0;
+
+        auto normal            = GPUVertexAttribute{};
+        normal.format          = GPUVertexFormat::FLOAT32x3;
+        normal.offset          = offsetof(Vertex, normal);
+        normal.shader_location = 1;
+
+        auto vertex_layout         = GPUVertexBufferLayout{};
+        vertex_layout.attributes   = {position, normal};
+        vertex_layout.array_stride = sizeof(Vertex);
+        vertex_layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        // one float4 attribute per matrix column, world in locations 2-5 and mvp in locations 6-9
+        auto instance_layout         = GPUVertexBufferLayout{};
+        instance_layout.array_stride = sizeof(InstanceTransform);
+        instance_layout.step_mode    = GPUVertexStepMode::INSTANCE;
+        for (uint i = 0; i < 8; i++) {
+            auto column            = GPUVertexAttribute{};
+            column.format          = GPUVertexFormat::FLOAT32x4;
+            column.offset          = sizeof(glm::vec4) * i;
+            column.shader_location = 2 + i;
+            instance_layout.attributes.push_back(column);
+        }
+
+        auto target         = GPUColorTargetState{};
+        target.format       = surface.get_current_format();
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = playout;
+        desc.primitive.cull_mode                   = GPUCullMode::BACK;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.format                  = GPUTextureFormat::DEPTH16UNORM;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::LESS;
+        desc.depth_stencil.depth_write_enabled     = true;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vshader;
+        desc.fragment.module                       = fshader;
+        desc.vertex.buffers.push_back(vertex_layout);
+        desc.vertex.buffers.push_back(instance_layout);
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+}
+
+void setup_geometry()
+{
+    auto& device = RHI::get_current_device();
+
+    vbuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "vertex_buffer";
+        desc.size               = sizeof(Vertex) * 24;
+        desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    ibuffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "index_buffer";
+        desc.size               = sizeof(uint32_t) * 36;
+        desc.usage              = GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    // unit cube, 4 vertices per face so that every face has its own normal
+    auto vertices = vbuffer.get_mapped_range<Vertex>();
+    auto indices  = ibuffer.get_mapped_range<uint>();
+    for (uint face = 0; face < 6; face++) {
+        auto axis         = face / 2;
+        auto sign         = (face % 2 == 0) ? 1.0f : -1.0f;
+        auto normal       = glm::vec3(0.0f);
+        auto u            = glm::vec3(0.0f);
+        auto v            = glm::vec3(0.0f);
+        normal[axis]      = sign;
+        u[(axis + 1) % 3] = 0.5f;
+        v[(axis + 2) % 3] = 0.5f * sign;
+
+        auto center               = normal * 0.5f;
+        vertices.at(face * 4 + 0) = {center - u - v, normal};
+        vertices.at(face * 4 + 1) = {center + u - v, normal};
+        vertices.at(face * 4 + 2) = {center + u + v, normal};
+        vertices.at(face * 4 + 3) = {center - u + v, normal};
+
+        indices.at(face * 6 + 0) = face * 4 + 0;
+        indices.at(face * 6 + 1) = face * 4 + 1;
+        indices.at(face * 6 + 2) = face * 4 + 2;
+        indices.at(face * 6 + 3) = face * 4 + 0;
+        indices.at(face * 6 + 4) = face * 4 + 2;
+        indices.at(face * 6 + 5) = face * 4 + 3;
+    }
+}
+
+void setup_instances()
+{
+    auto& device = RHI::get_current_device();
+
+    // one instance buffer per frame in flight, so that the CPU never writes what the GPU is reading
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        instances[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "instance_buffer";
+            desc.size               = sizeof(InstanceTransform) * OBJECT_COUNT;
+            desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+    }
+
+    for (uint z = 0; z < GRID_SIZE; z++) {
+        for (uint x = 0; x < GRID_SIZE; x++) {
+            auto seed     = float(z * GRID_SIZE + x);
+            auto position = glm::vec3(float(x) - GRID_SIZE * 0.5f, 0.0f, float(z) - GRID_SIZE * 0.5f);
+            auto axis     = glm::normalize(glm::vec3(std::sin(seed), 1.0f, std::cos(seed)));
+            auto rotation = glm::angleAxis(seed, axis);
+            auto scale    = glm::vec3(0.6f, 0.3f + 0.3f * std::abs(std::sin(seed * 0.37f)), 0.6f);
+            auto spin     = 0.5f + std::fmod(seed, 7.0f) * 0.25f;
+            transforms.add(position, rotation, scale, spin);
+        }
+    }
+
+    std::cout << "Objects: " << OBJECT_COUNT
+              << ", Kernel: " << TransformSystem::kernel_name()
+              << ", Threads: " << workers.thread_count() << std::endl;
+}
+
+void setup_depth_buffer()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    dbuffer = execute([&]() {
+        auto extent          = surface.get_current_extent();
+        auto desc            = GPUTextureDescriptor{};
+        desc.format          = GPUTextureFormat::DEPTH16UNORM;
+        desc.size.width      = extent.width;
+        desc.size.height     = extent.height;
+        desc.size.depth      = 1;
+        desc.array_layers    = 1;
+        desc.mip_level_count = 1;
+        desc.usage           = GPUTextureUsage::RENDER_ATTACHMENT;
+        desc.label           = "depth_buffer";
+        return device.create_texture(desc);
+    });
+
+    dview = dbuffer.create_view();
+}
+
+void cleanup()
+{
+    auto& device = RHI::get_current_device();
+    device.wait();
+
+    // NOTE: This is optional, because all resources will be automatically collected by device at destruction.
+    for (auto& instance : instances)
+        instance.destroy();
+    dbuffer.destroy();
+    ibuffer.destroy();
+    vbuffer.destroy();
+    vshader.destroy();
+    fshader.destroy();
+    playout.destroy();
+    pipeline.destroy();
+}
+
+void update(const WindowInput& input)
+{
+    static float time = 0.0f;
+    time += input.delta_time;
+
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    auto eye  = glm::vec3(std::sin(time * 0.1f) * 160.0f, 60.0f, std::cos(time * 0.1f) * 160.0f);
+    auto proj = glm::perspective(1.05f, float(extent.width) / float(extent.height), 0.1f, 500.0f);
+    auto view = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    view_proj = proj * view;
+
+    transforms.spin(input.delta_time, workers);
+}
+
+void upload_transforms()
+{
+    auto slot   = frame_index % FRAMES_INFLIGHT;
+    auto output = instances[slot].get_mapped_range<InstanceTransform>();
+
+    auto start = std::chrono::steady_clock::now();
+    transforms.update(view_proj, &output.at(0), workers);
+    auto end = std::chrono::steady_clock::now();
+
+    timer.accumulated += std::chrono::duration<double, std::milli>(end - start).count();
+    if (++timer.frames == 240) {
+        auto ms = timer.accumulated / timer.frames;
+        std::cout << "Transform Update: " << ms << " ms, " << ms * 1e6 / OBJECT_COUNT << " ns/object" << std::endl;
+        timer = FrameTimer{};
+    }
+}
+
+void render()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    // acquire next frame from swapchain
+    auto texture = surface.get_current_texture();
+    if (texture.suboptimal) return;
+
+    // write all transforms of this frame straight into the mapped instance buffer
+    upload_transforms();
+
+    // create command buffer
+    auto command = execute([&]() {
+        auto desc  = GPUCommandBufferDescriptor{};
+        desc.queue = GPUQueueType::DEFAULT;
+        return device.create_command_buffer(desc);
+    });
+
+    auto color_attachment        = GPURenderPassColorAttachment{};
+    color_attachment.clear_value = GPUColor{0.1f, 0.1f, 0.1f, 1.0f};
+    color_attachment.load_op     = GPULoadOp::CLEAR;
+    color_attachment.store_op    = GPUStoreOp::STORE;
+    color_attachment.view        = texture.view;
+
+    auto depth_attachment              = GPURenderPassDepthStencilAttachment{};
+    depth_attachment.view              = dview;
+    depth_attachment.depth_clear_value = 1.0f;
+    depth_attachment.depth_load_op     = GPULoadOp::CLEAR;
+    depth_attachment.depth_store_op    = GPUStoreOp::DISCARD;
+    depth_attachment.depth_read_only   = false;
+
+    auto render_pass                     = GPURenderPassDescriptor{};
+    render_pass.color_attachments        = {color_attachment};
+    render_pass.depth_stencil_attachment = depth_attachment;
+
+    auto extent = surface.get_current_extent();
+    command.wait(texture.available, GPUBarrierSync::PIXEL_SHADING);
+    command.resource_barrier(state_transition(texture.texture, undefined_state(), color_attachment_state()));
+    command.resource_barrier(state_transition(dbuffer, undefined_state(), depth_stencil_attachment_state()));
+    command.begin_render_pass(render_pass);
+    command.set_viewport(0, 0, extent.width, extent.height);
+    command.set_scissor_rect(0, 0, extent.width, extent.height);
+    command.set_pipeline(pipeline);
+    command.set_vertex_buffer(0, vbuffer);
+    command.set_vertex_buffer(1, instances[frame_index % FRAMES_INFLIGHT]);
+    command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
+    command.draw_indexed(36, OBJECT_COUNT, 0, 0, 0);
+    command.end_render_pass();
+    command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
+    command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
+    command.submit();
+
+    // present this frame to swapchain
+    texture.present();
+
+    frame_index++;
+}
+
+int main()
+{
+    auto win = execute([&]() {
+        auto desc   = WindowDescriptor{};
+        desc.title  = "Lyra Engine :: Sample";
+        desc.width  = 1920;
+        desc.height = 1080;
+        return Window::init(desc);
+    });
+
+    auto rhi = execute([&] {
+        auto desc    = RHIDescriptor{};
+        desc.backend = LYRA_RHI_BACKEND;
+        desc.flags   = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+        desc.window  = win->handle;
+        return RHI::init(desc);
+    });
+
+    auto adapter = execute([&]() {
+        auto desc = GPUAdapterDescriptor{};
+        return rhi->request_adapter(desc);
+    });
+
+    auto device = execute([&]() {
+        auto desc  = GPUDeviceDescriptor{};
+        desc.label = "main_device";
+        return adapter.request_device(desc);
+    });
+
+    auto surface = execute([&]() {
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Fifo;
+        desc.frames_inflight = FRAMES_INFLIGHT;
+        return rhi->request_surface(desc);
+    });
+
+    (void)surface; // avoid unused warning
+
+    win->bind<WindowEvent::START>(setup_pipeline);
+    win->bind<WindowEvent::START>(setup_geometry);
+    win->bind<WindowEvent::START>(setup_instances);
+    win->bind<WindowEvent::START>(setup_depth_buffer);
+    win->bind<WindowEvent::CLOSE>(cleanup);
+    win->bind<WindowEvent::UPDATE>(update);
+    win->bind<WindowEvent::RENDER>(render);
+    win->loop();
+
+    return 0;
+}
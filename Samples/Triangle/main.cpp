@@ -19,14 +19,13 @@ struct Vertex
     glm::vec3 color;
 };
 
-GPUShaderModule    vshader;
-GPUShaderModule    fshader;
-GPUBindGroupLayout blayout;
-GPUPipelineLayout  playout;
-GPURenderPipeline  pipeline;
-GPUBuffer          vbuffer;
-GPUBuffer          ibuffer;
-GPUBuffer          ubuffer;
+GPUShaderModule   vshader;
+GPUShaderModule   fshader;
+GPUPipelineLayout playout;
+GPURenderPipeline pipeline;
+GPUBuffer         vbuffer;
+GPUBuffer         ibuffer;
+glm::mat4         mvp;
 
 auto read_shader_source() -> const char*
 {
@@ -75,21 +74,11 @@ void setup_pipeline()
         return device.create_shader_module(desc);
     });
 
-    blayout = execute([&]() {
-        auto desc                       = GPUBindGroupLayoutDescriptor{};
-        auto entry                      = GPUBindGroupLayoutEntry{};
-        entry.type                      = GPUBindingResourceType::BUFFER;
-        entry.binding                   = 0;
-        entry.visibility                = GPUShaderStage::VERTEX;
-        entry.buffer.type               = GPUBufferBindingType::UNIFORM;
-        entry.buffer.has_dynamic_offset = false;
-        desc.entries.push_back(entry);
-        return device.create_bind_group_layout(desc);
-    });
-
+    // NOTE: the mvp is pushed with every draw, no bind group is needed.
+    // The range comes from the reflection of the [[vk::push_constant]] block, so it always matches the shader.
     playout = execute([&]() {
-        auto desc               = GPUPipelineLayoutDescriptor{};
-        desc.bind_group_layouts = {blayout};
+        auto desc                 = GPUPipelineLayoutDescriptor{};
+        desc.push_constant_ranges = module->get_push_constant_ranges();
         return device.create_pipeline_layout(desc);
     });
 
@@ -154,15 +143,6 @@ void setup_buffers()
         return device.create_buffer(desc);
     });
 
-    ubuffer = execute([&]() {
-        auto desc               = GPUBufferDescriptor{};
-        desc.label              = "uniform_buffer";
-        desc.size               = sizeof(glm::mat4x4);
-        desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
-        desc.mapped_at_creation = true;
-        return device.create_buffer(desc);
-    });
-
     auto vertices = vbuffer.get_mapped_range<Vertex>();
 
     // positions
@@ -181,16 +161,15 @@ void setup_buffers()
     indices.at(1) = 1;
     indices.at(2) = 2;
 
-    // uniform
+    // transform, pushed at draw time
     auto& surface    = RHI::get_current_surface();
     auto  extent     = surface.get_current_extent();
-    auto  uniform    = ubuffer.get_mapped_range<glm::mat4>();
     auto  projection = glm::perspective(1.05f, float(extent.width) / float(extent.height), 0.1f, 100.0f);
     auto  modelview  = glm::lookAt(
         glm::vec3(0.0f, 0.0f, 3.0f),
         glm::vec3(0.0f, 0.0f, 0.0f),
         glm::vec3(0.0f, 1.0f, 0.0f));
-    uniform.at(0) = projection * modelview;
+    mvp = projection * modelview;
 }
 
 void cleanup()
@@ -203,7 +182,6 @@ void cleanup()
     vbuffer.destroy();
     vshader.destroy();
     fshader.destroy();
-    blayout.destroy();
     playout.destroy();
     pipeline.destroy();
 }
@@ -224,21 +202,6 @@ void render()
         return device.create_command_buffer(desc);
     });
 
-    // create bind group
-    auto bind_group = execute([&]() {
-        auto entry          = GPUBindGroupEntry{};
-        entry.type          = GPUBindingResourceType::BUFFER;
-        entry.binding       = 0;
-        entry.buffer.buffer = ubuffer;
-        entry.buffer.offset = 0;
-        entry.buffer.size   = 0;
-
-        auto desc   = GPUBindGroupDescriptor{};
-        desc.layout = blayout;
-        desc.entries.push_back(entry);
-        return device.create_bind_group(desc);
-    });
-
     auto color_attachment        = GPURenderPassColorAttachment{};
     color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
     color_attachment.load_op     = GPULoadOp::CLEAR;
@@ -258,7 +221,7 @@ void render()
     command.set_pipeline(pipeline);
     command.set_vertex_buffer(0, vbuffer);
     command.set_index_buffer(ibuffer, GPUIndexFormat::UINT32);
-    command.set_bind_group(0, bind_group);
+    command.set_push_constants(GPUShaderStage::VERTEX, 0, sizeof(glm::mat4), &mvp);
     command.draw_indexed(3, 1, 0, 0, 0);
     command.end_render_pass();
     command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <system_error>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "FrameCapture.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // O_DIRECT requires the buffer address, file offset and size of every write to be block aligned
+    constexpr size_t BLOCK_SIZE = 4096;
+
+    // output is written in chunks of at least this size, large sequential writes keep the disk busy
+    constexpr size_t CHUNK_SIZE = 16ull << 20;
+
+    constexpr char   FRAME_HEADER[]    = "FRAME\n";
+    constexpr size_t FRAME_HEADER_SIZE = sizeof(FRAME_HEADER) - 1;
+
+    inline auto align_up(size_t value, size_t alignment) -> size_t
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    inline auto elapsed_ms(Clock::time_point start) -> double
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+} // namespace
+
+FrameCapture::FrameCapture(const FrameCaptureDescriptor& descriptor)
+    : descriptor(descriptor), layout(descriptor.width, descriptor.height)
+{
+    // NOTE: frames are preallocated, so that submit() never allocates on the render thread
+    frames.resize(descriptor.queue_depth);
+    for (uint i = 0; i < descriptor.queue_depth; i++) {
+        frames.at(i).resize(size_t(descriptor.width) * descriptor.height * 4);
+        free_frames.push_back(i);
+    }
+
+    // room for at least two frames, so that a chunk can always be written before the next frame is converted
+    auto frame_bytes = FRAME_HEADER_SIZE + layout.frame_size();
+    capacity         = align_up(std::max(CHUNK_SIZE, frame_bytes * 2), BLOCK_SIZE) + BLOCK_SIZE;
+    storage.resize(capacity + BLOCK_SIZE);
+    output = reinterpret_cast<uint8_t*>(align_up(reinterpret_cast<uintptr_t>(storage.data()), BLOCK_SIZE));
+
+#if defined(__linux__)
+    auto flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    if (descriptor.direct_io) {
+        fd        = open(descriptor.path.c_str(), flags | O_DIRECT, 0644);
+        direct_io = fd >= 0;
+    }
+
+    // NOTE: some file systems (tmpfs, for example) refuse O_DIRECT, fall back to buffered writes
+    if (fd < 0)
+        fd = open(descriptor.path.c_str(), flags, 0644);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "failed to create " + descriptor.path);
+#else
+    file = std::fopen(descriptor.path.c_str(), "wb");
+    if (file == nullptr)
+        throw std::system_error(errno, std::generic_category(), "failed to create " + descriptor.path);
+
+    // the output buffer already batches writes, a second buffer would only add a copy
+    std::setvbuf(file, nullptr, _IONBF, 0);
+#endif
+
+    // full range 4:2:0, matching the conversion in rgba_to_i420
+    auto header = "YUV4MPEG2 W" + std::to_string(descriptor.width) +
+                  " H" + std::to_string(descriptor.height) +
+                  " F" + std::to_string(descriptor.fps) + ":1 Ip A1:1 C420jpeg\n";
+    append(header.data(), header.size());
+
+    thread = std::thread([this]() { encode_loop(); });
+}
+
+FrameCapture::~FrameCapture()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    if (thread.joinable())
+        thread.join();
+
+#if defined(__linux__)
+    if (fd >= 0)
+        close(fd);
+#else
+    if (file != nullptr)
+        std::fclose(file);
+#endif
+}
+
+auto FrameCapture::submit(const uint8_t* rgba, uint bytes_per_row) -> bool
+{
+    uint index = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (free_frames.empty()) {
+            statistics.dropped++;
+            return false;
+        }
+        index = free_frames.front();
+        free_frames.pop_front();
+    }
+
+    // the frame is owned by this thread until it is queued, rows are stored without padding
+    auto& frame     = frames.at(index);
+    auto  row_bytes = size_t(descriptor.width) * 4;
+    for (uint row = 0; row < descriptor.height; row++)
+        std::memcpy(frame.data() + row * row_bytes, rgba + size_t(row) * bytes_per_row, row_bytes);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued_frames.push_back(index);
+        statistics.submitted++;
+    }
+    ready.notify_one();
+    return true;
+}
+
+auto FrameCapture::stats() const -> FrameCaptureStats
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+void FrameCapture::encode_loop()
+{
+    while (true) {
+        uint index = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [&]() { return stopping || !queued_frames.empty(); });
+
+            // NOTE: frames queued before stopping are still written
+            if (queued_frames.empty())
+                break;
+
+            index = queued_frames.front();
+            queued_frames.pop_front();
+        }
+
+        encode(frames.at(index));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        free_frames.push_back(index);
+        statistics.written++;
+    }
+
+    flush(true);
+}
+
+void FrameCapture::encode(const std::vector<uint8_t>& rgba)
+{
+    reserve(FRAME_HEADER_SIZE + layout.frame_size());
+    append(FRAME_HEADER, FRAME_HEADER_SIZE);
+
+    // convert straight into the output buffer, the YUV planes are never copied
+    auto  start = Clock::now();
+    auto* y     = output + output_size;
+    auto* u     = y + layout.luma_size();
+    auto* v     = u + layout.chroma_size();
+    rgba_to_i420(rgba.data(), descriptor.width * 4, layout, y, u, v);
+    output_size += layout.frame_size();
+
+    auto convert_ms = elapsed_ms(start);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    statistics.convert_ms += convert_ms;
+}
+
+void FrameCapture::append(const void* data, size_t size)
+{
+    reserve(size);
+    std::memcpy(output + output_size, data, size);
+    output_size += size;
+}
+
+void FrameCapture::reserve(size_t size)
+{
+    if (output_size + size > capacity)
+        flush(false);
+}
+
+void FrameCapture::flush(bool final)
+{
+    // only whole blocks are written, the remainder stays in the buffer until the next flush
+    auto bytes = final ? output_size : output_size / BLOCK_SIZE * BLOCK_SIZE;
+    if (bytes == 0)
+        return;
+
+    auto start = Clock::now();
+
+#if defined(__linux__)
+    // NOTE: the last write of a direct file is padded to a whole block, and the padding is truncated afterwards
+    auto padded = direct_io ? align_up(bytes, BLOCK_SIZE) : bytes;
+    std::memset(output + bytes, 0, padded - bytes);
+
+    size_t offset = 0;
+    while (!failed && offset < padded) {
+        auto result = write(fd, output + offset, padded - offset);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0) {
+            std::cerr << "FrameCapture: failed to write " << descriptor.path << ": " << std::strerror(errno) << std::endl;
+            failed = true;
+            break;
+        }
+        offset += size_t(result);
+    }
+
+    if (!failed && padded != bytes && ftruncate(fd, off_t(file_size + bytes)) != 0) {
+        std::cerr << "FrameCapture: failed to truncate " << descriptor.path << ": " << std::strerror(errno) << std::endl;
+        failed = true;
+    }
+#else
+    if (!failed && std::fwrite(output, 1, bytes, file) != bytes) {
+        std::cerr << "FrameCapture: failed to write " << descriptor.path << std::endl;
+        failed = true;
+    }
+#endif
+
+    std::memmove(output, output + bytes, output_size - bytes);
+    output_size -= bytes;
+    file_size += bytes;
+
+    auto write_ms = elapsed_ms(start);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    statistics.write_ms += write_ms;
+    statistics.bytes = file_size;
+}
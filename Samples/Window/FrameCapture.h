@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Lyra/Common.hpp>
+
+#include "YUV.h"
+
+struct FrameCaptureDescriptor
+{
+    std::string path;
+    uint        width       = 0;
+    uint        height      = 0;
+    uint        fps         = 60;
+    uint        queue_depth = 8;    // frames buffered between the render thread and the encoder
+    bool        direct_io   = true; // bypass the page cache with O_DIRECT where supported
+};
+
+struct FrameCaptureStats
+{
+    uint64_t submitted  = 0;
+    uint64_t written    = 0;
+    uint64_t dropped    = 0; // frames refused because the encoder was behind
+    uint64_t bytes      = 0;
+    double   convert_ms = 0.0; // total time spent converting to YUV
+    double   write_ms   = 0.0; // total time spent in write calls
+};
+
+// Writes frames to a Y4M (raw YUV 4:2:0) video file from a background thread.
+//
+// submit() only copies the RGBA pixels into one of queue_depth preallocated frames, and returns.
+// The encoder thread converts queued frames to YUV with SIMD, straight into a large aligned output
+// buffer, which is written out in big block aligned chunks. Nothing on the render thread waits for the
+// encoder; when every frame is queued, submit() drops the frame and counts it.
+class FrameCapture
+{
+public:
+    // Throws std::system_error when the file cannot be created.
+    explicit FrameCapture(const FrameCaptureDescriptor& descriptor);
+
+    // Encodes every queued frame before closing the file.
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&)            = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    auto submit(const uint8_t* rgba, uint bytes_per_row) -> bool;
+
+    auto stats() const -> FrameCaptureStats;
+
+    auto direct() const -> bool { return direct_io; }
+
+private:
+    void encode_loop();
+    void encode(const std::vector<uint8_t>& rgba);
+    void append(const void* data, size_t size);
+    void reserve(size_t size);
+    void flush(bool final);
+
+private:
+    FrameCaptureDescriptor descriptor;
+    I420Layout             layout;
+
+    // frames handed from the render thread to the encoder
+    std::vector<std::vector<uint8_t>> frames;
+    std::deque<uint>                  free_frames;
+    std::deque<uint>                  queued_frames;
+    mutable std::mutex                mutex;
+    std::condition_variable           ready;
+    std::atomic<bool>                 stopping = false;
+    std::thread                       thread;
+    FrameCaptureStats                 statistics;
+
+    // output, only touched by the encoder thread after construction
+    std::vector<uint8_t> storage;
+    uint8_t*             output      = nullptr; // block aligned view into storage
+    size_t               capacity    = 0;
+    size_t               output_size = 0;
+    uint64_t             file_size   = 0;
+    bool                 direct_io   = false;
+    bool                 failed      = false;
+    int                  fd          = -1;
+    std::FILE*           file        = nullptr;
+};
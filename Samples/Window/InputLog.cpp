@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "InputLog.h"
+
+using namespace lyra;
+using namespace lyra::wsi;
+
+namespace
+{
+    constexpr char     LOG_MAGIC[8] = {'L', 'Y', 'R', 'A', 'I', 'N', 'P', 'T'};
+    constexpr uint32_t LOG_VERSION  = 1;
+    constexpr uint64_t RUN_BYTES    = sizeof(uint16_t) + sizeof(uint32_t); // keys and frames, as written by save()
+
+    // NOTE: fields are written one by one in little endian, so logs can be shared between machines
+    struct LogHeader
+    {
+        char     magic[8];
+        uint32_t version;
+        uint32_t key_count;  // size of RECORDED_KEYS when the log was written
+        float    delta_time; // seconds per frame
+        uint32_t run_count;
+        uint64_t frame_count;
+    };
+
+    template <typename T>
+    void write_le(std::ostream& out, T value)
+    {
+        uint8_t bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        std::reverse(bytes, bytes + sizeof(T));
+#endif
+        out.write(reinterpret_cast<const char*>(bytes), sizeof(T));
+    }
+
+    template <typename T>
+    auto read_le(std::istream& in) -> T
+    {
+        uint8_t bytes[sizeof(T)] = {};
+        in.read(reinterpret_cast<char*>(bytes), sizeof(T));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        std::reverse(bytes, bytes + sizeof(T));
+#endif
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+} // namespace
+
+auto FrameInput::is_key_down(KeyButton key) const -> bool
+{
+    for (uint i = 0; i < RECORDED_KEYS.size(); i++)
+        if (RECORDED_KEYS[i] == key)
+            return (keys >> i) & 1;
+    return false;
+}
+
+auto FrameInput::from(const WindowInput& input, float delta_time) -> FrameInput
+{
+    auto frame       = FrameInput{};
+    frame.delta_time = delta_time;
+    for (uint i = 0; i < RECORDED_KEYS.size(); i++)
+        if (input.is_key_down(RECORDED_KEYS[i]))
+            frame.keys |= uint16_t(1u << i);
+    return frame;
+}
+
+InputRecorder::InputRecorder(std::string path, float delta_time) : path(std::move(path)), delta_time(delta_time)
+{
+}
+
+InputRecorder::~InputRecorder()
+{
+    if (!saved)
+        save();
+}
+
+void InputRecorder::record(const FrameInput& input)
+{
+    if (runs.empty() || runs.back().keys != input.keys || runs.back().frames == UINT32_MAX)
+        runs.push_back(Run{input.keys, 0});
+
+    runs.back().frames++;
+    frames++;
+}
+
+auto InputRecorder::save() -> bool
+{
+    saved = true;
+
+    auto out = std::ofstream(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "InputRecorder: failed to create " << path << std::endl;
+        return false;
+    }
+
+    out.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+    write_le<uint32_t>(out, LOG_VERSION);
+    write_le<uint32_t>(out, uint32_t(RECORDED_KEYS.size()));
+    write_le<float>(out, delta_time);
+    write_le<uint32_t>(out, uint32_t(runs.size()));
+    write_le<uint64_t>(out, frames);
+    for (auto& run : runs) {
+        write_le<uint16_t>(out, run.keys);
+        write_le<uint32_t>(out, run.frames);
+    }
+    return bool(out);
+}
+
+InputReplay::InputReplay(const std::string& path)
+{
+    auto in = std::ifstream(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("failed to open input log " + path);
+
+    auto header = LogHeader{};
+    in.read(header.magic, sizeof(header.magic));
+    header.version     = read_le<uint32_t>(in);
+    header.key_count   = read_le<uint32_t>(in);
+    header.delta_time  = read_le<float>(in);
+    header.run_count   = read_le<uint32_t>(in);
+    header.frame_count = read_le<uint64_t>(in);
+
+    if (!in || std::memcmp(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0)
+        throw std::runtime_error(path + " is not an input log");
+    if (header.version != LOG_VERSION)
+        throw std::runtime_error(path + " has unsupported version " + std::to_string(header.version));
+    if (header.key_count != RECORDED_KEYS.size())
+        throw std::runtime_error(path + " was recorded with a different set of keys");
+    if (!(header.delta_time > 0.0f))
+        throw std::runtime_error(path + " has an invalid delta time");
+    if (header.run_count > header.frame_count)
+        throw std::runtime_error(path + " is corrupted");
+
+    // NOTE: the run count comes from the file, check it against what is left of the file before allocating for it
+    auto position = in.tellg();
+    in.seekg(0, std::ios::end);
+    auto remaining = static_cast<uint64_t>(in.tellg() - position);
+    in.seekg(position);
+    if (uint64_t(header.run_count) * RUN_BYTES > remaining)
+        throw std::runtime_error(path + " is truncated");
+
+    uint64_t total = 0;
+    runs.resize(header.run_count);
+    for (auto& run : runs) {
+        run.keys   = read_le<uint16_t>(in);
+        run.frames = read_le<uint32_t>(in);
+        total += run.frames;
+    }
+
+    if (!in || total != header.frame_count)
+        throw std::runtime_error(path + " is truncated");
+
+    frames      = header.frame_count;
+    fixed_delta = header.delta_time;
+}
+
+auto InputReplay::next(FrameInput& input) -> bool
+{
+    while (run < runs.size() && played == runs[run].frames) {
+        run++;
+        played = 0;
+    }
+
+    if (run == runs.size())
+        return false;
+
+    input.delta_time = fixed_delta;
+    input.keys       = runs[run].keys;
+    played++;
+    return true;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Lyra/Common.hpp>
+#include <Lyra/Window.hpp>
+
+// Keys recorded by the input log, one bit each. Other keys read as released during replay.
+constexpr std::array<lyra::wsi::KeyButton, 11> RECORDED_KEYS = {
+    lyra::wsi::KeyButton::W,
+    lyra::wsi::KeyButton::A,
+    lyra::wsi::KeyButton::S,
+    lyra::wsi::KeyButton::D,
+    lyra::wsi::KeyButton::Q,
+    lyra::wsi::KeyButton::E,
+    lyra::wsi::KeyButton::SPACE,
+    lyra::wsi::KeyButton::UP,
+    lyra::wsi::KeyButton::DOWN,
+    lyra::wsi::KeyButton::LEFT,
+    lyra::wsi::KeyButton::RIGHT,
+};
+
+// The part of WindowInput a frame depends on, either taken from the window or from a log.
+struct FrameInput
+{
+    float    delta_time = 0.0f;
+    uint16_t keys       = 0; // bit i is RECORDED_KEYS[i]
+
+    auto is_key_down(lyra::wsi::KeyButton key) const -> bool;
+
+    static auto from(const lyra::wsi::WindowInput& input, float delta_time) -> FrameInput;
+};
+
+// Records key states frame by frame, and writes them to a compact binary log.
+//
+// The log stores the fixed delta time once, followed by run length encoded key states,
+// so a camera path of a few minutes takes a few hundred bytes.
+class InputRecorder
+{
+public:
+    explicit InputRecorder(std::string path, float delta_time);
+
+    // Writes the log, if it was not saved yet.
+    ~InputRecorder();
+
+    InputRecorder(const InputRecorder&)            = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    void record(const FrameInput& input);
+
+    auto save() -> bool;
+
+    auto frame_count() const -> uint64_t { return frames; }
+
+private:
+    struct Run
+    {
+        uint16_t keys   = 0;
+        uint32_t frames = 0;
+    };
+
+    std::string      path;
+    float            delta_time = 0.0f;
+    std::vector<Run> runs;
+    uint64_t         frames = 0;
+    bool             saved  = false;
+};
+
+// Plays a log back, one frame per call, always with the delta time it was recorded with.
+class InputReplay
+{
+public:
+    // Throws std::runtime_error when the log cannot be read.
+    explicit InputReplay(const std::string& path);
+
+    // Returns false once every recorded frame was played.
+    auto next(FrameInput& input) -> bool;
+
+    auto frame_count() const -> uint64_t { return frames; }
+
+    auto delta_time() const -> float { return fixed_delta; }
+
+private:
+    struct Run
+    {
+        uint16_t keys   = 0;
+        uint32_t frames = 0;
+    };
+
+    std::vector<Run> runs;
+    uint64_t         frames      = 0;
+    float            fixed_delta = 0.0f;
+    size_t           run         = 0; // current run
+    uint32_t         played      = 0; // frames played of the current run
+};
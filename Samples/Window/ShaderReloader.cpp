@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "ShaderReloader.h"
+
+using namespace lyra;
+using namespace lyra::rhi;
+
+namespace
+{
+    // editors tend to save in several steps (truncate, write, rename), wait for them to settle
+    constexpr auto SETTLE_TIME = std::chrono::milliseconds(50);
+
+    // how often the watcher thread checks whether it should exit
+    constexpr int POLL_TIMEOUT_MS = 100;
+} // namespace
+
+ShaderReloader::ShaderReloader(std::string directory, std::map<std::string, std::vector<std::string>> files)
+    : directory(std::move(directory)), files(std::move(files))
+{
+#if defined(__linux__)
+    // NOTE: Watch the directory rather than the files themselves, because many editors save by writing
+    // a temporary file and renaming it over the original, which would silently drop a per-file watch.
+    watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch_fd < 0 || inotify_add_watch(watch_fd, this->directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "ShaderReloader: failed to watch " << this->directory << std::endl;
+        return;
+    }
+#endif
+
+    thread = std::thread([this]() { watch_loop(); });
+}
+
+ShaderReloader::~ShaderReloader()
+{
+    stopping = true;
+    if (thread.joinable())
+        thread.join();
+
+#if defined(__linux__)
+    if (watch_fd >= 0)
+        close(watch_fd);
+#endif
+}
+
+auto ShaderReloader::poll() -> std::vector<Result>
+{
+    auto completed = std::vector<Result>{};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    completed.swap(results);
+    return completed;
+}
+
+void ShaderReloader::watch_loop()
+{
+    while (!stopping) {
+        auto changed = wait_for_changes();
+        if (changed.empty()) continue;
+
+        std::this_thread::sleep_for(SETTLE_TIME);
+        for (auto& file : changed)
+            compile(file);
+    }
+}
+
+#if defined(__linux__)
+auto ShaderReloader::wait_for_changes() -> std::vector<std::string>
+{
+    auto pfd   = pollfd{};
+    pfd.fd     = watch_fd;
+    pfd.events = POLLIN;
+    if (::poll(&pfd, 1, POLL_TIMEOUT_MS) <= 0) return {};
+
+    auto changed = std::vector<std::string>{};
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        auto length = read(watch_fd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            auto event = reinterpret_cast<const inotify_event*>(ptr);
+            if (event->len > 0 && files.count(event->name) && std::find(changed.begin(), changed.end(), event->name) == changed.end())
+                changed.push_back(event->name);
+            ptr += sizeof(inotify_event) + event->len;
+        }
+    }
+
+    return changed;
+}
+#else
+auto ShaderReloader::wait_for_changes() -> std::vector<std::string>
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(POLL_TIMEOUT_MS));
+
+    auto changed = std::vector<std::string>{};
+    for (auto& [file, entries] : files) {
+        auto error = std::error_code{};
+        auto time  = std::filesystem::last_write_time(std::filesystem::path(directory) / file, error);
+        if (error) continue;
+
+        auto it = timestamps.find(file);
+        if (it != timestamps.end() && it->second != time)
+            changed.push_back(file);
+        timestamps[file] = time;
+    }
+    return changed;
+}
+#endif
+
+void ShaderReloader::compile(const std::string& file)
+{
+    auto result = Result{};
+    result.file = file;
+    auto start  = std::chrono::steady_clock::now();
+
+    auto stream = std::ifstream(std::filesystem::path(directory) / file, std::ios::binary);
+    auto source = std::stringstream{};
+    source << stream.rdbuf();
+
+    try {
+        auto compiler = execute([&]() {
+            auto desc   = CompilerDescriptor{};
+            desc.target = LYRA_RHI_COMPILER;
+            desc.flags  = CompileFlag::DEBUG | CompileFlag::REFLECT;
+            return Compiler::init(desc);
+        });
+
+        auto text   = source.str();
+        auto module = execute([&]() {
+            auto desc   = CompileDescriptor{};
+            desc.module = file;
+            desc.path   = file;
+            desc.source = text.c_str();
+            return compiler->compile(desc);
+        });
+
+        // copy the code out, the compiler and module are gone when this function returns
+        for (auto& entry : files.at(file)) {
+            auto code  = module->get_shader_blob(entry.c_str());
+            auto bytes = static_cast<const uint8_t*>(code->data);
+            result.entries[entry].code.assign(bytes, bytes + code->size);
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        result.entries.clear();
+    }
+
+    auto end          = std::chrono::steady_clock::now();
+    result.compile_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    results.push_back(std::move(result));
+}
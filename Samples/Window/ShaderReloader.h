@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Lyra/Common.hpp>
+#include <Lyra/Render.hpp>
+
+// Development helper that watches shader sources on disk, and recompiles them in the background.
+//
+// The watcher thread only produces shader blobs, it never touches the device. The render loop calls poll()
+// once per frame (at a frame boundary), and swaps modules/pipelines for whatever has finished compiling.
+// Files are watched with inotify on Linux, and by polling modification times elsewhere.
+class ShaderReloader
+{
+public:
+    struct Blob
+    {
+        std::vector<uint8_t> code;
+    };
+
+    struct Result
+    {
+        std::string                 file;
+        std::map<std::string, Blob> entries; // entry point -> compiled code
+        std::string                 error;   // empty when compilation succeeded
+        double                      compile_ms = 0.0;
+    };
+
+    // Watch the given files inside directory. Only the listed entry points of each file are compiled.
+    explicit ShaderReloader(std::string directory, std::map<std::string, std::vector<std::string>> files);
+    ~ShaderReloader();
+
+    ShaderReloader(const ShaderReloader&)            = delete;
+    ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+    // Take all results completed since the last call, never blocks on compilation.
+    auto poll() -> std::vector<Result>;
+
+private:
+    void watch_loop();
+    void compile(const std::string& file);
+    auto wait_for_changes() -> std::vector<std::string>;
+
+private:
+    std::string                                            directory;
+    std::map<std::string, std::vector<std::string>>        files;
+    std::thread                                            thread;
+    std::atomic<bool>                                      stopping = false;
+    std::mutex                                             mutex;
+    std::vector<Result>                                    results;
+
+    // platform specific change detection, inotify on Linux, modification times elsewhere
+    int                                                    watch_fd = -1;
+    std::map<std::string, std::filesystem::file_time_type> timestamps;
+};
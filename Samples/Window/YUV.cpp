@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LYRA_YUV_SSE2 1
+#endif
+
+#include "YUV.h"
+
+// NOTE: 8 bit fixed point coefficients of full range BT.601, each row sums to 256 (Y) or 0 (U, V).
+namespace
+{
+    constexpr int YR = 77, YG = 150, YB = 29;
+    constexpr int UR = -43, UG = -85, UB = 128;
+    constexpr int VR = 128, VG = -107, VB = -21;
+
+    inline auto luma(const uint8_t* p) -> uint8_t
+    {
+        return uint8_t((YR * p[0] + YG * p[1] + YB * p[2] + 128) >> 8);
+    }
+
+    // r, g, b are sums of 4 pixels, hence the extra 2 bits of shift.
+    // NOTE: saturated blue (U) and red (V) round to 256, clamped like the saturating pack of the SSE2 path
+    inline auto chroma(int r, int g, int b, int cr, int cg, int cb) -> uint8_t
+    {
+        return uint8_t(std::clamp(((cr * r + cg * g + cb * b + 512) >> 10) + 128, 0, 255));
+    }
+
+    void luma_row_scalar(const uint8_t* src, uint8_t* dst, uint begin, uint end)
+    {
+        for (uint x = begin; x < end; x++)
+            dst[x] = luma(src + x * 4);
+    }
+
+    void chroma_row_scalar(const uint8_t* row0, const uint8_t* row1, uint width, uint8_t* u, uint8_t* v, uint begin, uint end)
+    {
+        for (uint cx = begin; cx < end; cx++) {
+            auto* p0 = row0 + cx * 8;
+            auto* p1 = row1 + cx * 8;
+            auto  dx = (cx * 2 + 1 < width) ? 4 : 0; // repeat the last column for odd widths
+
+            auto r = p0[0] + p0[dx + 0] + p1[0] + p1[dx + 0];
+            auto g = p0[1] + p0[dx + 1] + p1[1] + p1[dx + 1];
+            auto b = p0[2] + p0[dx + 2] + p1[2] + p1[dx + 2];
+
+            u[cx] = chroma(r, g, b, UR, UG, UB);
+            v[cx] = chroma(r, g, b, VR, VG, VB);
+        }
+    }
+
+#if defined(LYRA_YUV_SSE2)
+    // sums adjacent 32 bit lanes of a and b: [a0 + a1, a2 + a3, b0 + b1, b2 + b3]
+    inline auto add_pairs(__m128i a, __m128i b) -> __m128i
+    {
+        auto even = _mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0));
+        auto odd  = _mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1));
+        return _mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd));
+    }
+
+    // 4 RGBA pixels to 4 luma values in 32 bit lanes
+    inline auto luma4(__m128i pixels, __m128i coef) -> __m128i
+    {
+        auto zero = _mm_setzero_si128();
+        auto lo   = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), coef);
+        auto hi   = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), coef);
+        return _mm_srai_epi32(_mm_add_epi32(add_pairs(lo, hi), _mm_set1_epi32(128)), 8);
+    }
+
+    // 4 RGBA pixels of two rows to the 16 bit RGBA sums of their two 2x2 blocks
+    inline auto block_sums(__m128i top, __m128i bottom) -> __m128i
+    {
+        auto zero = _mm_setzero_si128();
+        auto lo   = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+        auto hi   = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+        lo        = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+        hi        = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+        return _mm_unpacklo_epi64(lo, hi);
+    }
+
+    // 4 chroma values from the block sums of 8 pixels, packed into the low 4 bytes
+    inline auto chroma4(__m128i blocks01, __m128i blocks23, __m128i coef) -> int
+    {
+        auto sum = add_pairs(_mm_madd_epi16(blocks01, coef), _mm_madd_epi16(blocks23, coef));
+        sum      = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(512)), 10), _mm_set1_epi32(128));
+        sum      = _mm_packs_epi32(sum, sum);
+        return _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+    }
+
+    // 16 pixels per iteration, returns the first pixel left to the scalar path
+    auto luma_row_sse2(const uint8_t* src, uint8_t* dst, uint width) -> uint
+    {
+        auto coef = _mm_setr_epi16(YR, YG, YB, 0, YR, YG, YB, 0);
+
+        uint x = 0;
+        for (; x + 16 <= width; x += 16) {
+            auto* p  = reinterpret_cast<const __m128i*>(src + x * 4);
+            auto  y0 = luma4(_mm_loadu_si128(p + 0), coef);
+            auto  y1 = luma4(_mm_loadu_si128(p + 1), coef);
+            auto  y2 = luma4(_mm_loadu_si128(p + 2), coef);
+            auto  y3 = luma4(_mm_loadu_si128(p + 3), coef);
+            auto  y  = _mm_packus_epi16(_mm_packs_epi32(y0, y1), _mm_packs_epi32(y2, y3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), y);
+        }
+        return x;
+    }
+
+    // 8 pixels (4 chroma values) per iteration, returns the first chroma value left to the scalar path
+    auto chroma_row_sse2(const uint8_t* row0, const uint8_t* row1, uint width, uint8_t* u, uint8_t* v) -> uint
+    {
+        auto coef_u = _mm_setr_epi16(UR, UG, UB, 0, UR, UG, UB, 0);
+        auto coef_v = _mm_setr_epi16(VR, VG, VB, 0, VR, VG, VB, 0);
+
+        uint x = 0;
+        for (; x + 8 <= width; x += 8) {
+            auto* p0 = reinterpret_cast<const __m128i*>(row0 + x * 4);
+            auto* p1 = reinterpret_cast<const __m128i*>(row1 + x * 4);
+            auto  b0 = block_sums(_mm_loadu_si128(p0 + 0), _mm_loadu_si128(p1 + 0));
+            auto  b1 = block_sums(_mm_loadu_si128(p0 + 1), _mm_loadu_si128(p1 + 1));
+
+            auto cu = chroma4(b0, b1, coef_u);
+            auto cv = chroma4(b0, b1, coef_v);
+            std::memcpy(u + x / 2, &cu, 4);
+            std::memcpy(v + x / 2, &cv, 4);
+        }
+        return x / 2;
+    }
+#endif
+} // namespace
+
+void rgba_to_i420(const uint8_t* rgba, uint bytes_per_row, const I420Layout& layout, uint8_t* y, uint8_t* u, uint8_t* v)
+{
+#if defined(LYRA_YUV_SSE2)
+    for (uint row = 0; row < layout.height; row++) {
+        auto* src   = rgba + size_t(row) * bytes_per_row;
+        auto* dst   = y + size_t(row) * layout.width;
+        auto  first = luma_row_sse2(src, dst, layout.width);
+        luma_row_scalar(src, dst, first, layout.width);
+    }
+
+    for (uint row = 0; row < layout.chroma_height; row++) {
+        auto* row0  = rgba + size_t(row * 2) * bytes_per_row;
+        auto* row1  = (row * 2 + 1 < layout.height) ? row0 + bytes_per_row : row0; // repeat the last row for odd heights
+        auto* dst_u = u + size_t(row) * layout.chroma_width;
+        auto* dst_v = v + size_t(row) * layout.chroma_width;
+        auto  first = chroma_row_sse2(row0, row1, layout.width, dst_u, dst_v);
+        chroma_row_scalar(row0, row1, layout.width, dst_u, dst_v, first, layout.chroma_width);
+    }
+#else
+    rgba_to_i420_scalar(rgba, bytes_per_row, layout, y, u, v);
+#endif
+}
+
+void rgba_to_i420_scalar(const uint8_t* rgba, uint bytes_per_row, const I420Layout& layout, uint8_t* y, uint8_t* u, uint8_t* v)
+{
+    for (uint row = 0; row < layout.height; row++)
+        luma_row_scalar(rgba + size_t(row) * bytes_per_row, y + size_t(row) * layout.width, 0, layout.width);
+
+    for (uint row = 0; row < layout.chroma_height; row++) {
+        auto* row0 = rgba + size_t(row * 2) * bytes_per_row;
+        auto* row1 = (row * 2 + 1 < layout.height) ? row0 + bytes_per_row : row0;
+        chroma_row_scalar(row0, row1, layout.width, u + size_t(row) * layout.chroma_width, v + size_t(row) * layout.chroma_width, 0, layout.chroma_width);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Lyra/Common.hpp>
+
+// Size of the I420 planes for an image, chroma planes are subsampled 2x2 (rounded up).
+struct I420Layout
+{
+    uint width         = 0;
+    uint height        = 0;
+    uint chroma_width  = 0;
+    uint chroma_height = 0;
+
+    explicit I420Layout(uint width, uint height)
+        : width(width), height(height), chroma_width((width + 1) / 2), chroma_height((height + 1) / 2)
+    {
+    }
+
+    auto luma_size() const -> size_t { return size_t(width) * height; }
+    auto chroma_size() const -> size_t { return size_t(chroma_width) * chroma_height; }
+    auto frame_size() const -> size_t { return luma_size() + chroma_size() * 2; }
+};
+
+// Convert RGBA8 to planar 4:2:0 YUV, full range BT.601 (what Y4M calls C420jpeg).
+// Alpha is ignored. Chroma is the average of each 2x2 block, edge pixels are repeated for odd sizes.
+// Uses SSE2 when available, the scalar path produces identical results.
+void rgba_to_i420(const uint8_t* rgba, uint bytes_per_row, const I420Layout& layout, uint8_t* y, uint8_t* u, uint8_t* v);
+
+// Scalar reference of rgba_to_i420, exposed to validate the SIMD path.
+void rgba_to_i420_scalar(const uint8_t* rgba, uint bytes_per_row, const I420Layout& layout, uint8_t* y, uint8_t* u, uint8_t* v);
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "YUV.h"
+
+// Compares rgba_to_i420 against rgba_to_i420_scalar, which must produce identical planes,
+// and solid colors against full range BT.601, so that builds without SSE2 are checked as well.
+// Sizes cover the SIMD blocks (16 luma, 8 chroma pixels) and the scalar tails of odd sizes,
+// images cover random noise and the saturated colors at the ends of the chroma range.
+
+namespace
+{
+    struct Image
+    {
+        const char*          name;
+        uint                 width;
+        uint                 height;
+        std::vector<uint8_t> rgba;
+        bool                 solid = false;
+    };
+
+    auto solid(const char* name, uint width, uint height, uint8_t r, uint8_t g, uint8_t b) -> Image
+    {
+        auto image = Image{name, width, height, std::vector<uint8_t>(size_t(width) * height * 4), true};
+        for (size_t i = 0; i < image.rgba.size(); i += 4) {
+            image.rgba[i + 0] = r;
+            image.rgba[i + 1] = g;
+            image.rgba[i + 2] = b;
+            image.rgba[i + 3] = 255;
+        }
+        return image;
+    }
+
+    auto noise(uint width, uint height, std::mt19937& rng) -> Image
+    {
+        auto image = Image{"noise", width, height, std::vector<uint8_t>(size_t(width) * height * 4), false};
+        for (auto& value : image.rgba)
+            value = uint8_t(rng() & 0xFF);
+        return image;
+    }
+
+    // every pixel of a solid image converts to the same values, within rounding of the fixed point coefficients
+    auto check_solid(const Image& image, const std::vector<uint8_t>& frame) -> bool
+    {
+        auto r = double(image.rgba[0]), g = double(image.rgba[1]), b = double(image.rgba[2]);
+
+        auto saturate = [](double value) { return int(std::clamp(std::lround(value), 0l, 255l)); };
+        int  expected[3] = {
+            saturate(0.299 * r + 0.587 * g + 0.114 * b),
+            saturate(-0.168736 * r - 0.331264 * g + 0.5 * b + 128.0),
+            saturate(0.5 * r - 0.418688 * g - 0.081312 * b + 128.0),
+        };
+
+        auto layout    = I420Layout(image.width, image.height);
+        size_t planes[3] = {size_t(0), layout.luma_size(), layout.luma_size() + layout.chroma_size()};
+        size_t sizes[3]  = {layout.luma_size(), layout.chroma_size(), layout.chroma_size()};
+        for (uint plane = 0; plane < 3; plane++) {
+            for (size_t i = 0; i < sizes[plane]; i++) {
+                auto value = int(frame[planes[plane] + i]);
+                if (std::abs(value - expected[plane]) <= 1)
+                    continue;
+
+                std::cerr << image.name << " " << image.width << "x" << image.height << ": " << "YUV"[plane] << " is " << value
+                          << " at " << i << ", expected " << expected[plane] << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto check(const Image& image) -> bool
+    {
+        auto layout = I420Layout(image.width, image.height);
+        auto simd   = std::vector<uint8_t>(layout.frame_size());
+        auto scalar = std::vector<uint8_t>(layout.frame_size());
+
+        auto convert = [&](auto function, std::vector<uint8_t>& frame) {
+            auto* y = frame.data();
+            auto* u = y + layout.luma_size();
+            auto* v = u + layout.chroma_size();
+            function(image.rgba.data(), image.width * 4, layout, y, u, v);
+        };
+        convert(rgba_to_i420, simd);
+        convert(rgba_to_i420_scalar, scalar);
+
+        if (std::memcmp(simd.data(), scalar.data(), simd.size()) == 0)
+            return !image.solid || check_solid(image, scalar);
+
+        auto offset = size_t(0);
+        while (simd[offset] == scalar[offset])
+            offset++;
+
+        auto plane = offset < layout.luma_size() ? "Y" : offset < layout.luma_size() + layout.chroma_size() ? "U" : "V";
+        std::cerr << image.name << " " << image.width << "x" << image.height << ": " << plane << " differs at byte " << offset
+                  << ", simd " << int(simd[offset]) << ", scalar " << int(scalar[offset]) << std::endl;
+        return false;
+    }
+} // namespace
+
+int main()
+{
+    auto rng    = std::mt19937(42);
+    auto failed = 0u;
+    auto total  = 0u;
+
+    uint sizes[][2] = {{1, 1}, {2, 2}, {7, 3}, {8, 2}, {10, 2}, {15, 5}, {16, 16}, {17, 9}, {33, 7}, {64, 4}, {101, 11}};
+    for (auto& size : sizes) {
+        auto w = size[0], h = size[1];
+
+        Image images[] = {
+            solid("red", w, h, 255, 0, 0),
+            solid("green", w, h, 0, 255, 0),
+            solid("blue", w, h, 0, 0, 255),
+            solid("black", w, h, 0, 0, 0),
+            solid("white", w, h, 255, 255, 255),
+            noise(w, h, rng),
+        };
+
+        for (auto& image : images) {
+            total++;
+            if (!check(image)) failed++;
+        }
+    }
+
+    std::cout << total - failed << "/" << total << " images convert identically" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -1,4 +1,10 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <string_view>
 #include <cmrc/cmrc.hpp>
 
@@ -7,12 +13,29 @@
 #include <Lyra/Render.hpp>
 #include <Lyra/Window.hpp>
 
+#include "InputLog.h"
+#include "MemoryTracker.h"
+
+#if defined(LYRA_SHADER_HOT_RELOAD_DIR)
+#include "ShaderReloader.h"
+#endif
+
+#if defined(LYRA_FRAME_CAPTURE)
+#include "FrameCapture.h"
+#include "ReadbackRing.h"
+#endif
+
 using namespace lyra;
 using namespace lyra::wsi;
 using namespace lyra::rhi;
 
 CMRC_DECLARE(resources);
 
+constexpr uint  FRAMES_INFLIGHT   = 3;
+constexpr uint  FRAMES_PER_REPORT = 120;
+constexpr float FIXED_DELTA_TIME  = 1.0f / 60.0f; // used while recording, replays use the delta time of the log
+constexpr auto  MEMORY_DUMP_PATH  = "window_memory.json";
+
 struct Camera
 {
     glm::vec3 position;
@@ -31,13 +54,82 @@ struct InverseTransform
     glm::vec2 fade_range;
 };
 
+// NOTE: the layout of a resolved statistics query depends on the backend. Vulkan packs the enabled statistics in the
+// order of the GPUPipelineStatistic bits, D3D12 always writes the whole D3D12_QUERY_DATA_PIPELINE_STATISTICS.
+// The stride of a query and the offset of each statistic are taken from the query set, in bytes.
+struct QueryLayout
+{
+    GPUSize64 vertex_invocations   = 0; // offsets within the statistics query
+    GPUSize64 primitives           = 0;
+    GPUSize64 fragment_invocations = 0;
+    GPUSize64 samples_passed       = 0; // offset of the occlusion query, after the statistics query
+    GPUSize64 size                 = 0; // of the resolved queries of one frame
+};
+
+// resolved queries of one frame, as read back
+struct QueryResults
+{
+    uint64_t vertex_invocations;
+    uint64_t primitives;
+    uint64_t fragment_invocations;
+    uint64_t samples_passed;
+};
+
+// pipeline objects replaced by a shader reload, kept alive until no frame in flight uses them
+struct RetiredPipeline
+{
+    GPUShaderModule   vshader;
+    GPUShaderModule   fshader;
+    GPURenderPipeline pipeline;
+    GPURenderPipeline capture_pipeline; // only created with frame capture
+    uint64_t          frame;
+};
+
 GPUShaderModule    vshader;
 GPUShaderModule    fshader;
 GPUBindGroupLayout blayout;
 GPUPipelineLayout  playout;
 GPURenderPipeline  pipeline;
 GPUBuffer          ubuffer;
+GPUQuerySet        statistics_queries[FRAMES_INFLIGHT];
+GPUQuerySet        occlusion_queries[FRAMES_INFLIGHT];
+GPUBuffer          query_resolve[FRAMES_INFLIGHT];
+GPUBuffer          query_readback[FRAMES_INFLIGHT];
+QueryLayout        query_layout;
 Camera             camera;
+uint64_t           frame_index = 0;
+
+// GPU memory by label, see SubAllocation, ids are released at cleanup
+MemoryTracker     memory;
+std::vector<uint> tracked;
+
+std::deque<RetiredPipeline> retired;
+
+// input recording and replay, see --record and --replay
+struct ReplayTimer
+{
+    std::chrono::steady_clock::time_point start;
+    bool                                  started  = false;
+    bool                                  finished = false;
+};
+
+std::unique_ptr<InputRecorder> recorder;
+std::unique_ptr<InputReplay>   replay;
+ReplayTimer                    replay_timer;
+
+#if defined(LYRA_SHADER_HOT_RELOAD_DIR)
+std::unique_ptr<ShaderReloader> reloader;
+#endif
+
+#if defined(LYRA_FRAME_CAPTURE)
+GPURenderPipeline             capture_pipeline;
+GPUTexture                    capture_target;
+GPUTextureView                capture_view;
+std::unique_ptr<ReadbackRing> capture_readback;
+std::unique_ptr<FrameCapture> capture;
+uint                          capture_count  = 0;
+uint                          capture_memory = 0;
+#endif
 
 auto read_shader_source() -> const char*
 {
@@ -48,6 +140,33 @@ auto read_shader_source() -> const char*
     return program;
 }
 
+auto create_pipeline(const GPUShaderModule& vertex, const GPUShaderModule& fragment, GPUTextureFormat format) -> GPURenderPipeline
+{
+    auto& device = RHI::get_current_device();
+
+    return execute([&]() {
+        auto target         = GPUColorTargetState{};
+        target.format       = format;
+        target.blend_enable = false;
+
+        auto desc                                  = GPURenderPipelineDescriptor{};
+        desc.layout                                = playout;
+        desc.primitive.cull_mode                   = GPUCullMode::NONE;
+        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.primitive.front_face                  = GPUFrontFace::CCW;
+        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
+        desc.depth_stencil.depth_compare           = GPUCompareFunction::ALWAYS;
+        desc.depth_stencil.depth_write_enabled     = false;
+        desc.multisample.alpha_to_coverage_enabled = false;
+        desc.multisample.count                     = 1;
+        desc.vertex.module                         = vertex;
+        desc.fragment.module                       = fragment;
+        desc.fragment.targets.push_back(target);
+
+        return device.create_render_pipeline(desc);
+    });
+}
+
 void setup_pipeline()
 {
     auto& device  = RHI::get_current_device();
@@ -105,27 +224,12 @@ void setup_pipeline()
         return device.create_pipeline_layout(desc);
     });
 
-    pipeline = execute([&]() {
-        auto target         = GPUColorTargetState{};
-        target.format       = surface.get_current_format();
-        target.blend_enable = false;
+    pipeline = create_pipeline(vshader, fshader, surface.get_current_format());
 
-        auto desc                                  = GPURenderPipelineDescriptor{};
-        desc.layout                                = playout;
-        desc.primitive.cull_mode                   = GPUCullMode::NONE;
-        desc.primitive.topology                    = GPUPrimitiveTopology::TRIANGLE_LIST;
-        desc.primitive.front_face                  = GPUFrontFace::CCW;
-        desc.primitive.strip_index_format          = GPUIndexFormat::UINT32;
-        desc.depth_stencil.depth_compare           = GPUCompareFunction::ALWAYS;
-        desc.depth_stencil.depth_write_enabled     = false;
-        desc.multisample.alpha_to_coverage_enabled = false;
-        desc.multisample.count                     = 1;
-        desc.vertex.module                         = vshader;
-        desc.fragment.module                       = fshader;
-        desc.fragment.targets.push_back(target);
-
-        return device.create_render_pipeline(desc);
-    });
+#if defined(LYRA_FRAME_CAPTURE)
+    // NOTE: the swapchain format is up to the platform, captured frames are rendered again in a format known to the encoder
+    capture_pipeline = create_pipeline(vshader, fshader, GPUTextureFormat::RGBA8UNORM);
+#endif
 }
 
 void setup_buffers()
@@ -138,10 +242,70 @@ void setup_buffers()
         desc.size               = sizeof(InverseTransform);
         desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
         desc.mapped_at_creation = true;
+        tracked.push_back(memory.track(desc));
         return device.create_buffer(desc);
     });
 }
 
+void setup_queries()
+{
+    auto& device = RHI::get_current_device();
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        statistics_queries[i] = execute([&]() {
+            auto desc                = GPUQuerySetDescriptor{};
+            desc.label               = "statistics_queries";
+            desc.type                = GPUQueryType::PIPELINE_STATISTICS;
+            desc.count               = 1;
+            desc.pipeline_statistics = GPUPipelineStatistic::VERTEX_SHADER_INVOCATIONS |
+                                       GPUPipelineStatistic::CLIPPER_INVOCATIONS |
+                                       GPUPipelineStatistic::FRAGMENT_SHADER_INVOCATIONS;
+            auto queries = device.create_query_set(desc);
+            tracked.push_back(memory.track(desc, queries));
+            return queries;
+        });
+
+        occlusion_queries[i] = execute([&]() {
+            auto desc  = GPUQuerySetDescriptor{};
+            desc.label = "occlusion_queries";
+            desc.type  = GPUQueryType::OCCLUSION;
+            desc.count = 1;
+            auto queries = device.create_query_set(desc);
+            tracked.push_back(memory.track(desc, queries));
+            return queries;
+        });
+    }
+
+    // NOTE: every statistics query set has the same layout, which is only known once one has been created
+    auto& queries                     = statistics_queries[0];
+    query_layout.vertex_invocations   = queries.get_statistic_offset(GPUPipelineStatistic::VERTEX_SHADER_INVOCATIONS);
+    query_layout.primitives           = queries.get_statistic_offset(GPUPipelineStatistic::CLIPPER_INVOCATIONS);
+    query_layout.fragment_invocations = queries.get_statistic_offset(GPUPipelineStatistic::FRAGMENT_SHADER_INVOCATIONS);
+    query_layout.samples_passed       = queries.get_result_stride();
+    query_layout.size                 = query_layout.samples_passed + sizeof(uint64_t);
+
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        query_resolve[i] = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "query_resolve_buffer";
+            desc.size  = query_layout.size;
+            desc.usage = GPUBufferUsage::QUERY_RESOLVE | GPUBufferUsage::COPY_SRC;
+            tracked.push_back(memory.track(desc));
+            return device.create_buffer(desc);
+        });
+
+        query_readback[i] = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "query_readback_buffer";
+            desc.size               = query_layout.size;
+            desc.usage              = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            desc.mapped_at_creation = true;
+            tracked.push_back(memory.track(desc));
+            return device.create_buffer(desc);
+        });
+    }
+}
+
 void setup_camera()
 {
     camera.position = glm::vec3(0.0f, 1.0f, 3.0f);
@@ -150,26 +314,276 @@ void setup_camera()
     camera.far      = 100.0f;
 }
 
+void setup_reloader()
+{
+#if defined(LYRA_SHADER_HOT_RELOAD_DIR)
+    reloader = std::make_unique<ShaderReloader>(
+        LYRA_SHADER_HOT_RELOAD_DIR,
+        std::map<std::string, std::vector<std::string>>{{"shader.slang", {"vsmain", "fsmain"}}});
+
+    std::cout << "Shader hot reload enabled, watching " << LYRA_SHADER_HOT_RELOAD_DIR << std::endl;
+#endif
+}
+
+void reload_shaders()
+{
+    // release pipelines that are no longer referenced by any frame in flight
+    while (!retired.empty() && retired.front().frame + FRAMES_INFLIGHT <= frame_index) {
+        retired.front().pipeline.destroy();
+#if defined(LYRA_FRAME_CAPTURE)
+        retired.front().capture_pipeline.destroy();
+#endif
+        retired.front().vshader.destroy();
+        retired.front().fshader.destroy();
+        retired.pop_front();
+    }
+
+#if defined(LYRA_SHADER_HOT_RELOAD_DIR)
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+
+    for (auto& result : reloader->poll()) {
+        if (!result.error.empty()) {
+            std::cerr << "Failed to reload " << result.file << ", keeping the previous pipeline:\n"
+                      << result.error << std::endl;
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        auto create_module = [&](const char* entry, const char* label) {
+            auto& blob = result.entries.at(entry);
+            auto  desc = GPUShaderModuleDescriptor{};
+            desc.label = label;
+            desc.data  = blob.code.data();
+            desc.size  = blob.code.size();
+            return device.create_shader_module(desc);
+        };
+
+        auto new_vshader  = execute([&]() { return create_module("vsmain", "vertex_shader"); });
+        auto new_fshader  = execute([&]() { return create_module("fsmain", "fragment_shader"); });
+        auto new_pipeline = create_pipeline(new_vshader, new_fshader, surface.get_current_format());
+
+        // NOTE: no device.wait() here, frames in flight keep using the old objects until they retire
+        auto old = RetiredPipeline{vshader, fshader, pipeline, {}, frame_index};
+        vshader  = new_vshader;
+        fshader  = new_fshader;
+        pipeline = new_pipeline;
+
+#if defined(LYRA_FRAME_CAPTURE)
+        old.capture_pipeline = capture_pipeline;
+        capture_pipeline     = create_pipeline(new_vshader, new_fshader, GPUTextureFormat::RGBA8UNORM);
+#endif
+        retired.push_back(old);
+
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "Reloaded " << result.file
+                  << " (compile: " << result.compile_ms << " ms, swap: "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms)" << std::endl;
+    }
+#endif
+}
+
+#if defined(LYRA_FRAME_CAPTURE)
+void start_capture()
+{
+    auto& device  = RHI::get_current_device();
+    auto& surface = RHI::get_current_surface();
+    auto  extent  = surface.get_current_extent();
+
+    capture_target = execute([&]() {
+        auto desc            = GPUTextureDescriptor{};
+        desc.format          = GPUTextureFormat::RGBA8UNORM;
+        desc.size.width      = extent.width;
+        desc.size.height     = extent.height;
+        desc.size.depth      = 1;
+        desc.array_layers    = 1;
+        desc.mip_level_count = 1;
+        desc.usage           = GPUTextureUsage::RENDER_ATTACHMENT | GPUTextureUsage::COPY_SRC;
+        desc.label           = "capture_target";
+        capture_memory       = memory.track(desc);
+        return device.create_texture(desc);
+    });
+
+    capture_view = capture_target.create_view();
+
+    auto ring       = ReadbackRingDescriptor{};
+    ring.width      = extent.width;
+    ring.height     = extent.height;
+    ring.format     = GPUTextureFormat::RGBA8UNORM;
+    ring.slot_count = FRAMES_INFLIGHT + 1;
+
+    auto desc   = FrameCaptureDescriptor{};
+    desc.path   = "capture_" + std::to_string(capture_count++) + ".y4m";
+    desc.width  = extent.width;
+    desc.height = extent.height;
+    desc.fps    = 60;
+
+    try {
+        capture = std::make_unique<FrameCapture>(desc);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        capture_target.destroy();
+        memory.release(capture_memory);
+        return;
+    }
+    capture_readback = std::make_unique<ReadbackRing>(ring);
+
+    std::cout << "Capturing " << extent.width << "x" << extent.height << " to " << desc.path
+              << (capture->direct() ? " (O_DIRECT)" : "") << std::endl;
+}
+
+void stop_capture()
+{
+    if (!capture)
+        return;
+
+    // deliver the frames still being copied, then let the encoder finish the queue
+    capture_readback->flush();
+    auto readbacks = capture_readback->stats();
+    capture_readback.reset();
+
+    auto encoder = capture->stats();
+    capture.reset();
+
+    // NOTE: flush() only waits for the readbacks that were enqueued, a frame dropped by a full ring
+    // still renders into the target without a fence, so the device must be idle before it is destroyed
+    RHI::get_current_device().wait();
+    capture_target.destroy();
+    memory.release(capture_memory);
+
+    auto written = std::max<uint64_t>(encoder.written, 1);
+    std::cout << "Captured " << encoder.written << " frames"
+              << ", " << double(encoder.bytes) / (1024.0 * 1024.0) << " MB"
+              << ", dropped " << readbacks.dropped << " (readback) + " << encoder.dropped << " (encoder)"
+              << ", convert " << encoder.convert_ms / written << " ms/frame"
+              << ", write " << encoder.write_ms / written << " ms/frame" << std::endl;
+}
+#endif
+
+void dump_memory()
+{
+    if (memory.dump(MEMORY_DUMP_PATH))
+        std::cout << "Memory usage written to " << MEMORY_DUMP_PATH << std::endl;
+    else
+        std::cerr << "Failed to write " << MEMORY_DUMP_PATH << std::endl;
+}
+
 void cleanup()
 {
     auto& device = RHI::get_current_device();
     device.wait();
 
+    // NOTE: dumped before anything is destroyed, so that the file shows what was resident at the end
+    dump_memory();
+
+#if defined(LYRA_SHADER_HOT_RELOAD_DIR)
+    reloader.reset();
+#endif
+
+#if defined(LYRA_FRAME_CAPTURE)
+    stop_capture();
+#endif
+
+    if (recorder && recorder->save())
+        std::cout << "Recorded " << recorder->frame_count() << " frames of input" << std::endl;
+    recorder.reset();
+
     // NOTE: This is optional, because all resources will be automatically
     // collected by device at destruction.
+    for (auto& old : retired) {
+        old.pipeline.destroy();
+#if defined(LYRA_FRAME_CAPTURE)
+        old.capture_pipeline.destroy();
+#endif
+        old.vshader.destroy();
+        old.fshader.destroy();
+    }
+    retired.clear();
+    for (uint i = 0; i < FRAMES_INFLIGHT; i++) {
+        statistics_queries[i].destroy();
+        occlusion_queries[i].destroy();
+        query_resolve[i].destroy();
+        query_readback[i].destroy();
+    }
+    ubuffer.destroy();
+    for (auto id : tracked)
+        memory.release(id);
+    tracked.clear();
     vshader.destroy();
     fshader.destroy();
     blayout.destroy();
     playout.destroy();
     pipeline.destroy();
+#if defined(LYRA_FRAME_CAPTURE)
+    capture_pipeline.destroy();
+#endif
 }
 
-void update(const WindowInput& input)
+// input of this frame, from the window, or from the log when replaying
+auto next_input(const WindowInput& window_input) -> FrameInput
 {
+    if (recorder) {
+        // NOTE: record with the same fixed delta time the log is replayed with, so that the recorded path is the replayed path
+        auto input = FrameInput::from(window_input, FIXED_DELTA_TIME);
+        recorder->record(input);
+        return input;
+    }
+
+    if (!replay)
+        return FrameInput::from(window_input, window_input.delta_time);
+
+    auto input = FrameInput{};
+    if (replay->next(input)) {
+        if (!replay_timer.started) {
+            replay_timer.start   = std::chrono::steady_clock::now();
+            replay_timer.started = true;
+        }
+        return input;
+    }
+
+    // the camera stops once the log runs out, the replay is timed from its first frame to its last
+    if (!replay_timer.finished) {
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replay_timer.start).count();
+        auto frames  = std::max<uint64_t>(replay->frame_count(), 1);
+        std::cout << "Replay finished: " << replay->frame_count() << " frames in " << seconds << " s"
+                  << ", " << seconds * 1000.0 / frames << " ms/frame" << std::endl;
+        replay_timer.finished = true;
+    }
+    input.delta_time = replay->delta_time();
+    return input;
+}
+
+void update(const WindowInput& window_input)
+{
+    auto input = next_input(window_input);
+
     glm::vec3 forward = glm::vec3(0.0f, 0.0f, 1.0f);
     glm::vec3 right   = glm::cross(forward, camera.up);
     glm::vec3 dir     = glm::vec3(0.0f, 0.0f, 0.0f);
 
+    // F1 writes the current memory usage, once per key press
+    static bool dump_key_was_down = false;
+
+    auto dump_key_down = window_input.is_key_down(KeyButton::F1);
+    if (dump_key_down && !dump_key_was_down)
+        dump_memory();
+    dump_key_was_down = dump_key_down;
+
+#if defined(LYRA_FRAME_CAPTURE)
+    // F9 starts and stops recording
+    static bool capture_key_was_down = false;
+
+    auto capture_key_down = window_input.is_key_down(KeyButton::F9);
+    if (capture_key_down && !capture_key_was_down) {
+        if (capture)
+            stop_capture();
+        else
+            start_capture();
+    }
+    capture_key_was_down = capture_key_down;
+#endif
+
     if (input.is_key_down(KeyButton::W))
         dir += forward;
 
@@ -216,16 +630,70 @@ void update(const WindowInput& input)
     uniform.at(0).fade_range    = glm::vec2(5.0f, 10.0f);
 }
 
+auto read_queries(uint slot) -> QueryResults
+{
+    auto data    = query_readback[slot].get_mapped_range<uint8_t>().data();
+    auto results = QueryResults{};
+    std::memcpy(&results.vertex_invocations, data + query_layout.vertex_invocations, sizeof(uint64_t));
+    std::memcpy(&results.primitives, data + query_layout.primitives, sizeof(uint64_t));
+    std::memcpy(&results.fragment_invocations, data + query_layout.fragment_invocations, sizeof(uint64_t));
+    std::memcpy(&results.samples_passed, data + query_layout.samples_passed, sizeof(uint64_t));
+    return results;
+}
+
+// the grid shader discards every pixel looking above the horizon, without a depth or stencil test
+// every fragment which is not discarded writes one sample, so the difference is the number of discards
+void report_queries(uint slot)
+{
+    static QueryResults total = {};
+
+    // the readback buffer in this slot was filled FRAMES_INFLIGHT frames ago, which is complete once its texture is acquired
+    if (frame_index < FRAMES_INFLIGHT)
+        return;
+
+    auto results = read_queries(slot);
+    total.vertex_invocations += results.vertex_invocations;
+    total.primitives += results.primitives;
+    total.fragment_invocations += results.fragment_invocations;
+    total.samples_passed += results.samples_passed;
+
+    if ((frame_index - FRAMES_INFLIGHT + 1) % FRAMES_PER_REPORT != 0)
+        return;
+
+    auto fragments = std::max<uint64_t>(total.fragment_invocations, 1);
+    auto discarded = total.fragment_invocations - std::min(total.samples_passed, total.fragment_invocations);
+    std::cout << "Vertices: " << total.vertex_invocations / FRAMES_PER_REPORT
+              << ", Primitives: " << total.primitives / FRAMES_PER_REPORT
+              << ", Fragments: " << total.fragment_invocations / FRAMES_PER_REPORT
+              << ", Samples Passed: " << total.samples_passed / FRAMES_PER_REPORT
+              << ", Discarded: " << discarded / FRAMES_PER_REPORT
+              << " (" << 100.0 * double(discarded) / double(fragments) << "%)" << std::endl;
+
+    total = {};
+}
+
 void render()
 {
     auto& device  = RHI::get_current_device();
     auto& surface = RHI::get_current_surface();
 
+    // swap in reloaded shaders at the frame boundary
+    reload_shaders();
+
+#if defined(LYRA_FRAME_CAPTURE)
+    // hand finished readbacks to the encoder, never waits for the GPU
+    if (capture_readback)
+        capture_readback->poll(frame_index);
+#endif
+
     // acquire next frame from swapchain
     auto texture = surface.get_current_texture();
     if (texture.suboptimal)
         return;
 
+    auto slot = static_cast<uint>(frame_index % FRAMES_INFLIGHT);
+    report_queries(slot);
+
     // create command buffer
     auto command = execute([&]() {
         auto desc  = GPUCommandBufferDescriptor{};
@@ -267,24 +735,88 @@ void render()
     command.set_scissor_rect(0, 0, extent.width, extent.height);
     command.set_pipeline(pipeline);
     command.set_bind_group(0, bind_group);
+    command.begin_query(statistics_queries[slot], 0);
+    command.begin_query(occlusion_queries[slot], 0);
     command.draw(3, 1, 0, 0);
+    command.end_query(occlusion_queries[slot], 0);
+    command.end_query(statistics_queries[slot], 0);
     command.end_render_pass();
+
+    // queries are resolved on the GPU, and read back by the frame that reuses this slot
+    command.resource_barrier(state_transition(query_resolve[slot], undefined_state(), copy_dst_state()));
+    command.resolve_query_set(statistics_queries[slot], 0, 1, query_resolve[slot], 0);
+    command.resolve_query_set(occlusion_queries[slot], 0, 1, query_resolve[slot], query_layout.samples_passed);
+    command.resource_barrier(state_transition(query_resolve[slot], copy_dst_state(), copy_src_state()));
+    command.copy_buffer_to_buffer(query_resolve[slot], 0, query_readback[slot], 0, query_layout.size);
+
+#if defined(LYRA_FRAME_CAPTURE)
+    if (capture) {
+        auto capture_attachment = color_attachment;
+        capture_attachment.view = capture_view;
+
+        auto capture_pass              = render_pass;
+        capture_pass.color_attachments = {capture_attachment};
+
+        command.resource_barrier(state_transition(capture_target, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(capture_pass);
+        command.set_viewport(0, 0, extent.width, extent.height);
+        command.set_scissor_rect(0, 0, extent.width, extent.height);
+        command.set_pipeline(capture_pipeline);
+        command.set_bind_group(0, bind_group);
+        command.draw(3, 1, 0, 0);
+        command.end_render_pass();
+    }
+#endif
+
     command.resource_barrier(state_transition(texture.texture, color_attachment_state(), present_src_state()));
     command.signal(texture.complete, GPUBarrierSync::RENDER_TARGET);
     command.submit();
 
+#if defined(LYRA_FRAME_CAPTURE)
+    // copy the frame into the readback ring, the encoder receives it a few frames later
+    if (capture) {
+        capture_readback->enqueue(capture_target, color_attachment_state(), frame_index, [](const ReadbackImage& image) {
+            capture->submit(image.data, image.bytes_per_row);
+        });
+    }
+#endif
+
     // present this frame to swapchain
     texture.present();
+
+    frame_index++;
 }
 
 void resize(const WindowInfo& info)
 {
     std::cout << "Window Resized: " << info.width << "x" << info.height
               << std::endl;
+
+#if defined(LYRA_FRAME_CAPTURE)
+    // NOTE: a Y4M stream has a fixed resolution, so recording stops with the resize
+    stop_capture();
+#endif
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    // --record <file> logs the input of every frame, --replay <file> plays it back with the recorded delta time
+    for (int i = 1; i + 1 < argc; i += 2) {
+        auto option = std::string(argv[i]);
+        if (option == "--record") {
+            recorder = std::make_unique<InputRecorder>(argv[i + 1], FIXED_DELTA_TIME);
+            std::cout << "Recording input to " << argv[i + 1] << std::endl;
+        } else if (option == "--replay") {
+            try {
+                replay = std::make_unique<InputReplay>(argv[i + 1]);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+            std::cout << "Replaying " << replay->frame_count() << " frames of input from " << argv[i + 1] << std::endl;
+        }
+    }
+
     auto win = execute([&]() {
         auto desc   = WindowDescriptor{};
         desc.title  = "Lyra Engine :: Sample";
@@ -313,12 +845,11 @@ int main()
     });
 
     auto surface = execute([&]() {
-        auto desc         = GPUSurfaceDescriptor{};
-        desc.label        = "main_surface";
-        desc.window       = win->handle;
-        desc.present_mode = GPUPresentMode::Fifo;
-
-        // desc.frames_inflight = 2;
+        auto desc            = GPUSurfaceDescriptor{};
+        desc.label           = "main_surface";
+        desc.window          = win->handle;
+        desc.present_mode    = GPUPresentMode::Fifo;
+        desc.frames_inflight = FRAMES_INFLIGHT;
         return rhi->request_surface(desc);
     });
 
@@ -326,7 +857,9 @@ int main()
 
     win->bind<WindowEvent::START>(setup_pipeline);
     win->bind<WindowEvent::START>(setup_buffers);
+    win->bind<WindowEvent::START>(setup_queries);
     win->bind<WindowEvent::START>(setup_camera);
+    win->bind<WindowEvent::START>(setup_reloader);
     win->bind<WindowEvent::CLOSE>(cleanup);
     win->bind<WindowEvent::UPDATE>(update);
     win->bind<WindowEvent::RENDER>(render);